@@ -0,0 +1,220 @@
+#include "nn_functions.h"
+
+static inline q7_t avg_pool_round(const q31_t sum, const uint32_t count)
+{
+    // Single rounding, half away from zero
+    q31_t half = (q31_t)(count >> 1);
+    return (q7_t)((sum >= 0 ? sum + half : sum - half) / (q31_t)count);
+}
+
+/**
+ * @brief Average of a window of HWC pixels, all channels
+ * @param[in]       pIn         Pointer to the first pixel of the window
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       row_stride  Distance between two window rows (in q7)
+ * @param[in]       num_cols    Pixels per window row
+ * @param[in]       num_rows    Window rows
+ * @param[in,out]   pOut        Pointer to the output pixel
+ *
+ * @details
+ * Four channels are summed per word with __SXTAB16 into two 16-bit lanes each.
+ * The lanes are flushed to 32-bit sums every 256 taps, before they can overflow.
+ * A channel group is written only after all its taps are read.
+ */
+static void avg_pool_window(const q7_t *pIn,
+                            const uint16_t ch_im_in,
+                            const uint32_t row_stride,
+                            const uint32_t num_cols,
+                            const uint32_t num_rows,
+                            q7_t *pOut)
+{
+    uint32_t count = num_cols * num_rows;
+    uint32_t i_row, i_col;
+    uint16_t row_shift = 0;
+    uint16_t rowCnt = ch_im_in >> 2;
+
+    while (rowCnt)
+    {
+        q31_t sum = 0;
+        q31_t sum2 = 0;
+        q31_t sum3 = 0;
+        q31_t sum4 = 0;
+        q31_t acc13 = 0;
+        q31_t acc24 = 0;
+        uint16_t taps = 0;
+
+        for (i_row = 0; i_row < num_rows; i_row++)
+        {
+            const q7_t *pB = pIn + i_row * row_stride + row_shift;
+            for (i_col = 0; i_col < num_cols; i_col++)
+            {
+                q31_t inB = *__SIMD32(pB);
+                pB += ch_im_in;
+                acc13 = __SXTAB16(acc13, inB);
+                acc24 = __SXTAB16(acc24, __ROR(inB, 8));
+                taps++;
+                if (taps == 256)
+                {
+                    sum += (q15_t)acc13;
+                    sum3 += (q15_t)(acc13 >> 16);
+                    sum2 += (q15_t)acc24;
+                    sum4 += (q15_t)(acc24 >> 16);
+                    acc13 = 0;
+                    acc24 = 0;
+                    taps = 0;
+                }
+            }
+        }
+        sum += (q15_t)acc13;
+        sum3 += (q15_t)(acc13 >> 16);
+        sum2 += (q15_t)acc24;
+        sum4 += (q15_t)(acc24 >> 16);
+
+        *pOut++ = avg_pool_round(sum, count);
+        *pOut++ = avg_pool_round(sum2, count);
+        *pOut++ = avg_pool_round(sum3, count);
+        *pOut++ = avg_pool_round(sum4, count);
+
+        row_shift += 4;
+        rowCnt--;
+    }
+
+    rowCnt = ch_im_in & 0x3;
+    while (rowCnt)
+    {
+        q31_t sum = 0;
+
+        for (i_row = 0; i_row < num_rows; i_row++)
+        {
+            const q7_t *pB = pIn + i_row * row_stride + row_shift;
+            for (i_col = 0; i_col < num_cols; i_col++)
+            {
+                sum += *pB;
+                pB += ch_im_in;
+            }
+        }
+        *pOut++ = avg_pool_round(sum, count);
+
+        row_shift += 1;
+        rowCnt--;
+    }
+}
+
+/**
+ * @brief Fast Q7 average pooling, any kernel size, stride and padding
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     Padding
+ * @param[in]       stride      Stride
+ * @param[in]       dim_im_out  Output tensor dimention
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ *
+ * @details
+ * Same output as arm_avepool_q7_HWC except for rounding: the window is summed
+ * in 16-bit SIMD lanes and divided once with rounding, so the result is the
+ * correctly rounded mean. Padding taps are not counted, as in CMSIS-NN.
+ * No buffer is needed.
+ *
+ * Im_out may be Im_in when padding is 0.
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. padding < dim_kernel
+*/
+
+void avg_pool_q7_HWC(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const uint16_t stride,
+                     const uint16_t dim_im_out,
+                     q7_t *Im_out)
+{
+    NN_PROFILE_BEGIN("avg_pool_q7_HWC");
+    avg_pool_q7_HWC_rows(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, stride, dim_im_out, Im_out, 0, dim_im_out);
+    NN_PROFILE_END((uint64_t)dim_im_out * dim_im_out * ch_im_in * dim_kernel * dim_kernel,
+                   dim_im_out * dim_im_out * ch_im_in);
+}
+
+/**
+ * @brief avg_pool_q7_HWC for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_out
+ *
+ * @details
+ * Other parameters as avg_pool_q7_HWC. The rows written are bit-identical to
+ * the same rows of avg_pool_q7_HWC and no other output row is touched.
+ *
+ * Constrains: as avg_pool_q7_HWC, and Im_out is not Im_in when ranges run
+ * concurrently
+*/
+
+void avg_pool_q7_HWC_rows(const q7_t *Im_in,
+                          const uint16_t dim_im_in,
+                          const uint16_t ch_im_in,
+                          const uint16_t dim_kernel,
+                          const uint16_t padding,
+                          const uint16_t stride,
+                          const uint16_t dim_im_out,
+                          q7_t *Im_out,
+                          const uint16_t start_row,
+                          const uint16_t end_row)
+{
+    int32_t i_out_y, i_out_x;
+
+    NN_PROFILE_BEGIN("avg_pool_q7_HWC_rows");
+    for (i_out_y = start_row; i_out_y < end_row; i_out_y++)
+    {
+        int32_t y_start = i_out_y * stride - padding;
+        int32_t y_end = y_start + dim_kernel;
+        y_start = y_start < 0 ? 0 : y_start;
+        y_end = y_end > dim_im_in ? dim_im_in : y_end;
+
+        for (i_out_x = 0; i_out_x < dim_im_out; i_out_x++)
+        {
+            int32_t x_start = i_out_x * stride - padding;
+            int32_t x_end = x_start + dim_kernel;
+            x_start = x_start < 0 ? 0 : x_start;
+            x_end = x_end > dim_im_in ? dim_im_in : x_end;
+
+            avg_pool_window(Im_in + (y_start * dim_im_in + x_start) * ch_im_in,
+                            ch_im_in,
+                            dim_im_in * ch_im_in,
+                            x_end - x_start,
+                            y_end - y_start,
+                            Im_out + (i_out_y * dim_im_out + i_out_x) * ch_im_in);
+        }
+    }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_out * ch_im_in * dim_kernel * dim_kernel,
+                   (end_row - start_row) * dim_im_out * ch_im_in);
+}
+
+/**
+ * @brief Fast Q7 global average pooling
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in_x Input tensor width
+ * @param[in]       dim_im_in_y Input tensor height
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in,out]   Im_out      Pointer to the output tensor (ch_im_in)
+ *
+ * @details
+ * Averages every channel over the whole input, e.g. the last pooling layer of
+ * DS-CNN. The input is read as one run of pixels, summed in 16-bit SIMD lanes
+ * and flushed to 32 bits every 256 pixels, then divided once with rounding.
+ *
+ * Im_out may be Im_in.
+*/
+
+void global_avg_pool_q7_HWC(const q7_t *Im_in,
+                            const uint16_t dim_im_in_x,
+                            const uint16_t dim_im_in_y,
+                            const uint16_t ch_im_in,
+                            q7_t *Im_out)
+{
+    NN_PROFILE_BEGIN("global_avg_pool_q7_HWC");
+    avg_pool_window(Im_in, ch_im_in, 0, (uint32_t)dim_im_in_x * dim_im_in_y, 1, Im_out);
+    NN_PROFILE_END((uint64_t)dim_im_in_x * dim_im_in_y * ch_im_in, ch_im_in);
+}
@@ -9,6 +9,11 @@
  * 
  * @details
  * Uses SIMD to calculate average pooling by 2*2 kernel.
+ *
+ * im_out may be im_in (in place): output pixel (x, y) is written at or below
+ * the offset of input pixel (2x, 2y), after its 2x2 window is read, and every
+ * later read is above it. The output then takes the first quarter of the
+ * input tensor.
  * 
  * Constrains:
  * 1. Square input
@@ -32,6 +37,7 @@ void avg_pool_q7_HWC_opt(q7_t* im_in,
     pSrc2_2 = im_in + ch_im_in*dim_im_in + ch_im_in;
     pDst = im_out;
 
+    NN_PROFILE_BEGIN("avg_pool_q7_HWC_opt");
     uint32_t row_cnt = dim_im_in >> 1;
     while(row_cnt)
     {
@@ -64,4 +70,6 @@ void avg_pool_q7_HWC_opt(q7_t* im_in,
         pSrc2_2 += ch_im_in*dim_im_in;
         row_cnt--;
     }
+    NN_PROFILE_END((uint64_t)(dim_im_in >> 1) * (dim_im_in >> 1) * (ch_im_in & ~0x3U) * 4,
+                   (dim_im_in >> 1) * (dim_im_in >> 1) * (ch_im_in & ~0x3U));
 }
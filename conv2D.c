@@ -1,7 +1,580 @@
 #include "nn_functions.h"
 
+/*
+ * Weight offset of the w-th weight of a channel: weights are read a word (two
+ * q15) at a time, wt_step q15 apart (2 for plain widened weights, 4 for
+ * weights interleaved by output channel pair).
+ */
+static inline uint32_t conv_wt_offset(const uint32_t w, const uint16_t wt_step)
+{
+    return (w >> 1) * wt_step + (w & 0x1);
+}
+
+/*
+ * 4 pixels x 2 output channels over len contiguous window values: each weight
+ * word is loaded once for 4 pixels. The pixel windows are row_len apart. The
+ * inner loop keeps 8 accumulators, 4 data and 2 weight pointers, wt_step, the
+ * loop count, 2 weight words and 1 data word live, about 19 values: more than
+ * the Cortex-M4 has registers, so it spills. Only built into the columns with
+ * -DNN_CONV_4X2, see conv_HWC_column. With len8 (a constant), len is a
+ * multiple of 8: 4 words per loop and no leftover loop.
+ */
+NN_FORCEINLINE void conv_dot_4x2(const q15_t *pD1,
+                                 const uint32_t row_len,
+                                 const q15_t *pPara,
+                                 const q15_t *pPara2,
+                                 const uint16_t wt_step,
+                                 const uint32_t len,
+                                 const int len8,
+                                 q31_t *sum)
+{
+    const q15_t *pD2 = pD1 + row_len;
+    const q15_t *pD3 = pD2 + row_len;
+    const q15_t *pD4 = pD3 + row_len;
+    q31_t sum1 = sum[0], sum2 = sum[1], sum3 = sum[2], sum4 = sum[3];
+    q31_t sum5 = sum[4], sum6 = sum[5], sum7 = sum[6], sum8 = sum[7];
+    q31_t inA1, inA2, inB;
+
+    //One weight word of both channels against the next data word of the 4 pixels
+#define CONV_WORD_4X2()                 \
+    inA1 = *__SIMD32(pPara);            \
+    inA2 = *__SIMD32(pPara2);           \
+    inB = *__SIMD32(pD1)++;             \
+    pPara += wt_step;                   \
+    pPara2 += wt_step;                  \
+    sum1 = __SMLAD(inA1, inB, sum1);    \
+    sum5 = __SMLAD(inA2, inB, sum5);    \
+    inB = *__SIMD32(pD2)++;             \
+    sum2 = __SMLAD(inA1, inB, sum2);    \
+    sum6 = __SMLAD(inA2, inB, sum6);    \
+    inB = *__SIMD32(pD3)++;             \
+    sum3 = __SMLAD(inA1, inB, sum3);    \
+    sum7 = __SMLAD(inA2, inB, sum7);    \
+    inB = *__SIMD32(pD4)++;             \
+    sum4 = __SMLAD(inA1, inB, sum4);    \
+    sum8 = __SMLAD(inA2, inB, sum8)
+
+    uint32_t paraCnt = len8 ? len >> 3 : len >> 2;
+    while (paraCnt)
+    {
+        CONV_WORD_4X2();
+        CONV_WORD_4X2();
+        if (len8)
+        {
+            CONV_WORD_4X2();
+            CONV_WORD_4X2();
+        }
+        paraCnt--;
+    }
+#undef CONV_WORD_4X2
+    //Leftover values are contiguous in both weight layouts
+    paraCnt = len8 ? 0 : len & 0x3;
+    while (paraCnt)
+    {
+        q15_t inA1 = *pPara++;
+        q15_t inA2 = *pPara2++;
+        q15_t inB = *pD1++;
+        sum1 += inA1 * inB;
+        sum5 += inA2 * inB;
+        inB = *pD2++;
+        sum2 += inA1 * inB;
+        sum6 += inA2 * inB;
+        inB = *pD3++;
+        sum3 += inA1 * inB;
+        sum7 += inA2 * inB;
+        inB = *pD4++;
+        sum4 += inA1 * inB;
+        sum8 += inA2 * inB;
+        paraCnt--;
+    }
+
+    sum[0] = sum1;
+    sum[1] = sum2;
+    sum[2] = sum3;
+    sum[3] = sum4;
+    sum[4] = sum5;
+    sum[5] = sum6;
+    sum[6] = sum7;
+    sum[7] = sum8;
+}
+
+/*
+ * 2 pixels x 2 output channels over len contiguous window values: each weight
+ * word is loaded once for 2 pixels, with 4 accumulators, 2 data and 2 weight
+ * pointers live. len8 as conv_dot_4x2.
+ */
+NN_FORCEINLINE void conv_dot_2x2(const q15_t *pD1,
+                                 const uint32_t row_len,
+                                 const q15_t *pPara,
+                                 const q15_t *pPara2,
+                                 const uint16_t wt_step,
+                                 const uint32_t len,
+                                 const int len8,
+                                 q31_t *sum)
+{
+    const q15_t *pD2 = pD1 + row_len;
+    q31_t sum1 = sum[0], sum2 = sum[1], sum3 = sum[4], sum4 = sum[5];
+    q31_t inA1, inA2, inB1, inB2;
+
+#define CONV_WORD_2X2()                 \
+    inB1 = *__SIMD32(pD1)++;            \
+    inB2 = *__SIMD32(pD2)++;            \
+    inA1 = *__SIMD32(pPara);            \
+    inA2 = *__SIMD32(pPara2);           \
+    pPara += wt_step;                   \
+    pPara2 += wt_step;                  \
+    sum1 = __SMLAD(inA1, inB1, sum1);   \
+    sum2 = __SMLAD(inA1, inB2, sum2);   \
+    sum3 = __SMLAD(inA2, inB1, sum3);   \
+    sum4 = __SMLAD(inA2, inB2, sum4)
+
+    uint32_t paraCnt = len8 ? len >> 3 : len >> 2;
+    while (paraCnt)
+    {
+        CONV_WORD_2X2();
+        CONV_WORD_2X2();
+        if (len8)
+        {
+            CONV_WORD_2X2();
+            CONV_WORD_2X2();
+        }
+        paraCnt--;
+    }
+#undef CONV_WORD_2X2
+    paraCnt = len8 ? 0 : len & 0x3;
+    while (paraCnt)
+    {
+        q15_t inA1 = *pPara++;
+        q15_t inB1 = *pD1++;
+        q15_t inA2 = *pPara2++;
+        q15_t inB2 = *pD2++;
+        sum1 += inA1 * inB1;
+        sum2 += inA1 * inB2;
+        sum3 += inA2 * inB1;
+        sum4 += inA2 * inB2;
+        paraCnt--;
+    }
+
+    sum[0] = sum1;
+    sum[1] = sum2;
+    sum[4] = sum3;
+    sum[5] = sum4;
+}
+
+/*
+ * 1 pixel x 2 output channels over len contiguous window values, len8 as
+ * conv_dot_4x2.
+ */
+NN_FORCEINLINE void conv_dot_1x2(const q15_t *pD1,
+                                 const q15_t *pPara,
+                                 const q15_t *pPara2,
+                                 const uint16_t wt_step,
+                                 const uint32_t len,
+                                 const int len8,
+                                 q31_t *sum)
+{
+    q31_t sum1 = sum[0], sum3 = sum[4];
+    q31_t inA1, inA2, inB1;
+
+#define CONV_WORD_1X2()                 \
+    inB1 = *__SIMD32(pD1)++;            \
+    inA1 = *__SIMD32(pPara);            \
+    inA2 = *__SIMD32(pPara2);           \
+    pPara += wt_step;                   \
+    pPara2 += wt_step;                  \
+    sum1 = __SMLAD(inA1, inB1, sum1);   \
+    sum3 = __SMLAD(inA2, inB1, sum3)
+
+    uint32_t paraCnt = len8 ? len >> 3 : len >> 1;
+    while (paraCnt)
+    {
+        CONV_WORD_1X2();
+        if (len8)
+        {
+            CONV_WORD_1X2();
+            CONV_WORD_1X2();
+            CONV_WORD_1X2();
+        }
+        paraCnt--;
+    }
+#undef CONV_WORD_1X2
+    if (!len8 && (len & 0x1))
+    {
+        q15_t inB1 = *pD1;
+        sum1 += *pPara * inB1;
+        sum3 += *pPara2 * inB1;
+    }
+
+    sum[0] = sum1;
+    sum[4] = sum3;
+}
+
+/*
+ * pixels (4, 2 or 1, a constant after inlining) x 2 output channels over len
+ * contiguous window values. sum[p] and sum[4 + p] are pixel p of the two
+ * channels.
+ */
+NN_FORCEINLINE void conv_dot(const int pixels,
+                             const q15_t *pData,
+                             const uint32_t row_len,
+                             const q15_t *pPara,
+                             const q15_t *pPara2,
+                             const uint16_t wt_step,
+                             const uint32_t len,
+                             const int len8,
+                             q31_t *sum)
+{
+    if (pixels == 4)
+    {
+        conv_dot_4x2(pData, row_len, pPara, pPara2, wt_step, len, len8, sum);
+    }
+    else if (pixels == 2)
+    {
+        conv_dot_2x2(pData, row_len, pPara, pPara2, wt_step, len, len8, sum);
+    }
+    else
+    {
+        conv_dot_1x2(pData, pPara, pPara2, wt_step, len, len8, sum);
+    }
+}
+
+/*
+ * Output rows y .. y + pixels - 1 of one output column, all output channels
+ * two at a time. pData is the window of row y in bufferA, the windows are
+ * row_len apart. A window is para_per_ch_out contiguous values, or with
+ * win_head != 0 (ring buffer) dim_kernel rows of row_len values that each
+ * start at win_head and wrap to 0. len8 (a constant) is only set for
+ * contiguous windows whose length is a multiple of 8.
+ */
+NN_FORCEINLINE void conv_block(const int pixels,
+                               const q15_t *pData,
+                               const uint32_t row_len,
+                               const uint32_t win_head,
+                               const q15_t *wt,
+                               const uint32_t wt_pair,
+                               const uint16_t wt_step,
+                               const int32_t para_per_ch_out,
+                               const uint16_t ch_im_out,
+                               const nn_epilogue *ep,
+                               const uint16_t out_shift,
+                               q7_t *pOut,
+                               const uint32_t out_row,
+                               const int len8)
+{
+    //Locals, the q7 output stores may alias the epilogue
+    const q7_t *pBias = ep->bias;
+    const uint16_t b_shift = ep->bias_shift;
+    const uint8_t *pShift = ep->out_shift;
+    const q7_t act_min = ep->act_min;
+    const q7_t act_max = ep->act_max;
+    const q15_t *pPara = wt;
+    uint16_t i;
+    int p;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pPara2 = pPara + wt_pair;
+        uint16_t shift = pShift ? pShift[i] : out_shift;
+        uint16_t shift2 = pShift ? pShift[i + 1] : out_shift;
+        q31_t sum[8];
+
+        for (p = 0; p < pixels; p++)
+        {
+            sum[p] = (q31_t)pBias[i] << b_shift;
+            sum[4 + p] = (q31_t)pBias[i + 1] << b_shift;
+        }
+
+        if (win_head == 0)
+        {
+            conv_dot(pixels, pData, row_len, pPara, pPara2, wt_step, para_per_ch_out, len8, sum);
+        }
+        else
+        {
+            const q15_t *pRow = pData;
+            uint32_t w;
+            for (w = 0; w < (uint32_t)para_per_ch_out; w += row_len)
+            {
+                uint32_t off = conv_wt_offset(w, wt_step);
+                conv_dot(pixels, pRow + win_head, row_len, pPara + off, pPara2 + off, wt_step, row_len - win_head, 0,
+                         sum);
+                off = conv_wt_offset(w + row_len - win_head, wt_step);
+                conv_dot(pixels, pRow, row_len, pPara + off, pPara2 + off, wt_step, win_head, 0, sum);
+                pRow += row_len;
+            }
+        }
+
+        for (p = 0; p < pixels; p++)
+        {
+            pOut[p * out_row + i] = nn_requantize(sum[p], shift, act_min, act_max);
+            pOut[p * out_row + i + 1] = nn_requantize(sum[4 + p], shift2, act_min, act_max);
+        }
+
+        /* next channel pair, in both weight layouts */
+        pPara += 2 * para_per_ch_out;
+    }
+}
+
+/*
+ * The output rows of conv_HWC_column, len8 as conv_block
+ */
+NN_FORCEINLINE void conv_column(const q15_t *bufferA,
+                                const uint32_t row_len,
+                                const uint32_t win_head,
+                                const q15_t *wt,
+                                const uint32_t wt_pair,
+                                const uint16_t wt_step,
+                                const int32_t para_per_ch_out,
+                                const uint16_t ch_im_out,
+                                const nn_epilogue *ep,
+                                const uint16_t out_shift,
+                                q7_t *pOut,
+                                const uint32_t out_row,
+                                const uint16_t start_row,
+                                const uint16_t end_row,
+                                const int len8)
+{
+    int32_t y;
+
+#ifdef NN_CONV_4X2
+    //Calculate four points at the same time, then two, then one
+    for (y = start_row; y + 4 <= end_row; y += 4)
+    {
+        conv_block(4, bufferA + row_len * y, row_len, win_head, wt, wt_pair, wt_step, para_per_ch_out, ch_im_out,
+                   ep, out_shift, pOut, out_row, len8);
+        pOut += 4 * out_row;
+    }
+    if ((end_row - start_row) & 0x2)
+    {
+        conv_block(2, bufferA + row_len * y, row_len, win_head, wt, wt_pair, wt_step, para_per_ch_out, ch_im_out,
+                   ep, out_shift, pOut, out_row, len8);
+        pOut += 2 * out_row;
+        y += 2;
+    }
+#else
+    //Calculate two points at the same time, then one
+    for (y = start_row; y + 2 <= end_row; y += 2)
+    {
+        conv_block(2, bufferA + row_len * y, row_len, win_head, wt, wt_pair, wt_step, para_per_ch_out, ch_im_out,
+                   ep, out_shift, pOut, out_row, len8);
+        pOut += 2 * out_row;
+    }
+#endif
+    if ((end_row - start_row) & 0x1)
+    {
+        conv_block(1, bufferA + row_len * y, row_len, win_head, wt, wt_pair, wt_step, para_per_ch_out, ch_im_out,
+                   ep, out_shift, pOut, out_row, len8);
+    }
+}
+
 /**
- * @brief Fast depthwise convolution
+ * @brief Output rows [start_row, end_row) of one conv_HWC output column
+ * @param[in]       bufferA         Column window of output row 0
+ * @param[in]       row_len         q15 between the windows of two adjacent output rows (dim_kernel * ch_im_in)
+ * @param[in]       win_head        0, or for a ring buffer the offset each window row starts at
+ * @param[in]       wt              Widened weights
+ * @param[in]       wt_pair         q15 from the weights of output channel 2n to those of 2n+1
+ * @param[in]       wt_step         q15 between two weight words of one output channel
+ * @param[in]       para_per_ch_out Weights per output channel
+ * @param[in]       ch_im_out       Output channels to compute
+ * @param[in]       ep              Resolved epilogue, see nn_epilogue_resolve
+ * @param[in]       out_shift       Used when ep has no out_shift
+ * @param[in,out]   pOut            Output pixel (x, start_row)
+ * @param[in]       out_row         q7 between two output rows
+ * @param[in]       start_row       First output row
+ * @param[in]       end_row         Output row after the last one
+ *
+ * @details
+ * The blocks of conv_HWC: 2 pixels x 2 output channels per pass, so each
+ * weight word is loaded once for 2 pixels, then a 1-pixel block for an odd
+ * last row. The 1-pixel block reads only its own window, so nothing past
+ * bufferA. Built with -DNN_CONV_4X2, 4-pixel blocks come first and load each
+ * weight word once for 4 pixels, but their inner loop does not fit the
+ * Cortex-M4 register file and measures slower than the 2-pixel blocks (make
+ * bench DEFS=-DNN_CONV_4X2 in tests/), so they are opt-in until a target shows
+ * a gain.
+ *
+ * Built with -DNN_FIXED_KERNELS, a contiguous window (win_head 0) of a
+ * multiple of 8 values, e.g. ch_im_in multiple of 8 with an odd kernel, runs
+ * a variant of the blocks with 4 weight words per loop and no leftover loop.
+ * It measured about 0.8x of the plain blocks on the host, so it is opt-in.
+ *
+ * Plain widened weights are wt_pair = para_per_ch_out, wt_step = 2. Weights
+ * interleaved by output channel pair (pack_conv_HWC_weights) are wt_pair = 2,
+ * wt_step = 4.
+ *
+ * Constrains:
+ * 1. ch_im_out is even
+ * 2. with win_head != 0 or wt_step != 2, ch_im_in is even
+ */
+
+void conv_HWC_column(const q15_t *bufferA,
+                     const uint32_t row_len,
+                     const uint32_t win_head,
+                     const q15_t *wt,
+                     const uint32_t wt_pair,
+                     const uint16_t wt_step,
+                     const int32_t para_per_ch_out,
+                     const uint16_t ch_im_out,
+                     const nn_epilogue *ep,
+                     const uint16_t out_shift,
+                     q7_t *pOut,
+                     const uint32_t out_row,
+                     const uint16_t start_row,
+                     const uint16_t end_row)
+{
+    //Plain widened weights with contiguous windows (conv_HWC, _rows, _batch, _tiled, _nonsquare): a constant
+    //wt_step lets the weight pointers step by a word as in the original loop
+    if (win_head == 0 && wt_step == 2)
+    {
+#ifdef NN_FIXED_KERNELS
+        if ((para_per_ch_out & 0x7) == 0)
+        {
+            conv_column(bufferA, row_len, 0, wt, wt_pair, 2, para_per_ch_out, ch_im_out, ep, out_shift, pOut,
+                        out_row, start_row, end_row, 1);
+            return;
+        }
+#endif
+        conv_column(bufferA, row_len, 0, wt, wt_pair, 2, para_per_ch_out, ch_im_out, ep, out_shift, pOut, out_row,
+                    start_row, end_row, 0);
+        return;
+    }
+#ifdef NN_FIXED_KERNELS
+    if (win_head == 0 && (para_per_ch_out & 0x7) == 0)
+    {
+        conv_column(bufferA, row_len, 0, wt, wt_pair, wt_step, para_per_ch_out, ch_im_out, ep, out_shift, pOut,
+                    out_row, start_row, end_row, 1);
+        return;
+    }
+#endif
+    conv_column(bufferA, row_len, win_head, wt, wt_pair, wt_step, para_per_ch_out, ch_im_out, ep, out_shift, pOut,
+                out_row, start_row, end_row, 0);
+}
+
+/**
+ * @brief Widen input rows [row_lo, row_hi) of the window of output column x into bufferA
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding
+ * @param[in,out]   bufferA     Column windows, dim_kernel * ch_im_in q15 per input row
+ * @param[in]       x           Output column
+ * @param[in]       row_lo      First input row
+ * @param[in]       row_hi      Input row after the last one
+ *
+ * @details
+ * Padding columns are zeroed. The top and bottom padding rows of bufferA are
+ * left to the caller, they do not change from column to column.
+ */
+
+void conv_HWC_load_col(const q7_t *Im_in,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       q15_t *bufferA,
+                       const int32_t x,
+                       const int32_t row_lo,
+                       const int32_t row_hi)
+{
+    int32_t y;
+    uint32_t data_to_transfer;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    q15_t *pBuffer = bufferA + num_data_in_row * (padding + row_lo);
+    q7_t *data_source;
+
+    NN_PROFILE_COPY_START();
+    if (x < padding)
+    {
+        //set the left padding
+        memset((void *)pBuffer, 0, num_data_in_row * (row_hi - row_lo) * 2);
+        data_to_transfer = ch_im_in * (dim_kernel - padding + x);
+        pBuffer += num_data_in_row - data_to_transfer;
+        data_source = (q7_t *)Im_in + row_lo * num_data_in_im_row;
+        for (y = row_lo; y < row_hi; y++)
+        {
+            arm_q7_to_q15_no_shift(data_source, pBuffer, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+    }
+    else if (x > (dim_im_in - padding - 1))
+    {
+        //set the right padding
+        memset((void *)pBuffer, 0, num_data_in_row * (row_hi - row_lo) * 2);
+        data_to_transfer = ch_im_in * (dim_kernel - (x + padding - (dim_im_in - 1)));
+        data_source = (q7_t *)Im_in + row_lo * num_data_in_im_row + (x - padding) * ch_im_in;
+        for (y = row_lo; y < row_hi; y++)
+        {
+            arm_q7_to_q15_no_shift(data_source, pBuffer, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+    }
+    else
+    {
+        data_source = (q7_t *)Im_in + row_lo * num_data_in_im_row + (x - padding) * ch_im_in;
+        for (y = row_lo; y < row_hi; y++)
+        {
+            arm_q7_to_q15_no_shift(data_source, pBuffer, num_data_in_row);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+    }
+    NN_PROFILE_COPY_STOP(num_data_in_row * (row_hi - row_lo) * 2);
+}
+
+/*
+ * conv_HWC on one input with the weights already widened in bufferB, output
+ * rows [start_row, end_row) only
+ */
+static void conv_HWC_widened(const q7_t *Im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             const uint16_t ch_im_out,
+                             const uint16_t dim_kernel,
+                             const uint16_t padding,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             const q15_t *bufferB,
+                             const nn_epilogue *epilogue,
+                             const uint16_t start_row,
+                             const uint16_t end_row)
+{
+    int32_t x;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row_out = dim_im_in * ch_im_out;
+    //Input rows the windows of the output rows reach
+    int32_t row_lo = start_row > padding ? start_row - padding : 0;
+    int32_t row_hi = end_row + dim_kernel - 1 - padding < dim_im_in ? end_row + dim_kernel - 1 - padding : dim_im_in;
+    //Resolve bias, shift and clamp once for all blocks
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    //set bottom and top padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding * 2); // *2 for q15
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 4);
+
+    for (x = 0; x < dim_im_in; x++)
+    {
+        //Move data to bufferA
+        conv_HWC_load_col(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, bufferA, x, row_lo, row_hi);
+
+        //Calculation
+        conv_HWC_column(bufferA, num_data_in_row, 0, bufferB, para_per_ch_out, 2, para_per_ch_out, ch_im_out, &ep,
+                        out_shift, Im_out + start_row * num_data_in_im_row_out + x * ch_im_out,
+                        num_data_in_im_row_out, start_row, end_row);
+    }
+}
+
+/**
+ * @brief Fast convolution
  * @param[in]       Im_in       Pointer to the input tensor
  * @param[in]       dim_im_in   Input tensor dimention
  * @param[in]       ch_im_in    Input tensor channel
@@ -19,6 +592,12 @@
  * @details
  * Changes from the original function:
  * 1. Optimized memory copy process with a trade off of larger bufferA.
+ * 2. Optional fused epilogue through conv_HWC_ep, see nn_epilogue.
+ * 3. Each output column is computed in blocks of 2 pixels x 2 output channels,
+ *    with a 1-pixel block for an odd last row, so dim_im_in may be odd (see
+ *    conv_HWC_column for the opt-in 4-pixel blocks).
+ * 4. The windows are contiguous and the weights plain widened (see
+ *    conv_HWC_column), so ch_im_in may be odd.
  * 
  * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
  * BufferB size:  dim_kernel * dim_kernel * ch_im_in * ch_im_out (in q15)
@@ -26,7 +605,6 @@
  * Constrains:
  * 1. Square input
  * 2. Output channel is even
- * 3. ch_im_in is even
 */
 
 void conv_HWC(const q7_t *Im_in,
@@ -43,147 +621,200 @@ void conv_HWC(const q7_t *Im_in,
               q15_t *bufferA,
               q15_t *bufferB)
 {
+    conv_HWC_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift, Im_out,
+                bufferA, bufferB, NULL);
+}
 
+/**
+ * @brief conv_HWC with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC. A NULL epilogue gives the same output as
+ * conv_HWC.
+ */
+
+void conv_HWC_ep(const q7_t *Im_in,
+                 const uint16_t dim_im_in,
+                 const uint16_t ch_im_in,
+                 const q7_t *wt,
+                 const uint16_t ch_im_out,
+                 const uint16_t dim_kernel,
+                 const uint16_t padding,
+                 const q7_t *bias,
+                 const uint16_t bias_shift,
+                 const uint16_t out_shift,
+                 q7_t *Im_out,
+                 q15_t *bufferA,
+                 q15_t *bufferB,
+                 const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("conv_HWC");
     // Move parameters to bufferB
-    int32_t x, y;
-    uint32_t data_to_transfer;
-    q15_t *pBuffer;
-    q7_t *data_source;
-    pBuffer = bufferB;
-    data_source = (q7_t *)wt;
-    data_to_transfer = dim_kernel * dim_kernel * ch_im_in * ch_im_out;
-    arm_q7_to_q15_no_shift(data_source, pBuffer, data_to_transfer);
+    NN_PROFILE_COPY_START();
+    arm_q7_to_q15_no_shift((q7_t *)wt, bufferB, dim_kernel * dim_kernel * ch_im_in * ch_im_out);
+    NN_PROFILE_COPY_STOP(dim_kernel * dim_kernel * ch_im_in * ch_im_out * 2);
 
-    // Move data and calculate per col
-    pBuffer = bufferA;
-    uint32_t num_data_in_row = dim_kernel * ch_im_in;
-    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
-    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    conv_HWC_widened(Im_in, dim_im_in, ch_im_in, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                     Im_out, bufferA, bufferB, epilogue, 0, dim_im_in);
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * dim_kernel * dim_kernel * ch_im_in,
+                   dim_im_in * dim_im_in * ch_im_out);
+}
 
-    //set bottom and top padding
-    memset((void *)pBuffer, 0, num_data_in_row * padding * 2); // *2 for q15
-    memset((void *)(pBuffer + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+/**
+ * @brief conv_HWC for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_in
+ *
+ * @details
+ * Other parameters as conv_HWC_ep. The rows written are bit-identical to the same
+ * rows of conv_HWC, and no other output row is touched, so calls on disjoint
+ * ranges with their own bufferA/bufferB can run concurrently. Only the input
+ * rows the range reaches are widened into bufferA.
+ *
+ * BufferA/BufferB size and Constrains: as conv_HWC
+*/
 
-    for (x = 0; x < dim_im_in; x++)
-    {
-        //Move data to bufferA
-        pBuffer = bufferA;
-        if (x < padding)
-        {
-            //set the left padding
-            memset((void *)(pBuffer + num_data_in_row * padding), 0, num_data_in_row * dim_im_in * 2);
-            data_to_transfer = ch_im_in * (dim_kernel - padding + x);
-            pBuffer += num_data_in_row * padding + num_data_in_row - data_to_transfer;
-            data_source = (q7_t *)Im_in;
-            for (y = 0; y < dim_im_in; y++)
-            {
-                arm_q7_to_q15_no_shift(data_source, pBuffer, data_to_transfer);
-                data_source += num_data_in_im_row;
-                pBuffer += num_data_in_row;
-            }
-        }
-        else if (x > (dim_im_in - padding - 1))
-        {
-            //set the right padding
-            memset((void *)(pBuffer + num_data_in_row * padding), 0, num_data_in_row * dim_im_in * 2);
-            data_to_transfer = ch_im_in * (dim_kernel - (x + padding - (dim_im_in - 1)));
-            pBuffer += num_data_in_row * padding;
-            data_source = (q7_t *)Im_in + (x - padding) * ch_im_in;
-            for (y = 0; y < dim_im_in; y++)
-            {
-                arm_q7_to_q15_no_shift(data_source, pBuffer, data_to_transfer);
-                data_source += num_data_in_im_row;
-                pBuffer += num_data_in_row;
-            }
-        }
-        else
-        {
-            pBuffer += num_data_in_row * padding;
-            data_source = (q7_t *)Im_in + (x - padding) * ch_im_in;
-            for (y = 0; y < dim_im_in; y++)
-            {
-                arm_q7_to_q15_no_shift(data_source, pBuffer, num_data_in_row);
-                data_source += num_data_in_im_row;
-                pBuffer += num_data_in_row;
-            }
-        }
+void conv_HWC_rows(const q7_t *Im_in,
+                   const uint16_t dim_im_in,
+                   const uint16_t ch_im_in,
+                   const q7_t *wt,
+                   const uint16_t ch_im_out,
+                   const uint16_t dim_kernel,
+                   const uint16_t padding,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   q7_t *Im_out,
+                   q15_t *bufferA,
+                   q15_t *bufferB,
+                   const nn_epilogue *epilogue,
+                   const uint16_t start_row,
+                   const uint16_t end_row)
+{
+    NN_PROFILE_BEGIN("conv_HWC_rows");
+    // Move parameters to bufferB
+    NN_PROFILE_COPY_START();
+    arm_q7_to_q15_no_shift((q7_t *)wt, bufferB, dim_kernel * dim_kernel * ch_im_in * ch_im_out);
+    NN_PROFILE_COPY_STOP(dim_kernel * dim_kernel * ch_im_in * ch_im_out * 2);
 
-        //Calculation
-        //Calculate two points at the same time
-        for (y = 0; y < dim_im_in; y += 2)
-        {
-            q7_t *pOut = Im_out + x * ch_im_out + ch_im_out * dim_im_in * y;
-            q7_t *pOut2 = pOut + ch_im_out * dim_im_in;
-            q7_t *pBias = (q7_t*)bias;
-
-            uint16_t chCnt = ch_im_out >> 1;
-            q15_t *pPara = bufferB;
-            q15_t *pPara2 = bufferB + para_per_ch_out;
-            //Calculate two channels at the same time
-            while (chCnt > 0)
-            {
-                q15_t *pData = bufferA + num_data_in_row * y;
-                q15_t *pData2 = pData + num_data_in_row;
-
-                q31_t sum1 = (q31_t)((*pBias) << bias_shift);
-                q31_t sum2 = sum1;
-                q31_t sum3 = (q31_t)((*pBias+1) << bias_shift);
-                q31_t sum4 = sum3;
-
-                int32_t paraCnt = para_per_ch_out >> 2;
-                while (paraCnt)
-                {
-                    q31_t inB1 = *__SIMD32(pData)++;
-                    q31_t inB2 = *__SIMD32(pData2)++;
-
-                    q31_t inA1 = *__SIMD32(pPara)++;
-                    q31_t inA2 = *__SIMD32(pPara2)++;
-
-                    sum1 = __SMLAD(inA1, inB1, sum1);
-                    sum2 = __SMLAD(inA1, inB2, sum2);
-                    sum3 = __SMLAD(inA2, inB1, sum3);
-                    sum4 = __SMLAD(inA2, inB2, sum4);
-
-                    inB1 = *__SIMD32(pData)++;
-                    inB2 = *__SIMD32(pData2)++;
-
-                    inA1 = *__SIMD32(pPara)++;
-                    inA2 = *__SIMD32(pPara2)++;
-
-                    sum1 = __SMLAD(inA1, inB1, sum1);
-                    sum2 = __SMLAD(inA1, inB2, sum2);
-                    sum3 = __SMLAD(inA2, inB1, sum3);
-                    sum4 = __SMLAD(inA2, inB2, sum4);
-
-                    paraCnt--;
-                }
-                paraCnt = para_per_ch_out & 0x3U;
-                while (paraCnt)
-                {
-                    q15_t inA1 = *pPara++;
-                    q15_t inB1 = *pData++;
-                    q15_t inA2 = *pPara2++;
-                    q15_t inB2 = *pData2++;
-
-                    sum1 += inA1 * inB1;
-                    sum2 += inA1 * inB2;
-                    sum3 += inA2 * inB1;
-                    sum4 += inA2 * inB2;
-                    paraCnt--;
-                }
-
-                *pOut = (q7_t)__SSAT((sum1 >> out_shift), 8);
-                *(pOut + 1) = (q7_t)__SSAT((sum3 >> out_shift), 8);
-                *pOut2 = (q7_t)__SSAT((sum2 >> out_shift), 8);
-                *(pOut2 + 1) = (q7_t)__SSAT((sum4 >> out_shift), 8);
-                pBias += 2;
-                pOut += 2;
-                pOut2 += 2;
-                pPara += para_per_ch_out;
-                pPara2 += para_per_ch_out;
-                chCnt--;
-            }
-        }
+    conv_HWC_widened(Im_in, dim_im_in, ch_im_in, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                     Im_out, bufferA, bufferB, epilogue, start_row, end_row);
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_in * ch_im_out * dim_kernel * dim_kernel * ch_im_in,
+                   (end_row - start_row) * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief conv_HWC over a batch of inputs, weights widened once
+ * @param[in]       Im_in       Pointer to the input tensors, batch x dim_im_in x dim_im_in x ch_im_in
+ * @param[in]       batch       Number of inputs
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Pointer to kernel weights
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensors, batch x dim_im_in x dim_im_in x ch_im_out
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ * @param[in,out]   bufferB     Pointer to buffer B (weight buffer)
+ *
+ * @details
+ * Same output as batch calls of conv_HWC. The weights are widened to bufferB
+ * once for the whole batch instead of once per input; the columns and blocks
+ * are those of conv_HWC. The saving is dim_kernel * dim_kernel * ch_im_in * ch_im_out
+ * widened weights per input after the first, largest for layers with few
+ * output pixels per weight.
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
+ * BufferB size:  dim_kernel * dim_kernel * ch_im_in * ch_im_out (in q15)
+ *
+ * Constrains: as conv_HWC
+*/
+
+void conv_HWC_batch(const q7_t *Im_in,
+                    const uint16_t batch,
+                    const uint16_t dim_im_in,
+                    const uint16_t ch_im_in,
+                    const q7_t *wt,
+                    const uint16_t ch_im_out,
+                    const uint16_t dim_kernel,
+                    const uint16_t padding,
+                    const q7_t *bias,
+                    const uint16_t bias_shift,
+                    const uint16_t out_shift,
+                    q7_t *Im_out,
+                    q15_t *bufferA,
+                    q15_t *bufferB)
+{
+    conv_HWC_batch_ep(Im_in, batch, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift,
+                      out_shift, Im_out, bufferA, bufferB, NULL);
+}
+
+/**
+ * @brief conv_HWC_batch with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_batch. A NULL epilogue gives the same output as
+ * conv_HWC_batch.
+ */
+
+void conv_HWC_batch_ep(const q7_t *Im_in,
+                       const uint16_t batch,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const q7_t *wt,
+                       const uint16_t ch_im_out,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       const q7_t *bias,
+                       const uint16_t bias_shift,
+                       const uint16_t out_shift,
+                       q7_t *Im_out,
+                       q15_t *bufferA,
+                       q15_t *bufferB,
+                       const nn_epilogue *epilogue)
+{
+    uint32_t in_size = dim_im_in * dim_im_in * ch_im_in;
+    uint32_t out_size = dim_im_in * dim_im_in * ch_im_out;
+    uint16_t b;
+
+    NN_PROFILE_BEGIN("conv_HWC_batch");
+    // Move parameters to bufferB, once
+    NN_PROFILE_COPY_START();
+    arm_q7_to_q15_no_shift((q7_t *)wt, bufferB, dim_kernel * dim_kernel * ch_im_in * ch_im_out);
+    NN_PROFILE_COPY_STOP(dim_kernel * dim_kernel * ch_im_in * ch_im_out * 2);
+
+    for (b = 0; b < batch; b++)
+    {
+        conv_HWC_widened(Im_in + b * in_size, dim_im_in, ch_im_in, ch_im_out, dim_kernel, padding, bias,
+                         bias_shift, out_shift, Im_out + b * out_size, bufferA, bufferB, epilogue, 0, dim_im_in);
     }
+    NN_PROFILE_END((uint64_t)batch * out_size * dim_kernel * dim_kernel * ch_im_in, batch * out_size);
 }
 
+/**
+ * @brief Scratch size of conv_HWC
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       ch_im_out       Output tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @param[out]      bufferB_size    Bytes of bufferB, may be NULL
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_get_buffer_size(const uint16_t dim_im_in,
+                                  const uint16_t ch_im_in,
+                                  const uint16_t ch_im_out,
+                                  const uint16_t dim_kernel,
+                                  uint32_t *bufferB_size)
+{
+    if (bufferB_size)
+    {
+        *bufferB_size = dim_kernel * dim_kernel * ch_im_in * ch_im_out * 2; // *2 for q15
+    }
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in * 2;
+}
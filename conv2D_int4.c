@@ -0,0 +1,285 @@
+#include "nn_functions.h"
+
+/*
+ * Output rows y, y+1 of one output column, 2 output channels per pass. pData
+ * is window y in bufferA, window y+1 is row_len further. Each packed weight
+ * word is 4 taps of both output channels, unpacked with read_and_pad_int4.
+ */
+static void conv_int4_2x2(const q15_t *pData,
+                          const uint32_t row_len,
+                          const nn_int4_weights *wt,
+                          const int32_t para_per_ch_out,
+                          const uint16_t ch_im_out,
+                          const nn_epilogue *ep,
+                          const uint16_t out_shift,
+                          q7_t *pOut,
+                          const uint32_t out_row)
+{
+    const q7_t *pA = wt->values;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pD1 = pData;
+        const q15_t *pD2 = pD1 + row_len;
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        uint16_t shift2 = ep->out_shift ? ep->out_shift[i + 1] : out_shift;
+        uint16_t w_shift = wt->shift ? wt->shift[i] : wt->layer_shift;
+        uint16_t w_shift2 = wt->shift ? wt->shift[i + 1] : wt->layer_shift;
+
+        //Sums of weights * 16
+        q31_t acc1 = 0;
+        q31_t acc2 = 0;
+        q31_t acc3 = 0;
+        q31_t acc4 = 0;
+
+        int32_t paraCnt = para_per_ch_out >> 2;
+        while (paraCnt)
+        {
+            q31_t inA1, inA2, inA3, inA4;
+            q31_t inB1, inB2;
+
+            pA = (const q7_t *)read_and_pad_int4((void *)pA, &inA1, &inA2, &inA3, &inA4);
+
+            inB1 = *__SIMD32(pD1)++;
+            inB2 = *__SIMD32(pD2)++;
+            acc1 = __SMLAD(inA1, inB1, acc1);
+            acc2 = __SMLAD(inA1, inB2, acc2);
+            acc3 = __SMLAD(inA3, inB1, acc3);
+            acc4 = __SMLAD(inA3, inB2, acc4);
+
+            inB1 = *__SIMD32(pD1)++;
+            inB2 = *__SIMD32(pD2)++;
+            acc1 = __SMLAD(inA2, inB1, acc1);
+            acc2 = __SMLAD(inA2, inB2, acc2);
+            acc3 = __SMLAD(inA4, inB1, acc3);
+            acc4 = __SMLAD(inA4, inB2, acc4);
+
+            paraCnt--;
+        }
+
+        //Exact: the sums are multiples of 16
+        q31_t sum1 = ((q31_t)ep->bias[i] << ep->bias_shift) + (acc1 >> (4 - w_shift));
+        q31_t sum2 = ((q31_t)ep->bias[i] << ep->bias_shift) + (acc2 >> (4 - w_shift));
+        q31_t sum3 = ((q31_t)ep->bias[i + 1] << ep->bias_shift) + (acc3 >> (4 - w_shift2));
+        q31_t sum4 = ((q31_t)ep->bias[i + 1] << ep->bias_shift) + (acc4 >> (4 - w_shift2));
+
+        pOut[i] = nn_requantize(sum1, shift, ep->act_min, ep->act_max);
+        pOut[i + 1] = nn_requantize(sum3, shift2, ep->act_min, ep->act_max);
+        pOut[out_row + i] = nn_requantize(sum2, shift, ep->act_min, ep->act_max);
+        pOut[out_row + i + 1] = nn_requantize(sum4, shift2, ep->act_min, ep->act_max);
+    }
+}
+
+/*
+ * Last output row of one output column when dim_im_in is odd. Reads only
+ * window y, so nothing past bufferA.
+ */
+static void conv_int4_1x2(const q15_t *pData,
+                          const nn_int4_weights *wt,
+                          const int32_t para_per_ch_out,
+                          const uint16_t ch_im_out,
+                          const nn_epilogue *ep,
+                          const uint16_t out_shift,
+                          q7_t *pOut)
+{
+    const q7_t *pA = wt->values;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pD1 = pData;
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        uint16_t shift2 = ep->out_shift ? ep->out_shift[i + 1] : out_shift;
+        uint16_t w_shift = wt->shift ? wt->shift[i] : wt->layer_shift;
+        uint16_t w_shift2 = wt->shift ? wt->shift[i + 1] : wt->layer_shift;
+        q31_t acc1 = 0;
+        q31_t acc3 = 0;
+
+        int32_t paraCnt = para_per_ch_out >> 2;
+        while (paraCnt)
+        {
+            q31_t inA1, inA2, inA3, inA4;
+            q31_t inB1;
+
+            pA = (const q7_t *)read_and_pad_int4((void *)pA, &inA1, &inA2, &inA3, &inA4);
+
+            inB1 = *__SIMD32(pD1)++;
+            acc1 = __SMLAD(inA1, inB1, acc1);
+            acc3 = __SMLAD(inA3, inB1, acc3);
+            inB1 = *__SIMD32(pD1)++;
+            acc1 = __SMLAD(inA2, inB1, acc1);
+            acc3 = __SMLAD(inA4, inB1, acc3);
+
+            paraCnt--;
+        }
+
+        q31_t sum1 = ((q31_t)ep->bias[i] << ep->bias_shift) + (acc1 >> (4 - w_shift));
+        q31_t sum3 = ((q31_t)ep->bias[i + 1] << ep->bias_shift) + (acc3 >> (4 - w_shift2));
+
+        pOut[i] = nn_requantize(sum1, shift, ep->act_min, ep->act_max);
+        pOut[i + 1] = nn_requantize(sum3, shift2, ep->act_min, ep->act_max);
+    }
+}
+
+/**
+ * @brief Fast convolution with packed int4 weights
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          int4 weights packed by pack_conv_int4_weights, read in place (may be in flash)
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ *
+ * @details
+ * Same output as conv_HWC with the q7 weights w_int4 << shift (the expanded
+ * weights of the packer). The column windows are widened into bufferA as in
+ * conv_HWC, the weights are read in place at half the size of the q7 ones
+ * and unpacked in registers, so there is no bufferB. Every weight word is 4
+ * taps of the 2 output channels of a pass (read_and_pad_int4).
+ *
+ * Cost per layer: the same __SMLAD count as conv_HWC, with one weight load
+ * and 6 unpack instructions per 8 weights in place of the 4 widened bufferB
+ * words conv_HWC loads, and no weight copy. make bench measures 0.95x to 1.05x of conv_HWC
+ * on 3x3 convolutions of the DS-CNN S/M/L widths.
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. Output channel is even
+ * 3. dim_kernel * dim_kernel * ch_im_in is multiple of 4
+*/
+
+void conv_HWC_int4(const q7_t *Im_in,
+                   const uint16_t dim_im_in,
+                   const uint16_t ch_im_in,
+                   const nn_int4_weights *wt,
+                   const uint16_t ch_im_out,
+                   const uint16_t dim_kernel,
+                   const uint16_t padding,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   q7_t *Im_out,
+                   q15_t *bufferA)
+{
+    conv_HWC_int4_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                     Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief conv_HWC_int4 with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_int4. A NULL epilogue gives the same output as
+ * conv_HWC_int4.
+ */
+
+void conv_HWC_int4_ep(const q7_t *Im_in,
+                      const uint16_t dim_im_in,
+                      const uint16_t ch_im_in,
+                      const nn_int4_weights *wt,
+                      const uint16_t ch_im_out,
+                      const uint16_t dim_kernel,
+                      const uint16_t padding,
+                      const q7_t *bias,
+                      const uint16_t bias_shift,
+                      const uint16_t out_shift,
+                      q7_t *Im_out,
+                      q15_t *bufferA,
+                      const nn_epilogue *epilogue)
+{
+    int32_t x, y;
+    uint32_t data_to_transfer;
+    q15_t *pBuffer;
+    const q7_t *data_source;
+
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    uint32_t num_data_in_im_row_out = dim_im_in * ch_im_out;
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+
+    //Resolve bias, shift and clamp once for all blocks
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_int4");
+
+    //set bottom and top padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding * 2); // *2 for q15
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 4);
+
+    for (x = 0; x < dim_im_in; x++)
+    {
+        //Move data to bufferA
+        NN_PROFILE_COPY_START();
+        pBuffer = bufferA + num_data_in_row * padding;
+        if (x < padding)
+        {
+            //set the left padding
+            memset((void *)pBuffer, 0, num_data_in_row * dim_im_in * 2);
+            data_to_transfer = ch_im_in * (dim_kernel - padding + x);
+            pBuffer += num_data_in_row - data_to_transfer;
+            data_source = Im_in;
+        }
+        else if (x > (dim_im_in - padding - 1))
+        {
+            //set the right padding
+            memset((void *)pBuffer, 0, num_data_in_row * dim_im_in * 2);
+            data_to_transfer = ch_im_in * (dim_kernel - (x + padding - (dim_im_in - 1)));
+            data_source = Im_in + (x - padding) * ch_im_in;
+        }
+        else
+        {
+            data_to_transfer = num_data_in_row;
+            data_source = Im_in + (x - padding) * ch_im_in;
+        }
+        for (y = 0; y < dim_im_in; y++)
+        {
+            arm_q7_to_q15_no_shift((q7_t *)data_source, pBuffer, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+        NN_PROFILE_COPY_STOP(num_data_in_row * dim_im_in * 2);
+
+        //Calculation
+        //Calculate two points at the same time, the last one alone if dim_im_in is odd
+        q7_t *pOut = Im_out + x * ch_im_out;
+        for (y = 0; y + 2 <= dim_im_in; y += 2)
+        {
+            conv_int4_2x2(bufferA + num_data_in_row * y, num_data_in_row, wt, para_per_ch_out, ch_im_out, &ep,
+                          out_shift, pOut, num_data_in_im_row_out);
+            pOut += 2 * num_data_in_im_row_out;
+        }
+        if (dim_im_in & 0x1)
+        {
+            conv_int4_1x2(bufferA + num_data_in_row * y, wt, para_per_ch_out, ch_im_out, &ep, out_shift, pOut);
+        }
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * dim_kernel * dim_kernel * ch_im_in,
+                   dim_im_in * num_data_in_im_row_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_int4
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_int4_get_buffer_size(const uint16_t dim_im_in,
+                                       const uint16_t ch_im_in,
+                                       const uint16_t dim_kernel)
+{
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in * 2; // *2 for q15
+}
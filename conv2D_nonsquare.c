@@ -0,0 +1,246 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Fast convolution, non-square input/kernel, stride and asymmetric padding
+ * @param[in]       Im_in           Pointer to the input tensor
+ * @param[in]       dim_im_in_x     Input tensor width
+ * @param[in]       dim_im_in_y     Input tensor height
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       wt              Pointer to kernel weights
+ * @param[in]       ch_im_out       Output tensor channel
+ * @param[in]       dim_kernel_x    Kernel width
+ * @param[in]       dim_kernel_y    Kernel height
+ * @param[in]       pad_top         Padding rows above the input
+ * @param[in]       pad_bottom      Padding rows below the input
+ * @param[in]       pad_left        Padding columns left of the input
+ * @param[in]       pad_right       Padding columns right of the input
+ * @param[in]       stride_x        Stride along the width
+ * @param[in]       stride_y        Stride along the height
+ * @param[in]       bias            Pointers to bias
+ * @param[in]       bias_shift      Amount of left-shift for bias
+ * @param[in]       out_shift       Amount of right-shift for output
+ * @param[in,out]   Im_out          Pointer to the output tensor
+ * @param[in,out]   bufferA         Pointer to buffer A (tensor buffer)
+ * @param[in,out]   bufferB         Pointer to buffer B (weight buffer)
+ *
+ * @details
+ * Column-buffer conv_HWC generalised to rectangular shapes. For each kept
+ * output column the dim_kernel_x input columns under the kernel are moved to
+ * bufferA once, and only the kept output rows are computed from it, so a
+ * strided layer costs only the MACs of its output. The output is computed by
+ * the conv_HWC blocks (conv_HWC_column), with the windows of adjacent output
+ * rows stride_y input rows apart.
+ *
+ * Output size:   dim_im_out_x = (pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1
+ *                dim_im_out_y = (pad_top + dim_im_in_y + pad_bottom - dim_kernel_y) / stride_y + 1
+ *
+ * BufferA size:  dim_kernel_x * (pad_top + dim_im_in_y + pad_bottom) * ch_im_in (in q15)
+ * BufferB size:  dim_kernel_x * dim_kernel_y * ch_im_in * ch_im_out (in q15)
+ *
+ * Constrains:
+ * 1. Output channel is even
+ * 2. pad_left + dim_im_in_x + pad_right >= dim_kernel_x, same for y
+*/
+
+void conv_HWC_nonsquare(const q7_t *Im_in,
+                        const uint16_t dim_im_in_x,
+                        const uint16_t dim_im_in_y,
+                        const uint16_t ch_im_in,
+                        const q7_t *wt,
+                        const uint16_t ch_im_out,
+                        const uint16_t dim_kernel_x,
+                        const uint16_t dim_kernel_y,
+                        const uint16_t pad_top,
+                        const uint16_t pad_bottom,
+                        const uint16_t pad_left,
+                        const uint16_t pad_right,
+                        const uint16_t stride_x,
+                        const uint16_t stride_y,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA,
+                        q15_t *bufferB)
+{
+    conv_HWC_nonsquare_ep(Im_in, dim_im_in_x, dim_im_in_y, ch_im_in, wt, ch_im_out, dim_kernel_x, dim_kernel_y, pad_top,
+                          pad_bottom, pad_left, pad_right, stride_x, stride_y, bias, bias_shift, out_shift, Im_out,
+                          bufferA, bufferB, NULL);
+}
+
+/**
+ * @brief conv_HWC_nonsquare with an output epilogue
+ * @param[in]       epilogue        Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_nonsquare. A NULL epilogue gives the same output as
+ * conv_HWC_nonsquare.
+ */
+
+void conv_HWC_nonsquare_ep(const q7_t *Im_in,
+                           const uint16_t dim_im_in_x,
+                           const uint16_t dim_im_in_y,
+                           const uint16_t ch_im_in,
+                           const q7_t *wt,
+                           const uint16_t ch_im_out,
+                           const uint16_t dim_kernel_x,
+                           const uint16_t dim_kernel_y,
+                           const uint16_t pad_top,
+                           const uint16_t pad_bottom,
+                           const uint16_t pad_left,
+                           const uint16_t pad_right,
+                           const uint16_t stride_x,
+                           const uint16_t stride_y,
+                           const q7_t *bias,
+                           const uint16_t bias_shift,
+                           const uint16_t out_shift,
+                           q7_t *Im_out,
+                           q15_t *bufferA,
+                           q15_t *bufferB,
+                           const nn_epilogue *epilogue)
+{
+    uint16_t dim_im_out_y = (pad_top + dim_im_in_y + pad_bottom - dim_kernel_y) / stride_y + 1;
+
+    NN_PROFILE_BEGIN("conv_HWC_nonsquare");
+    conv_HWC_nonsquare_rows(Im_in, dim_im_in_x, dim_im_in_y, ch_im_in, wt, ch_im_out, dim_kernel_x, dim_kernel_y,
+                            pad_top, pad_bottom, pad_left, pad_right, stride_x, stride_y, bias, bias_shift, out_shift,
+                            Im_out, bufferA, bufferB, epilogue, 0, dim_im_out_y);
+    NN_PROFILE_END((uint64_t)dim_im_out_y * ((pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1)
+                   * ch_im_out * dim_kernel_x * dim_kernel_y * ch_im_in,
+                   dim_im_out_y * ((pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1) * ch_im_out);
+}
+
+/**
+ * @brief conv_HWC_nonsquare for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_out_y
+ *
+ * @details
+ * Other parameters as conv_HWC_nonsquare_ep. The rows written are bit-identical
+ * to the same rows of conv_HWC_nonsquare and no other output row is touched.
+ * Only the input rows the range reaches are widened into bufferA.
+ *
+ * BufferA/BufferB size and Constrains: as conv_HWC_nonsquare
+*/
+
+void conv_HWC_nonsquare_rows(const q7_t *Im_in,
+                             const uint16_t dim_im_in_x,
+                             const uint16_t dim_im_in_y,
+                             const uint16_t ch_im_in,
+                             const q7_t *wt,
+                             const uint16_t ch_im_out,
+                             const uint16_t dim_kernel_x,
+                             const uint16_t dim_kernel_y,
+                             const uint16_t pad_top,
+                             const uint16_t pad_bottom,
+                             const uint16_t pad_left,
+                             const uint16_t pad_right,
+                             const uint16_t stride_x,
+                             const uint16_t stride_y,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             q15_t *bufferB,
+                             const nn_epilogue *epilogue,
+                             const uint16_t start_row,
+                             const uint16_t end_row)
+{
+    int32_t x, y;
+    q15_t *pBuffer;
+    const q7_t *data_source;
+
+    uint32_t num_data_in_row = dim_kernel_x * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in_x * ch_im_in;
+    int32_t para_per_ch_out = dim_kernel_x * dim_kernel_y * ch_im_in;
+    uint16_t dim_im_out_x = (pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1;
+    uint16_t dim_im_out_y = (pad_top + dim_im_in_y + pad_bottom - dim_kernel_y) / stride_y + 1;
+    //Padded rows actually read by the kept output rows
+    int32_t num_rows = (dim_im_out_y - 1) * stride_y + dim_kernel_y;
+    int32_t row_end = (num_rows < pad_top + dim_im_in_y) ? num_rows : pad_top + dim_im_in_y;
+    //Padded rows the windows of the output rows reach, inside the image
+    int32_t row_lo = start_row * stride_y;
+    int32_t row_hi = (end_row - 1) * stride_y + dim_kernel_y;
+    row_lo = row_lo > pad_top ? row_lo : pad_top;
+    row_hi = row_hi < row_end ? row_hi : row_end;
+    //Resolve bias, shift and clamp once for all blocks
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_nonsquare_rows");
+
+    // Move parameters to bufferB
+    NN_PROFILE_COPY_START();
+    arm_q7_to_q15_no_shift((q7_t *)wt, bufferB, para_per_ch_out * ch_im_out);
+
+    //set bottom and top padding
+    memset((void *)bufferA, 0, num_data_in_row * pad_top * 2); // *2 for q15
+    if (num_rows > row_end)
+    {
+        memset((void *)(bufferA + num_data_in_row * row_end), 0, num_data_in_row * (num_rows - row_end) * 2);
+    }
+    NN_PROFILE_COPY_STOP((para_per_ch_out * ch_im_out + num_data_in_row * (pad_top + num_rows - row_end)) * 2);
+
+    for (x = 0; x < dim_im_out_x; x++)
+    {
+        //Input columns under the kernel, clipped to the image
+        int32_t col_start = x * stride_x - pad_left;
+        int32_t left = col_start < 0 ? -col_start : 0;
+        int32_t right = (col_start + dim_kernel_x > dim_im_in_x) ? col_start + dim_kernel_x - dim_im_in_x : 0;
+        uint32_t data_to_transfer = (dim_kernel_x - left - right) * ch_im_in;
+
+        //Move data to bufferA
+        NN_PROFILE_COPY_START();
+        pBuffer = bufferA + num_data_in_row * row_lo;
+        if ((left || right) && row_hi > row_lo)
+        {
+            //set the left and right padding
+            memset((void *)pBuffer, 0, num_data_in_row * (row_hi - row_lo) * 2);
+        }
+        pBuffer += left * ch_im_in;
+        data_source = Im_in + (row_lo - pad_top) * num_data_in_im_row + (col_start + left) * ch_im_in;
+        for (y = row_lo; y < row_hi; y++)
+        {
+            arm_q7_to_q15_no_shift((q7_t *)data_source, pBuffer, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+        NN_PROFILE_COPY_STOP(row_hi > row_lo ? num_data_in_row * (row_hi - row_lo) * 2 : 0);
+
+        //Calculation, the windows of two adjacent output rows are stride_y input rows apart
+        conv_HWC_column(bufferA, num_data_in_row * stride_y, 0, bufferB, para_per_ch_out, 2, para_per_ch_out,
+                        ch_im_out, &ep, out_shift, Im_out + (x + start_row * dim_im_out_x) * ch_im_out,
+                        dim_im_out_x * ch_im_out, start_row, end_row);
+    }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_out_x * ch_im_out * para_per_ch_out,
+                   (end_row - start_row) * dim_im_out_x * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_nonsquare
+ * @param[in]       dim_im_in_y     Input tensor height
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       ch_im_out       Output tensor channel
+ * @param[in]       dim_kernel_x    Kernel width
+ * @param[in]       dim_kernel_y    Kernel height
+ * @param[in]       pad_top         Padding rows above the input
+ * @param[in]       pad_bottom      Padding rows below the input
+ * @param[out]      bufferB_size    Bytes of bufferB, may be NULL
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_nonsquare_get_buffer_size(const uint16_t dim_im_in_y,
+                                            const uint16_t ch_im_in,
+                                            const uint16_t ch_im_out,
+                                            const uint16_t dim_kernel_x,
+                                            const uint16_t dim_kernel_y,
+                                            const uint16_t pad_top,
+                                            const uint16_t pad_bottom,
+                                            uint32_t *bufferB_size)
+{
+    if (bufferB_size)
+    {
+        *bufferB_size = dim_kernel_x * dim_kernel_y * ch_im_in * ch_im_out * 2; // *2 for q15
+    }
+    return dim_kernel_x * (pad_top + dim_im_in_y + pad_bottom) * ch_im_in * 2;
+}
@@ -0,0 +1,110 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Fast convolution with pre-packed weights
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt_packed   Pointer to weights packed by pack_conv_HWC_weights
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ *
+ * @details
+ * Same as conv_HWC, but the weights are already widened and interleaved by
+ * output channel pair (see weight_packer.h), so they can stay in flash and
+ * bufferB is not needed. The output is computed by the conv_HWC blocks
+ * (conv_HWC_column).
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. Output channel is even
+ * 3. ch_im_in is even
+*/
+
+void conv_HWC_packed(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const q15_t *wt_packed,
+                     const uint16_t ch_im_out,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const q7_t *bias,
+                     const uint16_t bias_shift,
+                     const uint16_t out_shift,
+                     q7_t *Im_out,
+                     q15_t *bufferA)
+{
+    conv_HWC_packed_ep(Im_in, dim_im_in, ch_im_in, wt_packed, ch_im_out, dim_kernel, padding, bias, bias_shift,
+                       out_shift, Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief conv_HWC_packed with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_packed. A NULL epilogue gives the same output as
+ * conv_HWC_packed.
+ */
+
+void conv_HWC_packed_ep(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const q15_t *wt_packed,
+                        const uint16_t ch_im_out,
+                        const uint16_t dim_kernel,
+                        const uint16_t padding,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA,
+                        const nn_epilogue *epilogue)
+{
+    int32_t x;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_packed");
+
+    //set bottom and top padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding * 2); // *2 for q15
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 4);
+
+    for (x = 0; x < dim_im_in; x++)
+    {
+        //Move data to bufferA
+        conv_HWC_load_col(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, bufferA, x, 0, dim_im_in);
+
+        //Calculation, the channel pair is interleaved in one weight stream
+        conv_HWC_column(bufferA, num_data_in_row, 0, wt_packed, 2, 4, para_per_ch_out, ch_im_out, &ep, out_shift,
+                        Im_out + x * ch_im_out, dim_im_in * ch_im_out, 0, dim_im_in);
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * para_per_ch_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_packed
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_packed_get_buffer_size(const uint16_t dim_im_in,
+                                         const uint16_t ch_im_in,
+                                         const uint16_t dim_kernel)
+{
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in * 2; // *2 for q15
+}
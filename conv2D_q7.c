@@ -0,0 +1,352 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Two output pixels of conv_HWC_q7, 2 output channels per pass
+ * @param[in]       pData           Window of the first pixel, q7, para_per_ch_out values
+ * @param[in]       row_len         Distance from the first to the second window
+ * @param[in]       wt              Kernel weights
+ * @param[in]       para_per_ch_out Weights per output channel
+ * @param[in]       ch_im_out       Output tensor channel, even
+ * @param[in]       ep              Resolved epilogue, bias not NULL
+ * @param[in]       out_shift       Amount of right-shift for output if ep->out_shift is NULL
+ * @param[in,out]   pOut            Output of the first pixel
+ * @param[in]       out_row         Distance from the first to the second output
+ *
+ * @details
+ * Activations and weights are q7, both widened in registers: SXTB16 gives
+ * bytes 0 and 2 of a word, SXTB16(ROR(, 8)) bytes 1 and 3, the same lanes for
+ * both operands, so no reordering is needed.
+ */
+
+void conv_HWC_q7_block_2x2(const q7_t *pData,
+                           const uint32_t row_len,
+                           const q7_t *wt,
+                           const int32_t para_per_ch_out,
+                           const uint16_t ch_im_out,
+                           const nn_epilogue *ep,
+                           const uint16_t out_shift,
+                           q7_t *pOut,
+                           const uint32_t out_row)
+{
+    const q7_t *pPara = wt;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q7_t *pPara2 = pPara + para_per_ch_out;
+        const q7_t *pD1 = pData;
+        const q7_t *pD2 = pD1 + row_len;
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        uint16_t shift2 = ep->out_shift ? ep->out_shift[i + 1] : out_shift;
+
+        q31_t sum1 = (q31_t)ep->bias[i] << ep->bias_shift;
+        q31_t sum2 = sum1;
+        q31_t sum3 = (q31_t)ep->bias[i + 1] << ep->bias_shift;
+        q31_t sum4 = sum3;
+
+        int32_t paraCnt = para_per_ch_out >> 2;
+        while (paraCnt)
+        {
+            q31_t inA1 = *__SIMD32(pPara)++;
+            q31_t inA2 = *__SIMD32(pPara2)++;
+            q31_t inB1 = *__SIMD32(pD1)++;
+            q31_t inB2 = *__SIMD32(pD2)++;
+            q31_t opA1 = __SXTB16(inA1);
+            q31_t opA2 = __SXTB16(inA2);
+            q31_t opB = __SXTB16(inB1);
+
+            sum1 = __SMLAD(opA1, opB, sum1);
+            sum3 = __SMLAD(opA2, opB, sum3);
+            opB = __SXTB16(inB2);
+            sum2 = __SMLAD(opA1, opB, sum2);
+            sum4 = __SMLAD(opA2, opB, sum4);
+
+            opA1 = __SXTB16(__ROR(inA1, 8));
+            opA2 = __SXTB16(__ROR(inA2, 8));
+            opB = __SXTB16(__ROR(inB1, 8));
+            sum1 = __SMLAD(opA1, opB, sum1);
+            sum3 = __SMLAD(opA2, opB, sum3);
+            opB = __SXTB16(__ROR(inB2, 8));
+            sum2 = __SMLAD(opA1, opB, sum2);
+            sum4 = __SMLAD(opA2, opB, sum4);
+
+            paraCnt--;
+        }
+        paraCnt = para_per_ch_out & 0x3;
+        while (paraCnt)
+        {
+            q7_t inA1 = *pPara++;
+            q7_t inA2 = *pPara2++;
+            q7_t inB1 = *pD1++;
+            q7_t inB2 = *pD2++;
+            sum1 += inA1 * inB1;
+            sum2 += inA1 * inB2;
+            sum3 += inA2 * inB1;
+            sum4 += inA2 * inB2;
+            paraCnt--;
+        }
+
+        pOut[i] = nn_requantize(sum1, shift, ep->act_min, ep->act_max);
+        pOut[i + 1] = nn_requantize(sum3, shift2, ep->act_min, ep->act_max);
+        pOut[out_row + i] = nn_requantize(sum2, shift, ep->act_min, ep->act_max);
+        pOut[out_row + i + 1] = nn_requantize(sum4, shift2, ep->act_min, ep->act_max);
+
+        /* skip the channel computed with pPara2 */
+        pPara = pPara2;
+    }
+}
+
+/**
+ * @brief One output pixel of conv_HWC_q7, see conv_HWC_q7_block_2x2
+ */
+
+void conv_HWC_q7_block_1x2(const q7_t *pData,
+                           const q7_t *wt,
+                           const int32_t para_per_ch_out,
+                           const uint16_t ch_im_out,
+                           const nn_epilogue *ep,
+                           const uint16_t out_shift,
+                           q7_t *pOut)
+{
+    const q7_t *pPara = wt;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q7_t *pPara2 = pPara + para_per_ch_out;
+        const q7_t *pD1 = pData;
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        uint16_t shift2 = ep->out_shift ? ep->out_shift[i + 1] : out_shift;
+
+        q31_t sum1 = (q31_t)ep->bias[i] << ep->bias_shift;
+        q31_t sum3 = (q31_t)ep->bias[i + 1] << ep->bias_shift;
+
+        int32_t paraCnt = para_per_ch_out >> 2;
+        while (paraCnt)
+        {
+            q31_t inA1 = *__SIMD32(pPara)++;
+            q31_t inA2 = *__SIMD32(pPara2)++;
+            q31_t inB1 = *__SIMD32(pD1)++;
+            q31_t opB = __SXTB16(inB1);
+
+            sum1 = __SMLAD(__SXTB16(inA1), opB, sum1);
+            sum3 = __SMLAD(__SXTB16(inA2), opB, sum3);
+            opB = __SXTB16(__ROR(inB1, 8));
+            sum1 = __SMLAD(__SXTB16(__ROR(inA1, 8)), opB, sum1);
+            sum3 = __SMLAD(__SXTB16(__ROR(inA2, 8)), opB, sum3);
+
+            paraCnt--;
+        }
+        paraCnt = para_per_ch_out & 0x3;
+        while (paraCnt)
+        {
+            q7_t inB1 = *pD1++;
+            sum1 += *pPara++ * inB1;
+            sum3 += *pPara2++ * inB1;
+            paraCnt--;
+        }
+
+        pOut[i] = nn_requantize(sum1, shift, ep->act_min, ep->act_max);
+        pOut[i + 1] = nn_requantize(sum3, shift2, ep->act_min, ep->act_max);
+
+        pPara = pPara2;
+    }
+}
+
+/**
+ * @brief Fast convolution with q7 column buffer and q7 weights
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Pointer to kernel weights, read in place (may be in flash)
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ *
+ * @details
+ * Same output as conv_HWC. The column window is copied to bufferA as q7 with
+ * memcpy instead of being widened to q15, and the weights are not copied to
+ * bufferB: activations and weights are both widened in registers with
+ * __SXTB16, like depthwise_conv. bufferA is half the size of conv_HWC's and
+ * there is no bufferB, at the cost of 4 extra __SXTB16 per 4 taps of a 2x2
+ * block. Preferable when RAM or the conversion pass dominates, i.e. small
+ * ch_im_out.
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. Output channel is even
+*/
+
+void conv_HWC_q7(const q7_t *Im_in,
+                 const uint16_t dim_im_in,
+                 const uint16_t ch_im_in,
+                 const q7_t *wt,
+                 const uint16_t ch_im_out,
+                 const uint16_t dim_kernel,
+                 const uint16_t padding,
+                 const q7_t *bias,
+                 const uint16_t bias_shift,
+                 const uint16_t out_shift,
+                 q7_t *Im_out,
+                 q7_t *bufferA)
+{
+    conv_HWC_q7_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift, Im_out,
+                   bufferA, NULL);
+}
+
+/**
+ * @brief conv_HWC_q7 with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_q7. A NULL epilogue gives the same output as
+ * conv_HWC_q7.
+ */
+
+void conv_HWC_q7_ep(const q7_t *Im_in,
+                    const uint16_t dim_im_in,
+                    const uint16_t ch_im_in,
+                    const q7_t *wt,
+                    const uint16_t ch_im_out,
+                    const uint16_t dim_kernel,
+                    const uint16_t padding,
+                    const q7_t *bias,
+                    const uint16_t bias_shift,
+                    const uint16_t out_shift,
+                    q7_t *Im_out,
+                    q7_t *bufferA,
+                    const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("conv_HWC_q7");
+    conv_HWC_q7_rows(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                     Im_out, bufferA, epilogue, 0, dim_im_in);
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * dim_kernel * dim_kernel * ch_im_in,
+                   dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief conv_HWC_q7 for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_in
+ *
+ * @details
+ * Other parameters as conv_HWC_q7_ep. The rows written are bit-identical to the
+ * same rows of conv_HWC_q7 (and conv_HWC) and no other output row is touched.
+ * Only the input rows the range reaches are copied to bufferA.
+ *
+ * BufferA size and Constrains: as conv_HWC_q7
+*/
+
+void conv_HWC_q7_rows(const q7_t *Im_in,
+                      const uint16_t dim_im_in,
+                      const uint16_t ch_im_in,
+                      const q7_t *wt,
+                      const uint16_t ch_im_out,
+                      const uint16_t dim_kernel,
+                      const uint16_t padding,
+                      const q7_t *bias,
+                      const uint16_t bias_shift,
+                      const uint16_t out_shift,
+                      q7_t *Im_out,
+                      q7_t *bufferA,
+                      const nn_epilogue *epilogue,
+                      const uint16_t start_row,
+                      const uint16_t end_row)
+{
+    int32_t x, y;
+    uint32_t data_to_transfer;
+    q7_t *pBuffer;
+    const q7_t *data_source;
+
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    uint32_t num_data_in_im_row_out = dim_im_in * ch_im_out;
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    //Input rows the windows of the output rows reach
+    int32_t row_lo = start_row > padding ? start_row - padding : 0;
+    int32_t row_hi = end_row + dim_kernel - 1 - padding < dim_im_in ? end_row + dim_kernel - 1 - padding : dim_im_in;
+
+    //Resolve bias, shift and clamp once for all blocks
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_q7_rows");
+
+    //set bottom and top padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding);
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 2);
+
+    for (x = 0; x < dim_im_in; x++)
+    {
+        //Move data to bufferA
+        NN_PROFILE_COPY_START();
+        pBuffer = bufferA + num_data_in_row * (padding + row_lo);
+        if (x < padding)
+        {
+            //set the left padding
+            memset((void *)pBuffer, 0, num_data_in_row * (row_hi - row_lo));
+            data_to_transfer = ch_im_in * (dim_kernel - padding + x);
+            pBuffer += num_data_in_row - data_to_transfer;
+            data_source = Im_in + row_lo * num_data_in_im_row;
+        }
+        else if (x > (dim_im_in - padding - 1))
+        {
+            //set the right padding
+            memset((void *)pBuffer, 0, num_data_in_row * (row_hi - row_lo));
+            data_to_transfer = ch_im_in * (dim_kernel - (x + padding - (dim_im_in - 1)));
+            data_source = Im_in + row_lo * num_data_in_im_row + (x - padding) * ch_im_in;
+        }
+        else
+        {
+            data_to_transfer = num_data_in_row;
+            data_source = Im_in + row_lo * num_data_in_im_row + (x - padding) * ch_im_in;
+        }
+        for (y = row_lo; y < row_hi; y++)
+        {
+            memcpy(pBuffer, data_source, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+        NN_PROFILE_COPY_STOP(num_data_in_row * (row_hi - row_lo));
+
+        //Calculation
+        //Calculate two points at the same time, the last one alone if the range is odd
+        q7_t *pOut = Im_out + start_row * num_data_in_im_row_out + x * ch_im_out;
+        for (y = start_row; y + 2 <= end_row; y += 2)
+        {
+            conv_HWC_q7_block_2x2(bufferA + num_data_in_row * y, num_data_in_row, wt, para_per_ch_out,
+                              ch_im_out, &ep, out_shift, pOut, num_data_in_im_row_out);
+            pOut += 2 * num_data_in_im_row_out;
+        }
+        if ((end_row - start_row) & 0x1)
+        {
+            conv_HWC_q7_block_1x2(bufferA + num_data_in_row * y, wt, para_per_ch_out,
+                              ch_im_out, &ep, out_shift, pOut);
+        }
+    }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_in * ch_im_out * para_per_ch_out,
+                   (end_row - start_row) * num_data_in_im_row_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_q7
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_q7_get_buffer_size(const uint16_t dim_im_in,
+                                     const uint16_t ch_im_in,
+                                     const uint16_t dim_kernel)
+{
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in;
+}
@@ -0,0 +1,178 @@
+#include "nn_functions.h"
+
+/* Widen input column col into ring slot slot of bufferA, zeros for padding columns */
+static void ring_load_col_q15(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const uint16_t dim_kernel,
+                              const uint16_t padding,
+                              const int32_t col,
+                              const uint16_t slot,
+                              q15_t *bufferA)
+{
+    int32_t y;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    q15_t *pBuffer = bufferA + num_data_in_row * padding + slot * ch_im_in;
+
+    NN_PROFILE_COPY_START();
+    if (col < 0 || col >= dim_im_in)
+    {
+        for (y = 0; y < dim_im_in; y++)
+        {
+            memset((void *)pBuffer, 0, ch_im_in * 2);
+            pBuffer += num_data_in_row;
+        }
+    }
+    else
+    {
+        const q7_t *data_source = Im_in + col * ch_im_in;
+        for (y = 0; y < dim_im_in; y++)
+        {
+            arm_q7_to_q15_no_shift((q7_t *)data_source, pBuffer, ch_im_in);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+    }
+    NN_PROFILE_COPY_STOP(dim_im_in * ch_im_in * 2);
+}
+
+/**
+ * @brief Fast convolution with a sliding-window (ring) column buffer
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Pointer to kernel weights
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ * @param[in,out]   bufferB     Pointer to buffer B (weight buffer)
+ *
+ * @details
+ * Same as conv_HWC, but bufferA keeps the last dim_kernel input columns as a
+ * ring: each output column only widens the one newly exposed input column into
+ * the slot of the column that dropped out, and the window is read starting at
+ * slot (x % dim_kernel). Copy traffic into bufferA drops from
+ * dim_kernel * dim_im_in * ch_im_in to dim_im_in * ch_im_in per output column.
+ * The output is computed by the conv_HWC blocks (conv_HWC_column).
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
+ * BufferB size:  dim_kernel * dim_kernel * ch_im_in * ch_im_out (in q15)
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. Output channel is even
+ * 3. ch_im_in is even
+*/
+
+void conv_HWC_ring(const q7_t *Im_in,
+                   const uint16_t dim_im_in,
+                   const uint16_t ch_im_in,
+                   const q7_t *wt,
+                   const uint16_t ch_im_out,
+                   const uint16_t dim_kernel,
+                   const uint16_t padding,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   q7_t *Im_out,
+                   q15_t *bufferA,
+                   q15_t *bufferB)
+{
+    conv_HWC_ring_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                     Im_out, bufferA, bufferB, NULL);
+}
+
+/**
+ * @brief conv_HWC_ring with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_ring. A NULL epilogue gives the same output as
+ * conv_HWC_ring.
+ */
+
+void conv_HWC_ring_ep(const q7_t *Im_in,
+                      const uint16_t dim_im_in,
+                      const uint16_t ch_im_in,
+                      const q7_t *wt,
+                      const uint16_t ch_im_out,
+                      const uint16_t dim_kernel,
+                      const uint16_t padding,
+                      const q7_t *bias,
+                      const uint16_t bias_shift,
+                      const uint16_t out_shift,
+                      q7_t *Im_out,
+                      q15_t *bufferA,
+                      q15_t *bufferB,
+                      const nn_epilogue *epilogue)
+{
+    int32_t x;
+    uint16_t start_slot, new_slot;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_ring");
+
+    // Move parameters to bufferB
+    NN_PROFILE_COPY_START();
+    arm_q7_to_q15_no_shift((q7_t *)wt, bufferB, para_per_ch_out * ch_im_out);
+
+    //set bottom and top padding
+    memset((void *)bufferA, 0, num_data_in_row * padding * 2); // *2 for q15
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+    NN_PROFILE_COPY_STOP((para_per_ch_out * ch_im_out + num_data_in_row * padding * 2) * 2);
+
+    //Fill the first dim_kernel - 1 columns of the window
+    for (new_slot = 0; new_slot < dim_kernel - 1; new_slot++)
+    {
+        ring_load_col_q15(Im_in, dim_im_in, ch_im_in, dim_kernel, padding,
+                          (int32_t)new_slot - padding, new_slot, bufferA);
+    }
+
+    start_slot = 0;
+    for (x = 0; x < dim_im_in; x++)
+    {
+        //Only the newly exposed column is moved to bufferA
+        ring_load_col_q15(Im_in, dim_im_in, ch_im_in, dim_kernel, padding,
+                          x + dim_kernel - 1 - padding, new_slot, bufferA);
+
+        //Calculation, window rows start at slot start_slot and wrap
+        conv_HWC_column(bufferA, num_data_in_row, start_slot * ch_im_in, bufferB, para_per_ch_out, 2,
+                        para_per_ch_out, ch_im_out, &ep, out_shift, Im_out + x * ch_im_out, dim_im_in * ch_im_out,
+                        0, dim_im_in);
+
+        new_slot = start_slot;
+        start_slot = (start_slot + 1 == dim_kernel) ? 0 : start_slot + 1;
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * para_per_ch_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_ring
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       ch_im_out       Output tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @param[out]      bufferB_size    Bytes of bufferB, may be NULL
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_ring_get_buffer_size(const uint16_t dim_im_in,
+                                       const uint16_t ch_im_in,
+                                       const uint16_t ch_im_out,
+                                       const uint16_t dim_kernel,
+                                       uint32_t *bufferB_size)
+{
+    if (bufferB_size)
+    {
+        *bufferB_size = dim_kernel * dim_kernel * ch_im_in * ch_im_out * 2; // *2 for q15
+    }
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in * 2;
+}
@@ -0,0 +1,252 @@
+#include "nn_functions.h"
+
+/*
+ * Output rows y, y+1 of one output column, one output channel per pass. pData
+ * is window y in bufferA, window y+1 is row_len further. The q7 weights of
+ * each non-zero block are widened in registers.
+ */
+static void conv_sparse_2x1(const q15_t *pData,
+                            const uint32_t row_len,
+                            const nn_sparse_weights *wt,
+                            const uint16_t ch_im_out,
+                            const nn_epilogue *ep,
+                            const uint16_t out_shift,
+                            q7_t *pOut,
+                            const uint32_t out_row)
+{
+    const q7_t *pA = wt->values;
+    const uint16_t *pIdx = wt->col_idx;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i++)
+    {
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        q31_t sum1 = (q31_t)ep->bias[i] << ep->bias_shift;
+        q31_t sum2 = sum1;
+        uint32_t blkCnt = wt->row_ptr[i + 1] - wt->row_ptr[i];
+
+        while (blkCnt)
+        {
+            q31_t inA1, inA2;
+            q31_t inB1, inB2;
+            const q15_t *pD1 = pData + 4 * *pIdx++;
+            const q15_t *pD2 = pD1 + row_len;
+
+            pA = (const q7_t *)read_and_pad((void *)pA, &inA1, &inA2);
+
+            inB1 = *__SIMD32(pD1)++;
+            inB2 = *__SIMD32(pD2)++;
+            sum1 = __SMLAD(inA1, inB1, sum1);
+            sum2 = __SMLAD(inA1, inB2, sum2);
+            inB1 = *__SIMD32(pD1);
+            inB2 = *__SIMD32(pD2);
+            sum1 = __SMLAD(inA2, inB1, sum1);
+            sum2 = __SMLAD(inA2, inB2, sum2);
+
+            blkCnt--;
+        }
+
+        pOut[i] = nn_requantize(sum1, shift, ep->act_min, ep->act_max);
+        pOut[out_row + i] = nn_requantize(sum2, shift, ep->act_min, ep->act_max);
+    }
+}
+
+/*
+ * Last output row of one output column when the row count is odd. Reads only
+ * window y, so nothing past bufferA.
+ */
+static void conv_sparse_1x1(const q15_t *pData,
+                            const nn_sparse_weights *wt,
+                            const uint16_t ch_im_out,
+                            const nn_epilogue *ep,
+                            const uint16_t out_shift,
+                            q7_t *pOut)
+{
+    const q7_t *pA = wt->values;
+    const uint16_t *pIdx = wt->col_idx;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i++)
+    {
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        q31_t sum1 = (q31_t)ep->bias[i] << ep->bias_shift;
+        uint32_t blkCnt = wt->row_ptr[i + 1] - wt->row_ptr[i];
+
+        while (blkCnt)
+        {
+            q31_t inA1, inA2;
+            q31_t inB1;
+            const q15_t *pD1 = pData + 4 * *pIdx++;
+
+            pA = (const q7_t *)read_and_pad((void *)pA, &inA1, &inA2);
+
+            inB1 = *__SIMD32(pD1)++;
+            sum1 = __SMLAD(inA1, inB1, sum1);
+            inB1 = *__SIMD32(pD1);
+            sum1 = __SMLAD(inA2, inB1, sum1);
+
+            blkCnt--;
+        }
+
+        pOut[i] = nn_requantize(sum1, shift, ep->act_min, ep->act_max);
+    }
+}
+
+/**
+ * @brief Fast convolution with block-sparse weights
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Block-sparse weights, see nn_sparse_weights, read in place (may be in flash)
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ *
+ * @details
+ * Same output as conv_HWC with the dense weights. The column windows are
+ * widened into bufferA as in conv_HWC, but the weights are not copied to
+ * bufferB: only the non-zero blocks of 4 weights of each output channel are
+ * read and widened in registers, 2 output pixels per block.
+ *
+ * A block costs one weight word, one index and the widening on top of the 4
+ * weights conv_HWC reads from bufferB, so it pays off once a large share of
+ * the blocks is zero (block-pruned models). bufferB is always saved.
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. dim_kernel * dim_kernel * ch_im_in is multiple of 4
+*/
+
+void conv_HWC_sparse(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const nn_sparse_weights *wt,
+                     const uint16_t ch_im_out,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const q7_t *bias,
+                     const uint16_t bias_shift,
+                     const uint16_t out_shift,
+                     q7_t *Im_out,
+                     q15_t *bufferA)
+{
+    conv_HWC_sparse_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                       Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief conv_HWC_sparse with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_sparse. A NULL epilogue gives the same output as
+ * conv_HWC_sparse.
+ */
+
+void conv_HWC_sparse_ep(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const nn_sparse_weights *wt,
+                        const uint16_t ch_im_out,
+                        const uint16_t dim_kernel,
+                        const uint16_t padding,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA,
+                        const nn_epilogue *epilogue)
+{
+    int32_t x, y;
+    uint32_t data_to_transfer;
+    q15_t *pBuffer;
+    const q7_t *data_source;
+
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    uint32_t num_data_in_im_row_out = dim_im_in * ch_im_out;
+
+    //Resolve bias, shift and clamp once for all blocks
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_sparse");
+
+    //set bottom and top padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding * 2); // *2 for q15
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 4);
+
+    for (x = 0; x < dim_im_in; x++)
+    {
+        //Move data to bufferA
+        NN_PROFILE_COPY_START();
+        pBuffer = bufferA + num_data_in_row * padding;
+        if (x < padding)
+        {
+            //set the left padding
+            memset((void *)pBuffer, 0, num_data_in_row * dim_im_in * 2);
+            data_to_transfer = ch_im_in * (dim_kernel - padding + x);
+            pBuffer += num_data_in_row - data_to_transfer;
+            data_source = Im_in;
+        }
+        else if (x > (dim_im_in - padding - 1))
+        {
+            //set the right padding
+            memset((void *)pBuffer, 0, num_data_in_row * dim_im_in * 2);
+            data_to_transfer = ch_im_in * (dim_kernel - (x + padding - (dim_im_in - 1)));
+            data_source = Im_in + (x - padding) * ch_im_in;
+        }
+        else
+        {
+            data_to_transfer = num_data_in_row;
+            data_source = Im_in + (x - padding) * ch_im_in;
+        }
+        for (y = 0; y < dim_im_in; y++)
+        {
+            arm_q7_to_q15_no_shift((q7_t *)data_source, pBuffer, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+        NN_PROFILE_COPY_STOP(num_data_in_row * dim_im_in * 2);
+
+        //Calculation
+        //Calculate two points at the same time, the last one alone if dim_im_in is odd
+        q7_t *pOut = Im_out + x * ch_im_out;
+        for (y = 0; y + 2 <= dim_im_in; y += 2)
+        {
+            conv_sparse_2x1(bufferA + num_data_in_row * y, num_data_in_row, wt, ch_im_out, &ep, out_shift, pOut,
+                            num_data_in_im_row_out);
+            pOut += 2 * num_data_in_im_row_out;
+        }
+        if (dim_im_in & 0x1)
+        {
+            conv_sparse_1x1(bufferA + num_data_in_row * y, wt, ch_im_out, &ep, out_shift, pOut);
+        }
+    }
+    //Nominal MACs, as the dense layer
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * dim_kernel * dim_kernel * ch_im_in,
+                   dim_im_in * num_data_in_im_row_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_sparse
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_sparse_get_buffer_size(const uint16_t dim_im_in,
+                                         const uint16_t ch_im_in,
+                                         const uint16_t dim_kernel)
+{
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in * 2; // *2 for q15
+}
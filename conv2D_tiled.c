@@ -0,0 +1,174 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Largest output channel tile of conv_HWC_tiled that fits a bufferB budget
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       ch_im_out       Output tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @param[in]       bufferB_bytes   Scratch available for bufferB, in bytes
+ * @return          Even tile size (at most ch_im_out), 0 if not even two channels fit
+ */
+
+uint16_t conv_HWC_get_tile_size(const uint16_t ch_im_in,
+                                const uint16_t ch_im_out,
+                                const uint16_t dim_kernel,
+                                const uint32_t bufferB_bytes)
+{
+    uint32_t bytes_per_ch_out = dim_kernel * dim_kernel * ch_im_in * 2; // *2 for q15
+    uint32_t tile = bufferB_bytes / bytes_per_ch_out;
+
+    if (tile > ch_im_out)
+    {
+        tile = ch_im_out;
+    }
+    return (uint16_t)(tile & ~0x1U);
+}
+
+/**
+ * @brief Fast convolution, weights widened in tiles of output channels
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Pointer to kernel weights
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       bias        Pointers to bias
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A (tensor buffer)
+ * @param[in,out]   bufferB     Pointer to buffer B (weight buffer)
+ * @param[in]       ch_tile     Output channels per tile, see conv_HWC_get_tile_size
+ *
+ * @details
+ * Same as conv_HWC, but only ch_tile output channels of weights are widened
+ * into bufferB at a time, and the whole output is computed for that tile before
+ * moving to the next one. The column window in bufferA is rebuilt once per
+ * tile, so fewer tiles run faster; ch_tile = ch_im_out is the single-shot case.
+ * The output is computed by the conv_HWC blocks (conv_HWC_column).
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in (in q15)
+ * BufferB size:  dim_kernel * dim_kernel * ch_im_in * ch_tile (in q15)
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. Output channel is even
+ * 3. ch_im_in is even
+ * 4. ch_tile is even and not 0
+*/
+
+void conv_HWC_tiled(const q7_t *Im_in,
+                    const uint16_t dim_im_in,
+                    const uint16_t ch_im_in,
+                    const q7_t *wt,
+                    const uint16_t ch_im_out,
+                    const uint16_t dim_kernel,
+                    const uint16_t padding,
+                    const q7_t *bias,
+                    const uint16_t bias_shift,
+                    const uint16_t out_shift,
+                    q7_t *Im_out,
+                    q15_t *bufferA,
+                    q15_t *bufferB,
+                    const uint16_t ch_tile)
+{
+    conv_HWC_tiled_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, dim_kernel, padding, bias, bias_shift, out_shift,
+                      Im_out, bufferA, bufferB, ch_tile, NULL);
+}
+
+/**
+ * @brief conv_HWC_tiled with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as conv_HWC_tiled. A NULL epilogue gives the same output as
+ * conv_HWC_tiled.
+ */
+
+void conv_HWC_tiled_ep(const q7_t *Im_in,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const q7_t *wt,
+                       const uint16_t ch_im_out,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       const q7_t *bias,
+                       const uint16_t bias_shift,
+                       const uint16_t out_shift,
+                       q7_t *Im_out,
+                       q15_t *bufferA,
+                       q15_t *bufferB,
+                       const uint16_t ch_tile,
+                       const nn_epilogue *epilogue)
+{
+    int32_t x;
+    uint16_t ch_start, ch_cnt;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("conv_HWC_tiled");
+
+    //set bottom and top padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding * 2); // *2 for q15
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding * 2);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 4);
+
+    for (ch_start = 0; ch_start < ch_im_out; ch_start += ch_cnt)
+    {
+        //Per channel terms of this tile
+        nn_epilogue tile_ep = ep;
+        ch_cnt = (ch_im_out - ch_start < ch_tile) ? ch_im_out - ch_start : ch_tile;
+        if (tile_ep.bias)
+        {
+            tile_ep.bias += ch_start;
+        }
+        if (tile_ep.out_shift)
+        {
+            tile_ep.out_shift += ch_start;
+        }
+
+        // Move the parameters of this tile to bufferB
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_no_shift((q7_t *)wt + ch_start * para_per_ch_out, bufferB, ch_cnt * para_per_ch_out);
+        NN_PROFILE_COPY_STOP(ch_cnt * para_per_ch_out * 2);
+
+        // Move data and calculate per col
+        for (x = 0; x < dim_im_in; x++)
+        {
+            //Move data to bufferA
+            conv_HWC_load_col(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, bufferA, x, 0, dim_im_in);
+
+            //Calculation
+            conv_HWC_column(bufferA, num_data_in_row, 0, bufferB, para_per_ch_out, 2, para_per_ch_out, ch_cnt,
+                            &tile_ep, out_shift, Im_out + x * ch_im_out + ch_start, dim_im_in * ch_im_out, 0,
+                            dim_im_in);
+        }
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * para_per_ch_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of conv_HWC_tiled
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       ch_tile         Output channels per tile
+ * @param[in]       dim_kernel      Kernel dimention
+ * @param[out]      bufferB_size    Bytes of bufferB, may be NULL
+ * @return          Bytes of bufferA
+ */
+
+uint32_t conv_HWC_tiled_get_buffer_size(const uint16_t dim_im_in,
+                                        const uint16_t ch_im_in,
+                                        const uint16_t ch_tile,
+                                        const uint16_t dim_kernel,
+                                        uint32_t *bufferB_size)
+{
+    if (bufferB_size)
+    {
+        *bufferB_size = dim_kernel * dim_kernel * ch_im_in * ch_tile * 2; // *2 for q15
+    }
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in * 2;
+}
@@ -1,4 +1,140 @@
-#include "nn_functions.h"
+#include "nn_depthwise.h"
+
+/**
+ * @brief One output pixel of depthwise_conv over a window of num_rows x run taps
+ * @param[in]       pB          First tap of the input window
+ * @param[in]       pA          First tap of the weights
+ * @param[in]       ch_im_in    Input tensor channel, taps are ch_im_in apart
+ * @param[in]       num_rows    Window rows
+ * @param[in]       run         Taps per window row
+ * @param[in]       row_len     Row stride of both pB and pA
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ * @param[in,out]   pOut        Output pixel, ch_im_in values
+ */
+
+void depthwise_pixel(const q7_t *pB,
+                     const q7_t *pA,
+                     const uint16_t ch_im_in,
+                     uint16_t num_rows,
+                     uint16_t run,
+                     const uint16_t row_len,
+                     const uint16_t out_shift,
+                     const nn_epilogue *epilogue,
+                     q7_t *pOut)
+{
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+    const q7_t *pBias = ep.bias;
+    uint16_t bias_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    uint16_t rowCnt;
+    uint16_t row_shift = 0;
+    uint16_t colCnt;
+    uint16_t i_row;
+
+    //Full rows are contiguous, treat the window as one run
+    if (run * ch_im_in == row_len)
+    {
+        run *= num_rows;
+        num_rows = 1;
+    }
+
+    rowCnt = ch_im_in >> 2;
+    while (rowCnt)
+    {
+        q31_t sum = pBias ? (q31_t)pBias[row_shift] << bias_shift : 0;
+        q31_t sum2 = pBias ? (q31_t)pBias[row_shift + 1] << bias_shift : 0;
+        q31_t sum3 = pBias ? (q31_t)pBias[row_shift + 2] << bias_shift : 0;
+        q31_t sum4 = pBias ? (q31_t)pBias[row_shift + 3] << bias_shift : 0;
+
+        for (i_row = 0; i_row < num_rows; i_row++)
+        {
+            const q7_t *pB1 = pB + i_row * row_len + row_shift;
+            const q7_t *pA1 = pA + i_row * row_len + row_shift;
+
+            colCnt = run >> 1;
+            while (colCnt)
+            {
+                q31_t inA1, inA2, inB1, inB2, opA, opB;
+
+                inB1 = *__SIMD32(pB1);
+                pB1 += ch_im_in;
+                opB = *__SIMD32(pB1);
+                pB1 += ch_im_in;
+                inB2 = __PKHTB(opB, inB1, 16);
+                inB1 = __PKHBT(inB1, opB, 16);
+                inA1 = *__SIMD32(pA1);
+                pA1 += ch_im_in;
+                opB = *__SIMD32(pA1);
+                pA1 += ch_im_in;
+                inA2 = __PKHTB(opB, inA1, 16);
+                inA1 = __PKHBT(inA1, opB, 16);
+                opA = __SXTB16(inA1);
+                opB = __SXTB16(inB1);
+                sum = __SMLAD(opA, opB, sum);
+                opA = __SXTB16(__ROR(inA1, 8));
+                opB = __SXTB16(__ROR(inB1, 8));
+                sum2 = __SMLAD(opA, opB, sum2);
+                opA = __SXTB16(inA2);
+                opB = __SXTB16(inB2);
+                sum3 = __SMLAD(opA, opB, sum3);
+                opA = __SXTB16(__ROR(inA2, 8));
+                opB = __SXTB16(__ROR(inB2, 8));
+                sum4 = __SMLAD(opA, opB, sum4);
+                colCnt--;
+            }
+
+            if (run & 0x1)
+            {
+                union arm_nnword inA, inB;
+                inA.word = *__SIMD32(pA1);
+                inB.word = *__SIMD32(pB1);
+                sum += inA.bytes[0] * inB.bytes[0];
+                sum2 += inA.bytes[1] * inB.bytes[1];
+                sum3 += inA.bytes[2] * inB.bytes[2];
+                sum4 += inA.bytes[3] * inB.bytes[3];
+            }
+        }
+
+        *pOut++ = nn_requantize(sum, pShift ? pShift[row_shift] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum2, pShift ? pShift[row_shift + 1] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum3, pShift ? pShift[row_shift + 2] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum4, pShift ? pShift[row_shift + 3] : out_shift, act_min, act_max);
+
+        row_shift += 4;
+        rowCnt--;
+    }
+
+    rowCnt = ch_im_in & 0x3;
+    while (rowCnt)
+    {
+        q31_t sum = pBias ? (q31_t)pBias[row_shift] << bias_shift : 0;
+
+        for (i_row = 0; i_row < num_rows; i_row++)
+        {
+            const q7_t *pB1 = pB + i_row * row_len + row_shift;
+            const q7_t *pA1 = pA + i_row * row_len + row_shift;
+
+            colCnt = run;
+            while (colCnt)
+            {
+                q7_t A1 = *pA1;
+                q7_t B1 = *pB1;
+                pA1 += ch_im_in;
+                pB1 += ch_im_in;
+                sum += A1 * B1;
+
+                colCnt--;
+            }
+        }
+        *pOut++ = nn_requantize(sum, pShift ? pShift[row_shift] : out_shift, act_min, act_max);
+
+        row_shift += 1;
+        rowCnt--;
+    }
+}
 
 /**
  * @brief Fast depthwise convolution
@@ -15,6 +151,13 @@
  * Changes from the original function:
  * 1. Optimized memory copy process with a trade off of larger bufferA.
  * 2. Remove bias parameters, depthwise layer (tensorflow) does not have bias.
+ *    Bias (e.g. folded batch norm) can be added back through the epilogue.
+ * 3. No padding in bufferA. Interior pixels run the full kernel window as one
+ *    run of taps, like the padded kernel, border pixels run only the taps
+ *    inside the image.
+ * 4. Optional fused epilogue through depthwise_conv_ep, see nn_epilogue.
+ * 5. Built with -DNN_FIXED_KERNELS, 3x3 kernels with ch_im_in multiple of 4
+ *    run their interior pixels through depthwise_pixel_3x3.
  * 
  * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in
  * 
@@ -32,165 +175,423 @@ void depthwise_conv(const q7_t *Im_in,
                     q7_t *Im_out,
                     q7_t *bufferA)
 {
+    depthwise_conv_ep(Im_in, dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift, Im_out, bufferA, NULL);
+}
 
-    /* Run the following code for Cortex-M4 and Cortex-M7 */
+/**
+ * @brief depthwise_conv with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as depthwise_conv. A NULL epilogue gives the same output as
+ * depthwise_conv.
+ */
 
-    int16_t i_out_y, i_out_x;
-    q7_t *pBuffer = bufferA;
-    q7_t *pOut;
-    q7_t *data_source;
-    uint16_t rowCnt;
-    uint16_t row_shift;
+void depthwise_conv_ep(const q7_t *Im_in,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const q7_t *wt,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       const uint16_t out_shift,
+                       q7_t *Im_out,
+                       q7_t *bufferA,
+                       const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("depthwise_conv");
+    depthwise_conv_rows(Im_in, dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift, Im_out, bufferA, epilogue,
+                        0, dim_im_in);
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * dim_kernel * dim_kernel,
+                   dim_im_in * dim_im_in * ch_im_in);
+}
 
+/*
+ * Move input rows [row_lo, row_hi) of the kernel columns of output column
+ * i_out_x that lie inside the image to bufferA, padding is never read
+ */
+static void depthwise_load_col(const q7_t *Im_in,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const uint16_t dim_kernel,
+                               const uint16_t padding,
+                               q7_t *bufferA,
+                               const int16_t i_out_x,
+                               const int16_t row_lo,
+                               const int16_t row_hi)
+{
     uint16_t num_data_in_row = dim_kernel * ch_im_in;
-    uint16_t data_to_transfer;
     uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    int16_t kx_start = (i_out_x < padding) ? padding - i_out_x : 0;
+    int16_t kx_end = (i_out_x + dim_kernel - padding > dim_im_in) ? dim_im_in + padding - i_out_x : dim_kernel;
+    q7_t *pBuffer = bufferA + num_data_in_row * (padding + row_lo) + kx_start * ch_im_in;
+    const q7_t *data_source = Im_in + row_lo * num_data_in_im_row + (i_out_x - padding + kx_start) * ch_im_in;
+    uint16_t data_to_transfer = (kx_end - kx_start) * ch_im_in;
+    int16_t i_out_y;
+
+    NN_PROFILE_COPY_START();
+    for (i_out_y = row_lo; i_out_y < row_hi; i_out_y++)
+    {
+        memcpy(pBuffer, data_source, data_to_transfer);
+        data_source += num_data_in_im_row;
+        pBuffer += num_data_in_row;
+    }
+    NN_PROFILE_COPY_STOP(data_to_transfer * (row_hi - row_lo));
+}
+
+/*
+ * One interior output pixel of depthwise_conv: the full window is one run of
+ * taps taps, ch_im_in apart, as in the padded kernel, so there is no row loop
+ * and no window clipping. ep is resolved (nn_epilogue_resolve), its bias may
+ * be NULL.
+ */
+NN_FORCEINLINE void depthwise_pixel_full(const q7_t *pB,
+                                         const q7_t *pA,
+                                         const uint16_t ch_im_in,
+                                         const uint16_t taps,
+                                         const uint16_t out_shift,
+                                         const nn_epilogue *ep,
+                                         q7_t *pOut)
+{
+    const q7_t *pBias = ep->bias;
+    const uint16_t b_shift = ep->bias_shift;
+    const uint8_t *pShift = ep->out_shift;
+    const q7_t act_min = ep->act_min;
+    const q7_t act_max = ep->act_max;
+    uint16_t rowCnt = ch_im_in >> 2;
+    uint16_t row_shift = 0;
     uint16_t colCnt;
-    q7_t *pB;
-    q7_t *pA;
-    //TODO: ignore the mul with zero to accelerate
-    //set the top and bottom padding
-    memset((void *)pBuffer, 0, num_data_in_row * padding);
-    memset((void *)(pBuffer + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding);
 
-    for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+    while (rowCnt)
     {
-        pBuffer = bufferA;
-        if (i_out_x < padding)
+        const q7_t *pB1 = pB + row_shift;
+        const q7_t *pA1 = pA + row_shift;
+        q31_t sum = pBias ? (q31_t)pBias[row_shift] << b_shift : 0;
+        q31_t sum2 = pBias ? (q31_t)pBias[row_shift + 1] << b_shift : 0;
+        q31_t sum3 = pBias ? (q31_t)pBias[row_shift + 2] << b_shift : 0;
+        q31_t sum4 = pBias ? (q31_t)pBias[row_shift + 3] << b_shift : 0;
+
+        colCnt = taps >> 1;
+        while (colCnt)
         {
-            //set the left padding
-            memset((void *)(pBuffer + num_data_in_row * padding), 0, num_data_in_row * dim_im_in);
-            data_to_transfer = ch_im_in * (dim_kernel - padding + i_out_x);
-            pBuffer += num_data_in_row * padding + num_data_in_row - data_to_transfer;
-            data_source = (q7_t *)Im_in;
-            for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
-            {
-                memcpy(pBuffer, data_source, data_to_transfer);
-                data_source += num_data_in_im_row;
-                pBuffer += num_data_in_row;
-            }
+            q31_t inA1, inA2, inB1, inB2, opA, opB;
+
+            inB1 = *__SIMD32(pB1);
+            pB1 += ch_im_in;
+            opB = *__SIMD32(pB1);
+            pB1 += ch_im_in;
+            inB2 = __PKHTB(opB, inB1, 16);
+            inB1 = __PKHBT(inB1, opB, 16);
+            inA1 = *__SIMD32(pA1);
+            pA1 += ch_im_in;
+            opB = *__SIMD32(pA1);
+            pA1 += ch_im_in;
+            inA2 = __PKHTB(opB, inA1, 16);
+            inA1 = __PKHBT(inA1, opB, 16);
+            opA = __SXTB16(inA1);
+            opB = __SXTB16(inB1);
+            sum = __SMLAD(opA, opB, sum);
+            opA = __SXTB16(__ROR(inA1, 8));
+            opB = __SXTB16(__ROR(inB1, 8));
+            sum2 = __SMLAD(opA, opB, sum2);
+            opA = __SXTB16(inA2);
+            opB = __SXTB16(inB2);
+            sum3 = __SMLAD(opA, opB, sum3);
+            opA = __SXTB16(__ROR(inA2, 8));
+            opB = __SXTB16(__ROR(inB2, 8));
+            sum4 = __SMLAD(opA, opB, sum4);
+            colCnt--;
         }
-        else if (i_out_x > (dim_im_in - padding - 1))
+        if (taps & 0x1)
         {
-            //set the right padding
-            memset((void *)(pBuffer + num_data_in_row * padding), 0, num_data_in_row * dim_im_in);
-            data_to_transfer = ch_im_in * (dim_kernel - (i_out_x + padding - (dim_im_in - 1)));
-            pBuffer += num_data_in_row * padding;
-            data_source = (q7_t *)Im_in + (i_out_x - padding) * ch_im_in;
-            for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
-            {
-                memcpy(pBuffer, data_source, data_to_transfer);
-                data_source += num_data_in_im_row;
-                pBuffer += num_data_in_row;
-            }
+            union arm_nnword inA, inB;
+            inA.word = *__SIMD32(pA1);
+            inB.word = *__SIMD32(pB1);
+            sum += inA.bytes[0] * inB.bytes[0];
+            sum2 += inA.bytes[1] * inB.bytes[1];
+            sum3 += inA.bytes[2] * inB.bytes[2];
+            sum4 += inA.bytes[3] * inB.bytes[3];
         }
-        else
+
+        *pOut++ = nn_requantize(sum, pShift ? pShift[row_shift] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum2, pShift ? pShift[row_shift + 1] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum3, pShift ? pShift[row_shift + 2] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum4, pShift ? pShift[row_shift + 3] : out_shift, act_min, act_max);
+        row_shift += 4;
+        rowCnt--;
+    }
+
+    rowCnt = ch_im_in & 0x3;
+    while (rowCnt)
+    {
+        const q7_t *pB1 = pB + row_shift;
+        const q7_t *pA1 = pA + row_shift;
+        q31_t sum = pBias ? (q31_t)pBias[row_shift] << b_shift : 0;
+
+        colCnt = taps;
+        while (colCnt)
         {
-            pBuffer += num_data_in_row * padding;
-            data_source = (q7_t *)Im_in + (i_out_x - padding) * ch_im_in;
-            for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
-            {
-                memcpy(pBuffer, data_source, num_data_in_row);
-                data_source += num_data_in_im_row;
-                pBuffer += num_data_in_row;
-            }
+            sum += *pA1 * *pB1;
+            pA1 += ch_im_in;
+            pB1 += ch_im_in;
+            colCnt--;
         }
+        *pOut++ = nn_requantize(sum, pShift ? pShift[row_shift] : out_shift, act_min, act_max);
+        row_shift += 1;
+        rowCnt--;
+    }
+}
 
-        for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+/*
+ * Output rows [start_row, end_row) of output column i_out_x from bufferA,
+ * output row y at pOut + y * out_row_stride
+ */
+static void depthwise_compute_col(const uint16_t dim_im_in,
+                                  const uint16_t ch_im_in,
+                                  const q7_t *wt,
+                                  const uint16_t dim_kernel,
+                                  const uint16_t padding,
+                                  const uint16_t out_shift,
+                                  q7_t *pOut,
+                                  const uint32_t out_row_stride,
+                                  const q7_t *bufferA,
+                                  const nn_epilogue *epilogue,
+                                  const int16_t i_out_x,
+                                  const uint16_t start_row,
+                                  const uint16_t end_row)
+{
+    uint16_t num_data_in_row = dim_kernel * ch_im_in;
+    //Interior pixels of a 3x3 kernel take the unrolled pixel, if built in
+    int full_3x3 = dw_full_3x3(dim_kernel, dim_kernel, ch_im_in);
+    //Kernel columns inside the image
+    int16_t kx_start = (i_out_x < padding) ? padding - i_out_x : 0;
+    int16_t kx_end = (i_out_x + dim_kernel - padding > dim_im_in) ? dim_im_in + padding - i_out_x : dim_kernel;
+    int full_col = kx_start == 0 && kx_end == dim_kernel;
+    //Resolved once for the interior pixels
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+    int16_t i_out_y;
+
+    for (i_out_y = start_row; i_out_y < end_row; i_out_y++)
+    {
+        //Kernel rows inside the image
+        int16_t ky_start = (i_out_y < padding) ? padding - i_out_y : 0;
+        int16_t ky_end = (i_out_y + dim_kernel - padding > dim_im_in) ? dim_im_in + padding - i_out_y : dim_kernel;
+        uint16_t tap_offset = ky_start * num_data_in_row + kx_start * ch_im_in;
+
+        if (full_col && ky_start == 0 && ky_end == dim_kernel)
         {
-            rowCnt = ch_im_in >> 2;
-            row_shift = 0;
-            pOut = Im_out + i_out_x * ch_im_in + i_out_y * num_data_in_im_row;
-            while (rowCnt)
+            //Interior pixel: the whole window, one contiguous run of taps
+            if (full_3x3)
             {
-                q31_t sum = 0;
-                q31_t sum2 = 0;
-                q31_t sum3 = 0;
-                q31_t sum4 = 0;
-
-                colCnt = (dim_kernel * dim_kernel) >> 1;
-                pB = bufferA + num_data_in_row * i_out_y + row_shift;
-                pA = (q7_t *)wt + row_shift;
-
-                row_shift += 4;
-
-                while (colCnt)
-                {
-                    q31_t inA1, inA2, inB1, inB2, opA, opB;
-
-                    inB1 = *__SIMD32(pB);
-                    pB += ch_im_in;
-                    opB = *__SIMD32(pB);
-                    pB += ch_im_in;
-                    inB2 = __PKHTB(opB, inB1, 16);
-                    inB1 = __PKHBT(inB1, opB, 16);
-                    inA1 = *__SIMD32(pA);
-                    pA += ch_im_in;
-                    opB = *__SIMD32(pA);
-                    pA += ch_im_in;
-                    inA2 = __PKHTB(opB, inA1, 16);
-                    inA1 = __PKHBT(inA1, opB, 16);
-                    opA = __SXTB16(inA1);
-                    opB = __SXTB16(inB1);
-                    sum = __SMLAD(opA, opB, sum);
-                    opA = __SXTB16(__ROR(inA1, 8));
-                    opB = __SXTB16(__ROR(inB1, 8));
-                    sum2 = __SMLAD(opA, opB, sum2);
-                    opA = __SXTB16(inA2);
-                    opB = __SXTB16(inB2);
-                    sum3 = __SMLAD(opA, opB, sum3);
-                    opA = __SXTB16(__ROR(inA2, 8));
-                    opB = __SXTB16(__ROR(inB2, 8));
-                    sum4 = __SMLAD(opA, opB, sum4);
-                    colCnt--;
-                }
-
-                colCnt = (dim_kernel * dim_kernel) & 0x1;
-                while (colCnt)
-                {
-                    union arm_nnword inA, inB;
-                    inA.word = *__SIMD32(pA);
-                    pA += ch_im_in;
-                    inB.word = *__SIMD32(pB);
-                    pB += ch_im_in;
-                    sum += inA.bytes[0] * inB.bytes[0];
-                    sum2 += inA.bytes[1] * inB.bytes[1];
-                    sum3 += inA.bytes[2] * inB.bytes[2];
-                    sum4 += inA.bytes[3] * inB.bytes[3];
-                    colCnt--;
-                }
-
-                *pOut++ = (q7_t)__SSAT((sum  >> out_shift), 8);
-                *pOut++ = (q7_t)__SSAT((sum2 >> out_shift), 8);
-                *pOut++ = (q7_t)__SSAT((sum3 >> out_shift), 8);
-                *pOut++ = (q7_t)__SSAT((sum4 >> out_shift), 8);
-
-                rowCnt--;
+                depthwise_pixel_3x3(bufferA + num_data_in_row * i_out_y, wt, ch_im_in, out_shift, epilogue,
+                                    pOut + i_out_y * out_row_stride);
             }
-
-            rowCnt = ch_im_in & 0x3;
-            while (rowCnt)
+            else
             {
-                pB = bufferA + num_data_in_row * i_out_y + row_shift;
-                pA = (q7_t *)wt + row_shift;
-                q31_t sum = 0;
-                uint16_t colCnt = (dim_kernel * dim_kernel);
-
-                row_shift += 1;
-
-                while (colCnt)
-                {
-                    q7_t A1 = *pA;
-                    q7_t B1 = *pB;
-                    pA += ch_im_in;
-                    pB += ch_im_in;
-                    sum += A1 * B1;
-
-                    colCnt--;
-                }
-                *pOut++ = (q7_t)__SSAT((sum >> out_shift), 8);
-                rowCnt--;
+                depthwise_pixel_full(bufferA + num_data_in_row * i_out_y, wt, ch_im_in, dim_kernel * dim_kernel,
+                                     out_shift, &ep, pOut + i_out_y * out_row_stride);
             }
+            continue;
+        }
+
+        //Border pixel: only the taps inside the image
+
+        depthwise_pixel(bufferA + num_data_in_row * i_out_y + tap_offset,
+                        wt + tap_offset,
+                        ch_im_in,
+                        ky_end - ky_start,
+                        kx_end - kx_start,
+                        num_data_in_row,
+                        out_shift,
+                        epilogue,
+                        pOut + i_out_y * out_row_stride);
+    }
+}
+
+/**
+ * @brief depthwise_conv for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_in
+ *
+ * @details
+ * Other parameters as depthwise_conv_ep. The rows written are bit-identical to
+ * the same rows of depthwise_conv and no other output row is touched. Only the
+ * input rows the range reaches are copied to bufferA.
+ *
+ * BufferA size and Constrains: as depthwise_conv
+*/
+
+void depthwise_conv_rows(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t dim_kernel,
+                         const uint16_t padding,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q7_t *bufferA,
+                         const nn_epilogue *epilogue,
+                         const uint16_t start_row,
+                         const uint16_t end_row)
+{
+
+    /* Run the following code for Cortex-M4 and Cortex-M7 */
+
+    int16_t i_out_x;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    //Input rows the windows of the output rows reach
+    int16_t row_lo = start_row > padding ? start_row - padding : 0;
+    int16_t row_hi = end_row + dim_kernel - 1 - padding < dim_im_in ? end_row + dim_kernel - 1 - padding : dim_im_in;
+
+    NN_PROFILE_BEGIN("depthwise_conv_rows");
+    for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+    {
+        depthwise_load_col(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, bufferA, i_out_x, row_lo, row_hi);
+        depthwise_compute_col(dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift, Im_out + i_out_x * ch_im_in,
+                              num_data_in_im_row, bufferA, epilogue, i_out_x, start_row, end_row);
+    }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * num_data_in_im_row * dim_kernel * dim_kernel,
+                   (end_row - start_row) * num_data_in_im_row);
+}
+
+/*
+ * Copy output column i_out_x from its lag slot to Im_out
+ */
+static void depthwise_flush_col(const q7_t *pSlot,
+                                const uint16_t dim_im_in,
+                                const uint16_t ch_im_in,
+                                q7_t *Im_out,
+                                const int16_t i_out_x)
+{
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    q7_t *pDst = Im_out + i_out_x * ch_im_in;
+    uint16_t i_out_y;
+
+    NN_PROFILE_COPY_START();
+    for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+    {
+        memcpy(pDst, pSlot, ch_im_in);
+        pSlot += ch_im_in;
+        pDst += num_data_in_im_row;
+    }
+    NN_PROFILE_COPY_STOP(num_data_in_im_row);
+}
+
+/**
+ * @brief depthwise_conv that may run in place (Im_out == Im_in)
+ *
+ * @details
+ * Parameters and output as depthwise_conv, bufferA is larger. Im_out may be
+ * Im_in, which removes one dim_im_in x dim_im_in x ch_im_in tensor from the
+ * peak RAM; any other overlap is not supported.
+ *
+ * Input column x is last copied to bufferA for output column x + padding.
+ * Output columns are therefore kept in a lag buffer of padding columns after
+ * the bufferA window and written to Im_out padding columns late, once their
+ * input column has been copied for the last time. With padding 0 the output
+ * is written directly.
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in + padding * dim_im_in * ch_im_in
+ *
+ * Constrains: as depthwise_conv
+*/
+
+void depthwise_conv_inplace(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t dim_kernel,
+                            const uint16_t padding,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q7_t *bufferA)
+{
+    depthwise_conv_inplace_ep(Im_in, dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift, Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief depthwise_conv_inplace with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as depthwise_conv_inplace. A NULL epilogue gives the same output as
+ * depthwise_conv_inplace.
+ */
+
+void depthwise_conv_inplace_ep(const q7_t *Im_in,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t dim_kernel,
+                               const uint16_t padding,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q7_t *bufferA,
+                               const nn_epilogue *epilogue)
+{
+    int16_t i_out_x;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    q7_t *pLag = bufferA + depthwise_conv_get_buffer_size(dim_im_in, ch_im_in, dim_kernel);
+
+    NN_PROFILE_BEGIN("depthwise_conv_inplace");
+    for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+    {
+        depthwise_load_col(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, bufferA, i_out_x, 0, dim_im_in);
+
+        if (padding == 0)
+        {
+            depthwise_compute_col(dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift,
+                                  Im_out + i_out_x * ch_im_in, num_data_in_im_row, bufferA, epilogue, i_out_x,
+                                  0, dim_im_in);
+            continue;
         }
+
+        //Column i_out_x - padding and column i_out_x share a slot
+        q7_t *pSlot = pLag + (i_out_x % padding) * num_data_in_im_row;
+        if (i_out_x >= padding)
+        {
+            depthwise_flush_col(pSlot, dim_im_in, ch_im_in, Im_out, i_out_x - padding);
+        }
+        depthwise_compute_col(dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift, pSlot, ch_im_in, bufferA,
+                              epilogue, i_out_x, 0, dim_im_in);
+    }
+
+    //Columns still in the lag buffer
+    for (i_out_x = dim_im_in > padding ? dim_im_in - padding : 0; i_out_x < dim_im_in; i_out_x++)
+    {
+        depthwise_flush_col(pLag + (i_out_x % padding) * num_data_in_im_row, dim_im_in, ch_im_in, Im_out, i_out_x);
     }
+    NN_PROFILE_END((uint64_t)dim_im_in * num_data_in_im_row * dim_kernel * dim_kernel,
+                   dim_im_in * num_data_in_im_row);
+}
+
+/**
+ * @brief Scratch size of depthwise_conv
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t depthwise_conv_get_buffer_size(const uint16_t dim_im_in,
+                                        const uint16_t ch_im_in,
+                                        const uint16_t dim_kernel)
+{
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in;
+}
+
+/**
+ * @brief Scratch size of depthwise_conv_inplace
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @param[in]       padding         Padding
+ * @return          Bytes of bufferA
+ */
+
+uint32_t depthwise_conv_inplace_get_buffer_size(const uint16_t dim_im_in,
+                                                const uint16_t ch_im_in,
+                                                const uint16_t dim_kernel,
+                                                const uint16_t padding)
+{
+    return depthwise_conv_get_buffer_size(dim_im_in, ch_im_in, dim_kernel) + padding * dim_im_in * ch_im_in;
 }
@@ -0,0 +1,96 @@
+#include "nn_functions.h"
+
+/**
+ * @brief One output pixel of a 3x3 depthwise convolution, window fully unrolled
+ * @param[in]       pB          First tap of the input window, taps ch_im_in apart
+ * @param[in]       pA          First tap of the weights, taps ch_im_in apart
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ * @param[in,out]   pOut        Output pixel, ch_im_in values
+ *
+ * @details
+ * Same arithmetic as the generic pixel loop of depthwise_conv and
+ * depthwise_conv_nonsquare, for the case they hit most in DS-CNN: a full
+ * 3x3 window stored as 9 consecutive taps (bufferA rows of 3 * ch_im_in).
+ * The 9 taps run as 4 pairs and 1 single tap with constant offsets, so there is
+ * no tap counter, no odd-tap test and no channel remainder loop. The kernels
+ * only dispatch to it when built with -DNN_FIXED_KERNELS: on the host it
+ * measured 0.79x of depthwise_pixel (tests/bench_fixed.c).
+ *
+ * Constrains:
+ * 1. ch_im_in is multiple of 4
+*/
+
+void depthwise_pixel_3x3(const q7_t *pB,
+                         const q7_t *pA,
+                         const uint16_t ch_im_in,
+                         const uint16_t out_shift,
+                         const nn_epilogue *epilogue,
+                         q7_t *pOut)
+{
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+    const q7_t *pBias = ep.bias;
+    uint16_t bias_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    uint16_t rowCnt = ch_im_in >> 2;
+    uint16_t ch = 0;
+
+    //Taps t and t + 1 of 4 channels
+#define DW_TAP_PAIR(t)                                                        \
+    pB1 = pB + (t) * ch_im_in;                                                \
+    pA1 = pA + (t) * ch_im_in;                                                \
+    inB1 = *__SIMD32(pB1);                                                    \
+    pB1 += ch_im_in;                                                          \
+    opB = *__SIMD32(pB1);                                                     \
+    inB2 = __PKHTB(opB, inB1, 16);                                            \
+    inB1 = __PKHBT(inB1, opB, 16);                                            \
+    inA1 = *__SIMD32(pA1);                                                    \
+    pA1 += ch_im_in;                                                          \
+    opB = *__SIMD32(pA1);                                                     \
+    inA2 = __PKHTB(opB, inA1, 16);                                            \
+    inA1 = __PKHBT(inA1, opB, 16);                                            \
+    sum = __SMLAD(__SXTB16(inA1), __SXTB16(inB1), sum);                       \
+    sum2 = __SMLAD(__SXTB16(__ROR(inA1, 8)), __SXTB16(__ROR(inB1, 8)), sum2); \
+    sum3 = __SMLAD(__SXTB16(inA2), __SXTB16(inB2), sum3);                     \
+    sum4 = __SMLAD(__SXTB16(__ROR(inA2, 8)), __SXTB16(__ROR(inB2, 8)), sum4)
+
+    while (rowCnt)
+    {
+        q31_t sum = pBias ? (q31_t)pBias[ch] << bias_shift : 0;
+        q31_t sum2 = pBias ? (q31_t)pBias[ch + 1] << bias_shift : 0;
+        q31_t sum3 = pBias ? (q31_t)pBias[ch + 2] << bias_shift : 0;
+        q31_t sum4 = pBias ? (q31_t)pBias[ch + 3] << bias_shift : 0;
+        q31_t inA1, inA2, inB1, inB2, opB;
+        const q7_t *pA1, *pB1;
+        union arm_nnword inA, inB;
+
+        DW_TAP_PAIR(0);
+        DW_TAP_PAIR(2);
+        DW_TAP_PAIR(4);
+        DW_TAP_PAIR(6);
+
+        pA1 = pA + 8 * ch_im_in;
+        pB1 = pB + 8 * ch_im_in;
+        inA.word = *__SIMD32(pA1);
+        inB.word = *__SIMD32(pB1);
+        sum += inA.bytes[0] * inB.bytes[0];
+        sum2 += inA.bytes[1] * inB.bytes[1];
+        sum3 += inA.bytes[2] * inB.bytes[2];
+        sum4 += inA.bytes[3] * inB.bytes[3];
+
+        *pOut++ = nn_requantize(sum, pShift ? pShift[ch] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum2, pShift ? pShift[ch + 1] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum3, pShift ? pShift[ch + 2] : out_shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum4, pShift ? pShift[ch + 3] : out_shift, act_min, act_max);
+
+        pA += 4;
+        pB += 4;
+        ch += 4;
+        rowCnt--;
+    }
+
+#undef DW_TAP_PAIR
+}
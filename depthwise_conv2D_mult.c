@@ -0,0 +1,410 @@
+#include "nn_depthwise.h"
+
+/*
+ * Weights of multipliers m, m + 1 of one input channel at two taps, as the
+ * bytes (tap1 m, tap1 m + 1, tap2 m, tap2 m + 1)
+ */
+static inline q31_t dw_mult_pair(const q7_t *pA1, const q7_t *pA2)
+{
+    return __PKHBT(*(const q15_t *)pA1, *(const q15_t *)pA2, 16);
+}
+
+/*
+ * Weights of one multiplier of 4 consecutive input channels, stride bytes apart
+ */
+static inline q31_t dw_mult_gather(const q7_t *pA, const uint16_t stride)
+{
+    if (stride == 1)
+    {
+        return *__SIMD32(pA);
+    }
+    return (uint8_t)pA[0] | ((uint32_t)(uint8_t)pA[stride] << 8) | ((uint32_t)(uint8_t)pA[2 * stride] << 16) |
+           ((uint32_t)(uint8_t)pA[3 * stride] << 24);
+}
+
+/**
+ * @brief One output pixel of depthwise_conv_mult over a window of num_rows x run taps
+ * @param[in]       pB          First tap of the input window, taps ch_im_in apart
+ * @param[in]       pA          First tap of the weights, taps ch_im_in * ch_mult apart
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       ch_mult     Channel multiplier
+ * @param[in]       num_rows    Window rows
+ * @param[in]       run         Taps per window row
+ * @param[in]       b_row_len   Row stride of pB
+ * @param[in]       a_row_len   Row stride of pA
+ * @param[in]       ep          Resolved epilogue, bias may be NULL
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   pOut        Output pixel, ch_im_in * ch_mult values
+ *
+ * @details
+ * Taps are paired along the window row as in depthwise_pixel. Each input
+ * operand (2 taps of one channel) feeds the __SMLAD of a pair of multipliers.
+ * A channel multiplier of 2 reads its weights as whole words, the last
+ * multiplier of an odd ch_mult runs 4 channels per loop as depthwise_pixel.
+ */
+static void depthwise_mult_pixel(const q7_t *pB,
+                                 const q7_t *pA,
+                                 const uint16_t ch_im_in,
+                                 const uint16_t ch_mult,
+                                 uint16_t num_rows,
+                                 uint16_t run,
+                                 const uint32_t b_row_len,
+                                 const uint32_t a_row_len,
+                                 const nn_epilogue *ep,
+                                 const uint16_t out_shift,
+                                 q7_t *pOut)
+{
+    uint32_t ch_im_out = ch_im_in * ch_mult;
+    uint16_t rowCnt;
+    uint16_t row_shift = 0;
+    uint16_t colCnt;
+    uint16_t i_row;
+    uint16_t c, m;
+    uint32_t o;
+    int k;
+
+    //Full rows are contiguous, treat the window as one run
+    if (run * ch_im_in == b_row_len && run * ch_im_out == a_row_len)
+    {
+        run *= num_rows;
+        num_rows = 1;
+    }
+
+    rowCnt = ch_im_in >> 2;
+    while (rowCnt)
+    {
+        //Multipliers m, m + 1 of the channels row_shift..row_shift + 3
+        for (m = 0; m + 2 <= ch_mult; m += 2)
+        {
+            q31_t sum[4][2];
+
+            for (k = 0; k < 4; k++)
+            {
+                o = (row_shift + k) * ch_mult + m;
+                sum[k][0] = ep->bias ? (q31_t)ep->bias[o] << ep->bias_shift : 0;
+                sum[k][1] = ep->bias ? (q31_t)ep->bias[o + 1] << ep->bias_shift : 0;
+            }
+
+            for (i_row = 0; i_row < num_rows; i_row++)
+            {
+                const q7_t *pB1 = pB + i_row * b_row_len + row_shift;
+                const q7_t *pA1 = pA + i_row * a_row_len + row_shift * ch_mult + m;
+
+                colCnt = run >> 1;
+                while (colCnt)
+                {
+                    q31_t inB1, inB2, opB[4], inA[4];
+
+                    inB1 = *__SIMD32(pB1);
+                    pB1 += ch_im_in;
+                    inB2 = *__SIMD32(pB1);
+                    pB1 += ch_im_in;
+                    opB[0] = __SXTB16(__PKHBT(inB1, inB2, 16));
+                    opB[1] = __SXTB16(__ROR(__PKHBT(inB1, inB2, 16), 8));
+                    opB[2] = __SXTB16(__PKHTB(inB2, inB1, 16));
+                    opB[3] = __SXTB16(__ROR(__PKHTB(inB2, inB1, 16), 8));
+
+                    if (ch_mult == 2)
+                    {
+                        const q7_t *pW1 = pA1;
+                        const q7_t *pW2 = pA1 + ch_im_out;
+                        q31_t inW1 = *__SIMD32(pW1)++;
+                        q31_t inW2 = *__SIMD32(pW2)++;
+                        inA[0] = __PKHBT(inW1, inW2, 16);
+                        inA[1] = __PKHTB(inW2, inW1, 16);
+                        inW1 = *__SIMD32(pW1);
+                        inW2 = *__SIMD32(pW2);
+                        inA[2] = __PKHBT(inW1, inW2, 16);
+                        inA[3] = __PKHTB(inW2, inW1, 16);
+                    }
+                    else
+                    {
+                        for (k = 0; k < 4; k++)
+                        {
+                            inA[k] = dw_mult_pair(pA1 + k * ch_mult, pA1 + ch_im_out + k * ch_mult);
+                        }
+                    }
+                    pA1 += 2 * ch_im_out;
+
+                    for (k = 0; k < 4; k++)
+                    {
+                        sum[k][0] = __SMLAD(__SXTB16(inA[k]), opB[k], sum[k][0]);
+                        sum[k][1] = __SMLAD(__SXTB16(__ROR(inA[k], 8)), opB[k], sum[k][1]);
+                    }
+                    colCnt--;
+                }
+
+                if (run & 0x1)
+                {
+                    for (k = 0; k < 4; k++)
+                    {
+                        sum[k][0] += pA1[k * ch_mult] * pB1[k];
+                        sum[k][1] += pA1[k * ch_mult + 1] * pB1[k];
+                    }
+                }
+            }
+
+            for (k = 0; k < 4; k++)
+            {
+                o = (row_shift + k) * ch_mult + m;
+                pOut[o] = nn_requantize(sum[k][0], ep->out_shift ? ep->out_shift[o] : out_shift, ep->act_min,
+                                        ep->act_max);
+                pOut[o + 1] = nn_requantize(sum[k][1], ep->out_shift ? ep->out_shift[o + 1] : out_shift,
+                                            ep->act_min, ep->act_max);
+            }
+        }
+
+        //Last multiplier of an odd ch_mult
+        if (ch_mult & 0x1)
+        {
+            q31_t sum[4];
+
+            m = ch_mult - 1;
+            for (k = 0; k < 4; k++)
+            {
+                o = (row_shift + k) * ch_mult + m;
+                sum[k] = ep->bias ? (q31_t)ep->bias[o] << ep->bias_shift : 0;
+            }
+
+            for (i_row = 0; i_row < num_rows; i_row++)
+            {
+                const q7_t *pB1 = pB + i_row * b_row_len + row_shift;
+                const q7_t *pA1 = pA + i_row * a_row_len + row_shift * ch_mult + m;
+
+                colCnt = run >> 1;
+                while (colCnt)
+                {
+                    q31_t inA1, inA2, inB1, inB2, opA, opB;
+
+                    inB1 = *__SIMD32(pB1);
+                    pB1 += ch_im_in;
+                    opB = *__SIMD32(pB1);
+                    pB1 += ch_im_in;
+                    inB2 = __PKHTB(opB, inB1, 16);
+                    inB1 = __PKHBT(inB1, opB, 16);
+                    inA1 = dw_mult_gather(pA1, ch_mult);
+                    pA1 += ch_im_out;
+                    opA = dw_mult_gather(pA1, ch_mult);
+                    pA1 += ch_im_out;
+                    inA2 = __PKHTB(opA, inA1, 16);
+                    inA1 = __PKHBT(inA1, opA, 16);
+                    sum[0] = __SMLAD(__SXTB16(inA1), __SXTB16(inB1), sum[0]);
+                    sum[1] = __SMLAD(__SXTB16(__ROR(inA1, 8)), __SXTB16(__ROR(inB1, 8)), sum[1]);
+                    sum[2] = __SMLAD(__SXTB16(inA2), __SXTB16(inB2), sum[2]);
+                    sum[3] = __SMLAD(__SXTB16(__ROR(inA2, 8)), __SXTB16(__ROR(inB2, 8)), sum[3]);
+                    colCnt--;
+                }
+
+                if (run & 0x1)
+                {
+                    for (k = 0; k < 4; k++)
+                    {
+                        sum[k] += pA1[k * ch_mult] * pB1[k];
+                    }
+                }
+            }
+
+            for (k = 0; k < 4; k++)
+            {
+                o = (row_shift + k) * ch_mult + m;
+                pOut[o] = nn_requantize(sum[k], ep->out_shift ? ep->out_shift[o] : out_shift, ep->act_min,
+                                        ep->act_max);
+            }
+        }
+
+        row_shift += 4;
+        rowCnt--;
+    }
+
+    //Channels left over, one output at a time
+    for (c = row_shift; c < ch_im_in; c++)
+    {
+        for (m = 0; m < ch_mult; m++)
+        {
+            q31_t sum;
+
+            o = c * ch_mult + m;
+            sum = ep->bias ? (q31_t)ep->bias[o] << ep->bias_shift : 0;
+            for (i_row = 0; i_row < num_rows; i_row++)
+            {
+                const q7_t *pB1 = pB + i_row * b_row_len + c;
+                const q7_t *pA1 = pA + i_row * a_row_len + o;
+
+                colCnt = run;
+                while (colCnt)
+                {
+                    sum += *pA1 * *pB1;
+                    pA1 += ch_im_out;
+                    pB1 += ch_im_in;
+                    colCnt--;
+                }
+            }
+            pOut[o] = nn_requantize(sum, ep->out_shift ? ep->out_shift[o] : out_shift, ep->act_min, ep->act_max);
+        }
+    }
+}
+
+/**
+ * @brief Fast depthwise convolution with channel multiplier, bias and dilation
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Pointer to kernel weights, dim_kernel x dim_kernel x (ch_im_in * ch_mult)
+ * @param[in]       ch_mult     Channel multiplier, output channel c * ch_mult + m comes from input channel c
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, (dim_kernel - 1) * dilation / 2
+ * @param[in]       dilation    Dilation rate, 1 for none
+ * @param[in]       bias        Pointer to bias (ch_im_in * ch_mult), NULL for none
+ * @param[in]       bias_shift  Amount of left-shift for bias
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A
+ *
+ * @details
+ * depthwise_conv generalised to the TensorFlow depthwise layer. For each
+ * output column only the dim_kernel dilated input columns are copied to
+ * bufferA, so a dilated kernel costs as much as an undilated one and no
+ * zero-filled kernel is needed. Border taps outside the image are skipped as
+ * in depthwise_conv. The input word of 4 channels is widened once per pair of
+ * taps and feeds 2 multipliers per __SMLAD pair.
+ *
+ * ch_mult 1 with dilation 1 runs the pixel kernels of depthwise_conv with the
+ * bias folded into the epilogue, so it gives the same output as depthwise_conv
+ * with that epilogue. In depthwise_conv_mult_ep the epilogue bias, when set,
+ * replaces bias.
+ *
+ * BufferA size:  dim_kernel * dim_im_in * ch_im_in
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. 2 * padding == (dim_kernel - 1) * dilation
+*/
+
+void depthwise_conv_mult(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t ch_mult,
+                         const uint16_t dim_kernel,
+                         const uint16_t padding,
+                         const uint16_t dilation,
+                         const q7_t *bias,
+                         const uint16_t bias_shift,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q7_t *bufferA)
+{
+    depthwise_conv_mult_ep(Im_in, dim_im_in, ch_im_in, wt, ch_mult, dim_kernel, padding, dilation, bias, bias_shift,
+                           out_shift, Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief depthwise_conv_mult with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as depthwise_conv_mult. A NULL epilogue gives the same output as
+ * depthwise_conv_mult.
+ */
+
+void depthwise_conv_mult_ep(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t ch_mult,
+                            const uint16_t dim_kernel,
+                            const uint16_t padding,
+                            const uint16_t dilation,
+                            const q7_t *bias,
+                            const uint16_t bias_shift,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q7_t *bufferA,
+                            const nn_epilogue *epilogue)
+{
+    int16_t i_out_y, i_out_x;
+    int16_t kx;
+    uint32_t ch_im_out = ch_im_in * ch_mult;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    uint32_t num_wt_in_row = dim_kernel * ch_im_out;
+    int plain = ch_mult == 1 && dilation == 1;
+    int full_3x3 = dw_full_3x3(dim_kernel, dim_kernel, ch_im_in);
+
+    //Resolve bias, shift and clamp once for all pixels
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("depthwise_conv_mult");
+    for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+    {
+        //Kernel columns inside the image
+        int16_t kx_start = (i_out_x < padding) ? (padding - i_out_x + dilation - 1) / dilation : 0;
+        int16_t kx_end = (dim_im_in - 1 - i_out_x + padding) / dilation + 1;
+        kx_end = kx_end < dim_kernel ? kx_end : dim_kernel;
+
+        //Move the kernel columns inside the image to bufferA, one bufferA row per input row
+        NN_PROFILE_COPY_START();
+        for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+        {
+            q7_t *pBuffer = bufferA + i_out_y * num_data_in_row;
+            const q7_t *data_source = Im_in + i_out_y * num_data_in_im_row + (i_out_x - padding) * ch_im_in;
+
+            if (dilation == 1)
+            {
+                memcpy(pBuffer + kx_start * ch_im_in, data_source + kx_start * ch_im_in,
+                       (kx_end - kx_start) * ch_im_in);
+                continue;
+            }
+            for (kx = kx_start; kx < kx_end; kx++)
+            {
+                memcpy(pBuffer + kx * ch_im_in, data_source + kx * dilation * ch_im_in, ch_im_in);
+            }
+        }
+        NN_PROFILE_COPY_STOP(dim_im_in * (kx_end - kx_start) * ch_im_in);
+
+        for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+        {
+            //Kernel rows inside the image
+            int16_t ky_start = (i_out_y < padding) ? (padding - i_out_y + dilation - 1) / dilation : 0;
+            int16_t ky_end = (dim_im_in - 1 - i_out_y + padding) / dilation + 1;
+            ky_end = ky_end < dim_kernel ? ky_end : dim_kernel;
+
+            const q7_t *pB = bufferA + (i_out_y - padding + ky_start * dilation) * num_data_in_row;
+            q7_t *pOut = Im_out + (i_out_y * dim_im_in + i_out_x) * ch_im_out;
+
+            //Plain depthwise layer plus bias, the pixel kernels of depthwise_conv
+            if (plain && full_3x3 && ky_end - ky_start == 3 && kx_end - kx_start == 3)
+            {
+                depthwise_pixel_3x3(pB, wt, ch_im_in, out_shift, &ep, pOut);
+            }
+            else if (plain)
+            {
+                depthwise_pixel(pB + kx_start * ch_im_in, wt + ky_start * num_wt_in_row + kx_start * ch_im_out,
+                                ch_im_in, ky_end - ky_start, kx_end - kx_start, num_data_in_row, out_shift, &ep, pOut);
+            }
+            else
+            {
+                depthwise_mult_pixel(pB + kx_start * ch_im_in, wt + ky_start * num_wt_in_row + kx_start * ch_im_out,
+                                     ch_im_in, ch_mult, ky_end - ky_start, kx_end - kx_start,
+                                     dilation * num_data_in_row, num_wt_in_row, &ep, out_shift, pOut);
+            }
+        }
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * dim_kernel * dim_kernel,
+                   dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of depthwise_conv_mult
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t depthwise_conv_mult_get_buffer_size(const uint16_t dim_im_in,
+                                             const uint16_t ch_im_in,
+                                             const uint16_t dim_kernel)
+{
+    return dim_kernel * dim_im_in * ch_im_in;
+}
@@ -0,0 +1,326 @@
+#include "nn_depthwise.h"
+
+/**
+ * @brief Fast depthwise convolution, non-square input/kernel, stride and asymmetric padding
+ * @param[in]       Im_in           Pointer to the input tensor
+ * @param[in]       dim_im_in_x     Input tensor width
+ * @param[in]       dim_im_in_y     Input tensor height
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       wt              Pointer to kernel weights
+ * @param[in]       dim_kernel_x    Kernel width
+ * @param[in]       dim_kernel_y    Kernel height
+ * @param[in]       pad_top         Padding rows above the input
+ * @param[in]       pad_bottom      Padding rows below the input
+ * @param[in]       pad_left        Padding columns left of the input
+ * @param[in]       pad_right       Padding columns right of the input
+ * @param[in]       stride_x        Stride along the width
+ * @param[in]       stride_y        Stride along the height
+ * @param[in]       out_shift       Amount of right-shift for output
+ * @param[in,out]   Im_out          Pointer to the output tensor
+ * @param[in,out]   bufferA         Pointer to buffer A
+ *
+ * @details
+ * Column-buffer depthwise_conv generalised to rectangular shapes. For each
+ * kept output column the dim_kernel_x input columns under the kernel are copied
+ * to bufferA once, and only the kept output rows are computed from it.
+ * Built with -DNN_FIXED_KERNELS, 3x3 kernels with ch_im_in multiple of 4 run
+ * through depthwise_pixel_3x3.
+ *
+ * Output size:   dim_im_out_x = (pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1
+ *                dim_im_out_y = (pad_top + dim_im_in_y + pad_bottom - dim_kernel_y) / stride_y + 1
+ *
+ * BufferA size:  dim_kernel_x * (pad_top + dim_im_in_y + pad_bottom) * ch_im_in
+ *
+ * Constrains:
+ * 1. pad_left + dim_im_in_x + pad_right >= dim_kernel_x, same for y
+*/
+
+void depthwise_conv_nonsquare(const q7_t *Im_in,
+                              const uint16_t dim_im_in_x,
+                              const uint16_t dim_im_in_y,
+                              const uint16_t ch_im_in,
+                              const q7_t *wt,
+                              const uint16_t dim_kernel_x,
+                              const uint16_t dim_kernel_y,
+                              const uint16_t pad_top,
+                              const uint16_t pad_bottom,
+                              const uint16_t pad_left,
+                              const uint16_t pad_right,
+                              const uint16_t stride_x,
+                              const uint16_t stride_y,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q7_t *bufferA)
+{
+    depthwise_conv_nonsquare_ep(Im_in, dim_im_in_x, dim_im_in_y, ch_im_in, wt, dim_kernel_x, dim_kernel_y, pad_top,
+                                pad_bottom, pad_left, pad_right, stride_x, stride_y, out_shift, Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief depthwise_conv_nonsquare with an output epilogue
+ * @param[in]       epilogue        Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as depthwise_conv_nonsquare. A NULL epilogue gives the same output as
+ * depthwise_conv_nonsquare.
+ */
+
+void depthwise_conv_nonsquare_ep(const q7_t *Im_in,
+                                 const uint16_t dim_im_in_x,
+                                 const uint16_t dim_im_in_y,
+                                 const uint16_t ch_im_in,
+                                 const q7_t *wt,
+                                 const uint16_t dim_kernel_x,
+                                 const uint16_t dim_kernel_y,
+                                 const uint16_t pad_top,
+                                 const uint16_t pad_bottom,
+                                 const uint16_t pad_left,
+                                 const uint16_t pad_right,
+                                 const uint16_t stride_x,
+                                 const uint16_t stride_y,
+                                 const uint16_t out_shift,
+                                 q7_t *Im_out,
+                                 q7_t *bufferA,
+                                 const nn_epilogue *epilogue)
+{
+    uint16_t dim_im_out_y = (pad_top + dim_im_in_y + pad_bottom - dim_kernel_y) / stride_y + 1;
+
+    NN_PROFILE_BEGIN("depthwise_conv_nonsquare");
+    depthwise_conv_nonsquare_rows(Im_in, dim_im_in_x, dim_im_in_y, ch_im_in, wt, dim_kernel_x, dim_kernel_y,
+                                  pad_top, pad_bottom, pad_left, pad_right, stride_x, stride_y, out_shift, Im_out,
+                                  bufferA, epilogue, 0, dim_im_out_y);
+    NN_PROFILE_END((uint64_t)dim_im_out_y * ((pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1)
+                   * ch_im_in * dim_kernel_x * dim_kernel_y,
+                   dim_im_out_y * ((pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1) * ch_im_in);
+}
+
+/**
+ * @brief depthwise_conv_nonsquare for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_out_y
+ *
+ * @details
+ * Other parameters as depthwise_conv_nonsquare_ep. The rows written are
+ * bit-identical to the same rows of depthwise_conv_nonsquare and no other
+ * output row is touched. Only the input rows the range reaches are copied to
+ * bufferA.
+ *
+ * BufferA size and Constrains: as depthwise_conv_nonsquare
+*/
+
+void depthwise_conv_nonsquare_rows(const q7_t *Im_in,
+                                   const uint16_t dim_im_in_x,
+                                   const uint16_t dim_im_in_y,
+                                   const uint16_t ch_im_in,
+                                   const q7_t *wt,
+                                   const uint16_t dim_kernel_x,
+                                   const uint16_t dim_kernel_y,
+                                   const uint16_t pad_top,
+                                   const uint16_t pad_bottom,
+                                   const uint16_t pad_left,
+                                   const uint16_t pad_right,
+                                   const uint16_t stride_x,
+                                   const uint16_t stride_y,
+                                   const uint16_t out_shift,
+                                   q7_t *Im_out,
+                                   q7_t *bufferA,
+                                   const nn_epilogue *epilogue,
+                                   const uint16_t start_row,
+                                   const uint16_t end_row)
+{
+    int32_t i_out_y, i_out_x, y;
+    q7_t *pBuffer;
+    q7_t *pOut;
+    const q7_t *data_source;
+    uint16_t rowCnt;
+    uint16_t row_shift;
+    uint16_t colCnt;
+    q7_t *pB;
+    q7_t *pA;
+
+    uint32_t num_data_in_row = dim_kernel_x * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in_x * ch_im_in;
+    uint16_t num_taps = dim_kernel_x * dim_kernel_y;
+    uint16_t dim_im_out_x = (pad_left + dim_im_in_x + pad_right - dim_kernel_x) / stride_x + 1;
+    uint16_t dim_im_out_y = (pad_top + dim_im_in_y + pad_bottom - dim_kernel_y) / stride_y + 1;
+    //Padded rows actually read by the kept output rows
+    int32_t num_rows = (dim_im_out_y - 1) * stride_y + dim_kernel_y;
+    int32_t row_end = (num_rows < pad_top + dim_im_in_y) ? num_rows : pad_top + dim_im_in_y;
+    //Padded rows the windows of the output rows reach, inside the image
+    int32_t row_lo = start_row * stride_y;
+    int32_t row_hi = (end_row - 1) * stride_y + dim_kernel_y;
+    row_lo = row_lo > pad_top ? row_lo : pad_top;
+    row_hi = row_hi < row_end ? row_hi : row_end;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+    const q7_t *pBias = ep.bias;
+    uint16_t bias_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    //The padded window is always full, 3x3 takes the unrolled pixel if built in
+    int full_3x3 = dw_full_3x3(dim_kernel_x, dim_kernel_y, ch_im_in);
+
+    NN_PROFILE_BEGIN("depthwise_conv_nonsquare_rows");
+
+    //set the top and bottom padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * pad_top);
+    if (num_rows > row_end)
+    {
+        memset((void *)(bufferA + num_data_in_row * row_end), 0, num_data_in_row * (num_rows - row_end));
+    }
+    NN_PROFILE_COPY_STOP(num_data_in_row * (pad_top + num_rows - row_end));
+
+    for (i_out_x = 0; i_out_x < dim_im_out_x; i_out_x++)
+    {
+        //Input columns under the kernel, clipped to the image
+        int32_t col_start = i_out_x * stride_x - pad_left;
+        int32_t left = col_start < 0 ? -col_start : 0;
+        int32_t right = (col_start + dim_kernel_x > dim_im_in_x) ? col_start + dim_kernel_x - dim_im_in_x : 0;
+        uint32_t data_to_transfer = (dim_kernel_x - left - right) * ch_im_in;
+
+        NN_PROFILE_COPY_START();
+        pBuffer = bufferA + num_data_in_row * row_lo;
+        if ((left || right) && row_hi > row_lo)
+        {
+            //set the left and right padding
+            memset((void *)pBuffer, 0, num_data_in_row * (row_hi - row_lo));
+        }
+        pBuffer += left * ch_im_in;
+        data_source = Im_in + (row_lo - pad_top) * num_data_in_im_row + (col_start + left) * ch_im_in;
+        for (y = row_lo; y < row_hi; y++)
+        {
+            memcpy(pBuffer, data_source, data_to_transfer);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+        NN_PROFILE_COPY_STOP(row_hi > row_lo ? num_data_in_row * (row_hi - row_lo) : 0);
+
+        for (i_out_y = start_row; i_out_y < end_row; i_out_y++)
+        {
+            if (full_3x3)
+            {
+                depthwise_pixel_3x3(bufferA + num_data_in_row * stride_y * i_out_y, wt, ch_im_in, out_shift,
+                                    epilogue, Im_out + (i_out_x + i_out_y * dim_im_out_x) * ch_im_in);
+                continue;
+            }
+
+            rowCnt = ch_im_in >> 2;
+            row_shift = 0;
+            pOut = Im_out + (i_out_x + i_out_y * dim_im_out_x) * ch_im_in;
+            while (rowCnt)
+            {
+                q31_t sum = pBias ? (q31_t)pBias[row_shift] << bias_shift : 0;
+                q31_t sum2 = pBias ? (q31_t)pBias[row_shift + 1] << bias_shift : 0;
+                q31_t sum3 = pBias ? (q31_t)pBias[row_shift + 2] << bias_shift : 0;
+                q31_t sum4 = pBias ? (q31_t)pBias[row_shift + 3] << bias_shift : 0;
+                uint16_t ch = row_shift;
+
+                colCnt = num_taps >> 1;
+                pB = bufferA + num_data_in_row * stride_y * i_out_y + row_shift;
+                pA = (q7_t *)wt + row_shift;
+
+                row_shift += 4;
+
+                while (colCnt)
+                {
+                    q31_t inA1, inA2, inB1, inB2, opA, opB;
+
+                    inB1 = *__SIMD32(pB);
+                    pB += ch_im_in;
+                    opB = *__SIMD32(pB);
+                    pB += ch_im_in;
+                    inB2 = __PKHTB(opB, inB1, 16);
+                    inB1 = __PKHBT(inB1, opB, 16);
+                    inA1 = *__SIMD32(pA);
+                    pA += ch_im_in;
+                    opB = *__SIMD32(pA);
+                    pA += ch_im_in;
+                    inA2 = __PKHTB(opB, inA1, 16);
+                    inA1 = __PKHBT(inA1, opB, 16);
+                    opA = __SXTB16(inA1);
+                    opB = __SXTB16(inB1);
+                    sum = __SMLAD(opA, opB, sum);
+                    opA = __SXTB16(__ROR(inA1, 8));
+                    opB = __SXTB16(__ROR(inB1, 8));
+                    sum2 = __SMLAD(opA, opB, sum2);
+                    opA = __SXTB16(inA2);
+                    opB = __SXTB16(inB2);
+                    sum3 = __SMLAD(opA, opB, sum3);
+                    opA = __SXTB16(__ROR(inA2, 8));
+                    opB = __SXTB16(__ROR(inB2, 8));
+                    sum4 = __SMLAD(opA, opB, sum4);
+                    colCnt--;
+                }
+
+                colCnt = num_taps & 0x1;
+                while (colCnt)
+                {
+                    union arm_nnword inA, inB;
+                    inA.word = *__SIMD32(pA);
+                    pA += ch_im_in;
+                    inB.word = *__SIMD32(pB);
+                    pB += ch_im_in;
+                    sum += inA.bytes[0] * inB.bytes[0];
+                    sum2 += inA.bytes[1] * inB.bytes[1];
+                    sum3 += inA.bytes[2] * inB.bytes[2];
+                    sum4 += inA.bytes[3] * inB.bytes[3];
+                    colCnt--;
+                }
+
+                *pOut++ = nn_requantize(sum, pShift ? pShift[ch] : out_shift, act_min, act_max);
+                *pOut++ = nn_requantize(sum2, pShift ? pShift[ch + 1] : out_shift, act_min, act_max);
+                *pOut++ = nn_requantize(sum3, pShift ? pShift[ch + 2] : out_shift, act_min, act_max);
+                *pOut++ = nn_requantize(sum4, pShift ? pShift[ch + 3] : out_shift, act_min, act_max);
+
+                rowCnt--;
+            }
+
+            rowCnt = ch_im_in & 0x3;
+            while (rowCnt)
+            {
+                pB = bufferA + num_data_in_row * stride_y * i_out_y + row_shift;
+                pA = (q7_t *)wt + row_shift;
+                q31_t sum = pBias ? (q31_t)pBias[row_shift] << bias_shift : 0;
+                uint16_t ch = row_shift;
+                colCnt = num_taps;
+
+                row_shift += 1;
+
+                while (colCnt)
+                {
+                    q7_t A1 = *pA;
+                    q7_t B1 = *pB;
+                    pA += ch_im_in;
+                    pB += ch_im_in;
+                    sum += A1 * B1;
+
+                    colCnt--;
+                }
+                *pOut++ = nn_requantize(sum, pShift ? pShift[ch] : out_shift, act_min, act_max);
+                rowCnt--;
+            }
+        }
+    }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_out_x * ch_im_in * num_taps,
+                   (end_row - start_row) * dim_im_out_x * ch_im_in);
+}
+
+/**
+ * @brief Scratch size of depthwise_conv_nonsquare
+ * @param[in]       dim_im_in_y     Input tensor height
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel_x    Kernel width
+ * @param[in]       pad_top         Padding rows above the input
+ * @param[in]       pad_bottom      Padding rows below the input
+ * @return          Bytes of bufferA
+ */
+
+uint32_t depthwise_conv_nonsquare_get_buffer_size(const uint16_t dim_im_in_y,
+                                                  const uint16_t ch_im_in,
+                                                  const uint16_t dim_kernel_x,
+                                                  const uint16_t pad_top,
+                                                  const uint16_t pad_bottom)
+{
+    return dim_kernel_x * (pad_top + dim_im_in_y + pad_bottom) * ch_im_in;
+}
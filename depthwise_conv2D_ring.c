@@ -0,0 +1,268 @@
+#include "nn_depthwise.h"
+
+/* Copy input column col into ring slot slot of bufferA, zeros for padding columns */
+static void ring_load_col_q7(const q7_t *Im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             const uint16_t dim_kernel,
+                             const uint16_t padding,
+                             const int32_t col,
+                             const uint16_t slot,
+                             q7_t *bufferA)
+{
+    int32_t y;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    q7_t *pBuffer = bufferA + num_data_in_row * padding + slot * ch_im_in;
+
+    NN_PROFILE_COPY_START();
+    if (col < 0 || col >= dim_im_in)
+    {
+        for (y = 0; y < dim_im_in; y++)
+        {
+            memset((void *)pBuffer, 0, ch_im_in);
+            pBuffer += num_data_in_row;
+        }
+    }
+    else
+    {
+        const q7_t *data_source = Im_in + col * ch_im_in;
+        for (y = 0; y < dim_im_in; y++)
+        {
+            memcpy(pBuffer, data_source, ch_im_in);
+            data_source += num_data_in_im_row;
+            pBuffer += num_data_in_row;
+        }
+    }
+    NN_PROFILE_COPY_STOP(dim_im_in * ch_im_in);
+}
+
+/**
+ * @brief Fast depthwise convolution with a sliding-window (ring) column buffer
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       wt          Pointer to kernel weights
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     'Same' padding only, please caluclate that
+ * @param[in]       out_shift   Amount of right-shift for output
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ * @param[in,out]   bufferA     Pointer to buffer A
+ *
+ * @details
+ * Same as depthwise_conv, but bufferA keeps the last dim_kernel input columns
+ * as a ring: each output column only copies the one newly exposed input column,
+ * and kernel column kx is read from slot ((x + kx) % dim_kernel). Copy traffic
+ * into bufferA drops to 1 / dim_kernel of depthwise_conv.
+ *
+ * Each window row is read as two runs of slots, so the wrap costs one extra
+ * loop per row pair and no index arithmetic per tap. bufferA is padded
+ * (depthwise_conv skips the padding taps), so border pixels multiply zeros,
+ * and every window row is split in two runs where depthwise_conv reads an
+ * interior window as one. On the host this measures about 0.85x of
+ * depthwise_conv on 3x3 layers: use it where the copy traffic or the bus to
+ * the input, not the multiplies, is the limit. make bench prints the time and
+ * the bytes copied per call of both kernels.
+ *
+ * BufferA size:  dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in
+ *
+ * Constrains:
+ * 1. Square input
+*/
+
+void depthwise_conv_ring(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t dim_kernel,
+                         const uint16_t padding,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q7_t *bufferA)
+{
+    depthwise_conv_ring_ep(Im_in, dim_im_in, ch_im_in, wt, dim_kernel, padding, out_shift, Im_out, bufferA, NULL);
+}
+
+/**
+ * @brief depthwise_conv_ring with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as depthwise_conv_ring. A NULL epilogue gives the same
+ * output as depthwise_conv_ring, and the same as depthwise_conv_ep otherwise.
+ */
+
+void depthwise_conv_ring_ep(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t dim_kernel,
+                            const uint16_t padding,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q7_t *bufferA,
+                            const nn_epilogue *epilogue)
+{
+    int16_t i_out_y, i_out_x;
+    uint16_t ky, kx;
+    uint16_t start_slot, new_slot;
+    uint16_t rowCnt;
+    uint16_t row_shift;
+    q7_t *pOut;
+
+    uint16_t num_data_in_row = dim_kernel * ch_im_in;
+
+    //Resolve bias, shift and clamp once for all pixels
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+
+    NN_PROFILE_BEGIN("depthwise_conv_ring");
+
+    //set the top and bottom padding
+    NN_PROFILE_COPY_START();
+    memset((void *)bufferA, 0, num_data_in_row * padding);
+    memset((void *)(bufferA + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding);
+    NN_PROFILE_COPY_STOP(num_data_in_row * padding * 2);
+
+    //Fill the first dim_kernel - 1 columns of the window
+    for (new_slot = 0; new_slot < dim_kernel - 1; new_slot++)
+    {
+        ring_load_col_q7(Im_in, dim_im_in, ch_im_in, dim_kernel, padding,
+                         (int32_t)new_slot - padding, new_slot, bufferA);
+    }
+
+    start_slot = 0;
+    for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+    {
+        //Only the newly exposed column is moved to bufferA
+        ring_load_col_q7(Im_in, dim_im_in, ch_im_in, dim_kernel, padding,
+                         i_out_x + dim_kernel - 1 - padding, new_slot, bufferA);
+
+        for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+        {
+            q7_t *pWindow = bufferA + num_data_in_row * i_out_y;
+            rowCnt = ch_im_in >> 2;
+            row_shift = 0;
+            pOut = Im_out + (i_out_x + i_out_y * dim_im_in) * ch_im_in;
+            while (rowCnt)
+            {
+                q31_t sum[4] = {0, 0, 0, 0};
+                q7_t *pB = pWindow + row_shift;
+                const q7_t *pA = wt + row_shift;
+
+                if (ep.bias)
+                {
+                    sum[0] = (q31_t)ep.bias[row_shift] << ep.bias_shift;
+                    sum[1] = (q31_t)ep.bias[row_shift + 1] << ep.bias_shift;
+                    sum[2] = (q31_t)ep.bias[row_shift + 2] << ep.bias_shift;
+                    sum[3] = (q31_t)ep.bias[row_shift + 3] << ep.bias_shift;
+                }
+
+                //Pair vertically adjacent taps, they share the slot. The slots of a window row run
+                //from start_slot to the end of the ring, then wrap to slot 0.
+                for (ky = 0; ky + 1 < dim_kernel; ky += 2)
+                {
+                    const q7_t *pS = pB + start_slot * ch_im_in;
+                    for (kx = start_slot; kx < dim_kernel; kx++)
+                    {
+                        dw_mac_tap_pair(pS, pS + num_data_in_row, pA, pA + num_data_in_row, sum);
+                        pS += ch_im_in;
+                        pA += ch_im_in;
+                    }
+                    pS = pB;
+                    for (kx = 0; kx < start_slot; kx++)
+                    {
+                        dw_mac_tap_pair(pS, pS + num_data_in_row, pA, pA + num_data_in_row, sum);
+                        pS += ch_im_in;
+                        pA += ch_im_in;
+                    }
+                    pB += 2 * num_data_in_row;
+                    pA += num_data_in_row;
+                }
+
+                //Odd row left, pair horizontally adjacent taps
+                if (ky < dim_kernel)
+                {
+                    const q7_t *pEnd = pB + num_data_in_row;
+                    const q7_t *pS = pB + start_slot * ch_im_in;
+                    for (kx = 0; kx + 1 < dim_kernel; kx += 2)
+                    {
+                        const q7_t *pS2 = (pS + ch_im_in == pEnd) ? pB : pS + ch_im_in;
+                        dw_mac_tap_pair(pS, pS2, pA, pA + ch_im_in, sum);
+                        pA += 2 * ch_im_in;
+                        pS = (pS2 + ch_im_in == pEnd) ? pB : pS2 + ch_im_in;
+                    }
+                    if (kx < dim_kernel)
+                    {
+                        union arm_nnword inA, inB;
+                        inA.word = *__SIMD32(pA);
+                        inB.word = *__SIMD32(pS);
+                        sum[0] += inA.bytes[0] * inB.bytes[0];
+                        sum[1] += inA.bytes[1] * inB.bytes[1];
+                        sum[2] += inA.bytes[2] * inB.bytes[2];
+                        sum[3] += inA.bytes[3] * inB.bytes[3];
+                    }
+                }
+
+                *pOut++ = nn_requantize(sum[0], ep.out_shift ? ep.out_shift[row_shift] : out_shift, ep.act_min,
+                                        ep.act_max);
+                *pOut++ = nn_requantize(sum[1], ep.out_shift ? ep.out_shift[row_shift + 1] : out_shift, ep.act_min,
+                                        ep.act_max);
+                *pOut++ = nn_requantize(sum[2], ep.out_shift ? ep.out_shift[row_shift + 2] : out_shift, ep.act_min,
+                                        ep.act_max);
+                *pOut++ = nn_requantize(sum[3], ep.out_shift ? ep.out_shift[row_shift + 3] : out_shift, ep.act_min,
+                                        ep.act_max);
+
+                row_shift += 4;
+                rowCnt--;
+            }
+
+            rowCnt = ch_im_in & 0x3;
+            while (rowCnt)
+            {
+                q7_t *pB = pWindow + row_shift;
+                const q7_t *pA = wt + row_shift;
+                q31_t sum = ep.bias ? (q31_t)ep.bias[row_shift] << ep.bias_shift : 0;
+
+                for (ky = 0; ky < dim_kernel; ky++)
+                {
+                    for (kx = start_slot; kx < dim_kernel; kx++)
+                    {
+                        sum += *pA * pB[kx * ch_im_in];
+                        pA += ch_im_in;
+                    }
+                    for (kx = 0; kx < start_slot; kx++)
+                    {
+                        sum += *pA * pB[kx * ch_im_in];
+                        pA += ch_im_in;
+                    }
+                    pB += num_data_in_row;
+                }
+                *pOut++ = nn_requantize(sum, ep.out_shift ? ep.out_shift[row_shift] : out_shift, ep.act_min,
+                                        ep.act_max);
+
+                row_shift += 1;
+                rowCnt--;
+            }
+        }
+
+        new_slot = start_slot;
+        start_slot = (start_slot + 1 == dim_kernel) ? 0 : start_slot + 1;
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * dim_kernel * dim_kernel,
+                   dim_im_in * dim_im_in * ch_im_in);
+}
+
+/**
+ * @brief Scratch size of depthwise_conv_ring
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dim_kernel      Kernel dimention
+ * @return          Bytes of bufferA
+ */
+
+uint32_t depthwise_conv_ring_get_buffer_size(const uint16_t dim_im_in,
+                                             const uint16_t ch_im_in,
+                                             const uint16_t dim_kernel)
+{
+    return dim_kernel * (dim_kernel - 1 + dim_im_in) * ch_im_in;
+}
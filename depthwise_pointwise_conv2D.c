@@ -0,0 +1,268 @@
+#include "nn_depthwise.h"
+
+/*
+ * Depthwise result of one output pixel, written to pBuffer as q15 in the
+ * order produced by arm_q7_to_q15_reordered_no_shift.
+ * Taps falling into the padding are skipped instead of multiplied by zero.
+ * The epilogue (may be NULL) is applied as in depthwise_conv.
+ */
+static void dw_pixel_q15_reordered(const q7_t *Im_in,
+                                   const uint16_t dim_im_in,
+                                   const uint16_t ch_im_in,
+                                   const q7_t *wt,
+                                   const uint16_t dim_kernel,
+                                   const uint16_t padding,
+                                   const uint16_t out_shift,
+                                   const nn_epilogue *epilogue,
+                                   const int32_t i_out_y,
+                                   const int32_t i_out_x,
+                                   q15_t *pBuffer)
+{
+    int32_t in_y = i_out_y - padding;
+    int32_t in_x = i_out_x - padding;
+    int32_t ky_start = in_y < 0 ? -in_y : 0;
+    int32_t ky_end = in_y + dim_kernel > dim_im_in ? dim_im_in - in_y : dim_kernel;
+    int32_t kx_start = in_x < 0 ? -in_x : 0;
+    int32_t kx_end = in_x + dim_kernel > dim_im_in ? dim_im_in - in_x : dim_kernel;
+    uint32_t im_row = dim_im_in * ch_im_in;
+    uint32_t wt_row = dim_kernel * ch_im_in;
+    uint16_t rowCnt = ch_im_in >> 2;
+    const q7_t *pIn = Im_in + ((in_y + ky_start) * dim_im_in + in_x + kx_start) * ch_im_in;
+    const q7_t *pWt = wt + (ky_start * dim_kernel + kx_start) * ch_im_in;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+    const q7_t *pBias = ep.bias;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    uint16_t i_ch = 0;
+
+    while (rowCnt)
+    {
+        q31_t sum[4] = {0, 0, 0, 0};
+        uint16_t i;
+        const q7_t *pRowB = pIn;
+        const q7_t *pRowA = pWt;
+        int32_t ky = ky_start;
+        int32_t kx;
+
+        //Pair vertically adjacent taps
+        for (; ky + 1 < ky_end; ky += 2)
+        {
+            const q7_t *pB = pRowB;
+            const q7_t *pA = pRowA;
+            for (kx = kx_start; kx < kx_end; kx++)
+            {
+                dw_mac_tap_pair(pB, pB + im_row, pA, pA + wt_row, sum);
+                pB += ch_im_in;
+                pA += ch_im_in;
+            }
+            pRowB += 2 * im_row;
+            pRowA += 2 * wt_row;
+        }
+
+        //Odd row left, pair horizontally adjacent taps
+        if (ky < ky_end)
+        {
+            const q7_t *pB = pRowB;
+            const q7_t *pA = pRowA;
+            for (kx = kx_start; kx + 1 < kx_end; kx += 2)
+            {
+                dw_mac_tap_pair(pB, pB + ch_im_in, pA, pA + ch_im_in, sum);
+                pB += 2 * ch_im_in;
+                pA += 2 * ch_im_in;
+            }
+            if (kx < kx_end)
+            {
+                union arm_nnword inA, inB;
+                inA.word = *__SIMD32(pA);
+                inB.word = *__SIMD32(pB);
+                sum[0] += inA.bytes[0] * inB.bytes[0];
+                sum[1] += inA.bytes[1] * inB.bytes[1];
+                sum[2] += inA.bytes[2] * inB.bytes[2];
+                sum[3] += inA.bytes[3] * inB.bytes[3];
+            }
+        }
+
+        //Reordered q15 layout: ch0 ch2 ch1 ch3
+        for (i = 0; i < 4; i++)
+        {
+            uint16_t c = (i == 1) ? 2 : (i == 2) ? 1 : i;
+            q31_t acc = sum[c];
+            if (pBias)
+            {
+                acc += (q31_t)pBias[i_ch + c] << ep.bias_shift;
+            }
+            *pBuffer++ = nn_requantize(acc, pShift ? pShift[i_ch + c] : out_shift, act_min, act_max);
+        }
+
+        i_ch += 4;
+        pIn += 4;
+        pWt += 4;
+        rowCnt--;
+    }
+}
+
+/**
+ * @brief Fused depthwise + pointwise convolution (one DS-CNN block)
+ * @param[in]       Im_in           Pointer to the input tensor
+ * @param[in]       dim_im_in       Input tensor dimention
+ * @param[in]       ch_im_in        Input tensor channel
+ * @param[in]       dw_wt           Pointer to depthwise kernel weights
+ * @param[in]       dim_kernel      Depthwise kernel dimention
+ * @param[in]       padding         'Same' padding only, please caluclate that
+ * @param[in]       dw_out_shift    Amount of right-shift for the depthwise output
+ * @param[in]       pw_wt           Pointer to pointwise kernel weights
+ * @param[in]       ch_im_out       Output tensor channel
+ * @param[in]       bias            Pointer to pointwise bias
+ * @param[in]       bias_shift      Amount of left-shift for bias
+ * @param[in]       out_shift       Amount of right-shift for output
+ * @param[in,out]   Im_out          Pointer to the output tensor
+ * @param[in,out]   bufferA         Pointer to buffer A
+ *
+ * @details
+ * Equivalent to depthwise_conv followed by pointwise_conv_fast, without the
+ * intermediate tensor. The depthwise result of two pixels is computed
+ * straight from Im_in into bufferA (q15, reordered) and consumed by the
+ * pointwise matrix multiplication, so the peak activation RAM is one feature
+ * map lower. depthwise_pointwise_conv_ep adds an epilogue to each stage.
+ *
+ * BufferA size:  2 * ch_im_in (in q15)
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. ch_im_in is multiple of 4
+ * 3. ch_im_out is even
+*/
+
+void depthwise_pointwise_conv(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const q7_t *dw_wt,
+                              const uint16_t dim_kernel,
+                              const uint16_t padding,
+                              const uint16_t dw_out_shift,
+                              const q7_t *pw_wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA)
+{
+    depthwise_pointwise_conv_ep(Im_in, dim_im_in, ch_im_in, dw_wt, dim_kernel, padding, dw_out_shift, pw_wt,
+                                ch_im_out, bias, bias_shift, out_shift, Im_out, bufferA, NULL, NULL);
+}
+
+/**
+ * @brief depthwise_pointwise_conv with an epilogue for each stage
+ * @param[in]       dw_epilogue     Depthwise epilogue (bias, shift, clamp of
+ *                                  the intermediate values, as depthwise_conv),
+ *                                  or NULL
+ * @param[in]       pw_epilogue     Pointwise output epilogue, as
+ *                                  pointwise_conv_fast, or NULL
+ *
+ * @details
+ * Other parameters, bufferA size and Constrains: as depthwise_pointwise_conv.
+ * The output is that of depthwise_conv with dw_epilogue followed by
+ * pointwise_conv_fast with pw_epilogue, e.g. the batch-norm bias and ReLU of
+ * both layers of a DS-CNN block.
+*/
+
+void depthwise_pointwise_conv_ep(const q7_t *Im_in,
+                                 const uint16_t dim_im_in,
+                                 const uint16_t ch_im_in,
+                                 const q7_t *dw_wt,
+                                 const uint16_t dim_kernel,
+                                 const uint16_t padding,
+                                 const uint16_t dw_out_shift,
+                                 const q7_t *pw_wt,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *bias,
+                                 const uint16_t bias_shift,
+                                 const uint16_t out_shift,
+                                 q7_t *Im_out,
+                                 q15_t *bufferA,
+                                 const nn_epilogue *dw_epilogue,
+                                 const nn_epilogue *pw_epilogue)
+{
+    int16_t i_out_y, i_out_x;
+    int16_t i_ch_out;
+
+    q15_t *pBuffer = bufferA;
+    q7_t *pOut = Im_out;
+    nn_epilogue pw_ep = nn_epilogue_resolve(pw_epilogue, bias, bias_shift);
+    const q7_t *pBias = pw_ep.bias;
+    uint16_t b_shift = pw_ep.bias_shift;
+    q7_t act_min = pw_ep.act_min;
+    q7_t act_max = pw_ep.act_max;
+
+    NN_PROFILE_BEGIN("depthwise_pointwise_conv");
+    for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+    {
+        for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+        {
+            dw_pixel_q15_reordered(Im_in, dim_im_in, ch_im_in, dw_wt, dim_kernel, padding, dw_out_shift,
+                                   dw_epilogue, i_out_y, i_out_x, pBuffer);
+            pBuffer += ch_im_in;
+
+            if (pBuffer == bufferA + 2 * ch_im_in)
+            {
+                if (pw_epilogue)
+                {
+                    pOut = nn_mat_mult_kernel_q7_q15_reordered_epilogue(pw_wt, bufferA, ch_im_out, ch_im_in,
+                                                                        bias_shift, out_shift, bias, pw_epilogue, pOut);
+                }
+                else
+                {
+                    pOut = arm_nn_mat_mult_kernel_q7_q15_reordered(pw_wt, bufferA, ch_im_out, ch_im_in, bias_shift,
+                                                                   out_shift, bias, pOut);
+                }
+                /* counter reset */
+                pBuffer = bufferA;
+            }
+        }
+    }
+
+    /* check if there is left-over for compute */
+    if (pBuffer != bufferA)
+    {
+        const q7_t *pA = pw_wt;
+        for (i_ch_out = 0; i_ch_out < ch_im_out; i_ch_out++)
+        {
+            uint16_t shift = pw_ep.out_shift ? pw_ep.out_shift[i_ch_out] : out_shift;
+            q31_t sum = ((q31_t)pBias[i_ch_out] << b_shift) + NN_ROUND(shift);
+            q15_t *pB = bufferA;
+            uint16_t colCnt = ch_im_in >> 2;
+
+            while (colCnt)
+            {
+                q31_t inA1, inA2;
+                q31_t inB1, inB2;
+
+                pA = (const q7_t *)read_and_pad_reordered((void *)pA, &inA1, &inA2);
+
+                inB1 = *__SIMD32(pB)++;
+                sum = __SMLAD(inA1, inB1, sum);
+                inB2 = *__SIMD32(pB)++;
+                sum = __SMLAD(inA2, inB2, sum);
+
+                colCnt--;
+            }
+            *pOut = nn_requantize(sum, shift, act_min, act_max);
+            pOut++;
+        }
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * (dim_kernel * dim_kernel + ch_im_out),
+                   dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of depthwise_pointwise_conv
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t depthwise_pointwise_conv_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 2 * ch_im_in * 2; // *2 for q15
+}
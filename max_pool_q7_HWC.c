@@ -0,0 +1,141 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Fast Q7 max pooling
+ * @param[in]       Im_in       Pointer to the input tensor
+ * @param[in]       dim_im_in   Input tensor dimention
+ * @param[in]       ch_im_in    Input tensor channel
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       padding     Padding
+ * @param[in]       stride      Stride
+ * @param[in]       dim_im_out  Output tensor dimention
+ * @param[in,out]   Im_out      Pointer to the output tensor
+ *
+ * @details
+ * Same output as arm_maxpool_q7_HWC. Four channels are compared per word with
+ * __SSUB8 and picked with __SEL, straight from the input, so no buffer is
+ * needed. Padding taps are skipped. One __SSUB8/__SEL chain per 4 channels
+ * walks the window row by row, stepping the pointer instead of recomputing it.
+ *
+ * Im_out may be Im_in when padding is 0.
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. padding < dim_kernel
+*/
+
+void max_pool_q7_HWC(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const uint16_t stride,
+                     const uint16_t dim_im_out,
+                     q7_t *Im_out)
+{
+    NN_PROFILE_BEGIN("max_pool_q7_HWC");
+    max_pool_q7_HWC_rows(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, stride, dim_im_out, Im_out, 0, dim_im_out);
+    NN_PROFILE_END((uint64_t)dim_im_out * dim_im_out * ch_im_in * dim_kernel * dim_kernel,
+                   dim_im_out * dim_im_out * ch_im_in);
+}
+
+/**
+ * @brief max_pool_q7_HWC for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_out
+ *
+ * @details
+ * Other parameters as max_pool_q7_HWC. The rows written are bit-identical to
+ * the same rows of max_pool_q7_HWC and no other output row is touched.
+ *
+ * Constrains: as max_pool_q7_HWC, and Im_out is not Im_in when ranges run
+ * concurrently
+*/
+
+void max_pool_q7_HWC_rows(const q7_t *Im_in,
+                          const uint16_t dim_im_in,
+                          const uint16_t ch_im_in,
+                          const uint16_t dim_kernel,
+                          const uint16_t padding,
+                          const uint16_t stride,
+                          const uint16_t dim_im_out,
+                          q7_t *Im_out,
+                          const uint16_t start_row,
+                          const uint16_t end_row)
+{
+    int32_t i_out_y, i_out_x;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+
+    NN_PROFILE_BEGIN("max_pool_q7_HWC_rows");
+    for (i_out_y = start_row; i_out_y < end_row; i_out_y++)
+    {
+        int32_t y_start = i_out_y * stride - padding;
+        int32_t y_end = y_start + dim_kernel;
+        y_start = y_start < 0 ? 0 : y_start;
+        y_end = y_end > dim_im_in ? dim_im_in : y_end;
+
+        for (i_out_x = 0; i_out_x < dim_im_out; i_out_x++)
+        {
+            int32_t x_start = i_out_x * stride - padding;
+            int32_t x_end = x_start + dim_kernel;
+            x_start = x_start < 0 ? 0 : x_start;
+            x_end = x_end > dim_im_in ? dim_im_in : x_end;
+
+            const q7_t *pIn = Im_in + (y_start * dim_im_in + x_start) * ch_im_in;
+            q7_t *pOut = Im_out + (i_out_y * dim_im_out + i_out_x) * ch_im_in;
+            uint16_t row_shift = 0;
+            uint16_t rowCnt = ch_im_in >> 2;
+            int32_t y, x;
+            // From the tap after a window row to the first tap of the next row
+            uint32_t row_step = num_data_in_im_row - (x_end - x_start) * ch_im_in;
+
+            while (rowCnt)
+            {
+                const q7_t *pB = pIn + row_shift;
+                q31_t max = *__SIMD32(pB);
+
+                // One __SSUB8/__SEL chain walks the window row by row
+                for (y = y_start; y < y_end; y++)
+                {
+                    for (x = x_start; x < x_end; x++)
+                    {
+                        q31_t inB = *__SIMD32(pB);
+                        pB += ch_im_in;
+                        // GE set per byte where inB >= max
+                        __SSUB8(inB, max);
+                        max = __SEL(inB, max);
+                    }
+                    pB += row_step;
+                }
+                *__SIMD32(pOut) = max;
+                pOut += 4;
+
+                row_shift += 4;
+                rowCnt--;
+            }
+
+            rowCnt = ch_im_in & 0x3;
+            while (rowCnt)
+            {
+                const q7_t *pB = pIn + row_shift;
+                q7_t max = *pB;
+
+                for (y = y_start; y < y_end; y++)
+                {
+                    for (x = x_start; x < x_end; x++)
+                    {
+                        max = *pB > max ? *pB : max;
+                        pB += ch_im_in;
+                    }
+                    pB += row_step;
+                }
+                *pOut++ = max;
+
+                row_shift += 1;
+                rowCnt--;
+            }
+        }
+    }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_out * ch_im_in * dim_kernel * dim_kernel,
+                   (end_row - start_row) * dim_im_out * ch_im_in);
+}
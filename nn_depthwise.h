@@ -0,0 +1,63 @@
+#ifndef NN_DEPTHWISE_H
+#define NN_DEPTHWISE_H
+
+#include "nn_functions.h"
+
+/*
+ * Inline helpers shared by the depthwise kernels, not part of the API.
+ */
+
+/**
+ * @brief Multiply-accumulate two kernel taps of 4 channels, same pairing as depthwise_conv
+ * @param[in]       pB          Input values of the first tap, channels c .. c + 3
+ * @param[in]       pB2         Input values of the second tap
+ * @param[in]       pA          Weights of the first tap
+ * @param[in]       pA2         Weights of the second tap
+ * @param[in,out]   sum         Accumulators of channels c .. c + 3
+ */
+NN_FORCEINLINE void dw_mac_tap_pair(const q7_t *pB, const q7_t *pB2,
+                                    const q7_t *pA, const q7_t *pA2,
+                                    q31_t *sum)
+{
+    q31_t inA1, inA2, inB1, inB2, opA, opB;
+
+    inB1 = *__SIMD32(pB);
+    opB = *__SIMD32(pB2);
+    inB2 = __PKHTB(opB, inB1, 16);
+    inB1 = __PKHBT(inB1, opB, 16);
+    inA1 = *__SIMD32(pA);
+    opA = *__SIMD32(pA2);
+    inA2 = __PKHTB(opA, inA1, 16);
+    inA1 = __PKHBT(inA1, opA, 16);
+    opA = __SXTB16(inA1);
+    opB = __SXTB16(inB1);
+    sum[0] = __SMLAD(opA, opB, sum[0]);
+    opA = __SXTB16(__ROR(inA1, 8));
+    opB = __SXTB16(__ROR(inB1, 8));
+    sum[1] = __SMLAD(opA, opB, sum[1]);
+    opA = __SXTB16(inA2);
+    opB = __SXTB16(inB2);
+    sum[2] = __SMLAD(opA, opB, sum[2]);
+    opA = __SXTB16(__ROR(inA2, 8));
+    opB = __SXTB16(__ROR(inB2, 8));
+    sum[3] = __SMLAD(opA, opB, sum[3]);
+}
+
+/*
+ * Whether a full window takes depthwise_pixel_3x3: 3x3 kernels with ch_im_in
+ * multiple of 4, and only when built with -DNN_FIXED_KERNELS. The unrolled
+ * pixel measured slower than the generic loop on the host, so it is opt-in.
+ */
+NN_FORCEINLINE int dw_full_3x3(const uint16_t dim_kernel_x, const uint16_t dim_kernel_y, const uint16_t ch_im_in)
+{
+#ifdef NN_FIXED_KERNELS
+    return dim_kernel_x == 3 && dim_kernel_y == 3 && (ch_im_in & 0x3) == 0;
+#else
+    (void)dim_kernel_x;
+    (void)dim_kernel_y;
+    (void)ch_im_in;
+    return 0;
+#endif
+}
+
+#endif
@@ -1,6 +1,233 @@
+#ifndef NN_FUNCTIONS_H
+#define NN_FUNCTIONS_H
+
+#ifdef NN_PORTABLE
+#include "nn_portable.h"
+#else
 #include "arm_math.h"
 #include "arm_nnfunctions.h"
 #include "arm_nnsupportfunctions.h"
+#endif
+#include "nn_profile.h"
+
+/**
+ * @brief Output epilogue, applied in registers before each output is stored
+ *
+ * @details
+ * bias:        per output channel bias (left-shifted by bias_shift), NULL to
+ *              keep the layer bias (conv_HWC, pointwise_conv_*) or no bias
+ *              (depthwise_conv).
+ * out_shift:   per output channel right-shift, NULL to use the layer out_shift.
+ * act_min/max: clamp after saturation. ReLU is {0, 127}, ReLU6 is
+ *              {0, 6 << frac_bits} of the output format.
+ *
+ * Passing a NULL epilogue to a kernel keeps the plain __SSAT(sum >> out_shift, 8).
+ */
+typedef struct
+{
+    const q7_t *bias;
+    uint16_t bias_shift;
+    const uint8_t *out_shift;
+    q7_t act_min;
+    q7_t act_max;
+} nn_epilogue;
+
+#ifndef NN_FORCEINLINE
+#define NN_FORCEINLINE static inline __attribute__((always_inline))
+#endif
+
+static inline q7_t nn_requantize(q31_t sum, const uint16_t out_shift, const q7_t act_min, const q7_t act_max)
+{
+    sum = __SSAT((sum >> out_shift), 8);
+    sum = sum < act_min ? act_min : sum;
+    return (q7_t)(sum > act_max ? act_max : sum);
+}
+
+// Epilogue with the layer bias filled in when it has none, and the full range when NULL
+static inline nn_epilogue nn_epilogue_resolve(const nn_epilogue *epilogue, const q7_t *bias, const uint16_t bias_shift)
+{
+    nn_epilogue ep;
+    ep.bias = (epilogue && epilogue->bias) ? epilogue->bias : bias;
+    ep.bias_shift = (epilogue && epilogue->bias) ? epilogue->bias_shift : bias_shift;
+    ep.out_shift = epilogue ? epilogue->out_shift : NULL;
+    ep.act_min = epilogue ? epilogue->act_min : -128;
+    ep.act_max = epilogue ? epilogue->act_max : 127;
+    return ep;
+}
+
+/**
+ * @brief Block-sparse q7 weights, packed offline by pack_sparse_weights
+ *
+ * @details
+ * Each output channel row (ch_im_in, or dim_kernel * dim_kernel * ch_im_in
+ * weights) is cut into blocks of 4 consecutive weights, and only blocks with a
+ * non-zero weight are stored (CSR by output channel):
+ *
+ * row_ptr:     ch_im_out + 1 entries, the blocks of output channel o are
+ *              row_ptr[o] .. row_ptr[o + 1] - 1.
+ * col_idx:     block index in the row, i.e. first weight / 4, per block.
+ * values:      4 weights per block in row order, word aligned.
+ */
+typedef struct
+{
+    const uint32_t *row_ptr;
+    const uint16_t *col_idx;
+    const q7_t *values;
+} nn_sparse_weights;
+
+/**
+ * @brief Packed int4 weights, packed offline by pack_pointwise_int4_weights or
+ *        pack_conv_int4_weights
+ *
+ * @details
+ * values:      two signed 4-bit weights per byte, half a byte per weight of
+ *              the q7 layout. Output channels go in pairs: every word holds 4
+ *              consecutive weights of output channel 2j in the low nibbles
+ *              and the same 4 of channel 2j + 1 in the high nibbles
+ *              (read_and_pad_int4), and the words of a pair follow its row.
+ * shift:       per output channel left-shift (0 to 4) back to the q7 weight,
+ *              w_q7 = w_int4 << shift, NULL to use layer_shift.
+ * layer_shift: shift of every output channel when shift is NULL.
+ */
+typedef struct
+{
+    const q7_t *values;
+    const uint8_t *shift;
+    uint16_t layer_shift;
+} nn_int4_weights;
+
+/**
+ * @brief Read 4 int4 weights of two output channels as 4 __SMLAD operands, every weight times 16
+ * @param[in]       source      Packed weight word
+ * @param[out]      out1        First channel, low nibbles of byte 0 and 2
+ * @param[out]      out2        First channel, low nibbles of byte 1 and 3
+ * @param[out]      out3        Second channel, high nibbles of byte 0 and 2
+ * @param[out]      out4        Second channel, high nibbles of byte 1 and 3
+ * @return          source + 4 bytes
+ *
+ * @details
+ * Masking with 0xF0F0F0F0 (after a 4 bit left shift for the low nibbles) puts
+ * every nibble at the top of its byte, so the bytes are the signed weights
+ * times 16 and __SXTB16 sign-extends them with no separate nibble extension.
+ * Sums of these operands are exact multiples of 16, shifted right by
+ * 4 - shift at the end.
+ */
+static inline void *read_and_pad_int4(void *source, q31_t *out1, q31_t *out2, q31_t *out3, q31_t *out4)
+{
+    uint32_t inA = (uint32_t)*__SIMD32(source)++;
+    uint32_t lo = (inA << 4) & 0xF0F0F0F0;
+    uint32_t hi = inA & 0xF0F0F0F0;
+
+    *out1 = __SXTB16(lo);
+    *out2 = __SXTB16(__ROR(lo, 8));
+    *out3 = __SXTB16(hi);
+    *out4 = __SXTB16(__ROR(hi, 8));
+
+    return source;
+}
+
+q7_t *nn_mat_mult_kernel_q7_q15_epilogue(const q7_t *pA,
+                                         const q15_t *pInBuffer,
+                                         const uint16_t ch_im_out,
+                                         const uint16_t numCol_A,
+                                         const uint16_t bias_shift,
+                                         const uint16_t out_shift,
+                                         const q7_t *bias,
+                                         const nn_epilogue *epilogue,
+                                         q7_t *pOut);
+
+q7_t *nn_mat_mult_kernel_q7_q15_reordered_epilogue(const q7_t *pA,
+                                                   const q15_t *pInBuffer,
+                                                   const uint16_t ch_im_out,
+                                                   const uint16_t numCol_A,
+                                                   const uint16_t bias_shift,
+                                                   const uint16_t out_shift,
+                                                   const q7_t *bias,
+                                                   const nn_epilogue *epilogue,
+                                                   q7_t *pOut);
+
+typedef q7_t *(*nn_mat_mult_fixed_fn)(const q7_t *pA,
+                                      const q15_t *pInBuffer,
+                                      const uint16_t ch_im_out,
+                                      const uint16_t bias_shift,
+                                      const uint16_t out_shift,
+                                      const q7_t *bias,
+                                      const nn_epilogue *epilogue,
+                                      q7_t *pOut);
+
+nn_mat_mult_fixed_fn nn_mat_mult_kernel_q7_q15_reordered_fixed(const uint16_t numCol_A);
+
+void depthwise_pixel(const q7_t *pB,
+                     const q7_t *pA,
+                     const uint16_t ch_im_in,
+                     uint16_t num_rows,
+                     uint16_t run,
+                     const uint16_t row_len,
+                     const uint16_t out_shift,
+                     const nn_epilogue *epilogue,
+                     q7_t *pOut);
+
+void conv_HWC_column(const q15_t *bufferA,
+                     const uint32_t row_len,
+                     const uint32_t win_head,
+                     const q15_t *wt,
+                     const uint32_t wt_pair,
+                     const uint16_t wt_step,
+                     const int32_t para_per_ch_out,
+                     const uint16_t ch_im_out,
+                     const nn_epilogue *ep,
+                     const uint16_t out_shift,
+                     q7_t *pOut,
+                     const uint32_t out_row,
+                     const uint16_t start_row,
+                     const uint16_t end_row);
+
+void conv_HWC_load_col(const q7_t *Im_in,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       q15_t *bufferA,
+                       const int32_t x,
+                       const int32_t row_lo,
+                       const int32_t row_hi);
+
+void conv_HWC_q7_block_2x2(const q7_t *pData,
+                           const uint32_t row_len,
+                           const q7_t *wt,
+                           const int32_t para_per_ch_out,
+                           const uint16_t ch_im_out,
+                           const nn_epilogue *ep,
+                           const uint16_t out_shift,
+                           q7_t *pOut,
+                           const uint32_t out_row);
+
+void conv_HWC_q7_block_1x2(const q7_t *pData,
+                           const q7_t *wt,
+                           const int32_t para_per_ch_out,
+                           const uint16_t ch_im_out,
+                           const nn_epilogue *ep,
+                           const uint16_t out_shift,
+                           q7_t *pOut);
+
+void pointwise_conv_4x2_pixels(const q7_t *Im_in,
+                               const uint32_t num_pixels,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t ch_im_out,
+                               const q7_t *bias,
+                               const uint16_t bias_shift,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q15_t *bufferA,
+                               const nn_epilogue *epilogue);
+
+void depthwise_pixel_3x3(const q7_t *pB,
+                         const q7_t *pA,
+                         const uint16_t ch_im_in,
+                         const uint16_t out_shift,
+                         const nn_epilogue *epilogue,
+                         q7_t *pOut);
 
 void pointwise_conv_basic(const q7_t *Im_in,
                           const uint16_t dim_im_in,
@@ -13,6 +240,18 @@ void pointwise_conv_basic(const q7_t *Im_in,
                           q7_t *Im_out,
                           q15_t *bufferA);
 
+void pointwise_conv_basic_ep(const q7_t *Im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             const q7_t *wt,
+                             const uint16_t ch_im_out,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             const nn_epilogue *epilogue);
+
 void pointwise_conv_fast(const q7_t *Im_in,
                          const uint16_t dim_im_in,
                          const uint16_t ch_im_in,
@@ -24,6 +263,18 @@ void pointwise_conv_fast(const q7_t *Im_in,
                          q7_t *Im_out,
                          q15_t *bufferA);
 
+void pointwise_conv_fast_ep(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t ch_im_out,
+                            const q7_t *bias,
+                            const uint16_t bias_shift,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q15_t *bufferA,
+                            const nn_epilogue *epilogue);
+
 
 void conv_HWC(const q7_t *Im_in,
               const uint16_t dim_im_in,
@@ -39,6 +290,147 @@ void conv_HWC(const q7_t *Im_in,
               q15_t *bufferA,
               q15_t *bufferB);
 
+void conv_HWC_ep(const q7_t *Im_in,
+                 const uint16_t dim_im_in,
+                 const uint16_t ch_im_in,
+                 const q7_t *wt,
+                 const uint16_t ch_im_out,
+                 const uint16_t dim_kernel,
+                 const uint16_t padding,
+                 const q7_t *bias,
+                 const uint16_t bias_shift,
+                 const uint16_t out_shift,
+                 q7_t *Im_out,
+                 q15_t *bufferA,
+                 q15_t *bufferB,
+                 const nn_epilogue *epilogue);
+
+void conv_HWC_batch(const q7_t *Im_in,
+                    const uint16_t batch,
+                    const uint16_t dim_im_in,
+                    const uint16_t ch_im_in,
+                    const q7_t *wt,
+                    const uint16_t ch_im_out,
+                    const uint16_t dim_kernel,
+                    const uint16_t padding,
+                    const q7_t *bias,
+                    const uint16_t bias_shift,
+                    const uint16_t out_shift,
+                    q7_t *Im_out,
+                    q15_t *bufferA,
+                    q15_t *bufferB);
+
+void conv_HWC_batch_ep(const q7_t *Im_in,
+                       const uint16_t batch,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const q7_t *wt,
+                       const uint16_t ch_im_out,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       const q7_t *bias,
+                       const uint16_t bias_shift,
+                       const uint16_t out_shift,
+                       q7_t *Im_out,
+                       q15_t *bufferA,
+                       q15_t *bufferB,
+                       const nn_epilogue *epilogue);
+
+void pointwise_conv_fast_batch(const q7_t *Im_in,
+                               const uint16_t batch,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t ch_im_out,
+                               const q7_t *bias,
+                               const uint16_t bias_shift,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q15_t *bufferA);
+
+void pointwise_conv_fast_batch_ep(const q7_t *Im_in,
+                                  const uint16_t batch,
+                                  const uint16_t dim_im_in,
+                                  const uint16_t ch_im_in,
+                                  const q7_t *wt,
+                                  const uint16_t ch_im_out,
+                                  const q7_t *bias,
+                                  const uint16_t bias_shift,
+                                  const uint16_t out_shift,
+                                  q7_t *Im_out,
+                                  q15_t *bufferA,
+                                  const nn_epilogue *epilogue);
+
+void conv_HWC_q7(const q7_t *Im_in,
+                 const uint16_t dim_im_in,
+                 const uint16_t ch_im_in,
+                 const q7_t *wt,
+                 const uint16_t ch_im_out,
+                 const uint16_t dim_kernel,
+                 const uint16_t padding,
+                 const q7_t *bias,
+                 const uint16_t bias_shift,
+                 const uint16_t out_shift,
+                 q7_t *Im_out,
+                 q7_t *bufferA);
+
+void conv_HWC_q7_ep(const q7_t *Im_in,
+                    const uint16_t dim_im_in,
+                    const uint16_t ch_im_in,
+                    const q7_t *wt,
+                    const uint16_t ch_im_out,
+                    const uint16_t dim_kernel,
+                    const uint16_t padding,
+                    const q7_t *bias,
+                    const uint16_t bias_shift,
+                    const uint16_t out_shift,
+                    q7_t *Im_out,
+                    q7_t *bufferA,
+                    const nn_epilogue *epilogue);
+
+void conv_HWC_nonsquare(const q7_t *Im_in,
+                        const uint16_t dim_im_in_x,
+                        const uint16_t dim_im_in_y,
+                        const uint16_t ch_im_in,
+                        const q7_t *wt,
+                        const uint16_t ch_im_out,
+                        const uint16_t dim_kernel_x,
+                        const uint16_t dim_kernel_y,
+                        const uint16_t pad_top,
+                        const uint16_t pad_bottom,
+                        const uint16_t pad_left,
+                        const uint16_t pad_right,
+                        const uint16_t stride_x,
+                        const uint16_t stride_y,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA,
+                        q15_t *bufferB);
+
+void conv_HWC_nonsquare_ep(const q7_t *Im_in,
+                           const uint16_t dim_im_in_x,
+                           const uint16_t dim_im_in_y,
+                           const uint16_t ch_im_in,
+                           const q7_t *wt,
+                           const uint16_t ch_im_out,
+                           const uint16_t dim_kernel_x,
+                           const uint16_t dim_kernel_y,
+                           const uint16_t pad_top,
+                           const uint16_t pad_bottom,
+                           const uint16_t pad_left,
+                           const uint16_t pad_right,
+                           const uint16_t stride_x,
+                           const uint16_t stride_y,
+                           const q7_t *bias,
+                           const uint16_t bias_shift,
+                           const uint16_t out_shift,
+                           q7_t *Im_out,
+                           q15_t *bufferA,
+                           q15_t *bufferB,
+                           const nn_epilogue *epilogue);
+
 void depthwise_conv(const q7_t *Im_in,
                     const uint16_t dim_im_in,
                     const uint16_t ch_im_in,
@@ -49,9 +441,693 @@ void depthwise_conv(const q7_t *Im_in,
                     q7_t *Im_out,
                     q7_t *bufferA);
 
+void depthwise_conv_ep(const q7_t *Im_in,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const q7_t *wt,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       const uint16_t out_shift,
+                       q7_t *Im_out,
+                       q7_t *bufferA,
+                       const nn_epilogue *epilogue);
+
+void depthwise_conv_inplace(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t dim_kernel,
+                            const uint16_t padding,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q7_t *bufferA);
+
+void depthwise_conv_inplace_ep(const q7_t *Im_in,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t dim_kernel,
+                               const uint16_t padding,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q7_t *bufferA,
+                               const nn_epilogue *epilogue);
+
+void depthwise_conv_mult(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t ch_mult,
+                         const uint16_t dim_kernel,
+                         const uint16_t padding,
+                         const uint16_t dilation,
+                         const q7_t *bias,
+                         const uint16_t bias_shift,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q7_t *bufferA);
+
+void depthwise_conv_mult_ep(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t ch_mult,
+                            const uint16_t dim_kernel,
+                            const uint16_t padding,
+                            const uint16_t dilation,
+                            const q7_t *bias,
+                            const uint16_t bias_shift,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q7_t *bufferA,
+                            const nn_epilogue *epilogue);
+
+void depthwise_conv_nonsquare(const q7_t *Im_in,
+                              const uint16_t dim_im_in_x,
+                              const uint16_t dim_im_in_y,
+                              const uint16_t ch_im_in,
+                              const q7_t *wt,
+                              const uint16_t dim_kernel_x,
+                              const uint16_t dim_kernel_y,
+                              const uint16_t pad_top,
+                              const uint16_t pad_bottom,
+                              const uint16_t pad_left,
+                              const uint16_t pad_right,
+                              const uint16_t stride_x,
+                              const uint16_t stride_y,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q7_t *bufferA);
+
+void depthwise_conv_nonsquare_ep(const q7_t *Im_in,
+                                 const uint16_t dim_im_in_x,
+                                 const uint16_t dim_im_in_y,
+                                 const uint16_t ch_im_in,
+                                 const q7_t *wt,
+                                 const uint16_t dim_kernel_x,
+                                 const uint16_t dim_kernel_y,
+                                 const uint16_t pad_top,
+                                 const uint16_t pad_bottom,
+                                 const uint16_t pad_left,
+                                 const uint16_t pad_right,
+                                 const uint16_t stride_x,
+                                 const uint16_t stride_y,
+                                 const uint16_t out_shift,
+                                 q7_t *Im_out,
+                                 q7_t *bufferA,
+                                 const nn_epilogue *epilogue);
+
+void conv_HWC_ring(const q7_t *Im_in,
+                   const uint16_t dim_im_in,
+                   const uint16_t ch_im_in,
+                   const q7_t *wt,
+                   const uint16_t ch_im_out,
+                   const uint16_t dim_kernel,
+                   const uint16_t padding,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   q7_t *Im_out,
+                   q15_t *bufferA,
+                   q15_t *bufferB);
+
+void conv_HWC_ring_ep(const q7_t *Im_in,
+                      const uint16_t dim_im_in,
+                      const uint16_t ch_im_in,
+                      const q7_t *wt,
+                      const uint16_t ch_im_out,
+                      const uint16_t dim_kernel,
+                      const uint16_t padding,
+                      const q7_t *bias,
+                      const uint16_t bias_shift,
+                      const uint16_t out_shift,
+                      q7_t *Im_out,
+                      q15_t *bufferA,
+                      q15_t *bufferB,
+                      const nn_epilogue *epilogue);
+
+void depthwise_conv_ring(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t dim_kernel,
+                         const uint16_t padding,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q7_t *bufferA);
+
+void depthwise_conv_ring_ep(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t dim_kernel,
+                            const uint16_t padding,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q7_t *bufferA,
+                            const nn_epilogue *epilogue);
+
+uint16_t conv_HWC_get_tile_size(const uint16_t ch_im_in,
+                                const uint16_t ch_im_out,
+                                const uint16_t dim_kernel,
+                                const uint32_t bufferB_bytes);
+
+void conv_HWC_tiled(const q7_t *Im_in,
+                    const uint16_t dim_im_in,
+                    const uint16_t ch_im_in,
+                    const q7_t *wt,
+                    const uint16_t ch_im_out,
+                    const uint16_t dim_kernel,
+                    const uint16_t padding,
+                    const q7_t *bias,
+                    const uint16_t bias_shift,
+                    const uint16_t out_shift,
+                    q7_t *Im_out,
+                    q15_t *bufferA,
+                    q15_t *bufferB,
+                    const uint16_t ch_tile);
+
+void conv_HWC_tiled_ep(const q7_t *Im_in,
+                       const uint16_t dim_im_in,
+                       const uint16_t ch_im_in,
+                       const q7_t *wt,
+                       const uint16_t ch_im_out,
+                       const uint16_t dim_kernel,
+                       const uint16_t padding,
+                       const q7_t *bias,
+                       const uint16_t bias_shift,
+                       const uint16_t out_shift,
+                       q7_t *Im_out,
+                       q15_t *bufferA,
+                       q15_t *bufferB,
+                       const uint16_t ch_tile,
+                       const nn_epilogue *epilogue);
+
+void conv_HWC_packed(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const q15_t *wt_packed,
+                     const uint16_t ch_im_out,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const q7_t *bias,
+                     const uint16_t bias_shift,
+                     const uint16_t out_shift,
+                     q7_t *Im_out,
+                     q15_t *bufferA);
+
+void conv_HWC_packed_ep(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const q15_t *wt_packed,
+                        const uint16_t ch_im_out,
+                        const uint16_t dim_kernel,
+                        const uint16_t padding,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA,
+                        const nn_epilogue *epilogue);
+
+void pointwise_conv_fast_packed(const q7_t *Im_in,
+                                const uint16_t dim_im_in,
+                                const uint16_t ch_im_in,
+                                const q15_t *wt_packed,
+                                const uint16_t ch_im_out,
+                                const q7_t *bias,
+                                const uint16_t bias_shift,
+                                const uint16_t out_shift,
+                                q7_t *Im_out,
+                                q15_t *bufferA);
+
+void pointwise_conv_fast_packed_ep(const q7_t *Im_in,
+                                   const uint16_t dim_im_in,
+                                   const uint16_t ch_im_in,
+                                   const q15_t *wt_packed,
+                                   const uint16_t ch_im_out,
+                                   const q7_t *bias,
+                                   const uint16_t bias_shift,
+                                   const uint16_t out_shift,
+                                   q7_t *Im_out,
+                                   q15_t *bufferA,
+                                   const nn_epilogue *epilogue);
+
+void pointwise_conv_4x2(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const q7_t *wt,
+                        const uint16_t ch_im_out,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA);
+
+void pointwise_conv_4x2_ep(const q7_t *Im_in,
+                           const uint16_t dim_im_in,
+                           const uint16_t ch_im_in,
+                           const q7_t *wt,
+                           const uint16_t ch_im_out,
+                           const q7_t *bias,
+                           const uint16_t bias_shift,
+                           const uint16_t out_shift,
+                           q7_t *Im_out,
+                           q15_t *bufferA,
+                           const nn_epilogue *epilogue);
+
+void pointwise_conv_sparse(const q7_t *Im_in,
+                           const uint16_t dim_im_in,
+                           const uint16_t ch_im_in,
+                           const nn_sparse_weights *wt,
+                           const uint16_t ch_im_out,
+                           const q7_t *bias,
+                           const uint16_t bias_shift,
+                           const uint16_t out_shift,
+                           q7_t *Im_out,
+                           q15_t *bufferA);
+
+void pointwise_conv_sparse_ep(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const nn_sparse_weights *wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA,
+                              const nn_epilogue *epilogue);
+
+void conv_HWC_sparse(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const nn_sparse_weights *wt,
+                     const uint16_t ch_im_out,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const q7_t *bias,
+                     const uint16_t bias_shift,
+                     const uint16_t out_shift,
+                     q7_t *Im_out,
+                     q15_t *bufferA);
+
+void conv_HWC_sparse_ep(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const nn_sparse_weights *wt,
+                        const uint16_t ch_im_out,
+                        const uint16_t dim_kernel,
+                        const uint16_t padding,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA,
+                        const nn_epilogue *epilogue);
+
+void pointwise_conv_fast_int4(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const nn_int4_weights *wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA);
+
+void pointwise_conv_fast_int4_ep(const q7_t *Im_in,
+                                 const uint16_t dim_im_in,
+                                 const uint16_t ch_im_in,
+                                 const nn_int4_weights *wt,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *bias,
+                                 const uint16_t bias_shift,
+                                 const uint16_t out_shift,
+                                 q7_t *Im_out,
+                                 q15_t *bufferA,
+                                 const nn_epilogue *epilogue);
+
+void conv_HWC_int4(const q7_t *Im_in,
+                   const uint16_t dim_im_in,
+                   const uint16_t ch_im_in,
+                   const nn_int4_weights *wt,
+                   const uint16_t ch_im_out,
+                   const uint16_t dim_kernel,
+                   const uint16_t padding,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   q7_t *Im_out,
+                   q15_t *bufferA);
+
+void conv_HWC_int4_ep(const q7_t *Im_in,
+                      const uint16_t dim_im_in,
+                      const uint16_t ch_im_in,
+                      const nn_int4_weights *wt,
+                      const uint16_t ch_im_out,
+                      const uint16_t dim_kernel,
+                      const uint16_t padding,
+                      const q7_t *bias,
+                      const uint16_t bias_shift,
+                      const uint16_t out_shift,
+                      q7_t *Im_out,
+                      q15_t *bufferA,
+                      const nn_epilogue *epilogue);
+
+void depthwise_pointwise_conv(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const q7_t *dw_wt,
+                              const uint16_t dim_kernel,
+                              const uint16_t padding,
+                              const uint16_t dw_out_shift,
+                              const q7_t *pw_wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA);
+
+void depthwise_pointwise_conv_ep(const q7_t *Im_in,
+                                 const uint16_t dim_im_in,
+                                 const uint16_t ch_im_in,
+                                 const q7_t *dw_wt,
+                                 const uint16_t dim_kernel,
+                                 const uint16_t padding,
+                                 const uint16_t dw_out_shift,
+                                 const q7_t *pw_wt,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *bias,
+                                 const uint16_t bias_shift,
+                                 const uint16_t out_shift,
+                                 q7_t *Im_out,
+                                 q15_t *bufferA,
+                                 const nn_epilogue *dw_epilogue,
+                                 const nn_epilogue *pw_epilogue);
+
 void avg_pool_q7_HWC_opt(q7_t* im_in,
                         const uint16_t dim_im_in,
                         const uint16_t ch_im_in,
                         q7_t* im_out);
 
+void avg_pool_q7_HWC(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const uint16_t stride,
+                     const uint16_t dim_im_out,
+                     q7_t *Im_out);
+
+void global_avg_pool_q7_HWC(const q7_t *Im_in,
+                            const uint16_t dim_im_in_x,
+                            const uint16_t dim_im_in_y,
+                            const uint16_t ch_im_in,
+                            q7_t *Im_out);
+
+void max_pool_q7_HWC(const q7_t *Im_in,
+                     const uint16_t dim_im_in,
+                     const uint16_t ch_im_in,
+                     const uint16_t dim_kernel,
+                     const uint16_t padding,
+                     const uint16_t stride,
+                     const uint16_t dim_im_out,
+                     q7_t *Im_out);
+
+/* Output row-range variants, bit-identical to the same rows of the full kernel. */
+
+void conv_HWC_rows(const q7_t *Im_in,
+                   const uint16_t dim_im_in,
+                   const uint16_t ch_im_in,
+                   const q7_t *wt,
+                   const uint16_t ch_im_out,
+                   const uint16_t dim_kernel,
+                   const uint16_t padding,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   q7_t *Im_out,
+                   q15_t *bufferA,
+                   q15_t *bufferB,
+                   const nn_epilogue *epilogue,
+                   const uint16_t start_row,
+                   const uint16_t end_row);
+
+void conv_HWC_q7_rows(const q7_t *Im_in,
+                      const uint16_t dim_im_in,
+                      const uint16_t ch_im_in,
+                      const q7_t *wt,
+                      const uint16_t ch_im_out,
+                      const uint16_t dim_kernel,
+                      const uint16_t padding,
+                      const q7_t *bias,
+                      const uint16_t bias_shift,
+                      const uint16_t out_shift,
+                      q7_t *Im_out,
+                      q7_t *bufferA,
+                      const nn_epilogue *epilogue,
+                      const uint16_t start_row,
+                      const uint16_t end_row);
+
+void conv_HWC_nonsquare_rows(const q7_t *Im_in,
+                             const uint16_t dim_im_in_x,
+                             const uint16_t dim_im_in_y,
+                             const uint16_t ch_im_in,
+                             const q7_t *wt,
+                             const uint16_t ch_im_out,
+                             const uint16_t dim_kernel_x,
+                             const uint16_t dim_kernel_y,
+                             const uint16_t pad_top,
+                             const uint16_t pad_bottom,
+                             const uint16_t pad_left,
+                             const uint16_t pad_right,
+                             const uint16_t stride_x,
+                             const uint16_t stride_y,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             q15_t *bufferB,
+                             const nn_epilogue *epilogue,
+                             const uint16_t start_row,
+                             const uint16_t end_row);
+
+void depthwise_conv_rows(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t dim_kernel,
+                         const uint16_t padding,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q7_t *bufferA,
+                         const nn_epilogue *epilogue,
+                         const uint16_t start_row,
+                         const uint16_t end_row);
+
+void depthwise_conv_nonsquare_rows(const q7_t *Im_in,
+                                   const uint16_t dim_im_in_x,
+                                   const uint16_t dim_im_in_y,
+                                   const uint16_t ch_im_in,
+                                   const q7_t *wt,
+                                   const uint16_t dim_kernel_x,
+                                   const uint16_t dim_kernel_y,
+                                   const uint16_t pad_top,
+                                   const uint16_t pad_bottom,
+                                   const uint16_t pad_left,
+                                   const uint16_t pad_right,
+                                   const uint16_t stride_x,
+                                   const uint16_t stride_y,
+                                   const uint16_t out_shift,
+                                   q7_t *Im_out,
+                                   q7_t *bufferA,
+                                   const nn_epilogue *epilogue,
+                                   const uint16_t start_row,
+                                   const uint16_t end_row);
+
+void pointwise_conv_basic_rows(const q7_t *Im_in,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t ch_im_out,
+                               const q7_t *bias,
+                               const uint16_t bias_shift,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q15_t *bufferA,
+                               const nn_epilogue *epilogue,
+                               const uint16_t start_row,
+                               const uint16_t end_row);
+
+void pointwise_conv_fast_rows(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const q7_t *wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA,
+                              const nn_epilogue *epilogue,
+                              const uint16_t start_row,
+                              const uint16_t end_row);
+
+void avg_pool_q7_HWC_rows(const q7_t *Im_in,
+                          const uint16_t dim_im_in,
+                          const uint16_t ch_im_in,
+                          const uint16_t dim_kernel,
+                          const uint16_t padding,
+                          const uint16_t stride,
+                          const uint16_t dim_im_out,
+                          q7_t *Im_out,
+                          const uint16_t start_row,
+                          const uint16_t end_row);
+
+void max_pool_q7_HWC_rows(const q7_t *Im_in,
+                          const uint16_t dim_im_in,
+                          const uint16_t ch_im_in,
+                          const uint16_t dim_kernel,
+                          const uint16_t padding,
+                          const uint16_t stride,
+                          const uint16_t dim_im_out,
+                          q7_t *Im_out,
+                          const uint16_t start_row,
+                          const uint16_t end_row);
+
+#if defined(NN_PORTABLE) && defined(__SSE4_1__)
+
+/* Host x86 (SSE4.1/AVX2) variants, bit-identical to the _ep kernel of the same name. */
+
+void conv_HWC_x86(const q7_t *Im_in,
+                  const uint16_t dim_im_in,
+                  const uint16_t ch_im_in,
+                  const q7_t *wt,
+                  const uint16_t ch_im_out,
+                  const uint16_t dim_kernel,
+                  const uint16_t padding,
+                  const q7_t *bias,
+                  const uint16_t bias_shift,
+                  const uint16_t out_shift,
+                  q7_t *Im_out,
+                  q15_t *bufferA,
+                  q15_t *bufferB,
+                  const nn_epilogue *epilogue);
+
+void depthwise_conv_x86(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const q7_t *wt,
+                        const uint16_t dim_kernel,
+                        const uint16_t padding,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q7_t *bufferA,
+                        const nn_epilogue *epilogue);
+
+void pointwise_conv_fast_x86(const q7_t *Im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             const q7_t *wt,
+                             const uint16_t ch_im_out,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             const nn_epilogue *epilogue);
+
+void avg_pool_q7_HWC_opt_x86(q7_t *im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             q7_t *im_out);
+
+#endif
+
+/* Scratch sizes, in bytes. Two-buffer kernels return bufferA and write bufferB. */
+
+uint32_t conv_HWC_get_buffer_size(const uint16_t dim_im_in,
+                                  const uint16_t ch_im_in,
+                                  const uint16_t ch_im_out,
+                                  const uint16_t dim_kernel,
+                                  uint32_t *bufferB_size);
+
+uint32_t conv_HWC_q7_get_buffer_size(const uint16_t dim_im_in,
+                                     const uint16_t ch_im_in,
+                                     const uint16_t dim_kernel);
+
+uint32_t conv_HWC_ring_get_buffer_size(const uint16_t dim_im_in,
+                                       const uint16_t ch_im_in,
+                                       const uint16_t ch_im_out,
+                                       const uint16_t dim_kernel,
+                                       uint32_t *bufferB_size);
+
+uint32_t conv_HWC_tiled_get_buffer_size(const uint16_t dim_im_in,
+                                        const uint16_t ch_im_in,
+                                        const uint16_t ch_tile,
+                                        const uint16_t dim_kernel,
+                                        uint32_t *bufferB_size);
+
+uint32_t conv_HWC_packed_get_buffer_size(const uint16_t dim_im_in,
+                                         const uint16_t ch_im_in,
+                                         const uint16_t dim_kernel);
+
+uint32_t conv_HWC_nonsquare_get_buffer_size(const uint16_t dim_im_in_y,
+                                            const uint16_t ch_im_in,
+                                            const uint16_t ch_im_out,
+                                            const uint16_t dim_kernel_x,
+                                            const uint16_t dim_kernel_y,
+                                            const uint16_t pad_top,
+                                            const uint16_t pad_bottom,
+                                            uint32_t *bufferB_size);
+
+uint32_t depthwise_conv_get_buffer_size(const uint16_t dim_im_in,
+                                        const uint16_t ch_im_in,
+                                        const uint16_t dim_kernel);
+
+uint32_t depthwise_conv_inplace_get_buffer_size(const uint16_t dim_im_in,
+                                                const uint16_t ch_im_in,
+                                                const uint16_t dim_kernel,
+                                                const uint16_t padding);
+
+uint32_t depthwise_conv_mult_get_buffer_size(const uint16_t dim_im_in,
+                                             const uint16_t ch_im_in,
+                                             const uint16_t dim_kernel);
+
+uint32_t depthwise_conv_ring_get_buffer_size(const uint16_t dim_im_in,
+                                             const uint16_t ch_im_in,
+                                             const uint16_t dim_kernel);
+
+uint32_t depthwise_conv_nonsquare_get_buffer_size(const uint16_t dim_im_in_y,
+                                                  const uint16_t ch_im_in,
+                                                  const uint16_t dim_kernel_x,
+                                                  const uint16_t pad_top,
+                                                  const uint16_t pad_bottom);
+
+uint32_t pointwise_conv_basic_get_buffer_size(const uint16_t ch_im_in);
+
+uint32_t pointwise_conv_fast_get_buffer_size(const uint16_t ch_im_in);
+
+uint32_t pointwise_conv_fast_packed_get_buffer_size(const uint16_t ch_im_in);
+
+uint32_t pointwise_conv_4x2_get_buffer_size(const uint16_t ch_im_in);
+
+uint32_t pointwise_conv_sparse_get_buffer_size(const uint16_t ch_im_in);
+
+uint32_t conv_HWC_sparse_get_buffer_size(const uint16_t dim_im_in,
+                                         const uint16_t ch_im_in,
+                                         const uint16_t dim_kernel);
+
+uint32_t pointwise_conv_fast_int4_get_buffer_size(const uint16_t ch_im_in);
+
+uint32_t conv_HWC_int4_get_buffer_size(const uint16_t dim_im_in,
+                                       const uint16_t ch_im_in,
+                                       const uint16_t dim_kernel);
+
+uint32_t depthwise_pointwise_conv_get_buffer_size(const uint16_t ch_im_in);
 
+#endif
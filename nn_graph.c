@@ -0,0 +1,289 @@
+#include "nn_graph.h"
+
+#ifdef NN_PROFILE
+static const char *const op_names[] = {"conv", "depthwise", "pointwise", "avg_pool_2x2", "avg_pool", "max_pool",
+                                       "global_avg_pool"};
+#endif
+
+static uint16_t layer_dim_out(const nn_layer *l)
+{
+    switch (l->op)
+    {
+    case NN_OP_AVG_POOL_2X2:
+        return l->dim_im_in >> 1;
+    case NN_OP_AVG_POOL:
+    case NN_OP_MAX_POOL:
+        return l->dim_im_out;
+    case NN_OP_GLOBAL_AVG_POOL:
+        return 1;
+    default:
+        return l->dim_im_in;
+    }
+}
+
+static uint16_t layer_ch_out(const nn_layer *l)
+{
+    return (l->op == NN_OP_CONV || l->op == NN_OP_POINTWISE) ? l->ch_im_out : l->ch_im_in;
+}
+
+static int pointwise_is_fast(const nn_layer *l)
+{
+    return (l->ch_im_in & 0x3) == 0 && (l->ch_im_out & 0x1) == 0;
+}
+
+static uint32_t conv_bufferB_offset(const nn_layer *l)
+{
+    uint32_t bufferA_size = conv_HWC_get_buffer_size(l->dim_im_in, l->ch_im_in, l->ch_im_out, l->dim_kernel, NULL);
+    return (bufferA_size + 3) & ~0x3U;
+}
+
+static int layer_check(const nn_layer *l)
+{
+    switch (l->op)
+    {
+    case NN_OP_CONV:
+        //'Same' padding, even channels
+        return l->padding * 2 + 1 == l->dim_kernel &&
+               (l->ch_im_in & 0x1) == 0 && (l->ch_im_out & 0x1) == 0;
+    case NN_OP_DEPTHWISE:
+        return l->padding * 2 + 1 == l->dim_kernel;
+    case NN_OP_POINTWISE:
+        return l->ch_im_out > 0;
+    case NN_OP_AVG_POOL_2X2:
+        return (l->ch_im_in & 0x3) == 0 && (l->dim_im_in & 0x1) == 0;
+    case NN_OP_AVG_POOL:
+    case NN_OP_MAX_POOL:
+        return l->stride > 0 && l->padding < l->dim_kernel &&
+               l->dim_im_in + 2 * l->padding >= l->dim_kernel &&
+               l->dim_im_out == (l->dim_im_in + 2 * l->padding - l->dim_kernel) / l->stride + 1;
+    case NN_OP_GLOBAL_AVG_POOL:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Scratch a layer needs, bufferA then bufferB
+ * @param[in]       layer       Layer descriptor
+ * @return          Bytes of scratch
+ */
+
+uint32_t nn_graph_scratch_size(const nn_layer *layer)
+{
+    uint32_t bufferB_size;
+
+    switch (layer->op)
+    {
+    case NN_OP_CONV:
+        conv_HWC_get_buffer_size(layer->dim_im_in, layer->ch_im_in, layer->ch_im_out, layer->dim_kernel, &bufferB_size);
+        return conv_bufferB_offset(layer) + bufferB_size;
+    case NN_OP_DEPTHWISE:
+        return depthwise_conv_get_buffer_size(layer->dim_im_in, layer->ch_im_in, layer->dim_kernel);
+    case NN_OP_POINTWISE:
+        return pointwise_is_fast(layer) ? pointwise_conv_fast_get_buffer_size(layer->ch_im_in)
+                                        : pointwise_conv_basic_get_buffer_size(layer->ch_im_in);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Check a layer table and bind its buffers
+ * @param[out]      g               Graph
+ * @param[in]       layers          Layer table
+ * @param[in]       num_layers      Number of layers
+ * @param[in]       buf0            Activation buffer, holds the input of layer 0
+ * @param[in]       buf1            Activation buffer
+ * @param[in]       buf_size        Bytes of each activation buffer
+ * @param[in]       scratch         Shared scratch, 4-byte aligned
+ * @param[in]       scratch_size    Bytes of scratch
+ * @return          NN_GRAPH_OK, or the first error with g->err_layer set
+ *
+ * @details
+ * buf_size must hold the largest activation tensor, scratch_size the largest
+ * nn_graph_scratch_size of the table.
+ */
+
+nn_graph_status nn_graph_init(nn_graph *g,
+                              const nn_layer *layers,
+                              const uint16_t num_layers,
+                              q7_t *buf0,
+                              q7_t *buf1,
+                              const uint32_t buf_size,
+                              void *scratch,
+                              const uint32_t scratch_size)
+{
+    uint16_t i;
+
+    g->layers = layers;
+    g->num_layers = num_layers;
+    g->buf[0] = buf0;
+    g->buf[1] = buf1;
+    g->scratch = scratch;
+    g->err_layer = 0;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        const nn_layer *l = &layers[i];
+        uint16_t dim_out = layer_dim_out(l);
+        nn_graph_status status = NN_GRAPH_OK;
+
+        if (i > 0 && (l->dim_im_in != layer_dim_out(&layers[i - 1]) || l->ch_im_in != layer_ch_out(&layers[i - 1])))
+        {
+            status = NN_GRAPH_ERR_SHAPE;
+        }
+        else if (!layer_check(l))
+        {
+            status = NN_GRAPH_ERR_CONSTRAINT;
+        }
+        else if ((uint32_t)l->dim_im_in * l->dim_im_in * l->ch_im_in > buf_size ||
+                 (uint32_t)dim_out * dim_out * layer_ch_out(l) > buf_size)
+        {
+            status = NN_GRAPH_ERR_BUFFER;
+        }
+        else if (nn_graph_scratch_size(l) > scratch_size)
+        {
+            status = NN_GRAPH_ERR_SCRATCH;
+        }
+
+        if (status != NN_GRAPH_OK)
+        {
+            g->err_layer = i;
+            return status;
+        }
+    }
+    return NN_GRAPH_OK;
+}
+
+/**
+ * @brief Run layers first..last (inclusive) of an initialised graph
+ * @param[in]       g       Graph
+ * @param[in]       first   First layer, its input at nn_graph_input(g, first)
+ * @param[in]       last    Last layer, its output at nn_graph_output(g, last)
+ */
+
+void nn_graph_run(const nn_graph *g,
+                  const uint16_t first,
+                  const uint16_t last)
+{
+    uint16_t i;
+
+    for (i = first; i <= last && i < g->num_layers; i++)
+    {
+        NN_PROFILE_LAYER_BEGIN(op_names[g->layers[i].op]);
+        nn_layer_run_rows(&g->layers[i], g->buf[i & 1], g->buf[(i + 1) & 1], g->scratch, 0,
+                          nn_layer_num_rows(&g->layers[i]));
+        NN_PROFILE_LAYER_END();
+    }
+}
+
+/**
+ * @brief Output rows a layer can be split into
+ * @param[in]       layer       Layer descriptor
+ * @return          Output rows, 1 for the layers that only run whole
+ *
+ * @details
+ * NN_OP_AVG_POOL_2X2 (in place) and NN_OP_GLOBAL_AVG_POOL have no row-range
+ * kernel and count as one row.
+ */
+
+uint16_t nn_layer_num_rows(const nn_layer *layer)
+{
+    if (layer->op == NN_OP_AVG_POOL_2X2 || layer->op == NN_OP_GLOBAL_AVG_POOL)
+    {
+        return 1;
+    }
+    return layer_dim_out(layer);
+}
+
+/**
+ * @brief Run output rows [start_row, end_row) of one layer
+ * @param[in]       layer       Layer descriptor, checked by nn_graph_init
+ * @param[in]       in          Input tensor
+ * @param[in,out]   out         Output tensor
+ * @param[in]       scratch     Scratch of nn_graph_scratch_size(layer) bytes, 4-byte aligned
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most nn_layer_num_rows(layer)
+ *
+ * @details
+ * Dispatches to the _rows variant of the layer kernel. Calls on disjoint
+ * ranges with separate scratch write disjoint output rows and may run
+ * concurrently.
+ */
+
+void nn_layer_run_rows(const nn_layer *layer,
+                       q7_t *in,
+                       q7_t *out,
+                       void *scratch,
+                       const uint16_t start_row,
+                       const uint16_t end_row)
+{
+    const nn_layer *l = layer;
+
+    switch (l->op)
+    {
+    case NN_OP_CONV:
+        conv_HWC_rows(in, l->dim_im_in, l->ch_im_in, l->wt, l->ch_im_out, l->dim_kernel, l->padding,
+                      l->bias, l->bias_shift, l->out_shift, out,
+                      (q15_t *)scratch, (q15_t *)((q7_t *)scratch + conv_bufferB_offset(l)), l->epilogue,
+                      start_row, end_row);
+        break;
+    case NN_OP_DEPTHWISE:
+        depthwise_conv_rows(in, l->dim_im_in, l->ch_im_in, l->wt, l->dim_kernel, l->padding,
+                            l->out_shift, out, (q7_t *)scratch, l->epilogue, start_row, end_row);
+        break;
+    case NN_OP_POINTWISE:
+        if (pointwise_is_fast(l))
+        {
+            pointwise_conv_fast_rows(in, l->dim_im_in, l->ch_im_in, l->wt, l->ch_im_out, l->bias,
+                                     l->bias_shift, l->out_shift, out, (q15_t *)scratch, l->epilogue,
+                                     start_row, end_row);
+        }
+        else
+        {
+            pointwise_conv_basic_rows(in, l->dim_im_in, l->ch_im_in, l->wt, l->ch_im_out, l->bias,
+                                      l->bias_shift, l->out_shift, out, (q15_t *)scratch, l->epilogue,
+                                      start_row, end_row);
+        }
+        break;
+    case NN_OP_AVG_POOL_2X2:
+        if (start_row == 0 && end_row > 0)
+        {
+            avg_pool_q7_HWC_opt(in, l->dim_im_in, l->ch_im_in, out);
+        }
+        break;
+    case NN_OP_AVG_POOL:
+        avg_pool_q7_HWC_rows(in, l->dim_im_in, l->ch_im_in, l->dim_kernel, l->padding, l->stride,
+                             l->dim_im_out, out, start_row, end_row);
+        break;
+    case NN_OP_MAX_POOL:
+        max_pool_q7_HWC_rows(in, l->dim_im_in, l->ch_im_in, l->dim_kernel, l->padding, l->stride,
+                             l->dim_im_out, out, start_row, end_row);
+        break;
+    case NN_OP_GLOBAL_AVG_POOL:
+        if (start_row == 0 && end_row > 0)
+        {
+            global_avg_pool_q7_HWC(in, l->dim_im_in, l->dim_im_in, l->ch_im_in, out);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Input buffer of a layer
+ */
+
+q7_t *nn_graph_input(const nn_graph *g, const uint16_t layer)
+{
+    return g->buf[layer & 1];
+}
+
+/**
+ * @brief Output buffer of a layer
+ */
+
+q7_t *nn_graph_output(const nn_graph *g, const uint16_t layer)
+{
+    return g->buf[(layer + 1) & 1];
+}
@@ -0,0 +1,101 @@
+#ifndef NN_GRAPH_H
+#define NN_GRAPH_H
+
+#include "nn_functions.h"
+
+/**
+ * @brief Table-driven executor for a chain of layers
+ *
+ * @details
+ * The model is a const table of nn_layer, usually in flash. Layer i reads
+ * buf[i & 1] and writes buf[(i + 1) & 1], so two activation buffers of the
+ * largest tensor are enough, and all layers share one scratch area for
+ * bufferA/bufferB. nn_graph_init checks every shape and kernel constraint once,
+ * nn_graph_run then only dispatches. Nothing is allocated.
+ *
+ * Usage:
+ *   nn_graph_init(&g, layers, num_layers, buf0, buf1, buf_size, scratch, scratch_size);
+ *   memcpy(nn_graph_input(&g, 0), input, input_size);
+ *   nn_graph_run(&g, 0, num_layers - 1);
+ *   output = nn_graph_output(&g, num_layers - 1);
+ *
+ * A prefix is nn_graph_run(&g, 0, last). A single layer i is nn_graph_run(&g, i, i)
+ * after its input is placed at nn_graph_input(&g, i). nn_layer_run_rows runs a
+ * slice of output rows of one layer, see nn_parallel.h.
+*/
+
+typedef enum
+{
+    NN_OP_CONV,             // conv_HWC
+    NN_OP_DEPTHWISE,        // depthwise_conv
+    NN_OP_POINTWISE,        // pointwise_conv_fast, or pointwise_conv_basic if the shape does not fit
+    NN_OP_AVG_POOL_2X2,     // avg_pool_q7_HWC_opt
+    NN_OP_AVG_POOL,         // avg_pool_q7_HWC
+    NN_OP_MAX_POOL,         // max_pool_q7_HWC
+    NN_OP_GLOBAL_AVG_POOL   // global_avg_pool_q7_HWC
+} nn_op;
+
+typedef struct
+{
+    nn_op op;
+    uint16_t dim_im_in;
+    uint16_t ch_im_in;
+    uint16_t ch_im_out;     // conv, pointwise
+    uint16_t dim_kernel;    // conv, depthwise, pools
+    uint16_t padding;       // conv, depthwise, pools
+    uint16_t stride;        // avg/max pool
+    uint16_t dim_im_out;    // avg/max pool
+    const q7_t *wt;
+    const q7_t *bias;       // conv, pointwise
+    uint16_t bias_shift;
+    uint16_t out_shift;
+    const nn_epilogue *epilogue;    // conv, depthwise, pointwise, may be NULL
+} nn_layer;
+
+typedef enum
+{
+    NN_GRAPH_OK = 0,
+    NN_GRAPH_ERR_SHAPE,         // input does not match the previous output
+    NN_GRAPH_ERR_CONSTRAINT,    // kernel constraint not met
+    NN_GRAPH_ERR_BUFFER,        // activation buffer too small
+    NN_GRAPH_ERR_SCRATCH        // scratch too small
+} nn_graph_status;
+
+typedef struct
+{
+    const nn_layer *layers;
+    uint16_t num_layers;
+    q7_t *buf[2];
+    void *scratch;
+    uint16_t err_layer;     // layer that failed nn_graph_init
+} nn_graph;
+
+nn_graph_status nn_graph_init(nn_graph *g,
+                              const nn_layer *layers,
+                              const uint16_t num_layers,
+                              q7_t *buf0,
+                              q7_t *buf1,
+                              const uint32_t buf_size,
+                              void *scratch,
+                              const uint32_t scratch_size);
+
+void nn_graph_run(const nn_graph *g,
+                  const uint16_t first,
+                  const uint16_t last);
+
+q7_t *nn_graph_input(const nn_graph *g, const uint16_t layer);
+
+q7_t *nn_graph_output(const nn_graph *g, const uint16_t layer);
+
+uint32_t nn_graph_scratch_size(const nn_layer *layer);
+
+uint16_t nn_layer_num_rows(const nn_layer *layer);
+
+void nn_layer_run_rows(const nn_layer *layer,
+                       q7_t *in,
+                       q7_t *out,
+                       void *scratch,
+                       const uint16_t start_row,
+                       const uint16_t end_row);
+
+#endif
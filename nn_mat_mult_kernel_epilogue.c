@@ -0,0 +1,200 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Matrix-multiplication kernel of pointwise_conv_basic with an output epilogue
+ * @param[in]       pA          pointer to operand A (q7 weights)
+ * @param[in]       pInBuffer   pointer to operand B, two q15 columns
+ * @param[in]       ch_im_out   numRow of A
+ * @param[in]       numCol_A    numCol of A
+ * @param[in]       bias_shift  amount of left-shift for bias
+ * @param[in]       out_shift   amount of right-shift for output
+ * @param[in]       bias        the bias
+ * @param[in]       epilogue    output epilogue, NULL for none
+ * @param[in,out]   pOut        pointer to output
+ * @return          The function returns the incremented output pointer
+ *
+ * @details
+ * Same arithmetic as arm_nn_mat_mult_kernel_q7_q15, with the per-channel bias,
+ * per-channel shift and clamp of the epilogue.
+ */
+
+q7_t *nn_mat_mult_kernel_q7_q15_epilogue(const q7_t *pA,
+                                         const q15_t *pInBuffer,
+                                         const uint16_t ch_im_out,
+                                         const uint16_t numCol_A,
+                                         const uint16_t bias_shift,
+                                         const uint16_t out_shift,
+                                         const q7_t *bias,
+                                         const nn_epilogue *epilogue,
+                                         q7_t *pOut)
+{
+    q7_t *pOut2 = pOut + ch_im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pB = pInBuffer;
+        const q15_t *pB2 = pB + numCol_A;
+        const q7_t *pA2 = pA + numCol_A;
+        //Odd ch_im_out: the last row is calculated twice into the same output
+        uint16_t row2 = (i + 1 < ch_im_out) ? 1 : 0;
+        uint16_t shift = ep.out_shift ? ep.out_shift[i] : out_shift;
+        uint16_t shift2 = ep.out_shift ? ep.out_shift[i + row2] : out_shift;
+
+        if (!row2)
+        {
+            pA2 = pA;
+        }
+
+        q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        q31_t sum2 = sum;
+        q31_t sum3 = ((q31_t)pBias[i + row2] << b_shift) + NN_ROUND(shift2);
+        q31_t sum4 = sum3;
+
+        uint16_t colCnt = numCol_A >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12, inA21, inA22;
+            q31_t inB1 = *__SIMD32(pB)++;
+            q31_t inB2 = *__SIMD32(pB2)++;
+
+            pA = (q7_t *)read_and_pad((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad((void *)pA2, &inA21, &inA22);
+
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+
+            colCnt--;
+        }
+        colCnt = numCol_A & 0x3;
+        while (colCnt)
+        {
+            q7_t inA1 = *pA++;
+            q15_t inB1 = *pB++;
+            q7_t inA2 = *pA2++;
+            q15_t inB2 = *pB2++;
+
+            sum += inA1 * inB1;
+            sum2 += inA1 * inB2;
+            sum3 += inA2 * inB1;
+            sum4 += inA2 * inB2;
+            colCnt--;
+        }
+
+        *pOut++ = nn_requantize(sum, shift, ep.act_min, ep.act_max);
+        *pOut2++ = nn_requantize(sum2, shift, ep.act_min, ep.act_max);
+        if (row2)
+        {
+            *pOut++ = nn_requantize(sum3, shift2, ep.act_min, ep.act_max);
+            *pOut2++ = nn_requantize(sum4, shift2, ep.act_min, ep.act_max);
+        }
+
+        /* skip the row computed with A2 */
+        pA += numCol_A;
+    }
+
+    pOut += ch_im_out;
+
+    return pOut;
+}
+
+/**
+ * @brief Matrix-multiplication kernel of pointwise_conv_fast with an output epilogue
+ * @param[in]       pA          pointer to operand A (q7 weights)
+ * @param[in]       pInBuffer   pointer to operand B, two reordered q15 columns
+ * @param[in]       ch_im_out   numRow of A
+ * @param[in]       numCol_A    numCol of A
+ * @param[in]       bias_shift  amount of left-shift for bias
+ * @param[in]       out_shift   amount of right-shift for output
+ * @param[in]       bias        the bias
+ * @param[in]       epilogue    output epilogue, NULL for none
+ * @param[in,out]   pOut        pointer to output
+ * @return          The function returns the incremented output pointer
+ *
+ * @details
+ * Same arithmetic as arm_nn_mat_mult_kernel_q7_q15_reordered, with the
+ * per-channel bias, per-channel shift and clamp of the epilogue.
+ * numCol_A is multiple of 4, ch_im_out is even.
+ */
+
+q7_t *nn_mat_mult_kernel_q7_q15_reordered_epilogue(const q7_t *pA,
+                                                   const q15_t *pInBuffer,
+                                                   const uint16_t ch_im_out,
+                                                   const uint16_t numCol_A,
+                                                   const uint16_t bias_shift,
+                                                   const uint16_t out_shift,
+                                                   const q7_t *bias,
+                                                   const nn_epilogue *epilogue,
+                                                   q7_t *pOut)
+{
+    q7_t *pOut2 = pOut + ch_im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pB = pInBuffer;
+        const q15_t *pB2 = pB + numCol_A;
+        const q7_t *pA2 = pA + numCol_A;
+        uint16_t shift = ep.out_shift ? ep.out_shift[i] : out_shift;
+        uint16_t shift2 = ep.out_shift ? ep.out_shift[i + 1] : out_shift;
+
+        q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        q31_t sum2 = sum;
+        q31_t sum3 = ((q31_t)pBias[i + 1] << b_shift) + NN_ROUND(shift2);
+        q31_t sum4 = sum3;
+
+        uint16_t colCnt = numCol_A >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12, inA21, inA22;
+            q31_t inB1 = *__SIMD32(pB)++;
+            q31_t inB2 = *__SIMD32(pB2)++;
+
+            pA = (q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+
+            colCnt--;
+        }
+
+        *pOut++ = nn_requantize(sum, shift, ep.act_min, ep.act_max);
+        *pOut++ = nn_requantize(sum3, shift2, ep.act_min, ep.act_max);
+        *pOut2++ = nn_requantize(sum2, shift, ep.act_min, ep.act_max);
+        *pOut2++ = nn_requantize(sum4, shift2, ep.act_min, ep.act_max);
+
+        /* skip the row computed with A2 */
+        pA += numCol_A;
+    }
+
+    pOut += ch_im_out;
+
+    return pOut;
+}
@@ -0,0 +1,165 @@
+#include "nn_functions.h"
+
+/*
+ * Body of the fixed-size kernels. Inlined into each wrapper with a literal
+ * numCol_A, so the trip count, the 4-column tail test and the row stride are
+ * all compile-time constants.
+ */
+NN_FORCEINLINE q7_t *mat_mult_reordered_fixed(const q7_t *pA,
+                                              const q15_t *pInBuffer,
+                                              const uint16_t ch_im_out,
+                                              const uint16_t numCol_A,
+                                              const uint16_t bias_shift,
+                                              const uint16_t out_shift,
+                                              const q7_t *bias,
+                                              const nn_epilogue *epilogue,
+                                              q7_t *pOut)
+{
+    q7_t *pOut2 = pOut + ch_im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pB = pInBuffer;
+        const q15_t *pB2 = pB + numCol_A;
+        const q7_t *pA2 = pA + numCol_A;
+        uint16_t shift = pShift ? pShift[i] : out_shift;
+        uint16_t shift2 = pShift ? pShift[i + 1] : out_shift;
+
+        q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        q31_t sum2 = sum;
+        q31_t sum3 = ((q31_t)pBias[i + 1] << b_shift) + NN_ROUND(shift2);
+        q31_t sum4 = sum3;
+
+        q31_t inA11, inA12, inA21, inA22, inB1, inB2;
+
+        //8 columns per iteration, no counter for the last 4
+        uint16_t colCnt = numCol_A >> 3;
+        while (colCnt)
+        {
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            pA = (q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            pA = (q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+
+            colCnt--;
+        }
+        if (numCol_A & 0x4)
+        {
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            pA = (q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+        }
+
+        *pOut++ = nn_requantize(sum, shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum3, shift2, act_min, act_max);
+        *pOut2++ = nn_requantize(sum2, shift, act_min, act_max);
+        *pOut2++ = nn_requantize(sum4, shift2, act_min, act_max);
+
+        /* skip the row computed with A2 */
+        pA += numCol_A;
+    }
+
+    pOut += ch_im_out;
+
+    return pOut;
+}
+
+#ifdef NN_FIXED_KERNELS
+
+#define NN_MAT_MULT_REORDERED_FIXED(NUM_COL)                                                              \
+    static q7_t *mat_mult_reordered_##NUM_COL(const q7_t *pA, const q15_t *pInBuffer,                    \
+                                              const uint16_t ch_im_out, const uint16_t bias_shift,       \
+                                              const uint16_t out_shift, const q7_t *bias,                \
+                                              const nn_epilogue *epilogue, q7_t *pOut)                   \
+    {                                                                                                     \
+        return mat_mult_reordered_fixed(pA, pInBuffer, ch_im_out, NUM_COL, bias_shift, out_shift, bias, \
+                                        epilogue, pOut);                                                  \
+    }
+
+//Pointwise input channels of the DS-CNN models
+NN_MAT_MULT_REORDERED_FIXED(64)
+NN_MAT_MULT_REORDERED_FIXED(128)
+NN_MAT_MULT_REORDERED_FIXED(172)
+NN_MAT_MULT_REORDERED_FIXED(276)
+
+#endif
+
+/**
+ * @brief Matrix-multiplication kernel of pointwise_conv_fast specialised for numCol_A
+ * @param[in]       numCol_A    numCol of A, i.e. ch_im_in of the pointwise layer
+ * @return          The kernel, or NULL if numCol_A has no specialisation
+ *
+ * @details
+ * The returned kernel has the arithmetic of
+ * nn_mat_mult_kernel_q7_q15_reordered_epilogue (and of
+ * arm_nn_mat_mult_kernel_q7_q15_reordered for a NULL epilogue) with the column
+ * loop unrolled by 8 and no counter for the remainder. ch_im_out is even.
+ *
+ * Specialised: numCol_A = 64, 128, 172, 276, only when built with
+ * -DNN_FIXED_KERNELS. They measured 0.74-0.92x of the generic kernel on the
+ * host (tests/bench_fixed.c), so without it this returns NULL and the
+ * pointwise kernels keep the generic mat mult.
+ */
+
+nn_mat_mult_fixed_fn nn_mat_mult_kernel_q7_q15_reordered_fixed(const uint16_t numCol_A)
+{
+#ifdef NN_FIXED_KERNELS
+    switch (numCol_A)
+    {
+    case 64:
+        return mat_mult_reordered_64;
+    case 128:
+        return mat_mult_reordered_128;
+    case 172:
+        return mat_mult_reordered_172;
+    case 276:
+        return mat_mult_reordered_276;
+    default:
+        break;
+    }
+#endif
+    return NULL;
+}
@@ -0,0 +1,137 @@
+#if defined(NN_PORTABLE) || defined(NN_PTHREADS)
+
+#include <pthread.h>
+#include "nn_parallel.h"
+
+typedef struct
+{
+    const nn_graph *g;
+    uint16_t first;
+    uint16_t last;
+    uint16_t index;
+    uint16_t num_threads;
+    void *scratch;
+    pthread_barrier_t *barrier;
+    //Start gate, workers wait until every thread is created
+    pthread_mutex_t *lock;
+    pthread_cond_t *cond;
+    int *state;     // 0 wait, 1 run, -1 abort
+} parallel_worker;
+
+static void parallel_slices(const parallel_worker *w)
+{
+    uint16_t i;
+
+    for (i = w->first; i <= w->last && i < w->g->num_layers; i++)
+    {
+        const nn_layer *l = &w->g->layers[i];
+        uint32_t rows = nn_layer_num_rows(l);
+
+        nn_layer_run_rows(l, nn_graph_input(w->g, i), nn_graph_output(w->g, i), w->scratch,
+                          rows * w->index / w->num_threads, rows * (w->index + 1) / w->num_threads);
+        pthread_barrier_wait(w->barrier);
+    }
+}
+
+static void *parallel_worker_main(void *arg)
+{
+    const parallel_worker *w = (const parallel_worker *)arg;
+    int state;
+
+    pthread_mutex_lock(w->lock);
+    while (*w->state == 0)
+    {
+        pthread_cond_wait(w->cond, w->lock);
+    }
+    state = *w->state;
+    pthread_mutex_unlock(w->lock);
+
+    if (state > 0)
+    {
+        parallel_slices(w);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run layers first..last (inclusive) of an initialised graph on num_threads threads
+ * @param[in]       g               Graph, see nn_graph_run
+ * @param[in]       first           First layer, its input at nn_graph_input(g, first)
+ * @param[in]       last            Last layer, its output at nn_graph_output(g, last)
+ * @param[in]       num_threads     Threads including the caller, 1 runs inline, at most NN_PARALLEL_MAX_THREADS
+ * @param[in]       scratch         num_threads - 1 scratch areas for the workers
+ * @param[in]       scratch_stride  Bytes between the worker scratch areas
+ * @return          NN_PARALLEL_OK, or NN_PARALLEL_ERR_THREAD
+ */
+
+nn_parallel_status nn_parallel_run(const nn_graph *g,
+                                   const uint16_t first,
+                                   const uint16_t last,
+                                   const uint16_t num_threads,
+                                   void *scratch,
+                                   const uint32_t scratch_stride)
+{
+    pthread_barrier_t barrier;
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+    parallel_worker workers[NN_PARALLEL_MAX_THREADS];
+    pthread_t threads[NN_PARALLEL_MAX_THREADS];
+    int state = 0;
+    uint16_t created;
+    uint16_t t;
+
+    if (num_threads <= 1)
+    {
+        nn_graph_run(g, first, last);
+        return NN_PARALLEL_OK;
+    }
+
+    if (num_threads > NN_PARALLEL_MAX_THREADS)
+    {
+        return NN_PARALLEL_ERR_THREAD;
+    }
+    pthread_barrier_init(&barrier, NULL, num_threads);
+
+    for (t = 0; t < num_threads; t++)
+    {
+        workers[t].g = g;
+        workers[t].first = first;
+        workers[t].last = last;
+        workers[t].index = t;
+        workers[t].num_threads = num_threads;
+        workers[t].scratch = t ? (q7_t *)scratch + (t - 1) * scratch_stride : g->scratch;
+        workers[t].barrier = &barrier;
+        workers[t].lock = &lock;
+        workers[t].cond = &cond;
+        workers[t].state = &state;
+    }
+
+    for (created = 1; created < num_threads; created++)
+    {
+        if (pthread_create(&threads[created], NULL, parallel_worker_main, &workers[created]) != 0)
+        {
+            break;
+        }
+    }
+
+    //Open the gate, or send the started workers home before any barrier
+    pthread_mutex_lock(&lock);
+    state = (created == num_threads) ? 1 : -1;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+
+    if (state > 0)
+    {
+        parallel_slices(&workers[0]);
+    }
+
+    for (t = 1; t < created; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+
+    return state > 0 ? NN_PARALLEL_OK : NN_PARALLEL_ERR_THREAD;
+}
+
+#endif
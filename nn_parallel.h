@@ -0,0 +1,51 @@
+#ifndef NN_PARALLEL_H
+#define NN_PARALLEL_H
+
+#include "nn_graph.h"
+
+/**
+ * @brief Run an nn_graph with every layer split across threads (POSIX threads)
+ *
+ * @details
+ * Each layer is cut into num_threads contiguous ranges of output rows, run
+ * with nn_layer_run_rows, one range per thread. The threads are started once
+ * per call and meet at a barrier after every layer, because the next layer
+ * reads all of its rows and overwrites the previous input. The result is
+ * bit-identical to nn_graph_run.
+ *
+ * Every thread needs its own scratch: the caller uses the graph scratch, worker
+ * t (1..num_threads-1) uses scratch + (t - 1) * scratch_stride. scratch_stride
+ * is at least the largest nn_graph_scratch_size of the table, a multiple of 4.
+ *
+ * Layers with few output rows leave threads idle (a layer of R rows uses at
+ * most R threads), and NN_OP_AVG_POOL_2X2 / NN_OP_GLOBAL_AVG_POOL run on the
+ * caller only. Conv layers widen the full weight set in every thread.
+ *
+ * Built for the host (-DNN_PORTABLE) or a target with POSIX threads
+ * (-DNN_PTHREADS). Without pthreads, e.g. on a dual-core MCU, the same split
+ * is nn_layer_run_rows on each core with a core-to-core sync per layer.
+ *
+ * Usage:
+ *   nn_graph_init(&g, layers, num_layers, buf0, buf1, buf_size, scratch0, scratch_size);
+ *   memcpy(nn_graph_input(&g, 0), input, input_size);
+ *   nn_parallel_run(&g, 0, num_layers - 1, num_threads, scratch, scratch_size);
+*/
+
+#ifndef NN_PARALLEL_MAX_THREADS
+#define NN_PARALLEL_MAX_THREADS 16
+#endif
+
+typedef enum
+{
+    NN_PARALLEL_OK = 0,
+    NN_PARALLEL_ERR_THREAD      // too many threads or a thread could not be started, nothing was run
+} nn_parallel_status;
+
+nn_parallel_status nn_parallel_run(const nn_graph *g,
+                                   const uint16_t first,
+                                   const uint16_t last,
+                                   const uint16_t num_threads,
+                                   void *scratch,
+                                   const uint32_t scratch_stride);
+
+#endif
@@ -0,0 +1,461 @@
+#include <stdio.h>
+#include "nn_planner.h"
+
+#define NN_PLAN_UNPLACED 0xFFFFFFFFU
+
+/**
+ * @brief Layers a tensor is alive for
+ * @param[in]       layers      Layer list
+ * @param[in]       num_layers  Number of layers
+ * @param[in]       t           Tensor index
+ * @param[out]      first       First layer, greater than last if never used
+ * @param[out]      last        Last layer
+ */
+static void tensor_lifetime(const nn_plan_layer *layers,
+                            const uint16_t num_layers,
+                            const int16_t t,
+                            int32_t *first,
+                            int32_t *last)
+{
+    int32_t i;
+    int32_t written = -1;
+    int32_t read = -1;
+
+    *first = -1;
+    *last = -1;
+    for (i = 0; i < num_layers; i++)
+    {
+        if (layers[i].output == t && written < 0)
+        {
+            written = i;
+        }
+        if (layers[i].input == t || layers[i].input2 == t)
+        {
+            read = i;
+        }
+    }
+
+    if (written < 0 && read < 0)
+    {
+        *first = 1;
+        *last = 0;
+        return;
+    }
+    //Graph inputs live from the start, graph outputs until the end
+    *first = written < 0 ? 0 : written;
+    *last = read < 0 ? num_layers - 1 : (read > written ? read : written);
+}
+
+typedef struct
+{
+    nn_plan_tensor *tensors;
+    uint16_t num_tensors;
+    nn_plan_layer *layers;
+    uint16_t num_layers;
+    uint32_t align;
+} plan_ctx;
+
+//Orders tried by nn_plan, each with first fit and best fit
+typedef enum
+{
+    PLAN_BY_SIZE,       // largest first
+    PLAN_BY_AREA,       // largest size * lifetime first
+    PLAN_BY_LENGTH,     // longest lifetime first, then largest
+    PLAN_BY_FIRST,      // earliest first layer first, then largest
+    PLAN_NUM_ORDERS
+} plan_order;
+
+//Buffer b is tensor b, or the scratch of layer b - num_tensors
+static uint32_t buf_size(const plan_ctx *c, const uint32_t b)
+{
+    return b < c->num_tensors ? c->tensors[b].size : c->layers[b - c->num_tensors].scratch;
+}
+
+static uint32_t *buf_offset(const plan_ctx *c, const uint32_t b)
+{
+    return b < c->num_tensors ? &c->tensors[b].offset : &c->layers[b - c->num_tensors].scratch_offset;
+}
+
+static void buf_lifetime(const plan_ctx *c, const uint32_t b, int32_t *first, int32_t *last)
+{
+    if (b < c->num_tensors)
+    {
+        tensor_lifetime(c->layers, c->num_layers, (int16_t)b, first, last);
+    }
+    else
+    {
+        *first = *last = b - c->num_tensors;
+    }
+}
+
+//Placed, not empty and alive at some layer of [first, last]
+static int buf_conflicts(const plan_ctx *c, const uint32_t b2, const int32_t first, const int32_t last)
+{
+    int32_t first2, last2;
+
+    if (*buf_offset(c, b2) == NN_PLAN_UNPLACED || buf_size(c, b2) == 0)
+    {
+        return 0;
+    }
+    buf_lifetime(c, b2, &first2, &last2);
+    return first2 <= last && first <= last2;
+}
+
+/**
+ * @brief Offset for unplaced buffer b, clear of every placed buffer alive at the same time
+ * @param[in]       c           Planner state
+ * @param[in]       b           Buffer
+ * @param[in]       best_fit    0: lowest offset. 1: lowest offset of the smallest gap that holds b
+ * @return          Offset, a multiple of align
+ *
+ * @details
+ * The candidates are 0 and the aligned end of every conflicting buffer; the
+ * lowest free offset is always one of them.
+ */
+static uint32_t buf_fit(const plan_ctx *c, const uint32_t b, const int best_fit)
+{
+    uint32_t num_buffers = c->num_tensors + c->num_layers;
+    uint32_t size = buf_size(c, b);
+    uint32_t best = NN_PLAN_UNPLACED;
+    uint32_t best_gap = NN_PLAN_UNPLACED;
+    int32_t first, last;
+    uint32_t b2, b3;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+    buf_lifetime(c, b, &first, &last);
+
+    //b2 == num_buffers is the candidate 0
+    for (b2 = 0; b2 <= num_buffers; b2++)
+    {
+        uint32_t cand = 0;
+        uint32_t gap = NN_PLAN_UNPLACED;
+        int free = 1;
+
+        if (b2 < num_buffers)
+        {
+            if (b2 == b || !buf_conflicts(c, b2, first, last))
+            {
+                continue;
+            }
+            cand = (*buf_offset(c, b2) + buf_size(c, b2) + c->align - 1) & ~(c->align - 1);
+        }
+        for (b3 = 0; b3 < num_buffers && free; b3++)
+        {
+            uint32_t offset3 = *buf_offset(c, b3);
+
+            if (b3 == b || !buf_conflicts(c, b3, first, last))
+            {
+                continue;
+            }
+            if (cand < offset3 + buf_size(c, b3) && offset3 < cand + size)
+            {
+                free = 0;
+            }
+            else if (offset3 >= cand && offset3 - cand < gap)
+            {
+                gap = offset3 - cand;
+            }
+        }
+        if (!free)
+        {
+            continue;
+        }
+        if (best_fit ? (gap < best_gap || (gap == best_gap && cand < best)) : cand < best)
+        {
+            best = cand;
+            best_gap = gap;
+        }
+    }
+    return best;
+}
+
+//Whether buffer a is placed before buffer b in the given order, ties go to the lower index
+static int buf_before(const plan_ctx *c, const plan_order order, const uint32_t a, const uint32_t b)
+{
+    uint32_t size_a = buf_size(c, a);
+    uint32_t size_b = buf_size(c, b);
+    int32_t first_a, last_a, first_b, last_b;
+    uint64_t key_a, key_b;
+
+    buf_lifetime(c, a, &first_a, &last_a);
+    buf_lifetime(c, b, &first_b, &last_b);
+    switch (order)
+    {
+    case PLAN_BY_AREA:
+        key_a = (uint64_t)size_a * (uint32_t)(last_a - first_a + 1);
+        key_b = (uint64_t)size_b * (uint32_t)(last_b - first_b + 1);
+        break;
+    case PLAN_BY_LENGTH:
+        key_a = (uint32_t)(last_a - first_a);
+        key_b = (uint32_t)(last_b - first_b);
+        break;
+    case PLAN_BY_FIRST:
+        key_a = (uint32_t)(c->num_layers - first_a);
+        key_b = (uint32_t)(c->num_layers - first_b);
+        break;
+    default:
+        key_a = key_b = 0;
+        break;
+    }
+    if (key_a != key_b)
+    {
+        return key_a > key_b;
+    }
+    if (size_a != size_b)
+    {
+        return size_a > size_b;
+    }
+    return a < b;
+}
+
+//Place every buffer in the given order, returns the arena size
+static uint32_t plan_pass(const plan_ctx *c, const plan_order order, const int best_fit)
+{
+    uint32_t num_buffers = c->num_tensors + c->num_layers;
+    uint32_t arena = 0;
+    uint32_t n, b;
+
+    for (b = 0; b < num_buffers; b++)
+    {
+        *buf_offset(c, b) = NN_PLAN_UNPLACED;
+    }
+    for (n = 0; n < num_buffers; n++)
+    {
+        uint32_t next = NN_PLAN_UNPLACED;
+
+        for (b = 0; b < num_buffers; b++)
+        {
+            if (*buf_offset(c, b) == NN_PLAN_UNPLACED && (next == NN_PLAN_UNPLACED || buf_before(c, order, b, next)))
+            {
+                next = b;
+            }
+        }
+        *buf_offset(c, next) = buf_fit(c, next, best_fit);
+        if (*buf_offset(c, next) + buf_size(c, next) > arena)
+        {
+            arena = *buf_offset(c, next) + buf_size(c, next);
+        }
+    }
+    return arena;
+}
+
+typedef struct
+{
+    uint16_t buf[NN_PLAN_EXACT_MAX];        // buffers of non-zero size
+    uint32_t offset[NN_PLAN_EXACT_MAX];     // offsets of the best plan found
+    uint32_t count;
+    uint32_t best;                          // arena of the best plan found
+    uint32_t bound;                         // stop once best reaches it
+} plan_exact;
+
+/**
+ * @brief Depth-first search over the order in which the buffers are placed at their lowest offset
+ *
+ * @details
+ * Placing the buffers of any plan in the order of their offsets, each at its
+ * lowest free offset, gives an arena no larger than that plan. Trying every
+ * order therefore finds the smallest arena. Branches that already reach the
+ * best arena are cut.
+ */
+static void plan_search(const plan_ctx *c, plan_exact *e, const uint32_t placed, const uint32_t arena)
+{
+    uint32_t i;
+
+    if (placed == e->count)
+    {
+        e->best = arena;
+        for (i = 0; i < e->count; i++)
+        {
+            e->offset[i] = *buf_offset(c, e->buf[i]);
+        }
+        return;
+    }
+    for (i = 0; i < e->count && e->best > e->bound; i++)
+    {
+        uint32_t b = e->buf[i];
+        uint32_t offset, top;
+
+        if (*buf_offset(c, b) != NN_PLAN_UNPLACED)
+        {
+            continue;
+        }
+        offset = buf_fit(c, b, 0);
+        top = offset + buf_size(c, b) > arena ? offset + buf_size(c, b) : arena;
+        if (top < e->best)
+        {
+            *buf_offset(c, b) = offset;
+            plan_search(c, e, placed + 1, top);
+            *buf_offset(c, b) = NN_PLAN_UNPLACED;
+        }
+    }
+}
+
+/**
+ * @brief Plan the arena of a chain of layers
+ * @param[in,out]   tensors     Tensor list, offset is written
+ * @param[in]       num_tensors Number of tensors
+ * @param[in,out]   layers      Layer list, scratch_offset and live_bytes are written
+ * @param[in]       num_layers  Number of layers
+ * @param[in]       align       Offset alignment in bytes (power of two, e.g. 4)
+ * @return          Arena size in bytes
+ *
+ * @details
+ * Places the buffers in four orders (by size, by size * lifetime, by lifetime,
+ * by first layer), each with first fit and best fit, and keeps the smallest
+ * arena. With at most NN_PLAN_EXACT_MAX buffers of non-zero size, a search over
+ * all placement orders then gives the smallest arena possible.
+ *
+ * O((num_tensors + num_layers)^3 * num_layers) for the passes, no allocation,
+ * meant for init time or the host. nn_plan_lower_bound gives the peak live
+ * bytes; no plan is smaller, but buffers that are alive at different times
+ * cannot always share addresses, so the smallest plan may be larger.
+ */
+
+uint32_t nn_plan(nn_plan_tensor *tensors,
+                 const uint16_t num_tensors,
+                 nn_plan_layer *layers,
+                 const uint16_t num_layers,
+                 const uint32_t align)
+{
+    plan_ctx c;
+    plan_exact e;
+    uint32_t num_buffers = num_tensors + num_layers;
+    uint32_t arena, best_arena = NN_PLAN_UNPLACED;
+    plan_order order, best_order = PLAN_BY_SIZE;
+    int best_fit, best_best_fit = 0;
+    uint32_t b;
+    int32_t i;
+
+    c.tensors = tensors;
+    c.num_tensors = num_tensors;
+    c.layers = layers;
+    c.num_layers = num_layers;
+    c.align = align;
+
+    //Per layer report
+    for (i = 0; i < num_layers; i++)
+    {
+        uint32_t live = layers[i].scratch;
+        for (b = 0; b < num_tensors; b++)
+        {
+            int32_t first, last;
+            tensor_lifetime(layers, num_layers, (int16_t)b, &first, &last);
+            if (first <= i && i <= last)
+            {
+                live += tensors[b].size;
+            }
+        }
+        layers[i].live_bytes = live;
+    }
+    e.bound = nn_plan_lower_bound(layers, num_layers);
+
+    for (order = PLAN_BY_SIZE; order < PLAN_NUM_ORDERS && best_arena > e.bound; order++)
+    {
+        for (best_fit = 0; best_fit < 2; best_fit++)
+        {
+            arena = plan_pass(&c, order, best_fit);
+            if (arena < best_arena)
+            {
+                best_arena = arena;
+                best_order = order;
+                best_best_fit = best_fit;
+            }
+        }
+    }
+
+    e.count = 0;
+    for (b = 0; b < num_buffers; b++)
+    {
+        if (buf_size(&c, b))
+        {
+            if (e.count < NN_PLAN_EXACT_MAX)
+            {
+                e.buf[e.count] = (uint16_t)b;
+            }
+            e.count++;
+        }
+    }
+    e.best = best_arena;
+    if (e.count <= NN_PLAN_EXACT_MAX && best_arena > e.bound)
+    {
+        for (b = 0; b < num_buffers; b++)
+        {
+            *buf_offset(&c, b) = buf_size(&c, b) ? NN_PLAN_UNPLACED : 0;
+        }
+        plan_search(&c, &e, 0, 0);
+    }
+
+    if (e.best < best_arena)
+    {
+        for (b = 0; b < e.count; b++)
+        {
+            *buf_offset(&c, e.buf[b]) = e.offset[b];
+        }
+        return e.best;
+    }
+    return plan_pass(&c, best_order, best_best_fit);
+}
+
+/**
+ * @brief Peak bytes alive at once, a lower bound on the arena
+ * @param[in]       layers      Layer list planned by nn_plan
+ * @param[in]       num_layers  Number of layers
+ * @return          Largest live_bytes
+ *
+ * @details
+ * No plan is smaller. The smallest plan can be larger when buffers alive at
+ * different times cannot share addresses; nn_plan_print reports the gap.
+ */
+
+uint32_t nn_plan_lower_bound(const nn_plan_layer *layers,
+                             const uint16_t num_layers)
+{
+    uint32_t peak = 0;
+    uint16_t i;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        if (layers[i].live_bytes > peak)
+        {
+            peak = layers[i].live_bytes;
+        }
+    }
+    return peak;
+}
+
+/**
+ * @brief Print the plan, one line per layer and per tensor
+ * @param[in]       tensors     Tensor list planned by nn_plan
+ * @param[in]       num_tensors Number of tensors
+ * @param[in]       layers      Layer list planned by nn_plan
+ * @param[in]       num_layers  Number of layers
+ * @param[in]       arena_size  Return value of nn_plan
+ */
+
+void nn_plan_print(const nn_plan_tensor *tensors,
+                   const uint16_t num_tensors,
+                   const nn_plan_layer *layers,
+                   const uint16_t num_layers,
+                   const uint32_t arena_size)
+{
+    uint32_t peak = nn_plan_lower_bound(layers, num_layers);
+    uint16_t i;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        printf("layer %3u: in %3d in2 %3d out %3d scratch %7lu @ %7lu live %7lu\n",
+               (unsigned)i, layers[i].input, layers[i].input2, layers[i].output,
+               (unsigned long)layers[i].scratch, (unsigned long)layers[i].scratch_offset,
+               (unsigned long)layers[i].live_bytes);
+    }
+    for (i = 0; i < num_tensors; i++)
+    {
+        printf("tensor %3u: %7lu bytes @ %7lu\n",
+               (unsigned)i, (unsigned long)tensors[i].size, (unsigned long)tensors[i].offset);
+    }
+    printf("arena %lu bytes, peak live %lu bytes, gap %lu bytes\n",
+           (unsigned long)arena_size, (unsigned long)peak, (unsigned long)(arena_size > peak ? arena_size - peak : 0));
+}
@@ -0,0 +1,69 @@
+#ifndef NN_PLANNER_H
+#define NN_PLANNER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Static arena planner for a chain of layers
+ *
+ * @details
+ * Every activation tensor and every layer's scratch (bufferA + bufferB, see the
+ * *_get_buffer_size functions) gets an offset into one arena. A tensor lives
+ * from the layer that writes it to the last layer that reads it, scratch lives
+ * for its own layer only. Each buffer is placed at an offset that does not
+ * overlap any buffer alive at the same time. nn_plan tries several placement
+ * orders with first fit and best fit and keeps the smallest arena; with at
+ * most NN_PLAN_EXACT_MAX buffers it searches every order, which finds the
+ * smallest arena possible.
+ *
+ * nn_plan_lower_bound (the peak bytes alive at once) is a lower bound, not
+ * always reachable: buffers alive at different times cannot always share
+ * addresses. nn_plan_print reports the gap between the two.
+ *
+ * Graph inputs are tensors no layer writes, they live from layer 0. Graph
+ * outputs are tensors no layer reads, they live until the last layer.
+ *
+ * A layer run in place (depthwise_conv_inplace, avg_pool_q7_HWC_opt) reads and
+ * writes one tensor: give it output == input and the size of the larger of
+ * the two. The tensor then lives from its first writer to its last reader.
+*/
+
+#define NN_PLAN_NONE (-1)
+
+// Exact search up to this many buffers (tensors + non-empty scratch), O(n!) in the worst case
+#ifndef NN_PLAN_EXACT_MAX
+#define NN_PLAN_EXACT_MAX 8
+#endif
+
+typedef struct
+{
+    uint32_t size;      // bytes
+    uint32_t offset;    // set by nn_plan
+} nn_plan_tensor;
+
+typedef struct
+{
+    int16_t input;          // tensor read, NN_PLAN_NONE if none
+    int16_t input2;         // second tensor read (e.g. residual add), NN_PLAN_NONE if none
+    int16_t output;         // tensor written
+    uint32_t scratch;       // bytes of scratch
+    uint32_t scratch_offset;// set by nn_plan
+    uint32_t live_bytes;    // set by nn_plan, tensors + scratch alive while the layer runs
+} nn_plan_layer;
+
+uint32_t nn_plan(nn_plan_tensor *tensors,
+                 const uint16_t num_tensors,
+                 nn_plan_layer *layers,
+                 const uint16_t num_layers,
+                 const uint32_t align);
+
+uint32_t nn_plan_lower_bound(const nn_plan_layer *layers,
+                             const uint16_t num_layers);
+
+void nn_plan_print(const nn_plan_tensor *tensors,
+                   const uint16_t num_tensors,
+                   const nn_plan_layer *layers,
+                   const uint16_t num_layers,
+                   const uint32_t arena_size);
+
+#endif
@@ -0,0 +1,419 @@
+#ifdef NN_PORTABLE
+
+#include "nn_functions.h"
+
+/**
+ * @brief Portable CMSIS-NN support functions
+ *
+ * @details
+ * Straight ports of the DSP (Cortex-M4) code paths of the CMSIS-NN support
+ * functions on top of the intrinsics in nn_portable.h, so a host build
+ * produces the same bytes as the target.
+*/
+
+void arm_q7_to_q15_no_shift(const q7_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+    const q7_t *pIn = pSrc;
+    uint32_t blkCnt;
+
+    q31_t in;
+    q31_t in1, in2;
+    q31_t out1, out2;
+
+    blkCnt = blockSize >> 2u;
+    while (blkCnt > 0u)
+    {
+        in = *__SIMD32(pIn)++;
+
+        in1 = __SXTB16(__ROR(in, 8));
+        in2 = __SXTB16(in);
+
+        out2 = __PKHTB(in1, in2, 16);
+        out1 = __PKHBT(in2, in1, 16);
+
+        *__SIMD32(pDst)++ = out1;
+        *__SIMD32(pDst)++ = out2;
+
+        blkCnt--;
+    }
+
+    blkCnt = blockSize % 0x4u;
+    while (blkCnt > 0u)
+    {
+        *pDst++ = (q15_t)*pIn++;
+        blkCnt--;
+    }
+}
+
+void arm_q7_to_q15_reordered_no_shift(const q7_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+    const q7_t *pIn = pSrc;
+    uint32_t blkCnt;
+
+    q31_t in;
+    q31_t in1, in2;
+
+    blkCnt = blockSize >> 2u;
+    while (blkCnt > 0u)
+    {
+        in = *__SIMD32(pIn)++;
+
+        in1 = __SXTB16(__ROR(in, 8));
+        in2 = __SXTB16(in);
+
+        *__SIMD32(pDst)++ = in2;
+        *__SIMD32(pDst)++ = in1;
+
+        blkCnt--;
+    }
+
+    blkCnt = blockSize % 0x4u;
+    while (blkCnt > 0u)
+    {
+        *pDst++ = (q15_t)*pIn++;
+        blkCnt--;
+    }
+}
+
+q7_t *arm_nn_mat_mult_kernel_q7_q15(const q7_t *pA,
+                                    const q15_t *pInBuffer,
+                                    const uint16_t ch_im_out,
+                                    const uint16_t numCol_A,
+                                    const uint16_t bias_shift,
+                                    const uint16_t out_shift,
+                                    const q7_t *bias,
+                                    q7_t *pOut)
+{
+    q7_t *pOut2 = pOut + ch_im_out;
+    const q7_t *pBias = bias;
+    uint16_t rowCnt = ch_im_out >> 1;
+
+    while (rowCnt)
+    {
+        const q15_t *pB = pInBuffer;
+        const q15_t *pB2 = pB + numCol_A;
+        const q7_t *pA2 = pA + numCol_A;
+
+        q31_t sum = ((q31_t)(*pBias) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum2 = ((q31_t)(*pBias++) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum3 = ((q31_t)(*pBias) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum4 = ((q31_t)(*pBias++) << bias_shift) + NN_ROUND(out_shift);
+
+        uint16_t colCnt = numCol_A >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12, inA21, inA22;
+            q31_t inB1 = *__SIMD32(pB)++;
+            q31_t inB2 = *__SIMD32(pB2)++;
+
+            pA = (q7_t *)read_and_pad((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad((void *)pA2, &inA21, &inA22);
+
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+
+            colCnt--;
+        }
+        colCnt = numCol_A & 0x3;
+        while (colCnt)
+        {
+            q7_t inA1 = *pA++;
+            q15_t inB1 = *pB++;
+            q7_t inA2 = *pA2++;
+            q15_t inB2 = *pB2++;
+
+            sum += inA1 * inB1;
+            sum2 += inA1 * inB2;
+            sum3 += inA2 * inB1;
+            sum4 += inA2 * inB2;
+            colCnt--;
+        }
+        *pOut++ = (q7_t)__SSAT((sum >> out_shift), 8);
+        *pOut++ = (q7_t)__SSAT((sum3 >> out_shift), 8);
+        *pOut2++ = (q7_t)__SSAT((sum2 >> out_shift), 8);
+        *pOut2++ = (q7_t)__SSAT((sum4 >> out_shift), 8);
+
+        pA += numCol_A;
+        rowCnt--;
+    }
+
+    /* left-over row because of odd ch_im_out */
+    if (ch_im_out & 0x1)
+    {
+        const q15_t *pB = pInBuffer;
+        const q15_t *pB2 = pB + numCol_A;
+
+        q31_t sum = ((q31_t)(*pBias) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum2 = ((q31_t)(*pBias++) << bias_shift) + NN_ROUND(out_shift);
+
+        uint16_t colCnt = numCol_A >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12;
+            q31_t inB1 = *__SIMD32(pB)++;
+            q31_t inB2 = *__SIMD32(pB2)++;
+
+            pA = (q7_t *)read_and_pad((void *)pA, &inA11, &inA12);
+
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+
+            colCnt--;
+        }
+        colCnt = numCol_A & 0x3;
+        while (colCnt)
+        {
+            q7_t inA1 = *pA++;
+            q15_t inB1 = *pB++;
+            q15_t inB2 = *pB2++;
+
+            sum += inA1 * inB1;
+            sum2 += inA1 * inB2;
+            colCnt--;
+        }
+
+        *pOut++ = (q7_t)__SSAT((sum >> out_shift), 8);
+        *pOut2++ = (q7_t)__SSAT((sum2 >> out_shift), 8);
+    }
+
+    pOut += ch_im_out;
+
+    return pOut;
+}
+
+q7_t *arm_nn_mat_mult_kernel_q7_q15_reordered(const q7_t *pA,
+                                              const q15_t *pInBuffer,
+                                              const uint16_t ch_im_out,
+                                              const uint16_t numCol_A,
+                                              const uint16_t bias_shift,
+                                              const uint16_t out_shift,
+                                              const q7_t *bias,
+                                              q7_t *pOut)
+{
+    q7_t *pOut2 = pOut + ch_im_out;
+    int i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pB = pInBuffer;
+        const q15_t *pB2 = pB + numCol_A;
+        const q7_t *pA2 = pA + numCol_A;
+
+        q31_t sum = ((q31_t)(bias[i]) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum2 = ((q31_t)(bias[i]) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum3 = ((q31_t)(bias[i + 1]) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum4 = ((q31_t)(bias[i + 1]) << bias_shift) + NN_ROUND(out_shift);
+
+        uint16_t colCnt = numCol_A >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12, inA21, inA22;
+            q31_t inB1 = *__SIMD32(pB)++;
+            q31_t inB2 = *__SIMD32(pB2)++;
+
+            pA = (q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+
+            sum = __SMLAD(inA11, inB1, sum);
+            sum2 = __SMLAD(inA11, inB2, sum2);
+            sum3 = __SMLAD(inA21, inB1, sum3);
+            sum4 = __SMLAD(inA21, inB2, sum4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+
+            sum = __SMLAD(inA12, inB1, sum);
+            sum2 = __SMLAD(inA12, inB2, sum2);
+            sum3 = __SMLAD(inA22, inB1, sum3);
+            sum4 = __SMLAD(inA22, inB2, sum4);
+
+            colCnt--;
+        }
+
+        *pOut++ = (q7_t)__SSAT((sum >> out_shift), 8);
+        *pOut++ = (q7_t)__SSAT((sum3 >> out_shift), 8);
+        *pOut2++ = (q7_t)__SSAT((sum2 >> out_shift), 8);
+        *pOut2++ = (q7_t)__SSAT((sum4 >> out_shift), 8);
+
+        pA += numCol_A;
+    }
+
+    pOut += ch_im_out;
+
+    return pOut;
+}
+
+arm_status arm_fully_connected_q7(const q7_t *pV,
+                                  const q7_t *pM,
+                                  const uint16_t dim_vec,
+                                  const uint16_t num_of_rows,
+                                  const uint16_t bias_shift,
+                                  const uint16_t out_shift,
+                                  const q7_t *bias,
+                                  q7_t *pOut,
+                                  q15_t *vec_buffer)
+{
+    const q7_t *pB = pM;
+    const q7_t *pB2;
+    q7_t *pO = pOut;
+    const q7_t *pBias = bias;
+    const q15_t *pA;
+    uint16_t rowCnt = num_of_rows >> 1;
+
+    /* expand the vector into the buffer */
+    arm_q7_to_q15_reordered_no_shift(pV, vec_buffer, dim_vec);
+
+    while (rowCnt)
+    {
+        q31_t sum = ((q31_t)(*pBias++) << bias_shift) + NN_ROUND(out_shift);
+        q31_t sum2 = ((q31_t)(*pBias++) << bias_shift) + NN_ROUND(out_shift);
+        uint16_t colCnt = dim_vec >> 2;
+
+        pA = vec_buffer;
+        pB2 = pB + dim_vec;
+
+        while (colCnt)
+        {
+            q31_t inV, inM11, inM12, inM21, inM22;
+            pB = (q7_t *)read_and_pad_reordered((void *)pB, &inM11, &inM12);
+            pB2 = (q7_t *)read_and_pad_reordered((void *)pB2, &inM21, &inM22);
+
+            inV = *__SIMD32(pA)++;
+
+            sum = __SMLAD(inV, inM11, sum);
+            sum2 = __SMLAD(inV, inM21, sum2);
+
+            inV = *__SIMD32(pA)++;
+
+            sum = __SMLAD(inV, inM12, sum);
+            sum2 = __SMLAD(inV, inM22, sum2);
+
+            colCnt--;
+        }
+        colCnt = dim_vec & 0x3;
+        while (colCnt)
+        {
+            q7_t inV = *pA++;
+            q15_t inM = *pB++;
+            q15_t inM2 = *pB2++;
+
+            sum += inV * inM;
+            sum2 += inV * inM2;
+            colCnt--;
+        }
+        *pO++ = (q7_t)(__SSAT((sum >> out_shift), 8));
+        *pO++ = (q7_t)(__SSAT((sum2 >> out_shift), 8));
+
+        /* adjust the pointers and counters */
+        pB += dim_vec;
+        rowCnt--;
+    }
+
+    /* left-over part of the rows */
+    rowCnt = num_of_rows & 0x1;
+
+    while (rowCnt)
+    {
+        uint16_t colCnt = dim_vec >> 2;
+        q31_t sum = ((q31_t)(*pBias++) << bias_shift) + NN_ROUND(out_shift);
+
+        pA = vec_buffer;
+
+        while (colCnt)
+        {
+            q31_t inV1, inV2, inM11, inM12;
+
+            pB = (q7_t *)read_and_pad_reordered((void *)pB, &inM11, &inM12);
+
+            inV1 = *__SIMD32(pA)++;
+            sum = __SMLAD(inV1, inM11, sum);
+
+            inV2 = *__SIMD32(pA)++;
+            sum = __SMLAD(inV2, inM12, sum);
+
+            colCnt--;
+        }
+
+        /* left-over of the vector */
+        colCnt = dim_vec & 0x3;
+        while (colCnt)
+        {
+            q7_t inV = *pA++;
+            q15_t inM = *pB++;
+            sum += inV * inM;
+            colCnt--;
+        }
+
+        *pO++ = (q7_t)(__SSAT((sum >> out_shift), 8));
+
+        rowCnt--;
+    }
+
+    return ARM_MATH_SUCCESS;
+}
+
+void arm_softmax_q7(const q7_t *vec_in, const uint16_t dim_vec, q7_t *p_out)
+{
+    q31_t sum;
+    int16_t i;
+    uint8_t shift;
+    q15_t base;
+    base = -128;
+
+    /* We first search for the maximum */
+    for (i = 0; i < dim_vec; i++)
+    {
+        if (vec_in[i] > base)
+        {
+            base = vec_in[i];
+        }
+    }
+
+    /*
+     * So the base is set to max-8, meaning
+     * that we ignore really small values.
+     * anyway, they will be 0 after shrinking to q7_t.
+     */
+    base = base - 8;
+
+    sum = 0;
+
+    for (i = 0; i < dim_vec; i++)
+    {
+        shift = (uint8_t)__USAT(vec_in[i] - base, 3);
+        sum += 0x1 << shift;
+    }
+
+    /* This is effectively (0x1 << 20) / sum */
+    int output_base = 0x100000 / sum;
+
+    /*
+     * Final confidence will be output_base >> ( 13 - (vec_in[i] - base) )
+     * so 128 (0x1<<7) -> 100% confidence when sum = 0x1 << 8, output_base = 0x1 << 12
+     * and vec_in[i]-base = 8
+     */
+    for (i = 0; i < dim_vec; i++)
+    {
+        /* Here minimum value of 13+base-vec_in[i] will be 5 */
+        shift = (uint8_t)__USAT(13 + base - vec_in[i], 5);
+        p_out[i] = (q7_t)__SSAT((output_base >> shift), 8);
+    }
+}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef NN_PORTABLE_H
+#define NN_PORTABLE_H
+
+/**
+ * @brief Host-portable replacement for the CMSIS headers used by the kernels
+ *
+ * @details
+ * Build with -DNN_PORTABLE to compile the kernels on a host without arm_math.h.
+ * Provides the q-types, the SIMD intrinsics and the CMSIS-NN support functions
+ * the kernels rely on, bit-exact with the Cortex-M4 instructions (little endian).
+ *
+ * The kernels access q7/q15 buffers through __SIMD32, so the host build needs
+ * -fno-strict-aliasing.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum
+{
+    ARM_MATH_SUCCESS = 0
+} arm_status;
+
+#define __SIMD32_TYPE int32_t
+#define __SIMD32(addr) (*(__SIMD32_TYPE **)&(addr))
+
+#ifndef ARM_NN_TRUNCATE
+#define NN_ROUND(out_shift) ((0x1u << out_shift) >> 1)
+#else
+#define NN_ROUND(out_shift) 0
+#endif
+
+union arm_nnword
+{
+    q31_t word;
+    q15_t half_words[2];
+    q7_t bytes[4];
+};
+
+static inline int32_t __SSAT(int32_t val, uint32_t sat)
+{
+    const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+    const int32_t min = -1 - max;
+    if (val > max)
+    {
+        return max;
+    }
+    if (val < min)
+    {
+        return min;
+    }
+    return val;
+}
+
+static inline uint32_t __USAT(int32_t val, uint32_t sat)
+{
+    const int32_t max = (int32_t)((1U << sat) - 1U);
+    if (val > max)
+    {
+        return (uint32_t)max;
+    }
+    if (val < 0)
+    {
+        return 0U;
+    }
+    return (uint32_t)val;
+}
+
+static inline uint32_t __ROR(uint32_t op1, uint32_t op2)
+{
+    op2 %= 32U;
+    if (op2 == 0U)
+    {
+        return op1;
+    }
+    return (op1 >> op2) | (op1 << (32U - op2));
+}
+
+static inline uint32_t __SXTB16(uint32_t op1)
+{
+    return ((uint32_t)(uint16_t)(int16_t)(int8_t)(op1)) |
+           ((uint32_t)(uint16_t)(int16_t)(int8_t)(op1 >> 16) << 16);
+}
+
+static inline int32_t __SMLAD(uint32_t op1, uint32_t op2, int32_t op3)
+{
+    int32_t p1 = (int32_t)(int16_t)op1 * (int32_t)(int16_t)op2;
+    int32_t p2 = (int32_t)(int16_t)(op1 >> 16) * (int32_t)(int16_t)(op2 >> 16);
+    /* wraps modulo 2^32 like the instruction */
+    return (int32_t)((uint32_t)op3 + (uint32_t)p1 + (uint32_t)p2);
+}
+
+static inline uint32_t __SHADD8(uint32_t op1, uint32_t op2)
+{
+    uint32_t res = 0;
+    int i;
+    for (i = 0; i < 32; i += 8)
+    {
+        int32_t s = ((int32_t)(int8_t)(op1 >> i) + (int32_t)(int8_t)(op2 >> i)) >> 1;
+        res |= ((uint32_t)s & 0xFFU) << i;
+    }
+    return res;
+}
+
+static inline uint32_t __SXTAB16(uint32_t op1, uint32_t op2)
+{
+    uint32_t lo = (uint32_t)(uint16_t)((int16_t)op1 + (int8_t)op2);
+    uint32_t hi = (uint32_t)(uint16_t)((int16_t)(op1 >> 16) + (int8_t)(op2 >> 16));
+    return lo | (hi << 16);
+}
+
+static inline uint32_t __SADD16(uint32_t op1, uint32_t op2)
+{
+    uint32_t lo = (uint32_t)(uint16_t)((int16_t)op1 + (int16_t)op2);
+    uint32_t hi = (uint32_t)(uint16_t)((int16_t)(op1 >> 16) + (int16_t)(op2 >> 16));
+    return lo | (hi << 16);
+}
+
+/*
+ * APSR.GE bits written by __SSUB8 and read by __SEL. APSR is per core, so the
+ * host copy is per thread: kernels running concurrently (nn_parallel.c) each
+ * see only their own __SSUB8. One copy per translation unit and thread. The
+ * host copy keeps each GE bit widened to a whole byte mask, so __SEL is a
+ * single blend.
+ */
+static inline uint32_t *nn_portable_ge(void)
+{
+    static _Thread_local uint32_t ge;
+    return &ge;
+}
+
+static inline uint32_t __SSUB8(uint32_t op1, uint32_t op2)
+{
+    // Bytewise op1 - op2 without borrows across bytes; GE where op1 >= op2 signed,
+    // that is op1 ^ 0x80 >= op2 ^ 0x80 unsigned: the borrow out of each byte
+    const uint32_t h = 0x80808080U;
+    uint32_t res = ((op1 | h) - (op2 & ~h)) ^ (~(op1 ^ op2) & h);
+    uint32_t a = op1 ^ h;
+    uint32_t b = op2 ^ h;
+    uint32_t low = (a | h) - (b & ~h);
+    uint32_t ge = ((a & ~b) | (~(a ^ b) & low)) & h;
+    *nn_portable_ge() = (ge >> 7) * 0xFFU;
+    return res;
+}
+
+static inline uint32_t __SEL(uint32_t op1, uint32_t op2)
+{
+    uint32_t mask = *nn_portable_ge();
+    return (op1 & mask) | (op2 & ~mask);
+}
+
+#define __PKHBT(ARG1, ARG2, ARG3) ((((uint32_t)(ARG1)) & 0x0000FFFFUL) | \
+                                   ((((uint32_t)(ARG2)) << (ARG3)) & 0xFFFF0000UL))
+#define __PKHTB(ARG1, ARG2, ARG3) ((((uint32_t)(ARG1)) & 0xFFFF0000UL) | \
+                                   ((((uint32_t)(ARG2)) >> (ARG3)) & 0x0000FFFFUL))
+
+/* CMSIS-NN support functions, see nn_portable.c */
+
+void arm_q7_to_q15_no_shift(const q7_t *pSrc, q15_t *pDst, uint32_t blockSize);
+
+void arm_q7_to_q15_reordered_no_shift(const q7_t *pSrc, q15_t *pDst, uint32_t blockSize);
+
+q7_t *arm_nn_mat_mult_kernel_q7_q15(const q7_t *pA,
+                                    const q15_t *pInBuffer,
+                                    const uint16_t ch_im_out,
+                                    const uint16_t numCol_A,
+                                    const uint16_t bias_shift,
+                                    const uint16_t out_shift,
+                                    const q7_t *bias,
+                                    q7_t *pOut);
+
+q7_t *arm_nn_mat_mult_kernel_q7_q15_reordered(const q7_t *pA,
+                                              const q15_t *pInBuffer,
+                                              const uint16_t ch_im_out,
+                                              const uint16_t numCol_A,
+                                              const uint16_t bias_shift,
+                                              const uint16_t out_shift,
+                                              const q7_t *bias,
+                                              q7_t *pOut);
+
+arm_status arm_fully_connected_q7(const q7_t *pV,
+                                  const q7_t *pM,
+                                  const uint16_t dim_vec,
+                                  const uint16_t num_of_rows,
+                                  const uint16_t bias_shift,
+                                  const uint16_t out_shift,
+                                  const q7_t *bias,
+                                  q7_t *pOut,
+                                  q15_t *vec_buffer);
+
+void arm_softmax_q7(const q7_t *vec_in, const uint16_t dim_vec, q7_t *p_out);
+
+static inline void *read_and_pad(void *source, q31_t *out1, q31_t *out2)
+{
+    q31_t inA = *__SIMD32(source)++;
+    q31_t inAbuf1 = __SXTB16(__ROR(inA, 8));
+    q31_t inAbuf2 = __SXTB16(inA);
+
+    *out2 = __PKHTB(inAbuf1, inAbuf2, 16);
+    *out1 = __PKHBT(inAbuf2, inAbuf1, 16);
+
+    return source;
+}
+
+static inline void *read_and_pad_reordered(void *source, q31_t *out1, q31_t *out2)
+{
+    q31_t inA = *__SIMD32(source)++;
+
+    *out2 = __SXTB16(__ROR(inA, 8));
+    *out1 = __SXTB16(inA);
+
+    return source;
+}
+
+#endif
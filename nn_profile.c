@@ -0,0 +1,274 @@
+#ifdef NN_PROFILE
+
+#include <stdio.h>
+#include "nn_functions.h"
+
+#ifdef NN_PORTABLE
+#include <time.h>
+
+#define PROFILE_UNIT "ns"
+typedef uint64_t profile_tick;
+
+static profile_tick profile_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#else
+
+#define PROFILE_UNIT "cycles"
+typedef uint32_t profile_tick;  // differences wrap correctly
+
+static profile_tick profile_now(void)
+{
+    return DWT->CYCCNT;
+}
+#endif
+
+static nn_profile_layer profile_rows[NN_PROFILE_MAX_LAYERS];
+static uint16_t profile_num_rows;
+static uint16_t profile_cursor;         // next row of this pass
+static nn_profile_layer *profile_row;   // open row, NULL if none or table full
+static uint16_t profile_depth;          // nested kernel calls
+static uint8_t profile_layer_open;
+static profile_tick profile_row_start;
+static profile_tick profile_copy_start;
+
+static void profile_open(const char *name)
+{
+    if (profile_cursor < NN_PROFILE_MAX_LAYERS)
+    {
+        profile_row = &profile_rows[profile_cursor++];
+        if (profile_cursor > profile_num_rows)
+        {
+            profile_num_rows = profile_cursor;
+        }
+        profile_row->name = name;
+        profile_row->calls++;
+    }
+    else
+    {
+        profile_row = NULL;
+    }
+    profile_row_start = profile_now();
+}
+
+static void profile_close(void)
+{
+    profile_tick now = profile_now();
+
+    if (profile_row)
+    {
+        profile_row->cycles += (profile_tick)(now - profile_row_start);
+        profile_row = NULL;
+    }
+}
+
+//x / y with 2 decimals, as x * 100 / y
+static uint32_t profile_ratio(const uint64_t x, const uint64_t y)
+{
+    return y ? (uint32_t)(x * 100 / y) : 0;
+}
+
+/**
+ * @brief Clear the table and start the cycle counter
+ */
+
+void nn_profile_reset(void)
+{
+#ifndef NN_PORTABLE
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    memset(profile_rows, 0, sizeof(profile_rows));
+    profile_num_rows = 0;
+    profile_row = NULL;
+    profile_depth = 0;
+    profile_layer_open = 0;
+    nn_profile_rewind();
+}
+
+/**
+ * @brief Start a new pass, its layers add to rows 0, 1, ... again
+ *
+ * @details
+ * Call before each inference so repeated runs of the same model accumulate
+ * into one row per layer, with calls counting the runs.
+ */
+
+void nn_profile_rewind(void)
+{
+    profile_cursor = 0;
+}
+
+/**
+ * @brief Profile rows
+ * @param[out]      num_layers  Number of rows
+ * @return          Row table, totals over all passes
+ */
+
+const nn_profile_layer *nn_profile_table(uint16_t *num_layers)
+{
+    *num_layers = profile_num_rows;
+    return profile_rows;
+}
+
+/**
+ * @brief Print the table, one line per layer plus the total
+ *
+ * @details
+ * Values per call, MACs per cycle (per ns on the host) and the share of the
+ * time spent filling bufferA/bufferB.
+ */
+
+void nn_profile_print(void)
+{
+    nn_profile_layer total;
+    uint16_t i;
+
+    memset(&total, 0, sizeof(total));
+    printf("layer %-20s %6s %12s %12s %9s %12s %7s %12s\n", "name", "calls", PROFILE_UNIT "/call", "MACs/call",
+           "MACs/" PROFILE_UNIT, "copied/call", "copy%", "written/call");
+
+    for (i = 0; i <= profile_num_rows; i++)
+    {
+        const nn_profile_layer *r = (i < profile_num_rows) ? &profile_rows[i] : &total;
+        uint32_t calls = r->calls ? r->calls : 1;
+        uint32_t mpc = profile_ratio(r->macs, r->cycles);
+        uint32_t copy = profile_ratio(r->copy_cycles * 10, r->cycles);
+
+        if (i < profile_num_rows)
+        {
+            printf("%5u %-20s %6lu ", i, r->name, (unsigned long)r->calls);
+            total.cycles += r->cycles / calls;
+            total.copy_cycles += r->copy_cycles / calls;
+            total.macs += r->macs / calls;
+            total.bytes_copied += r->bytes_copied / calls;
+            total.bytes_written += r->bytes_written / calls;
+        }
+        else
+        {
+            printf("%5s %-20s %6s ", "", "total", "");
+        }
+        printf("%12lu %12lu %6lu.%02lu %12lu %5lu.%lu %12lu\n", (unsigned long)(r->cycles / calls),
+               (unsigned long)(r->macs / calls), (unsigned long)(mpc / 100), (unsigned long)(mpc % 100),
+               (unsigned long)(r->bytes_copied / calls), (unsigned long)(copy / 10), (unsigned long)(copy % 10),
+               (unsigned long)(r->bytes_written / calls));
+    }
+}
+
+/**
+ * @brief Print the table as CSV with a header line, values per call
+ */
+
+void nn_profile_print_csv(void)
+{
+    uint16_t i;
+
+    printf("layer,name,calls," PROFILE_UNIT ",macs,macs_per_" PROFILE_UNIT ",copy_" PROFILE_UNIT
+           ",copy_pct,bytes_copied,bytes_written\n");
+    for (i = 0; i < profile_num_rows; i++)
+    {
+        const nn_profile_layer *r = &profile_rows[i];
+        uint32_t calls = r->calls ? r->calls : 1;
+        uint32_t mpc = profile_ratio(r->macs, r->cycles);
+        uint32_t copy = profile_ratio(r->copy_cycles * 10, r->cycles);
+
+        printf("%u,%s,%lu,%lu,%lu,%lu.%02lu,%lu,%lu.%lu,%lu,%lu\n", i, r->name, (unsigned long)r->calls,
+               (unsigned long)(r->cycles / calls), (unsigned long)(r->macs / calls),
+               (unsigned long)(mpc / 100), (unsigned long)(mpc % 100), (unsigned long)(r->copy_cycles / calls),
+               (unsigned long)(copy / 10), (unsigned long)(copy % 10), (unsigned long)(r->bytes_copied / calls),
+               (unsigned long)(r->bytes_written / calls));
+    }
+}
+
+/**
+ * @brief Kernel entry, opens a row if no kernel or layer has one open
+ * @param[in]       name    Kernel name, a string literal
+ */
+
+void nn_profile_begin(const char *name)
+{
+    if (profile_depth++ == 0 && !profile_layer_open)
+    {
+        profile_open(name);
+    }
+}
+
+/**
+ * @brief Kernel exit
+ * @param[in]       macs            MACs of the call
+ * @param[in]       bytes_written   Output bytes of the call
+ *
+ * @details
+ * The counts are only added for the outermost kernel, the ones of kernels it
+ * calls are part of them.
+ */
+
+void nn_profile_end(const uint64_t macs, const uint32_t bytes_written)
+{
+    if (--profile_depth == 0)
+    {
+        nn_profile_count(macs, bytes_written);
+        if (!profile_layer_open)
+        {
+            profile_close();
+        }
+    }
+}
+
+/**
+ * @brief Open the row of a layer, for executors running one layer with several kernel calls
+ * @param[in]       name    Layer op name, a string literal
+ */
+
+void nn_profile_layer_begin(const char *name)
+{
+    profile_layer_open = 1;
+    profile_open(name);
+}
+
+void nn_profile_layer_end(void)
+{
+    profile_close();
+    profile_layer_open = 0;
+}
+
+/**
+ * @brief Add MACs and output bytes computed outside a profiled kernel
+ */
+
+void nn_profile_count(const uint64_t macs, const uint32_t bytes_written)
+{
+    if (profile_row)
+    {
+        profile_row->macs += macs;
+        profile_row->bytes_written += bytes_written;
+    }
+}
+
+void nn_profile_copy_start(void)
+{
+    profile_copy_start = profile_now();
+}
+
+/**
+ * @brief End of a bufferA/bufferB fill started by nn_profile_copy_start
+ * @param[in]       bytes   Bytes written to the buffer
+ */
+
+void nn_profile_copy_stop(const uint32_t bytes)
+{
+    profile_tick now = profile_now();
+
+    if (profile_row)
+    {
+        profile_row->copy_cycles += (profile_tick)(now - profile_copy_start);
+        profile_row->bytes_copied += bytes;
+    }
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef NN_PROFILE_H
+#define NN_PROFILE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Per-layer cycle, MAC and copy profiling
+ *
+ * @details
+ * Build with -DNN_PROFILE to enable. Every kernel then records into a table
+ * with one row per layer:
+ *
+ * cycles:          DWT->CYCCNT cycles on target, nanoseconds on the host
+ *                  (-DNN_PORTABLE, clock_gettime).
+ * copy_cycles:     part of cycles spent filling bufferA/bufferB (im2col
+ *                  windows, widened weights and inputs).
+ * macs:            multiply-accumulates of the layer, padding taps included.
+ *                  Pools count one per window tap.
+ * bytes_copied:    bytes written to bufferA/bufferB.
+ * bytes_written:   output bytes.
+ *
+ * The outermost kernel call opens a row, unless nn_graph_run or nn_stream
+ * already opened one for the layer. Nested kernel calls add their time and
+ * copies to the open row, and only the outermost kernel counts MACs and
+ * output bytes.
+ *
+ * Without NN_PROFILE every hook is an empty macro, so nothing is compiled
+ * into the kernels. The table is global and not thread-safe: profile with
+ * nn_graph_run, not nn_parallel_run.
+ *
+ * Usage:
+ *   nn_profile_reset();
+ *   for each inference:
+ *       nn_profile_rewind();
+ *       nn_graph_run(&g, 0, num_layers - 1);
+ *   nn_profile_print();       // or nn_profile_print_csv()
+*/
+
+#ifdef NN_PROFILE
+
+#ifndef NN_PROFILE_MAX_LAYERS
+#define NN_PROFILE_MAX_LAYERS 64
+#endif
+
+typedef struct
+{
+    const char *name;       // kernel or layer op
+    uint32_t calls;         // passes that ran this row
+    uint64_t cycles;
+    uint64_t copy_cycles;
+    uint64_t macs;
+    uint64_t bytes_copied;
+    uint64_t bytes_written;
+} nn_profile_layer;
+
+void nn_profile_reset(void);
+
+void nn_profile_rewind(void);
+
+const nn_profile_layer *nn_profile_table(uint16_t *num_layers);
+
+void nn_profile_print(void);
+
+void nn_profile_print_csv(void);
+
+void nn_profile_begin(const char *name);
+
+void nn_profile_end(const uint64_t macs, const uint32_t bytes_written);
+
+void nn_profile_layer_begin(const char *name);
+
+void nn_profile_layer_end(void);
+
+void nn_profile_count(const uint64_t macs, const uint32_t bytes_written);
+
+void nn_profile_copy_start(void);
+
+void nn_profile_copy_stop(const uint32_t bytes);
+
+#define NN_PROFILE_BEGIN(name) nn_profile_begin(name)
+#define NN_PROFILE_END(macs, bytes_written) nn_profile_end(macs, bytes_written)
+#define NN_PROFILE_LAYER_BEGIN(name) nn_profile_layer_begin(name)
+#define NN_PROFILE_LAYER_END() nn_profile_layer_end()
+#define NN_PROFILE_COUNT(macs, bytes_written) nn_profile_count(macs, bytes_written)
+#define NN_PROFILE_COPY_START() nn_profile_copy_start()
+#define NN_PROFILE_COPY_STOP(bytes) nn_profile_copy_stop(bytes)
+
+#else
+
+#define NN_PROFILE_BEGIN(name)
+#define NN_PROFILE_END(macs, bytes_written)
+#define NN_PROFILE_LAYER_BEGIN(name)
+#define NN_PROFILE_LAYER_END()
+#define NN_PROFILE_COUNT(macs, bytes_written)
+#define NN_PROFILE_COPY_START()
+#define NN_PROFILE_COPY_STOP(bytes)
+
+#endif
+
+#endif
@@ -0,0 +1,313 @@
+#include "nn_stream.h"
+#include "nn_depthwise.h"
+
+#ifdef NN_PROFILE
+static const char *const op_names[] = {"stream_conv", "stream_depthwise", "stream_pointwise"};
+#endif
+
+static uint16_t layer_ch_out(const nn_stream_layer *l)
+{
+    return l->op == NN_STREAM_DEPTHWISE ? l->ch_im_in : l->ch_im_out;
+}
+
+static uint16_t layer_padding(const nn_stream_layer *l)
+{
+    return l->op == NN_STREAM_POINTWISE ? 0 : (l->dim_kernel - 1) >> 1;
+}
+
+static uint16_t tensor_ch(const nn_stream *s, const uint16_t tensor)
+{
+    return tensor < s->num_layers ? s->layers[tensor].ch_im_in : layer_ch_out(&s->layers[s->num_layers - 1]);
+}
+
+/*
+ * Kernel window of output pixel (x, r) to pBuffer as dim_kernel rows of
+ * dim_kernel * ch taps, zeros for the padding
+ */
+static void stream_window(const nn_stream *s,
+                          const uint16_t tensor,
+                          const uint16_t ch,
+                          const uint16_t dim_kernel,
+                          const int32_t x,
+                          const int32_t r,
+                          q7_t *pBuffer)
+{
+    int32_t padding = (dim_kernel - 1) >> 1;
+    int32_t kx_start = (x < padding) ? padding - x : 0;
+    int32_t kx_end = (x + dim_kernel - padding > s->dim_x) ? s->dim_x + padding - x : dim_kernel;
+    int32_t ky;
+
+    NN_PROFILE_COPY_START();
+    for (ky = 0; ky < dim_kernel; ky++)
+    {
+        int32_t iy = r + ky - padding;
+        if (iy < 0 || iy >= s->dim_y)
+        {
+            memset(pBuffer, 0, dim_kernel * ch);
+        }
+        else
+        {
+            memset(pBuffer, 0, kx_start * ch);
+            memcpy(pBuffer + kx_start * ch, nn_stream_row(s, tensor, iy) + (x - padding + kx_start) * ch,
+                   (kx_end - kx_start) * ch);
+            memset(pBuffer + kx_end * ch, 0, (dim_kernel - kx_end) * ch);
+        }
+        pBuffer += dim_kernel * ch;
+    }
+    NN_PROFILE_COPY_STOP(dim_kernel * dim_kernel * ch);
+}
+
+static void stream_conv_row(const nn_stream *s, const uint16_t i, const uint16_t r)
+{
+    const nn_stream_layer *l = &s->layers[i];
+    const nn_epilogue *epilogue = l->epilogue;
+    int32_t para_per_ch_out = l->dim_kernel * l->dim_kernel * l->ch_im_in;
+    q7_t *bufferA = (q7_t *)s->scratch;
+    q7_t *pOut = nn_stream_row(s, i + 1, r);
+    int32_t x;
+
+    //Resolve bias, shift and clamp as conv_HWC does
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, l->bias, l->bias_shift);
+
+    for (x = 0; x + 2 <= s->dim_x; x += 2)
+    {
+        stream_window(s, i, l->ch_im_in, l->dim_kernel, x, r, bufferA);
+        stream_window(s, i, l->ch_im_in, l->dim_kernel, x + 1, r, bufferA + para_per_ch_out);
+        conv_HWC_q7_block_2x2(bufferA, para_per_ch_out, l->wt, para_per_ch_out, l->ch_im_out, &ep,
+                              l->out_shift, pOut, l->ch_im_out);
+        pOut += 2 * l->ch_im_out;
+    }
+    if (s->dim_x & 0x1)
+    {
+        stream_window(s, i, l->ch_im_in, l->dim_kernel, x, r, bufferA);
+        conv_HWC_q7_block_1x2(bufferA, l->wt, para_per_ch_out, l->ch_im_out, &ep, l->out_shift, pOut);
+    }
+    NN_PROFILE_COUNT((uint64_t)s->dim_x * l->ch_im_out * para_per_ch_out, s->dim_x * l->ch_im_out);
+}
+
+static void stream_depthwise_row(const nn_stream *s, const uint16_t i, const uint16_t r)
+{
+    const nn_stream_layer *l = &s->layers[i];
+    uint16_t num_data_in_row = l->dim_kernel * l->ch_im_in;
+    q7_t *bufferA = (q7_t *)s->scratch;
+    q7_t *pOut = nn_stream_row(s, i + 1, r);
+    int full_3x3 = dw_full_3x3(l->dim_kernel, l->dim_kernel, l->ch_im_in);
+    int32_t x;
+
+    for (x = 0; x < s->dim_x; x++)
+    {
+        stream_window(s, i, l->ch_im_in, l->dim_kernel, x, r, bufferA);
+        if (full_3x3)
+        {
+            depthwise_pixel_3x3(bufferA, l->wt, l->ch_im_in, l->out_shift, l->epilogue, pOut);
+        }
+        else
+        {
+            depthwise_pixel(bufferA, l->wt, l->ch_im_in, l->dim_kernel, l->dim_kernel, num_data_in_row,
+                            l->out_shift, l->epilogue, pOut);
+        }
+        pOut += l->ch_im_in;
+    }
+    NN_PROFILE_COUNT((uint64_t)s->dim_x * l->ch_im_in * l->dim_kernel * l->dim_kernel, s->dim_x * l->ch_im_in);
+}
+
+static void stream_pointwise_row(const nn_stream *s, const uint16_t i, const uint16_t r)
+{
+    const nn_stream_layer *l = &s->layers[i];
+    q15_t *bufferA = (q15_t *)s->scratch;
+    const q7_t *pIn = nn_stream_row(s, i, r);
+    q7_t *pOut = nn_stream_row(s, i + 1, r);
+    int32_t x;
+
+    //A row is contiguous, two pixels per mat mult as in pointwise_conv_basic
+    for (x = 0; x + 2 <= s->dim_x; x += 2)
+    {
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_no_shift((q7_t *)pIn, bufferA, 2 * l->ch_im_in);
+        NN_PROFILE_COPY_STOP(2 * l->ch_im_in * 2);
+        if (l->epilogue)
+        {
+            pOut = nn_mat_mult_kernel_q7_q15_epilogue(l->wt, bufferA, l->ch_im_out, l->ch_im_in, l->bias_shift,
+                                                      l->out_shift, l->bias, l->epilogue, pOut);
+        }
+        else
+        {
+            pOut = arm_nn_mat_mult_kernel_q7_q15(l->wt, bufferA, l->ch_im_out, l->ch_im_in, l->bias_shift,
+                                                 l->out_shift, l->bias, pOut);
+        }
+        pIn += 2 * l->ch_im_in;
+    }
+    //The left-over pixel is counted by pointwise_conv_basic
+    NN_PROFILE_COUNT((uint64_t)(s->dim_x & ~0x1) * l->ch_im_in * l->ch_im_out, (s->dim_x & ~0x1) * l->ch_im_out);
+    if (s->dim_x & 0x1)
+    {
+        //Left-over pixel, a 1x1 image
+        pointwise_conv_basic_ep(pIn, 1, l->ch_im_in, l->wt, l->ch_im_out, l->bias, l->bias_shift, l->out_shift,
+                                pOut, bufferA, l->epilogue);
+    }
+}
+
+static void stream_layer_rows(const nn_stream *s, const uint16_t i, const uint16_t first, const uint16_t last)
+{
+    uint16_t r;
+
+    for (r = first; r < last; r++)
+    {
+        switch (s->layers[i].op)
+        {
+        case NN_STREAM_CONV:
+            stream_conv_row(s, i, r);
+            break;
+        case NN_STREAM_DEPTHWISE:
+            stream_depthwise_row(s, i, r);
+            break;
+        case NN_STREAM_POINTWISE:
+            stream_pointwise_row(s, i, r);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Bind a layer chain to its ring tensors
+ * @param[out]      s           Stream
+ * @param[in]       layers      Layer table, stride 1 'same' layers
+ * @param[in]       num_layers  Number of layers
+ * @param[in]       dim_x       Window width (e.g. MFCC coefficients), same for all tensors
+ * @param[in]       dim_y       Window height in rows (frames), same for all tensors
+ * @param[in,out]   tensors     num_layers + 1 tensors with data set, dim_y * dim_x * channels bytes each
+ * @param[in]       scratch     Largest nn_stream_scratch_size of the table, 4-byte aligned
+ */
+
+void nn_stream_init(nn_stream *s,
+                    const nn_stream_layer *layers,
+                    const uint16_t num_layers,
+                    const uint16_t dim_x,
+                    const uint16_t dim_y,
+                    nn_stream_tensor *tensors,
+                    void *scratch)
+{
+    uint16_t i;
+
+    s->layers = layers;
+    s->num_layers = num_layers;
+    s->dim_x = dim_x;
+    s->dim_y = dim_y;
+    s->tensors = tensors;
+    s->scratch = scratch;
+    s->rows_computed = 0;
+
+    for (i = 0; i <= num_layers; i++)
+    {
+        tensors[i].head = 0;
+    }
+}
+
+/**
+ * @brief Compute every row of every layer from the current input window
+ * @param[in,out]   s       Stream
+ */
+
+void nn_stream_run_full(nn_stream *s)
+{
+    uint16_t i;
+
+    for (i = 0; i < s->num_layers; i++)
+    {
+        NN_PROFILE_LAYER_BEGIN(op_names[s->layers[i].op]);
+        stream_layer_rows(s, i, 0, s->dim_y);
+        NN_PROFILE_LAYER_END();
+    }
+    s->rows_computed = (uint32_t)s->num_layers * s->dim_y;
+}
+
+/**
+ * @brief Slide the window by one frame and recompute the rows it changes
+ * @param[in,out]   s       Stream
+ * @param[in]       frame   New input row, dim_x * ch_im_in of layer 0
+ *
+ * @details
+ * Window row 0 is dropped and frame becomes row dim_y - 1. Per layer only
+ * top + bottom rows are computed, top = sum of the paddings of the layers so
+ * far, bottom = 1 + the same sum, instead of dim_y.
+ */
+
+void nn_stream_push(nn_stream *s, const q7_t *frame)
+{
+    uint16_t top = 0;
+    uint16_t bottom = 1;
+    uint16_t i;
+
+    //Slide every ring, the kept rows stay in place
+    for (i = 0; i <= s->num_layers; i++)
+    {
+        nn_stream_tensor *t = &s->tensors[i];
+        t->head = (t->head + 1 == s->dim_y) ? 0 : t->head + 1;
+    }
+    memcpy(nn_stream_row(s, 0, s->dim_y - 1), frame, s->dim_x * tensor_ch(s, 0));
+
+    s->rows_computed = 0;
+    for (i = 0; i < s->num_layers; i++)
+    {
+        uint16_t padding = layer_padding(&s->layers[i]);
+
+        top += padding;
+        bottom += padding;
+        NN_PROFILE_LAYER_BEGIN(op_names[s->layers[i].op]);
+        if (top + bottom >= s->dim_y)
+        {
+            top = s->dim_y;
+            bottom = 0;
+            stream_layer_rows(s, i, 0, s->dim_y);
+        }
+        else
+        {
+            stream_layer_rows(s, i, 0, top);
+            stream_layer_rows(s, i, s->dim_y - bottom, s->dim_y);
+        }
+        NN_PROFILE_LAYER_END();
+        s->rows_computed += top + bottom;
+    }
+}
+
+/**
+ * @brief Row of a tensor in window order
+ * @param[in]       s       Stream
+ * @param[in]       tensor  0 for the input, i + 1 for the output of layer i
+ * @param[in]       row     Window row, 0 is the oldest frame
+ * @return          dim_x * channels values
+ */
+
+q7_t *nn_stream_row(const nn_stream *s, const uint16_t tensor, const uint16_t row)
+{
+    uint32_t ring_row = s->tensors[tensor].head + row;
+
+    if (ring_row >= s->dim_y)
+    {
+        ring_row -= s->dim_y;
+    }
+    return s->tensors[tensor].data + ring_row * s->dim_x * tensor_ch(s, tensor);
+}
+
+/**
+ * @brief Scratch a streaming layer needs
+ * @param[in]       layer   Layer descriptor
+ * @return          Bytes of scratch
+ */
+
+uint32_t nn_stream_scratch_size(const nn_stream_layer *layer)
+{
+    uint32_t window = layer->dim_kernel * layer->dim_kernel * layer->ch_im_in;
+
+    switch (layer->op)
+    {
+    case NN_STREAM_CONV:
+        return 2 * window;
+    case NN_STREAM_DEPTHWISE:
+        return window;
+    case NN_STREAM_POINTWISE:
+        return 2 * layer->ch_im_in * 2; // *2 for q15
+    default:
+        return 0;
+    }
+}
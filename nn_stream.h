@@ -0,0 +1,88 @@
+#ifndef NN_STREAM_H
+#define NN_STREAM_H
+
+#include "nn_functions.h"
+
+/**
+ * @brief Streaming inference over a sliding window of time rows
+ *
+ * @details
+ * In keyword spotting the network input is a window of dim_y MFCC frames
+ * (rows) of dim_x coefficients, and each new frame slides the window by one
+ * row. Every tensor of the chain is kept as a ring of dim_y rows, so sliding
+ * only moves the ring head. For a stride-1 'same' layer, output row r of the
+ * new window is output row r + 1 of the previous window unless its kernel
+ * window reaches a changed input row or the zero padding. Each layer therefore
+ * recomputes only rows [0, top) and [dim_y - bottom, dim_y), where top and
+ * bottom are those of its input grown by the layer padding. The first layer
+ * starts from top = 0, bottom = 1 (the new frame).
+ *
+ * Results are bit-identical to running conv_HWC (conv_HWC_q7), depthwise_conv
+ * and pointwise_conv_basic/fast on the whole window.
+ *
+ * Usage:
+ *   nn_stream_init(&s, layers, num_layers, dim_x, dim_y, tensors, scratch);
+ *   memset(tensors[0].data, 0, dim_y * dim_x * ch_in);     // or a first window
+ *   nn_stream_run_full(&s);
+ *   for each new frame:
+ *       nn_stream_push(&s, frame);
+ *       output row r is nn_stream_row(&s, num_layers, r)
+ *
+ * nn_stream_run_full sets the state every nn_stream_push relies on, so it must
+ * run once before the first push and after any direct write to the tensors.
+*/
+
+typedef enum
+{
+    NN_STREAM_CONV,         // conv_HWC
+    NN_STREAM_DEPTHWISE,    // depthwise_conv
+    NN_STREAM_POINTWISE     // pointwise_conv_basic / pointwise_conv_fast
+} nn_stream_op;
+
+typedef struct
+{
+    nn_stream_op op;
+    uint16_t ch_im_in;
+    uint16_t ch_im_out;     // conv, pointwise
+    uint16_t dim_kernel;    // conv, depthwise, odd, 'same' padding of (dim_kernel - 1) / 2
+    const q7_t *wt;
+    const q7_t *bias;       // conv, pointwise
+    uint16_t bias_shift;
+    uint16_t out_shift;
+    const nn_epilogue *epilogue;    // may be NULL
+} nn_stream_layer;
+
+typedef struct
+{
+    q7_t *data;             // dim_y rows of dim_x * channels
+    uint16_t head;          // ring row holding window row 0
+} nn_stream_tensor;
+
+typedef struct
+{
+    const nn_stream_layer *layers;
+    uint16_t num_layers;
+    uint16_t dim_x;
+    uint16_t dim_y;
+    nn_stream_tensor *tensors;  // num_layers + 1, tensors[i] is the input of layer i
+    void *scratch;              // largest nn_stream_scratch_size, 4-byte aligned
+    uint32_t rows_computed;     // output rows computed by the last call, all layers
+} nn_stream;
+
+void nn_stream_init(nn_stream *s,
+                    const nn_stream_layer *layers,
+                    const uint16_t num_layers,
+                    const uint16_t dim_x,
+                    const uint16_t dim_y,
+                    nn_stream_tensor *tensors,
+                    void *scratch);
+
+void nn_stream_run_full(nn_stream *s);
+
+void nn_stream_push(nn_stream *s, const q7_t *frame);
+
+q7_t *nn_stream_row(const nn_stream *s, const uint16_t tensor, const uint16_t row);
+
+uint32_t nn_stream_scratch_size(const nn_stream_layer *layer);
+
+#endif
@@ -0,0 +1,496 @@
+#if defined(NN_PORTABLE) && defined(__SSE4_1__)
+
+#include <immintrin.h>
+#include "nn_functions.h"
+
+/**
+ * @brief x86 SSE4.1/AVX2 kernels for host-side evaluation
+ *
+ * @details
+ * Same parameters, buffers and output bytes as the Cortex-M4 kernels, for
+ * running deployed models over large data sets on a server. The device
+ * arithmetic is integer only: q7 x q7 products summed in 32 bits (wrapping,
+ * like __SMLAD), bias << bias_shift, the NN_ROUND of the kernel, >> out_shift,
+ * __SSAT to 8 bits and the epilogue clamp. The sums do not depend on the
+ * accumulation order, so the vector code only has to keep those steps, and
+ * requantizes with the same nn_requantize. __SHADD8 is a per-byte
+ * (a + b) >> 1 in 16-bit lanes.
+ *
+ * Built with -DNN_PORTABLE and -msse4.1 (128-bit vectors) or -mavx2
+ * (256-bit vectors).
+*/
+
+#ifdef __AVX2__
+
+#define X86_LANES 16
+typedef __m256i x86_vec;
+#define X86_ZERO() _mm256_setzero_si256()
+#define X86_LOAD_Q15(p) _mm256_loadu_si256((const __m256i *)(p))
+#define X86_LOAD_Q7(p) _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+#define X86_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define X86_MADD(a, b) _mm256_madd_epi16(a, b)
+#define X86_MULLO(a, b) _mm256_mullo_epi16(a, b)
+#define X86_ADD32(a, b) _mm256_add_epi32(a, b)
+#define X86_LO32(v) _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v))
+#define X86_HI32(v) _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1))
+
+static inline int32_t x86_hsum(const x86_vec v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+#else
+
+#define X86_LANES 8
+typedef __m128i x86_vec;
+#define X86_ZERO() _mm_setzero_si128()
+#define X86_LOAD_Q15(p) _mm_loadu_si128((const __m128i *)(p))
+#define X86_LOAD_Q7(p) _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(p)))
+#define X86_STORE(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define X86_MADD(a, b) _mm_madd_epi16(a, b)
+#define X86_MULLO(a, b) _mm_mullo_epi16(a, b)
+#define X86_ADD32(a, b) _mm_add_epi32(a, b)
+#define X86_LO32(v) _mm_cvtepi16_epi32(v)
+#define X86_HI32(v) _mm_cvtepi16_epi32(_mm_srli_si128(v, 8))
+
+static inline int32_t x86_hsum(const x86_vec v)
+{
+    __m128i s = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+#endif
+
+//8 q7 to 8 q15 lanes of a 128-bit vector
+#define X86_LOAD8_Q7(p) _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i *)(p)))
+
+/*
+ * q7 to q15, same values as arm_q7_to_q15_no_shift
+ */
+static void x86_q7_to_q15(const q7_t *pSrc, q15_t *pDst, const uint32_t blockSize)
+{
+    uint32_t i;
+
+    for (i = 0; i + X86_LANES <= blockSize; i += X86_LANES)
+    {
+        X86_STORE(pDst + i, X86_LOAD_Q7(pSrc + i));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i];
+    }
+}
+
+/*
+ * Four dot products of pIn with 4 q15 weight rows para_per_ch_out apart
+ */
+static void x86_dot4_q15(const q15_t *pIn, const q15_t *pW, const int32_t para_per_ch_out, q31_t *sums)
+{
+    const q15_t *pW2 = pW + para_per_ch_out;
+    const q15_t *pW3 = pW2 + para_per_ch_out;
+    const q15_t *pW4 = pW3 + para_per_ch_out;
+    x86_vec acc1 = X86_ZERO(), acc2 = X86_ZERO(), acc3 = X86_ZERO(), acc4 = X86_ZERO();
+    int32_t i;
+
+    for (i = 0; i + X86_LANES <= para_per_ch_out; i += X86_LANES)
+    {
+        x86_vec in = X86_LOAD_Q15(pIn + i);
+        acc1 = X86_ADD32(acc1, X86_MADD(in, X86_LOAD_Q15(pW + i)));
+        acc2 = X86_ADD32(acc2, X86_MADD(in, X86_LOAD_Q15(pW2 + i)));
+        acc3 = X86_ADD32(acc3, X86_MADD(in, X86_LOAD_Q15(pW3 + i)));
+        acc4 = X86_ADD32(acc4, X86_MADD(in, X86_LOAD_Q15(pW4 + i)));
+    }
+    sums[0] += x86_hsum(acc1);
+    sums[1] += x86_hsum(acc2);
+    sums[2] += x86_hsum(acc3);
+    sums[3] += x86_hsum(acc4);
+    for (; i < para_per_ch_out; i++)
+    {
+        sums[0] += pIn[i] * pW[i];
+        sums[1] += pIn[i] * pW2[i];
+        sums[2] += pIn[i] * pW3[i];
+        sums[3] += pIn[i] * pW4[i];
+    }
+}
+
+static q31_t x86_dot_q15(const q15_t *pIn, const q15_t *pW, const int32_t num)
+{
+    x86_vec acc = X86_ZERO();
+    q31_t sum;
+    int32_t i;
+
+    for (i = 0; i + X86_LANES <= num; i += X86_LANES)
+    {
+        acc = X86_ADD32(acc, X86_MADD(X86_LOAD_Q15(pIn + i), X86_LOAD_Q15(pW + i)));
+    }
+    sum = x86_hsum(acc);
+    for (; i < num; i++)
+    {
+        sum += pIn[i] * pW[i];
+    }
+    return sum;
+}
+
+/*
+ * Dot products of one q15 pixel with ch_im_out q7 weight rows of num q7 each,
+ * added to sums
+ */
+static void x86_dot_q7_rows(const q15_t *pIn, const q7_t *wt, const uint16_t ch_im_out, const int32_t num, q31_t *sums)
+{
+    uint16_t c = 0;
+
+    for (; c + 4 <= ch_im_out; c += 4)
+    {
+        const q7_t *pW = wt + c * num;
+        x86_vec acc1 = X86_ZERO(), acc2 = X86_ZERO(), acc3 = X86_ZERO(), acc4 = X86_ZERO();
+        int32_t i;
+
+        for (i = 0; i + X86_LANES <= num; i += X86_LANES)
+        {
+            x86_vec in = X86_LOAD_Q15(pIn + i);
+            acc1 = X86_ADD32(acc1, X86_MADD(in, X86_LOAD_Q7(pW + i)));
+            acc2 = X86_ADD32(acc2, X86_MADD(in, X86_LOAD_Q7(pW + num + i)));
+            acc3 = X86_ADD32(acc3, X86_MADD(in, X86_LOAD_Q7(pW + 2 * num + i)));
+            acc4 = X86_ADD32(acc4, X86_MADD(in, X86_LOAD_Q7(pW + 3 * num + i)));
+        }
+        sums[c] += x86_hsum(acc1);
+        sums[c + 1] += x86_hsum(acc2);
+        sums[c + 2] += x86_hsum(acc3);
+        sums[c + 3] += x86_hsum(acc4);
+        for (; i < num; i++)
+        {
+            sums[c] += pIn[i] * pW[i];
+            sums[c + 1] += pIn[i] * pW[num + i];
+            sums[c + 2] += pIn[i] * pW[2 * num + i];
+            sums[c + 3] += pIn[i] * pW[3 * num + i];
+        }
+    }
+    for (; c < ch_im_out; c++)
+    {
+        const q7_t *pW = wt + c * num;
+        int32_t i;
+
+        for (i = 0; i < num; i++)
+        {
+            sums[c] += pIn[i] * pW[i];
+        }
+    }
+}
+
+/**
+ * @brief conv_HWC for x86, bit-exact
+ * @details
+ * Parameters, buffer sizes and output as conv_HWC_ep. The weights are widened to
+ * bufferB, and the window of each output pixel to the start of bufferA, then
+ * 4 output channels share every input vector.
+ *
+ * Constrains:
+ * 1. Square input
+ */
+
+void conv_HWC_x86(const q7_t *Im_in,
+                  const uint16_t dim_im_in,
+                  const uint16_t ch_im_in,
+                  const q7_t *wt,
+                  const uint16_t ch_im_out,
+                  const uint16_t dim_kernel,
+                  const uint16_t padding,
+                  const q7_t *bias,
+                  const uint16_t bias_shift,
+                  const uint16_t out_shift,
+                  q7_t *Im_out,
+                  q15_t *bufferA,
+                  q15_t *bufferB,
+                  const nn_epilogue *epilogue)
+{
+    int32_t para_per_ch_out = dim_kernel * dim_kernel * ch_im_in;
+    uint32_t num_data_in_row = dim_kernel * ch_im_in;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    q7_t *pOut = Im_out;
+    int32_t x, y, ky;
+
+    NN_PROFILE_BEGIN("conv_HWC_x86");
+    NN_PROFILE_COPY_START();
+    x86_q7_to_q15(wt, bufferB, para_per_ch_out * ch_im_out);
+    NN_PROFILE_COPY_STOP(para_per_ch_out * ch_im_out * 2);
+
+    for (y = 0; y < dim_im_in; y++)
+    {
+        for (x = 0; x < dim_im_in; x++)
+        {
+            //Kernel columns inside the image, the rest of the window is zero
+            int32_t kx_start = (x < padding) ? padding - x : 0;
+            int32_t kx_end = (x + dim_kernel - padding > dim_im_in) ? dim_im_in + padding - x : dim_kernel;
+            q15_t *pBuffer = bufferA;
+            uint16_t c;
+
+            NN_PROFILE_COPY_START();
+            for (ky = 0; ky < dim_kernel; ky++)
+            {
+                int32_t iy = y + ky - padding;
+                if (iy < 0 || iy >= dim_im_in)
+                {
+                    memset(pBuffer, 0, num_data_in_row * 2);
+                }
+                else
+                {
+                    memset(pBuffer, 0, kx_start * ch_im_in * 2);
+                    x86_q7_to_q15(Im_in + (iy * dim_im_in + x - padding + kx_start) * ch_im_in,
+                                  pBuffer + kx_start * ch_im_in, (kx_end - kx_start) * ch_im_in);
+                    memset(pBuffer + kx_end * ch_im_in, 0, (dim_kernel - kx_end) * ch_im_in * 2);
+                }
+                pBuffer += num_data_in_row;
+            }
+            NN_PROFILE_COPY_STOP(para_per_ch_out * 2);
+
+            for (c = 0; c < ch_im_out; c += 4)
+            {
+                q31_t sums[4];
+                uint16_t n = (ch_im_out - c < 4) ? ch_im_out - c : 4;
+                uint16_t i;
+
+                for (i = 0; i < n; i++)
+                {
+                    sums[i] = (q31_t)pBias[c + i] << b_shift;
+                }
+                if (n == 4)
+                {
+                    x86_dot4_q15(bufferA, bufferB + c * para_per_ch_out, para_per_ch_out, sums);
+                }
+                else
+                {
+                    for (i = 0; i < n; i++)
+                    {
+                        sums[i] += x86_dot_q15(bufferA, bufferB + (c + i) * para_per_ch_out, para_per_ch_out);
+                    }
+                }
+                for (i = 0; i < n; i++)
+                {
+                    *pOut++ = nn_requantize(sums[i], pShift ? pShift[c + i] : out_shift, act_min, act_max);
+                }
+            }
+        }
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_out * para_per_ch_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief depthwise_conv for x86, bit-exact
+ * @details
+ * Parameters, buffer size and output as depthwise_conv_ep, bufferA is not used.
+ * Channels run X86_LANES at a time over the taps inside the image, products in
+ * 16 bits (|q7 x q7| <= 16384) added to 32-bit sums.
+ *
+ * Constrains:
+ * 1. Square input
+ */
+
+void depthwise_conv_x86(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const q7_t *wt,
+                        const uint16_t dim_kernel,
+                        const uint16_t padding,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q7_t *bufferA,
+                        const nn_epilogue *epilogue)
+{
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, NULL, 0);
+    const q7_t *pBias = ep.bias;
+    uint16_t bias_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    q7_t *pOut = Im_out;
+    int32_t x, y, kx, ky;
+
+    (void)bufferA;
+
+    NN_PROFILE_BEGIN("depthwise_conv_x86");
+    for (y = 0; y < dim_im_in; y++)
+    {
+        int32_t ky_start = (y < padding) ? padding - y : 0;
+        int32_t ky_end = (y + dim_kernel - padding > dim_im_in) ? dim_im_in + padding - y : dim_kernel;
+
+        for (x = 0; x < dim_im_in; x++)
+        {
+            int32_t kx_start = (x < padding) ? padding - x : 0;
+            int32_t kx_end = (x + dim_kernel - padding > dim_im_in) ? dim_im_in + padding - x : dim_kernel;
+            int32_t base = ((y - padding) * dim_im_in + x - padding) * ch_im_in;
+            int32_t ch = 0;
+
+            for (; ch + X86_LANES <= ch_im_in; ch += X86_LANES)
+            {
+                q31_t sums[X86_LANES];
+                x86_vec lo = X86_ZERO(), hi = X86_ZERO();
+                int32_t i;
+
+                for (ky = ky_start; ky < ky_end; ky++)
+                {
+                    for (kx = kx_start; kx < kx_end; kx++)
+                    {
+                        int32_t tap = base + (ky * dim_im_in + kx) * ch_im_in + ch;
+                        x86_vec prod = X86_MULLO(X86_LOAD_Q7(Im_in + tap),
+                                                 X86_LOAD_Q7(wt + (ky * dim_kernel + kx) * ch_im_in + ch));
+                        lo = X86_ADD32(lo, X86_LO32(prod));
+                        hi = X86_ADD32(hi, X86_HI32(prod));
+                    }
+                }
+                X86_STORE(sums, lo);
+                X86_STORE(sums + X86_LANES / 2, hi);
+                for (i = 0; i < X86_LANES; i++)
+                {
+                    q31_t sum = sums[i] + (pBias ? (q31_t)pBias[ch + i] << bias_shift : 0);
+                    *pOut++ = nn_requantize(sum, pShift ? pShift[ch + i] : out_shift, act_min, act_max);
+                }
+            }
+            for (; ch < ch_im_in; ch++)
+            {
+                q31_t sum = pBias ? (q31_t)pBias[ch] << bias_shift : 0;
+
+                for (ky = ky_start; ky < ky_end; ky++)
+                {
+                    for (kx = kx_start; kx < kx_end; kx++)
+                    {
+                        sum += Im_in[base + (ky * dim_im_in + kx) * ch_im_in + ch]
+                               * wt[(ky * dim_kernel + kx) * ch_im_in + ch];
+                    }
+                }
+                *pOut++ = nn_requantize(sum, pShift ? pShift[ch] : out_shift, act_min, act_max);
+            }
+        }
+    }
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * dim_kernel * dim_kernel,
+                   dim_im_in * dim_im_in * ch_im_in);
+}
+
+/**
+ * @brief pointwise_conv_fast for x86, bit-exact
+ * @details
+ * Parameters, buffer size and output as pointwise_conv_fast_ep, including its
+ * NN_ROUND. The weights are the same (reordered) array: the device reorders
+ * the input the same way, so each product pairs wt[c][i] with Im_in[i] and
+ * the x86 code reads both in plain order. Each pixel is widened to bufferA
+ * and 4 output channels share every input vector.
+ *
+ * Constraints:
+ *   Square input.
+ */
+
+void pointwise_conv_fast_x86(const q7_t *Im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             const q7_t *wt,
+                             const uint16_t ch_im_out,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             const nn_epilogue *epilogue)
+{
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    uint32_t num_pixels = dim_im_in * dim_im_in;
+    q7_t *pOut = Im_out;
+    q31_t sums[64];
+    uint32_t p;
+
+    NN_PROFILE_BEGIN("pointwise_conv_fast_x86");
+    for (p = 0; p < num_pixels; p++)
+    {
+        uint16_t c_start;
+
+        NN_PROFILE_COPY_START();
+        x86_q7_to_q15(Im_in + p * ch_im_in, bufferA, ch_im_in);
+        NN_PROFILE_COPY_STOP(ch_im_in * 2);
+
+        //Output channels in blocks of 64 sums
+        for (c_start = 0; c_start < ch_im_out; c_start += 64)
+        {
+            uint16_t n = (ch_im_out - c_start < 64) ? ch_im_out - c_start : 64;
+            uint16_t c;
+
+            for (c = 0; c < n; c++)
+            {
+                uint16_t shift = pShift ? pShift[c_start + c] : out_shift;
+                sums[c] = ((q31_t)pBias[c_start + c] << b_shift) + NN_ROUND(shift);
+            }
+            x86_dot_q7_rows(bufferA, wt + c_start * ch_im_in, n, ch_im_in, sums);
+            for (c = 0; c < n; c++)
+            {
+                *pOut++ = nn_requantize(sums[c], pShift ? pShift[c_start + c] : out_shift, act_min, act_max);
+            }
+        }
+    }
+    NN_PROFILE_END((uint64_t)num_pixels * ch_im_in * ch_im_out, num_pixels * ch_im_out);
+}
+
+/**
+ * @brief avg_pool_q7_HWC_opt for x86, bit-exact
+ * @details
+ * Parameters and output as avg_pool_q7_HWC_opt: each output byte is
+ * SHADD8(SHADD8(in[2y+1][2x], in[2y+1][2x+1]), SHADD8(in[2y][2x], in[2y][2x+1])),
+ * for the first ch_im_in & ~3 channels of every pixel, with the same output
+ * packing. In place as the original.
+ *
+ * Constrains:
+ * 1. Square input
+ * 2. Kernel size is 2.
+ */
+
+void avg_pool_q7_HWC_opt_x86(q7_t *im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             q7_t *im_out)
+{
+    uint32_t ch = ch_im_in & ~0x3U;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    q7_t *pDst = im_out;
+    uint32_t y, x;
+
+    NN_PROFILE_BEGIN("avg_pool_q7_HWC_opt_x86");
+    for (y = 0; y + 2 <= dim_im_in; y += 2)
+    {
+        for (x = 0; x + 2 <= dim_im_in; x += 2)
+        {
+            const q7_t *pSrc1_1 = im_in + y * num_data_in_im_row + x * ch_im_in;
+            const q7_t *pSrc1_2 = pSrc1_1 + ch_im_in;
+            const q7_t *pSrc2_1 = pSrc1_1 + num_data_in_im_row;
+            const q7_t *pSrc2_2 = pSrc2_1 + ch_im_in;
+            uint32_t i = 0;
+
+            for (; i + 8 <= ch; i += 8)
+            {
+                __m128i out = _mm_srai_epi16(_mm_add_epi16(X86_LOAD8_Q7(pSrc1_1 + i), X86_LOAD8_Q7(pSrc1_2 + i)), 1);
+                __m128i in = _mm_srai_epi16(_mm_add_epi16(X86_LOAD8_Q7(pSrc2_1 + i), X86_LOAD8_Q7(pSrc2_2 + i)), 1);
+                out = _mm_srai_epi16(_mm_add_epi16(in, out), 1);
+                _mm_storel_epi64((__m128i *)(pDst + i), _mm_packs_epi16(out, out));
+            }
+            for (; i < ch; i++)
+            {
+                int32_t out = (pSrc1_1[i] + pSrc1_2[i]) >> 1;
+                int32_t in = (pSrc2_1[i] + pSrc2_2[i]) >> 1;
+                pDst[i] = (q7_t)((in + out) >> 1);
+            }
+            pDst += ch;
+        }
+    }
+    NN_PROFILE_END((uint64_t)(dim_im_in >> 1) * (dim_im_in >> 1) * ch * 4, (dim_im_in >> 1) * (dim_im_in >> 1) * ch);
+}
+
+#endif
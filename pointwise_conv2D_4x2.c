@@ -0,0 +1,311 @@
+#include "nn_functions.h"
+
+/*
+ * 4 pixels x 2 output channels per inner loop. The 4 reordered q15 columns are
+ * ch_im_in apart in bufferA, each pair of weight rows is read once for all 4.
+ */
+static q7_t *pointwise_block_4x2(const q7_t *wt,
+                                 const q15_t *bufferA,
+                                 const uint16_t ch_im_in,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *pBias,
+                                 const uint16_t b_shift,
+                                 const uint16_t out_shift,
+                                 const uint8_t *pShift,
+                                 const q7_t act_min,
+                                 const q7_t act_max,
+                                 q7_t *pOut)
+{
+    const q7_t *pA = wt;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q7_t *pA2 = pA + ch_im_in;
+        const q15_t *pB0 = bufferA;
+        const q15_t *pB1 = pB0 + ch_im_in;
+        const q15_t *pB2 = pB1 + ch_im_in;
+        const q15_t *pB3 = pB2 + ch_im_in;
+        uint16_t shift = pShift ? pShift[i] : out_shift;
+        uint16_t shift2 = pShift ? pShift[i + 1] : out_shift;
+
+        //sumCP: output channel i + C of pixel P
+        q31_t sum00 = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        q31_t sum01 = sum00;
+        q31_t sum02 = sum00;
+        q31_t sum03 = sum00;
+        q31_t sum10 = ((q31_t)pBias[i + 1] << b_shift) + NN_ROUND(shift2);
+        q31_t sum11 = sum10;
+        q31_t sum12 = sum10;
+        q31_t sum13 = sum10;
+
+        uint16_t colCnt = ch_im_in >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12, inA21, inA22;
+            q31_t inB;
+
+            pA = (const q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (const q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+
+            inB = *__SIMD32(pB0)++;
+            sum00 = __SMLAD(inA11, inB, sum00);
+            sum10 = __SMLAD(inA21, inB, sum10);
+            inB = *__SIMD32(pB1)++;
+            sum01 = __SMLAD(inA11, inB, sum01);
+            sum11 = __SMLAD(inA21, inB, sum11);
+            inB = *__SIMD32(pB2)++;
+            sum02 = __SMLAD(inA11, inB, sum02);
+            sum12 = __SMLAD(inA21, inB, sum12);
+            inB = *__SIMD32(pB3)++;
+            sum03 = __SMLAD(inA11, inB, sum03);
+            sum13 = __SMLAD(inA21, inB, sum13);
+
+            inB = *__SIMD32(pB0)++;
+            sum00 = __SMLAD(inA12, inB, sum00);
+            sum10 = __SMLAD(inA22, inB, sum10);
+            inB = *__SIMD32(pB1)++;
+            sum01 = __SMLAD(inA12, inB, sum01);
+            sum11 = __SMLAD(inA22, inB, sum11);
+            inB = *__SIMD32(pB2)++;
+            sum02 = __SMLAD(inA12, inB, sum02);
+            sum12 = __SMLAD(inA22, inB, sum12);
+            inB = *__SIMD32(pB3)++;
+            sum03 = __SMLAD(inA12, inB, sum03);
+            sum13 = __SMLAD(inA22, inB, sum13);
+
+            colCnt--;
+        }
+
+        pOut[i] = nn_requantize(sum00, shift, act_min, act_max);
+        pOut[i + 1] = nn_requantize(sum10, shift2, act_min, act_max);
+        pOut[ch_im_out + i] = nn_requantize(sum01, shift, act_min, act_max);
+        pOut[ch_im_out + i + 1] = nn_requantize(sum11, shift2, act_min, act_max);
+        pOut[2 * ch_im_out + i] = nn_requantize(sum02, shift, act_min, act_max);
+        pOut[2 * ch_im_out + i + 1] = nn_requantize(sum12, shift2, act_min, act_max);
+        pOut[3 * ch_im_out + i] = nn_requantize(sum03, shift, act_min, act_max);
+        pOut[3 * ch_im_out + i + 1] = nn_requantize(sum13, shift2, act_min, act_max);
+
+        /* skip the row computed with A2 */
+        pA += ch_im_in;
+    }
+
+    return pOut + 4 * ch_im_out;
+}
+
+/*
+ * Single-pixel tail, 2 output channels per loop so each column word feeds two __SMLAD
+ */
+static q7_t *pointwise_block_1x2(const q7_t *wt,
+                                 const q15_t *pColumn,
+                                 const uint16_t ch_im_in,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *pBias,
+                                 const uint16_t b_shift,
+                                 const uint16_t out_shift,
+                                 const uint8_t *pShift,
+                                 const q7_t act_min,
+                                 const q7_t act_max,
+                                 q7_t *pOut)
+{
+    const q7_t *pA = wt;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q7_t *pA2 = pA + ch_im_in;
+        const q15_t *pB = pColumn;
+        uint16_t shift = pShift ? pShift[i] : out_shift;
+        uint16_t shift2 = pShift ? pShift[i + 1] : out_shift;
+        q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        q31_t sum2 = ((q31_t)pBias[i + 1] << b_shift) + NN_ROUND(shift2);
+
+        uint16_t colCnt = ch_im_in >> 2;
+        while (colCnt)
+        {
+            q31_t inA11, inA12, inA21, inA22;
+            q31_t inB;
+
+            pA = (const q7_t *)read_and_pad_reordered((void *)pA, &inA11, &inA12);
+            pA2 = (const q7_t *)read_and_pad_reordered((void *)pA2, &inA21, &inA22);
+
+            inB = *__SIMD32(pB)++;
+            sum = __SMLAD(inA11, inB, sum);
+            sum2 = __SMLAD(inA21, inB, sum2);
+            inB = *__SIMD32(pB)++;
+            sum = __SMLAD(inA12, inB, sum);
+            sum2 = __SMLAD(inA22, inB, sum2);
+
+            colCnt--;
+        }
+
+        *pOut++ = nn_requantize(sum, shift, act_min, act_max);
+        *pOut++ = nn_requantize(sum2, shift2, act_min, act_max);
+
+        /* skip the row computed with A2 */
+        pA += ch_im_in;
+    }
+
+    return pOut;
+}
+
+/**
+ * @brief Q7 pointwise (1x1) convolution, 4 pixels x 2 output channels per inner loop
+ * @param[in]       Im_in        pointer to input tensor
+ * @param[in]       dim_im_in    input tensor dimention
+ * @param[in]       ch_im_in     number of input tensor channels
+ * @param[in]       wt           pointer to kernel weights
+ * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
+ * @param[in]       bias         pointer to bias
+ * @param[in]       bias_shift   amount of left-shift for bias
+ * @param[in]       out_shift    amount of right-shift for output
+ * @param[in,out]   Im_out       pointer to output tensor
+ * @param[in,out]   bufferA      pointer to buffer space for input
+ *
+ * @details
+ * Same arguments, weights and output as pointwise_conv_fast. Pixels are
+ * widened 4 at a time into bufferA and each pair of weight rows is read once
+ * per 4 pixels instead of once per 2, which halves the weight reads from
+ * flash. 8 accumulators stay in registers for the whole ch_im_in loop.
+ *
+ * The last 1 to 3 pixels run as a 2-pixel block with the kernel of
+ * pointwise_conv_fast (unrolled for ch_im_in 64, 128, 172 and 276) and/or a
+ * 1-pixel x 2-channel block, both with __SMLAD, so an odd pixel count has no
+ * scalar loop.
+ *
+ * Size of bufferA: 4 * ch_im_in
+ *
+ * Constraints:
+ *   Square input.
+ *   ch_im_in is multiple of 4
+ *   ch_im_out is multiple of 2
+ *
+ */
+
+void pointwise_conv_4x2(const q7_t *Im_in,
+                        const uint16_t dim_im_in,
+                        const uint16_t ch_im_in,
+                        const q7_t *wt,
+                        const uint16_t ch_im_out,
+                        const q7_t *bias,
+                        const uint16_t bias_shift,
+                        const uint16_t out_shift,
+                        q7_t *Im_out,
+                        q15_t *bufferA)
+{
+    pointwise_conv_4x2_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out, bufferA,
+                          NULL);
+}
+
+/**
+ * @brief pointwise_conv_4x2 with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_4x2. A NULL epilogue gives the same output as
+ * pointwise_conv_4x2.
+ */
+
+void pointwise_conv_4x2_ep(const q7_t *Im_in,
+                           const uint16_t dim_im_in,
+                           const uint16_t ch_im_in,
+                           const q7_t *wt,
+                           const uint16_t ch_im_out,
+                           const q7_t *bias,
+                           const uint16_t bias_shift,
+                           const uint16_t out_shift,
+                           q7_t *Im_out,
+                           q15_t *bufferA,
+                           const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("pointwise_conv_4x2");
+    pointwise_conv_4x2_pixels(Im_in, dim_im_in * dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift,
+                              Im_out, bufferA, epilogue);
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * ch_im_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief pointwise_conv_4x2 over num_pixels consecutive HWC pixels
+ * @param[in]       num_pixels   number of pixels in Im_in
+ *
+ * @details
+ * Other parameters as pointwise_conv_4x2_ep. The pixels need not be one image:
+ * pointwise_conv_fast_batch runs the inputs of a batch as one pixel run.
+ */
+
+void pointwise_conv_4x2_pixels(const q7_t *Im_in,
+                               const uint32_t num_pixels,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t ch_im_out,
+                               const q7_t *bias,
+                               const uint16_t bias_shift,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q15_t *bufferA,
+                               const nn_epilogue *epilogue)
+{
+    uint32_t i_pixel;
+    q15_t *pBuffer = bufferA;
+    q7_t *pOut = Im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+
+    for (i_pixel = 0; i_pixel < num_pixels; i_pixel++)
+    {
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + i_pixel * ch_im_in, pBuffer, ch_im_in);
+        NN_PROFILE_COPY_STOP(ch_im_in * 2);
+        pBuffer += ch_im_in;
+
+        if (pBuffer == bufferA + 4 * ch_im_in)
+        {
+            pOut = pointwise_block_4x2(wt, bufferA, ch_im_in, ch_im_out, pBias, b_shift, out_shift, pShift,
+                                       act_min, act_max, pOut);
+            pBuffer = bufferA;
+        }
+    }
+
+    /* 2-pixel tail */
+    if (pBuffer >= bufferA + 2 * ch_im_in)
+    {
+        nn_mat_mult_fixed_fn fixed = nn_mat_mult_kernel_q7_q15_reordered_fixed(ch_im_in);
+
+        if (fixed)
+        {
+            pOut = fixed(wt, bufferA, ch_im_out, bias_shift, out_shift, bias, epilogue, pOut);
+        }
+        else if (epilogue)
+        {
+            pOut = nn_mat_mult_kernel_q7_q15_reordered_epilogue(wt, bufferA, ch_im_out, ch_im_in, bias_shift,
+                                                                out_shift, bias, epilogue, pOut);
+        }
+        else
+        {
+            pOut = arm_nn_mat_mult_kernel_q7_q15_reordered(wt, bufferA, ch_im_out, ch_im_in, bias_shift, out_shift,
+                                                           bias, pOut);
+        }
+    }
+
+    /* 1-pixel tail, the last column */
+    if ((pBuffer - bufferA) / ch_im_in & 1)
+    {
+        pointwise_block_1x2(wt, pBuffer - ch_im_in, ch_im_in, ch_im_out, pBias, b_shift, out_shift, pShift,
+                            act_min, act_max, pOut);
+    }
+}
+
+/**
+ * @brief Scratch size of pointwise_conv_4x2
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t pointwise_conv_4x2_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 4 * ch_im_in * 2; // *2 for q15
+}
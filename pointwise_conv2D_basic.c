@@ -16,6 +16,7 @@
  *
  * Changes from the original function:
  * 1. Deleted unused parameters in pointwise convolution.
+ * 2. Optional fused epilogue through pointwise_conv_basic_ep, see nn_epilogue.
  * 
  * bufferA size: 2*ch_im_in
  *
@@ -38,27 +39,94 @@ void pointwise_conv_basic(const q7_t *Im_in,
                           q7_t *Im_out,
                           q15_t *bufferA)
 {
-    int16_t i_out_y, i_out_x;
+    pointwise_conv_basic_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out, bufferA,
+                            NULL);
+}
 
-    q15_t *pBuffer = bufferA;
-    q7_t *pOut = Im_out;
+/**
+ * @brief pointwise_conv_basic with an output epilogue
+ * @param[in]       epilogue    output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_basic. A NULL epilogue gives the same output as
+ * pointwise_conv_basic.
+ */
+
+void pointwise_conv_basic_ep(const q7_t *Im_in,
+                             const uint16_t dim_im_in,
+                             const uint16_t ch_im_in,
+                             const q7_t *wt,
+                             const uint16_t ch_im_out,
+                             const q7_t *bias,
+                             const uint16_t bias_shift,
+                             const uint16_t out_shift,
+                             q7_t *Im_out,
+                             q15_t *bufferA,
+                             const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("pointwise_conv_basic");
+    pointwise_conv_basic_rows(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out,
+                              bufferA, epilogue, 0, dim_im_in);
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * ch_im_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief pointwise_conv_basic for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_in
+ *
+ * @details
+ * Other parameters as pointwise_conv_basic_ep. The rows written are
+ * bit-identical to the same rows of pointwise_conv_basic and no other output
+ * row is touched.
+ *
+ * bufferA size and Constraints: as pointwise_conv_basic
+*/
+
+void pointwise_conv_basic_rows(const q7_t *Im_in,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t ch_im_out,
+                               const q7_t *bias,
+                               const uint16_t bias_shift,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q15_t *bufferA,
+                               const nn_epilogue *epilogue,
+                               const uint16_t start_row,
+                               const uint16_t end_row)
+{
+    int32_t i_pixel;
 
+    q15_t *pBuffer = bufferA;
+    q7_t *pOut = Im_out + start_row * dim_im_in * ch_im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+
+    NN_PROFILE_BEGIN("pointwise_conv_basic_rows");
     /* This part implements the im2col function */
-    for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+    for (i_pixel = start_row * dim_im_in; i_pixel < end_row * dim_im_in; i_pixel++)
     {
-        for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
-        {
-
-            /* Copying the pixel data to column */
-            arm_q7_to_q15_no_shift((q7_t *)
-                                           Im_in +
-                                       (i_out_y * dim_im_in + i_out_x) * ch_im_in,
-                                   pBuffer, ch_im_in);
+        /* Copying the pixel data to column */
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_no_shift((q7_t *)Im_in + i_pixel * ch_im_in, pBuffer, ch_im_in);
+        NN_PROFILE_COPY_STOP(ch_im_in * 2);
 
-            pBuffer += ch_im_in;
+        pBuffer += ch_im_in;
 
-            /* Computation is filed for every 2 columns */
-            if (pBuffer == bufferA + 2 * ch_im_in)
+        /* Computation is filed for every 2 columns */
+        if (pBuffer == bufferA + 2 * ch_im_in)
+        {
+            if (epilogue)
+            {
+                pOut = nn_mat_mult_kernel_q7_q15_epilogue(wt, bufferA, ch_im_out, ch_im_in,
+                                                          bias_shift, out_shift, bias, epilogue, pOut);
+            }
+            else
             {
                 pOut =
                     arm_nn_mat_mult_kernel_q7_q15(wt, bufferA,
@@ -68,14 +136,14 @@ void pointwise_conv_basic(const q7_t *Im_in,
                                             out_shift,
                                             bias, 
                                             pOut);
-
-                /* counter reset */
-                pBuffer = bufferA;
             }
+
+            /* counter reset */
+            pBuffer = bufferA;
         }
     }
 
-    /* left-over because odd number of output pixels */
+    /* left-over because odd number of output pixels in the range */
     if (pBuffer != bufferA)
     {
         const q7_t *pA = wt;
@@ -83,8 +151,9 @@ void pointwise_conv_basic(const q7_t *Im_in,
 
         for (i = 0; i < ch_im_out; i++)
         {
-            /* Load the accumulator with bias first */
-            q31_t sum = *(bias + i);
+            uint16_t shift = ep.out_shift ? ep.out_shift[i] : out_shift;
+            /* Load the accumulator with bias first, same as the mat mult kernel */
+            q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
 
             /* Point to the beging of the im2col buffer */
             q15_t *pB = bufferA;
@@ -114,8 +183,20 @@ void pointwise_conv_basic(const q7_t *Im_in,
                 sum += inA1 * inB1;
                 colCnt--;
             }
-            *pOut++ = (q7_t)__SSAT((sum >> out_shift), 8);
+            *pOut++ = nn_requantize(sum, shift, act_min, act_max);
         }
     }
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_in * ch_im_in * ch_im_out,
+                   (end_row - start_row) * dim_im_in * ch_im_out);
 }
 
+/**
+ * @brief Scratch size of pointwise_conv_basic
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t pointwise_conv_basic_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 2 * ch_im_in * 2; // *2 for q15
+}
@@ -1,47 +1,25 @@
 #include "nn_functions.h"
 
 
-/**
- * @brief Fast Q7 pointwise (1x1) convolution function
- * @param[in]       Im_in        pointer to input tensor
- * @param[in]       dim_im_in    input tensor dimention
- * @param[in]       ch_im_in     number of input tensor channels
- * @param[in]       wt           pointer to kernel weights
- * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
- * @param[in]       bias         pointer to bias
- * @param[in]       bias_shift   amount of left-shift for bias
- * @param[in]       out_shift    amount of right-shift for output
- * @param[in,out]   Im_out       pointer to output tensor
- * @param[in,out]   bufferA      pointer to buffer space for input 
- *
- * @details
- * Changes from original function:
- * 1. Removed unused parameters.
- * 
- * Size of bufferA: 2 * ch_im_in
- * 
- * Constraints:
- *   Square input.
- *   ch_im_in is multiple of 4
- *   ch_im_out is multiple of 2
- *
+/*
+ * pointwise_conv_fast over num_pixels consecutive HWC pixels
  */
-
-void pointwise_conv_fast(const q7_t *Im_in,
-                         const uint16_t dim_im_in,
-                         const uint16_t ch_im_in,
-                         const q7_t *wt,
-                         const uint16_t ch_im_out,
-                         const q7_t *bias,
-                         const uint16_t bias_shift,
-                         const uint16_t out_shift,
-                         q7_t *Im_out,
-                         q15_t *bufferA)
+static void pointwise_fast_pixels(const q7_t *Im_in,
+                                  const uint32_t num_pixels,
+                                  const uint16_t ch_im_in,
+                                  const q7_t *wt,
+                                  const uint16_t ch_im_out,
+                                  const q7_t *bias,
+                                  const uint16_t bias_shift,
+                                  const uint16_t out_shift,
+                                  q7_t *Im_out,
+                                  q15_t *bufferA,
+                                  const nn_epilogue *epilogue)
 {
 
     /* Run the following code for Cortex-M4 and Cortex-M7 */
 
-    int16_t i_out_y, i_out_x;
+    uint32_t i_pixel;
     int16_t i_ch_out;
 
     /* -----------------------
@@ -51,23 +29,40 @@ void pointwise_conv_fast(const q7_t *Im_in,
 
     q15_t *pBuffer = bufferA;
     q7_t *pOut = Im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+    //Specialised mat mult for this ch_im_in, if any
+    nn_mat_mult_fixed_fn fixed = nn_mat_mult_kernel_q7_q15_reordered_fixed(ch_im_in);
 
-    for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+    for (i_pixel = 0; i_pixel < num_pixels; i_pixel++)
     {
-        for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
-        {
-            /* This part implements the im2col function */
-            arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + (i_out_y * dim_im_in + i_out_x) * ch_im_in, pBuffer,
-                                             ch_im_in);
-            pBuffer += ch_im_in;
+        /* This part implements the im2col function */
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + i_pixel * ch_im_in, pBuffer, ch_im_in);
+        NN_PROFILE_COPY_STOP(ch_im_in * 2);
+        pBuffer += ch_im_in;
 
-            if (pBuffer == bufferA + 2 * ch_im_in)
+        if (pBuffer == bufferA + 2 * ch_im_in)
+        {
+            if (fixed)
+            {
+                pOut = fixed(wt, bufferA, ch_im_out, bias_shift, out_shift, bias, epilogue, pOut);
+            }
+            else if (epilogue)
+            {
+                pOut = nn_mat_mult_kernel_q7_q15_reordered_epilogue(wt, bufferA, ch_im_out, ch_im_in,
+                                                                    bias_shift, out_shift, bias, epilogue, pOut);
+            }
+            else
             {
-                pOut =
-                    arm_nn_mat_mult_kernel_q7_q15_reordered(wt, bufferA, ch_im_out, ch_im_in, bias_shift, out_shift, bias, pOut);
-                /* counter reset */
-                pBuffer = bufferA;
+                pOut = arm_nn_mat_mult_kernel_q7_q15_reordered(wt, bufferA, ch_im_out, ch_im_in, bias_shift, out_shift,
+                                                               bias, pOut);
             }
+            /* counter reset */
+            pBuffer = bufferA;
         }
     }
 
@@ -77,7 +72,9 @@ void pointwise_conv_fast(const q7_t *Im_in,
         const q7_t *pA = wt;
         for (i_ch_out = 0; i_ch_out < ch_im_out; i_ch_out++)
         {
-            q31_t sum = bias[i_ch_out];
+            uint16_t shift = ep.out_shift ? ep.out_shift[i_ch_out] : out_shift;
+            /* same bias and rounding as the mat mult kernel */
+            q31_t sum = ((q31_t)pBias[i_ch_out] << b_shift) + NN_ROUND(shift);
             q15_t *pB = bufferA;
             /* basically each time it process 4 entries */
             uint16_t colCnt = ch_im_in >> 2;
@@ -105,8 +102,197 @@ void pointwise_conv_fast(const q7_t *Im_in,
                 sum += inA1 * inB1;
                 colCnt--;
             }
-            *pOut = (q7_t)__SSAT((sum >> out_shift), 8);
+            *pOut = nn_requantize(sum, shift, act_min, act_max);
             pOut++;
         }
     }
 }
+
+/**
+ * @brief Fast Q7 pointwise (1x1) convolution function
+ * @param[in]       Im_in        pointer to input tensor
+ * @param[in]       dim_im_in    input tensor dimention
+ * @param[in]       ch_im_in     number of input tensor channels
+ * @param[in]       wt           pointer to kernel weights
+ * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
+ * @param[in]       bias         pointer to bias
+ * @param[in]       bias_shift   amount of left-shift for bias
+ * @param[in]       out_shift    amount of right-shift for output
+ * @param[in,out]   Im_out       pointer to output tensor
+ * @param[in,out]   bufferA      pointer to buffer space for input 
+ *
+ * @details
+ * Changes from original function:
+ * 1. Removed unused parameters.
+ * 2. Optional fused epilogue through pointwise_conv_fast_ep, see nn_epilogue.
+ * 3. Built with -DNN_FIXED_KERNELS, ch_im_in of 64, 128, 172 and 276 use the
+ *    unrolled kernels of nn_mat_mult_kernel_q7_q15_reordered_fixed.
+ * 
+ * Size of bufferA: 2 * ch_im_in
+ * 
+ * Constraints:
+ *   Square input.
+ *   ch_im_in is multiple of 4
+ *   ch_im_out is multiple of 2
+ *
+ */
+
+void pointwise_conv_fast(const q7_t *Im_in,
+                         const uint16_t dim_im_in,
+                         const uint16_t ch_im_in,
+                         const q7_t *wt,
+                         const uint16_t ch_im_out,
+                         const q7_t *bias,
+                         const uint16_t bias_shift,
+                         const uint16_t out_shift,
+                         q7_t *Im_out,
+                         q15_t *bufferA)
+{
+    pointwise_conv_fast_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out, bufferA,
+                           NULL);
+}
+
+/**
+ * @brief pointwise_conv_fast with an output epilogue
+ * @param[in]       epilogue     output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_fast. A NULL epilogue gives the same output as
+ * pointwise_conv_fast.
+ */
+
+void pointwise_conv_fast_ep(const q7_t *Im_in,
+                            const uint16_t dim_im_in,
+                            const uint16_t ch_im_in,
+                            const q7_t *wt,
+                            const uint16_t ch_im_out,
+                            const q7_t *bias,
+                            const uint16_t bias_shift,
+                            const uint16_t out_shift,
+                            q7_t *Im_out,
+                            q15_t *bufferA,
+                            const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("pointwise_conv_fast");
+    pointwise_fast_pixels(Im_in, dim_im_in * dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift,
+                          Im_out, bufferA, epilogue);
+    NN_PROFILE_END((uint64_t)dim_im_in * dim_im_in * ch_im_in * ch_im_out, dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief pointwise_conv_fast for output rows [start_row, end_row) only
+ * @param[in]       start_row   First output row
+ * @param[in]       end_row     Output row after the last one, at most dim_im_in
+ *
+ * @details
+ * Other parameters as pointwise_conv_fast_ep. The rows written are bit-identical
+ * to the same rows of pointwise_conv_fast and no other output row is touched.
+ *
+ * Size of bufferA and Constraints: as pointwise_conv_fast
+ */
+
+void pointwise_conv_fast_rows(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const q7_t *wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA,
+                              const nn_epilogue *epilogue,
+                              const uint16_t start_row,
+                              const uint16_t end_row)
+{
+    uint32_t first = (uint32_t)start_row * dim_im_in;
+
+    NN_PROFILE_BEGIN("pointwise_conv_fast_rows");
+    pointwise_fast_pixels(Im_in + first * ch_im_in, (uint32_t)(end_row - start_row) * dim_im_in, ch_im_in, wt,
+                          ch_im_out, bias, bias_shift, out_shift, Im_out + first * ch_im_out, bufferA, epilogue);
+    NN_PROFILE_END((uint64_t)(end_row - start_row) * dim_im_in * ch_im_in * ch_im_out,
+                   (end_row - start_row) * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief pointwise_conv_fast over a batch of inputs
+ * @param[in]       Im_in        pointer to input tensors, batch x dim_im_in x dim_im_in x ch_im_in
+ * @param[in]       batch        number of inputs
+ * @param[in]       dim_im_in    input tensor dimention
+ * @param[in]       ch_im_in     number of input tensor channels
+ * @param[in]       wt           pointer to kernel weights
+ * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
+ * @param[in]       bias         pointer to bias
+ * @param[in]       bias_shift   amount of left-shift for bias
+ * @param[in]       out_shift    amount of right-shift for output
+ * @param[in,out]   Im_out       pointer to output tensors, batch x dim_im_in x dim_im_in x ch_im_out
+ * @param[in,out]   bufferA      pointer to buffer space for input
+ *
+ * @details
+ * Same output as batch calls of pointwise_conv_fast. The batch is one run of
+ * batch * dim_im_in * dim_im_in pixels through the blocks of
+ * pointwise_conv_4x2: each pair of weight rows is read once per 4 pixels of
+ * the batch, where batch calls of pointwise_conv_fast read it once per 2, and
+ * the blocks run across input boundaries so the 1 to 3 pixel tail runs once
+ * per batch instead of once per input.
+ *
+ * Size of bufferA: 4 * ch_im_in, pointwise_conv_4x2_get_buffer_size
+ *
+ * Constraints: as pointwise_conv_fast
+ */
+
+void pointwise_conv_fast_batch(const q7_t *Im_in,
+                               const uint16_t batch,
+                               const uint16_t dim_im_in,
+                               const uint16_t ch_im_in,
+                               const q7_t *wt,
+                               const uint16_t ch_im_out,
+                               const q7_t *bias,
+                               const uint16_t bias_shift,
+                               const uint16_t out_shift,
+                               q7_t *Im_out,
+                               q15_t *bufferA)
+{
+    pointwise_conv_fast_batch_ep(Im_in, batch, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out,
+                                 bufferA, NULL);
+}
+
+/**
+ * @brief pointwise_conv_fast_batch with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_fast_batch. A NULL epilogue gives the same output as
+ * pointwise_conv_fast_batch.
+ */
+
+void pointwise_conv_fast_batch_ep(const q7_t *Im_in,
+                                  const uint16_t batch,
+                                  const uint16_t dim_im_in,
+                                  const uint16_t ch_im_in,
+                                  const q7_t *wt,
+                                  const uint16_t ch_im_out,
+                                  const q7_t *bias,
+                                  const uint16_t bias_shift,
+                                  const uint16_t out_shift,
+                                  q7_t *Im_out,
+                                  q15_t *bufferA,
+                                  const nn_epilogue *epilogue)
+{
+    NN_PROFILE_BEGIN("pointwise_conv_fast_batch");
+    pointwise_conv_4x2_pixels(Im_in, (uint32_t)batch * dim_im_in * dim_im_in, ch_im_in, wt, ch_im_out, bias,
+                              bias_shift, out_shift, Im_out, bufferA, epilogue);
+    NN_PROFILE_END((uint64_t)batch * dim_im_in * dim_im_in * ch_im_in * ch_im_out,
+                   batch * dim_im_in * dim_im_in * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of pointwise_conv_fast
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t pointwise_conv_fast_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 2 * ch_im_in * 2; // *2 for q15
+}
@@ -0,0 +1,234 @@
+#include "nn_functions.h"
+
+/*
+ * Two reordered q15 columns ch_im_in apart, 2 output channels per pass. Each
+ * packed weight word is 4 input channels of both output channels, unpacked in
+ * registers with read_and_pad_int4.
+ */
+static q7_t *pointwise_int4_2x2(const nn_int4_weights *wt,
+                                const q15_t *bufferA,
+                                const uint16_t ch_im_in,
+                                const uint16_t ch_im_out,
+                                const nn_epilogue *ep,
+                                const uint16_t out_shift,
+                                q7_t *pOut)
+{
+    const q7_t *pA = wt->values;
+    q7_t *pOut2 = pOut + ch_im_out;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pB = bufferA;
+        const q15_t *pB2 = pB + ch_im_in;
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        uint16_t shift2 = ep->out_shift ? ep->out_shift[i + 1] : out_shift;
+        uint16_t w_shift = wt->shift ? wt->shift[i] : wt->layer_shift;
+        uint16_t w_shift2 = wt->shift ? wt->shift[i + 1] : wt->layer_shift;
+
+        //Sums of weights * 16
+        q31_t acc = 0;
+        q31_t acc2 = 0;
+        q31_t acc3 = 0;
+        q31_t acc4 = 0;
+
+        uint16_t colCnt = ch_im_in >> 2;
+        while (colCnt)
+        {
+            q31_t inA1, inA2, inA3, inA4;
+            q31_t inB1, inB2;
+
+            pA = (const q7_t *)read_and_pad_int4((void *)pA, &inA1, &inA2, &inA3, &inA4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            acc = __SMLAD(inA1, inB1, acc);
+            acc2 = __SMLAD(inA1, inB2, acc2);
+            acc3 = __SMLAD(inA3, inB1, acc3);
+            acc4 = __SMLAD(inA3, inB2, acc4);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            acc = __SMLAD(inA2, inB1, acc);
+            acc2 = __SMLAD(inA2, inB2, acc2);
+            acc3 = __SMLAD(inA4, inB1, acc3);
+            acc4 = __SMLAD(inA4, inB2, acc4);
+
+            colCnt--;
+        }
+
+        //Exact: the sums are multiples of 16
+        q31_t sum = ((q31_t)ep->bias[i] << ep->bias_shift) + NN_ROUND(shift);
+        q31_t sum3 = ((q31_t)ep->bias[i + 1] << ep->bias_shift) + NN_ROUND(shift2);
+
+        *pOut++ = nn_requantize(sum + (acc >> (4 - w_shift)), shift, ep->act_min, ep->act_max);
+        *pOut++ = nn_requantize(sum3 + (acc3 >> (4 - w_shift2)), shift2, ep->act_min, ep->act_max);
+        *pOut2++ = nn_requantize(sum + (acc2 >> (4 - w_shift)), shift, ep->act_min, ep->act_max);
+        *pOut2++ = nn_requantize(sum3 + (acc4 >> (4 - w_shift2)), shift2, ep->act_min, ep->act_max);
+    }
+
+    return pOut + ch_im_out;
+}
+
+/*
+ * Single-pixel tail of pointwise_int4_2x2
+ */
+static void pointwise_int4_1x2(const nn_int4_weights *wt,
+                               const q15_t *bufferA,
+                               const uint16_t ch_im_in,
+                               const uint16_t ch_im_out,
+                               const nn_epilogue *ep,
+                               const uint16_t out_shift,
+                               q7_t *pOut)
+{
+    const q7_t *pA = wt->values;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i += 2)
+    {
+        const q15_t *pB = bufferA;
+        uint16_t shift = ep->out_shift ? ep->out_shift[i] : out_shift;
+        uint16_t shift2 = ep->out_shift ? ep->out_shift[i + 1] : out_shift;
+        uint16_t w_shift = wt->shift ? wt->shift[i] : wt->layer_shift;
+        uint16_t w_shift2 = wt->shift ? wt->shift[i + 1] : wt->layer_shift;
+        q31_t acc = 0;
+        q31_t acc3 = 0;
+
+        uint16_t colCnt = ch_im_in >> 2;
+        while (colCnt)
+        {
+            q31_t inA1, inA2, inA3, inA4;
+            q31_t inB1;
+
+            pA = (const q7_t *)read_and_pad_int4((void *)pA, &inA1, &inA2, &inA3, &inA4);
+
+            inB1 = *__SIMD32(pB)++;
+            acc = __SMLAD(inA1, inB1, acc);
+            acc3 = __SMLAD(inA3, inB1, acc3);
+            inB1 = *__SIMD32(pB)++;
+            acc = __SMLAD(inA2, inB1, acc);
+            acc3 = __SMLAD(inA4, inB1, acc3);
+
+            colCnt--;
+        }
+
+        q31_t sum = ((q31_t)ep->bias[i] << ep->bias_shift) + NN_ROUND(shift);
+        q31_t sum3 = ((q31_t)ep->bias[i + 1] << ep->bias_shift) + NN_ROUND(shift2);
+
+        *pOut++ = nn_requantize(sum + (acc >> (4 - w_shift)), shift, ep->act_min, ep->act_max);
+        *pOut++ = nn_requantize(sum3 + (acc3 >> (4 - w_shift2)), shift2, ep->act_min, ep->act_max);
+    }
+}
+
+/**
+ * @brief Fast Q7 pointwise (1x1) convolution with packed int4 weights
+ * @param[in]       Im_in        pointer to input tensor
+ * @param[in]       dim_im_in    input tensor dimention
+ * @param[in]       ch_im_in     number of input tensor channels
+ * @param[in]       wt           int4 weights packed by pack_pointwise_int4_weights
+ * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
+ * @param[in]       bias         pointer to bias
+ * @param[in]       bias_shift   amount of left-shift for bias
+ * @param[in]       out_shift    amount of right-shift for output
+ * @param[in,out]   Im_out       pointer to output tensor
+ * @param[in,out]   bufferA      pointer to buffer space for input
+ *
+ * @details
+ * Same output as pointwise_conv_fast with the q7 weights w_int4 << shift
+ * (the expanded weights of the packer). The weights take half the flash
+ * and half the weight reads of pointwise_conv_fast: every word is 4 input
+ * channels of the 2 output channels of a pass, unpacked to __SMLAD operands
+ * by read_and_pad_int4 with one shift and two masks, against two
+ * read_and_pad_reordered (two loads) for the q7 weights.
+ *
+ * Cost per layer: the same __SMLAD count as pointwise_conv_fast, with one
+ * weight load and 6 unpack instructions per 8 weights instead of 2 loads and
+ * 4. make bench measures 0.95x to 1.05x of pointwise_conv_fast on the DS-CNN
+ * S/M/L pointwise layers, so the kernel trades no speed for half the weights.
+ *
+ * Size of bufferA: 2 * ch_im_in
+ *
+ * Constraints:
+ *   Square input.
+ *   ch_im_in is multiple of 4
+ *   ch_im_out is multiple of 2
+ *
+ */
+
+void pointwise_conv_fast_int4(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const nn_int4_weights *wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA)
+{
+    pointwise_conv_fast_int4_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out, bufferA,
+                                NULL);
+}
+
+/**
+ * @brief pointwise_conv_fast_int4 with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_fast_int4. A NULL epilogue gives the same output as
+ * pointwise_conv_fast_int4.
+ */
+
+void pointwise_conv_fast_int4_ep(const q7_t *Im_in,
+                                 const uint16_t dim_im_in,
+                                 const uint16_t ch_im_in,
+                                 const nn_int4_weights *wt,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *bias,
+                                 const uint16_t bias_shift,
+                                 const uint16_t out_shift,
+                                 q7_t *Im_out,
+                                 q15_t *bufferA,
+                                 const nn_epilogue *epilogue)
+{
+    uint32_t num_pixels = dim_im_in * dim_im_in;
+    uint32_t i_pixel;
+    q15_t *pBuffer = bufferA;
+    q7_t *pOut = Im_out;
+
+    //Resolve bias, shift and clamp once for all blocks
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("pointwise_conv_fast_int4");
+    for (i_pixel = 0; i_pixel < num_pixels; i_pixel++)
+    {
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + i_pixel * ch_im_in, pBuffer, ch_im_in);
+        NN_PROFILE_COPY_STOP(ch_im_in * 2);
+        pBuffer += ch_im_in;
+
+        if (pBuffer == bufferA + 2 * ch_im_in)
+        {
+            pOut = pointwise_int4_2x2(wt, bufferA, ch_im_in, ch_im_out, &ep, out_shift, pOut);
+            pBuffer = bufferA;
+        }
+    }
+
+    /* left-over because odd number of output pixels */
+    if (pBuffer != bufferA)
+    {
+        pointwise_int4_1x2(wt, bufferA, ch_im_in, ch_im_out, &ep, out_shift, pOut);
+    }
+    NN_PROFILE_END((uint64_t)num_pixels * ch_im_in * ch_im_out, num_pixels * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of pointwise_conv_fast_int4
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t pointwise_conv_fast_int4_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 2 * ch_im_in * 2; // *2 for q15
+}
@@ -0,0 +1,158 @@
+#include "nn_functions.h"
+
+/**
+ * @brief Fast Q7 pointwise (1x1) convolution with pre-packed weights
+ * @param[in]       Im_in        pointer to input tensor
+ * @param[in]       dim_im_in    input tensor dimention
+ * @param[in]       ch_im_in     number of input tensor channels
+ * @param[in]       wt_packed    pointer to weights packed by pack_pointwise_fast_weights
+ * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
+ * @param[in]       bias         pointer to bias
+ * @param[in]       bias_shift   amount of left-shift for bias
+ * @param[in]       out_shift    amount of right-shift for output
+ * @param[in,out]   Im_out       pointer to output tensor
+ * @param[in,out]   bufferA      pointer to buffer space for input
+ *
+ * @details
+ * Same results as pointwise_conv_fast, but the weights are already widened to
+ * q15 in the reordered layout and interleaved by output channel pair (see
+ * weight_packer.h), so no read_and_pad_reordered is needed per weight word.
+ * The packed weights take twice the flash of the q7 ones.
+ *
+ * Size of bufferA: 2 * ch_im_in
+ *
+ * Constraints:
+ *   Square input.
+ *   ch_im_in is multiple of 4
+ *   ch_im_out is multiple of 2
+ *
+ */
+
+void pointwise_conv_fast_packed(const q7_t *Im_in,
+                                const uint16_t dim_im_in,
+                                const uint16_t ch_im_in,
+                                const q15_t *wt_packed,
+                                const uint16_t ch_im_out,
+                                const q7_t *bias,
+                                const uint16_t bias_shift,
+                                const uint16_t out_shift,
+                                q7_t *Im_out,
+                                q15_t *bufferA)
+{
+    pointwise_conv_fast_packed_ep(Im_in, dim_im_in, ch_im_in, wt_packed, ch_im_out, bias, bias_shift, out_shift, Im_out,
+                                  bufferA, NULL);
+}
+
+/**
+ * @brief pointwise_conv_fast_packed with an output epilogue
+ * @param[in]       epilogue     output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_fast_packed. A NULL epilogue gives the same output as
+ * pointwise_conv_fast_packed.
+ */
+
+void pointwise_conv_fast_packed_ep(const q7_t *Im_in,
+                                   const uint16_t dim_im_in,
+                                   const uint16_t ch_im_in,
+                                   const q15_t *wt_packed,
+                                   const uint16_t ch_im_out,
+                                   const q7_t *bias,
+                                   const uint16_t bias_shift,
+                                   const uint16_t out_shift,
+                                   q7_t *Im_out,
+                                   q15_t *bufferA,
+                                   const nn_epilogue *epilogue)
+{
+    int32_t i_pixel;
+    int32_t num_pixel = dim_im_in * dim_im_in;
+    q7_t *pOut = Im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+
+    NN_PROFILE_BEGIN("pointwise_conv_fast_packed");
+    for (i_pixel = 0; i_pixel < num_pixel; i_pixel += 2)
+    {
+        /* the last odd pixel is calculated twice into the same output */
+        uint16_t col2_offset = (i_pixel + 1 < num_pixel) ? ch_im_in : 0;
+        q7_t *pOut2 = pOut + (col2_offset ? ch_im_out : 0);
+        const q15_t *pA = wt_packed;
+        const q7_t *pBias = ep.bias;
+        const uint8_t *pShift = ep.out_shift;
+        uint16_t rowCnt = ch_im_out >> 1;
+
+        /* This part implements the im2col function */
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + i_pixel * ch_im_in, bufferA, ch_im_in);
+        if (col2_offset)
+        {
+            arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + (i_pixel + 1) * ch_im_in, bufferA + ch_im_in, ch_im_in);
+        }
+        NN_PROFILE_COPY_STOP((ch_im_in + col2_offset) * 2);
+
+        while (rowCnt)
+        {
+            const q15_t *pB = bufferA;
+            const q15_t *pB2 = bufferA + col2_offset;
+
+            uint16_t shift = pShift ? pShift[0] : out_shift;
+            uint16_t shift2 = pShift ? pShift[1] : out_shift;
+            q31_t sum = ((q31_t)pBias[0] << ep.bias_shift) + NN_ROUND(shift);
+            q31_t sum2 = sum;
+            q31_t sum3 = ((q31_t)pBias[1] << ep.bias_shift) + NN_ROUND(shift2);
+            q31_t sum4 = sum3;
+
+            uint16_t colCnt = ch_im_in >> 2;
+            while (colCnt)
+            {
+                q31_t inA11 = *__SIMD32(pA)++;
+                q31_t inA12 = *__SIMD32(pA)++;
+                q31_t inA21 = *__SIMD32(pA)++;
+                q31_t inA22 = *__SIMD32(pA)++;
+                q31_t inB1 = *__SIMD32(pB)++;
+                q31_t inB2 = *__SIMD32(pB2)++;
+
+                sum = __SMLAD(inA11, inB1, sum);
+                sum2 = __SMLAD(inA11, inB2, sum2);
+                sum3 = __SMLAD(inA21, inB1, sum3);
+                sum4 = __SMLAD(inA21, inB2, sum4);
+
+                inB1 = *__SIMD32(pB)++;
+                inB2 = *__SIMD32(pB2)++;
+
+                sum = __SMLAD(inA12, inB1, sum);
+                sum2 = __SMLAD(inA12, inB2, sum2);
+                sum3 = __SMLAD(inA22, inB1, sum3);
+                sum4 = __SMLAD(inA22, inB2, sum4);
+
+                colCnt--;
+            }
+
+            *pOut2 = nn_requantize(sum2, shift, ep.act_min, ep.act_max);
+            *(pOut2 + 1) = nn_requantize(sum4, shift2, ep.act_min, ep.act_max);
+            *pOut = nn_requantize(sum, shift, ep.act_min, ep.act_max);
+            *(pOut + 1) = nn_requantize(sum3, shift2, ep.act_min, ep.act_max);
+            pOut += 2;
+            pOut2 += 2;
+            pBias += 2;
+            if (pShift)
+            {
+                pShift += 2;
+            }
+            rowCnt--;
+        }
+
+        pOut = pOut2;
+    }
+    NN_PROFILE_END((uint64_t)num_pixel * ch_im_in * ch_im_out, num_pixel * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of pointwise_conv_fast_packed
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t pointwise_conv_fast_packed_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 2 * ch_im_in * 2; // *2 for q15
+}
@@ -0,0 +1,215 @@
+#include "nn_functions.h"
+
+/*
+ * Two reordered q15 columns ch_im_in apart, one output channel per pass: each
+ * non-zero block is one weight word and one column word pair per pixel.
+ */
+static q7_t *pointwise_sparse_2x1(const nn_sparse_weights *wt,
+                                  const q15_t *bufferA,
+                                  const uint16_t ch_im_in,
+                                  const uint16_t ch_im_out,
+                                  const q7_t *pBias,
+                                  const uint16_t b_shift,
+                                  const uint16_t out_shift,
+                                  const uint8_t *pShift,
+                                  const q7_t act_min,
+                                  const q7_t act_max,
+                                  q7_t *pOut)
+{
+    const q7_t *pA = wt->values;
+    const uint16_t *pIdx = wt->col_idx;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i++)
+    {
+        uint16_t shift = pShift ? pShift[i] : out_shift;
+        q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        q31_t sum2 = sum;
+        uint32_t blkCnt = wt->row_ptr[i + 1] - wt->row_ptr[i];
+
+        while (blkCnt)
+        {
+            q31_t inA1, inA2;
+            q31_t inB1, inB2;
+            const q15_t *pB = bufferA + 4 * *pIdx++;
+            const q15_t *pB2 = pB + ch_im_in;
+
+            pA = (const q7_t *)read_and_pad_reordered((void *)pA, &inA1, &inA2);
+
+            inB1 = *__SIMD32(pB)++;
+            inB2 = *__SIMD32(pB2)++;
+            sum = __SMLAD(inA1, inB1, sum);
+            sum2 = __SMLAD(inA1, inB2, sum2);
+            inB1 = *__SIMD32(pB);
+            inB2 = *__SIMD32(pB2);
+            sum = __SMLAD(inA2, inB1, sum);
+            sum2 = __SMLAD(inA2, inB2, sum2);
+
+            blkCnt--;
+        }
+
+        pOut[i] = nn_requantize(sum, shift, act_min, act_max);
+        pOut[ch_im_out + i] = nn_requantize(sum2, shift, act_min, act_max);
+    }
+
+    return pOut + 2 * ch_im_out;
+}
+
+/*
+ * Single-pixel tail of pointwise_sparse_2x1
+ */
+static void pointwise_sparse_1x1(const nn_sparse_weights *wt,
+                                 const q15_t *bufferA,
+                                 const uint16_t ch_im_out,
+                                 const q7_t *pBias,
+                                 const uint16_t b_shift,
+                                 const uint16_t out_shift,
+                                 const uint8_t *pShift,
+                                 const q7_t act_min,
+                                 const q7_t act_max,
+                                 q7_t *pOut)
+{
+    const q7_t *pA = wt->values;
+    const uint16_t *pIdx = wt->col_idx;
+    uint16_t i;
+
+    for (i = 0; i < ch_im_out; i++)
+    {
+        uint16_t shift = pShift ? pShift[i] : out_shift;
+        q31_t sum = ((q31_t)pBias[i] << b_shift) + NN_ROUND(shift);
+        uint32_t blkCnt = wt->row_ptr[i + 1] - wt->row_ptr[i];
+
+        while (blkCnt)
+        {
+            q31_t inA1, inA2;
+            q31_t inB;
+            const q15_t *pB = bufferA + 4 * *pIdx++;
+
+            pA = (const q7_t *)read_and_pad_reordered((void *)pA, &inA1, &inA2);
+
+            inB = *__SIMD32(pB)++;
+            sum = __SMLAD(inA1, inB, sum);
+            inB = *__SIMD32(pB);
+            sum = __SMLAD(inA2, inB, sum);
+
+            blkCnt--;
+        }
+
+        *pOut++ = nn_requantize(sum, shift, act_min, act_max);
+    }
+}
+
+/**
+ * @brief Q7 pointwise (1x1) convolution with block-sparse weights
+ * @param[in]       Im_in        pointer to input tensor
+ * @param[in]       dim_im_in    input tensor dimention
+ * @param[in]       ch_im_in     number of input tensor channels
+ * @param[in]       wt           block-sparse weights, see nn_sparse_weights
+ * @param[in]       ch_im_out    number of filters, i.e., output tensor channels
+ * @param[in]       bias         pointer to bias
+ * @param[in]       bias_shift   amount of left-shift for bias
+ * @param[in]       out_shift    amount of right-shift for output
+ * @param[in,out]   Im_out       pointer to output tensor
+ * @param[in,out]   bufferA      pointer to buffer space for input
+ *
+ * @details
+ * Same output as pointwise_conv_fast with the dense weights. Only the
+ * non-zero blocks of 4 input channels are multiplied, each with 2 __SMLAD
+ * per pixel on the widened column, 2 pixels per pass.
+ *
+ * The blocks of one output channel are not shared with the next one, so a
+ * block costs one weight word and one index on top of the column loads, and
+ * a fully dense layer is slower than pointwise_conv_fast. The gain comes from
+ * block-pruned (4-channel group) models: scattered zeros rarely empty a whole
+ * block.
+ *
+ * Size of bufferA: 2 * ch_im_in
+ *
+ * Constraints:
+ *   Square input.
+ *   ch_im_in is multiple of 4
+ *
+ */
+
+void pointwise_conv_sparse(const q7_t *Im_in,
+                           const uint16_t dim_im_in,
+                           const uint16_t ch_im_in,
+                           const nn_sparse_weights *wt,
+                           const uint16_t ch_im_out,
+                           const q7_t *bias,
+                           const uint16_t bias_shift,
+                           const uint16_t out_shift,
+                           q7_t *Im_out,
+                           q15_t *bufferA)
+{
+    pointwise_conv_sparse_ep(Im_in, dim_im_in, ch_im_in, wt, ch_im_out, bias, bias_shift, out_shift, Im_out, bufferA,
+                             NULL);
+}
+
+/**
+ * @brief pointwise_conv_sparse with an output epilogue
+ * @param[in]       epilogue    Output epilogue (activation, per-channel bias/shift), NULL for none
+ *
+ * @details
+ * Other parameters as pointwise_conv_sparse. A NULL epilogue gives the same output as
+ * pointwise_conv_sparse.
+ */
+
+void pointwise_conv_sparse_ep(const q7_t *Im_in,
+                              const uint16_t dim_im_in,
+                              const uint16_t ch_im_in,
+                              const nn_sparse_weights *wt,
+                              const uint16_t ch_im_out,
+                              const q7_t *bias,
+                              const uint16_t bias_shift,
+                              const uint16_t out_shift,
+                              q7_t *Im_out,
+                              q15_t *bufferA,
+                              const nn_epilogue *epilogue)
+{
+    uint32_t num_pixels = dim_im_in * dim_im_in;
+    uint32_t i_pixel;
+    q15_t *pBuffer = bufferA;
+    q7_t *pOut = Im_out;
+    nn_epilogue ep = nn_epilogue_resolve(epilogue, bias, bias_shift);
+    const q7_t *pBias = ep.bias;
+    uint16_t b_shift = ep.bias_shift;
+    const uint8_t *pShift = ep.out_shift;
+    q7_t act_min = ep.act_min;
+    q7_t act_max = ep.act_max;
+
+    NN_PROFILE_BEGIN("pointwise_conv_sparse");
+    for (i_pixel = 0; i_pixel < num_pixels; i_pixel++)
+    {
+        NN_PROFILE_COPY_START();
+        arm_q7_to_q15_reordered_no_shift((q7_t *)Im_in + i_pixel * ch_im_in, pBuffer, ch_im_in);
+        NN_PROFILE_COPY_STOP(ch_im_in * 2);
+        pBuffer += ch_im_in;
+
+        if (pBuffer == bufferA + 2 * ch_im_in)
+        {
+            pOut = pointwise_sparse_2x1(wt, bufferA, ch_im_in, ch_im_out, pBias, b_shift, out_shift, pShift,
+                                        act_min, act_max, pOut);
+            pBuffer = bufferA;
+        }
+    }
+
+    /* left-over because odd number of output pixels */
+    if (pBuffer != bufferA)
+    {
+        pointwise_sparse_1x1(wt, bufferA, ch_im_out, pBias, b_shift, out_shift, pShift, act_min, act_max, pOut);
+    }
+    //Nominal MACs, as the dense layer
+    NN_PROFILE_END((uint64_t)num_pixels * ch_im_in * ch_im_out, num_pixels * ch_im_out);
+}
+
+/**
+ * @brief Scratch size of pointwise_conv_sparse
+ * @param[in]       ch_im_in        Input tensor channel
+ * @return          Bytes of bufferA
+ */
+
+uint32_t pointwise_conv_sparse_get_buffer_size(const uint16_t ch_im_in)
+{
+    return 2 * ch_im_in * 2; // *2 for q15
+}
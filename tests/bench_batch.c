@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * Throughput of the batch entry points against batch separate calls of the
+ * single-input kernel, for batch 1, 2, 4 and 8. Each case times the whole
+ * batch; the summary line gives inferences (inputs) per second of both.
+ */
+
+static void bench_pointwise(const uint16_t batch, const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out)
+{
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t out_size = dim * dim * ch_out;
+    uint64_t macs = (uint64_t)batch * dim * dim * ch_in * ch_out;
+    uint32_t bytes = batch * (in_size + out_size) + ch_out * ch_in;
+    q7_t *in = nn_test_alloc(batch * in_size);
+    q7_t *wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(batch * out_size);
+    q15_t *bufferA = nn_test_alloc(pointwise_conv_4x2_get_buffer_size(ch_in));
+    double separate, batched;
+    char name[80];
+    nn_bench b;
+    uint16_t i;
+
+    nn_test_fill(in, batch * in_size);
+    nn_test_fill(wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    snprintf(name, sizeof(name), "%u x pointwise_conv_fast %ux%ux%u -> %u", batch, dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        for (i = 0; i < batch; i++)
+        {
+            pointwise_conv_fast(in + i * in_size, dim, ch_in, wt, ch_out, bias, 2, 7, out + i * out_size, bufferA);
+        }
+    }
+    separate = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "pointwise_conv_fast_batch %u x %ux%ux%u -> %u", batch, dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        pointwise_conv_fast_batch(in, batch, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA);
+    }
+    batched = bench_stop(&b);
+    printf("pointwise batch %u: %.0f inferences/s separate, %.0f batched, %.2fx\n", batch, batch * 1e9 / separate,
+           batch * 1e9 / batched, separate / batched);
+}
+
+static void bench_conv(const uint16_t batch, const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out,
+                       const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t wt_size = ch_out * kernel * kernel * ch_in;
+    uint64_t macs = (uint64_t)batch * out_size * kernel * kernel * ch_in;
+    uint32_t bytes = batch * (in_size + out_size) + wt_size;
+    uint32_t size_b;
+    q7_t *in = nn_test_alloc(batch * in_size);
+    q7_t *wt = nn_test_alloc(wt_size);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(batch * out_size);
+    q15_t *bufferA = nn_test_alloc(conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &size_b));
+    q15_t *bufferB = nn_test_alloc(size_b);
+    double separate, batched;
+    char name[80];
+    nn_bench b;
+    uint16_t i;
+
+    nn_test_fill(in, batch * in_size);
+    nn_test_fill_range(wt, wt_size, 32);
+    nn_test_fill(bias, ch_out);
+
+    snprintf(name, sizeof(name), "%u x conv_HWC %ux%ux%u -> %u k%u", batch, dim, dim, ch_in, ch_out, kernel);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        for (i = 0; i < batch; i++)
+        {
+            conv_HWC(in + i * in_size, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out + i * out_size,
+                     bufferA, bufferB);
+        }
+    }
+    separate = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "conv_HWC_batch %u x %ux%ux%u -> %u k%u", batch, dim, dim, ch_in, ch_out, kernel);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC_batch(in, batch, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+    }
+    batched = bench_stop(&b);
+    printf("conv batch %u: %.0f inferences/s separate, %.0f batched, %.2fx\n", batch, batch * 1e9 / separate,
+           batch * 1e9 / batched, separate / batched);
+}
+
+void bench_batch(void)
+{
+    static const uint16_t batches[] = {1, 2, 4, 8};
+    uint32_t i;
+
+    bench_section("batch entry points vs separate calls");
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++)
+    {
+        // DS-CNN M pointwise layer on a 5x5 map (odd pixel count) and its 10x10 first layer
+        bench_pointwise(batches[i], 5, 172, 172);
+        bench_pointwise(batches[i], 11, 64, 64);
+        bench_conv(batches[i], 10, 2, 64, 3);
+        bench_conv(batches[i], 8, 16, 16, 3);
+        nn_test_free_all();
+    }
+}
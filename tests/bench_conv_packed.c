@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+#include "weight_packer.h"
+
+/*
+ * conv_HWC_packed and pointwise_conv_fast_packed, with weights packed
+ * offline, against conv_HWC and pointwise_conv_fast widening the weights on
+ * every call. RAM is the scratch of one call.
+ */
+
+static void bench_packed(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out)
+{
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t sizeA, sizeB, packed_sizeA;
+    q7_t *in = nn_test_alloc(in_size);
+    q7_t *out = nn_test_alloc(dim * dim * ch_out);
+    q7_t *wt = nn_test_alloc(9 * ch_in * ch_out);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q15_t *packed = nn_test_alloc(pack_conv_HWC_weights_size(ch_in, ch_out, 3) * 2);
+    q15_t *bufferA, *bufferB;
+    uint64_t macs = (uint64_t)dim * dim * ch_out * 9 * ch_in;
+    uint32_t bytes = in_size + 9 * ch_in * ch_out + ch_out + dim * dim * ch_out;
+    double plain, fast;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, in_size);
+    nn_test_fill_range(wt, 9 * ch_in * ch_out, 20);
+    nn_test_fill(bias, ch_out);
+    pack_conv_HWC_weights(wt, ch_in, ch_out, 3, packed);
+
+    sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, 3, &sizeB);
+    packed_sizeA = conv_HWC_packed_get_buffer_size(dim, ch_in, 3);
+    bufferA = nn_test_alloc(sizeA > packed_sizeA ? sizeA : packed_sizeA);
+    bufferB = nn_test_alloc(sizeB);
+
+    snprintf(name, sizeof(name), "conv_HWC %ux%ux%u -> %u k3", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC(in, dim, ch_in, wt, ch_out, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    }
+    plain = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "conv_HWC_packed %ux%ux%u -> %u k3", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC_packed(in, dim, ch_in, packed, ch_out, 3, 1, bias, 2, 7, out, bufferA);
+    }
+    fast = bench_stop(&b);
+    printf("conv packed %.2fx, RAM %u -> %u bytes\n", plain / fast, sizeA + sizeB, packed_sizeA);
+
+    macs = (uint64_t)dim * dim * ch_out * ch_in;
+    bytes = in_size + ch_in * ch_out + ch_out + dim * dim * ch_out;
+    pack_pointwise_fast_weights(wt, ch_in, ch_out, packed);
+    snprintf(name, sizeof(name), "pointwise_conv_fast %ux%ux%u -> %u", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        pointwise_conv_fast(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA);
+    }
+    plain = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "pointwise_conv_fast_packed %ux%ux%u -> %u", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        pointwise_conv_fast_packed(in, dim, ch_in, packed, ch_out, bias, 2, 7, out, bufferA);
+    }
+    fast = bench_stop(&b);
+    printf("pointwise packed %.2fx\n", plain / fast);
+}
+
+void bench_conv_packed(void)
+{
+    bench_section("weights packed offline");
+    bench_packed(11, 16, 16);
+    bench_packed(11, 64, 64);
+    nn_test_free_all();
+}
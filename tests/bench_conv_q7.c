@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * conv_HWC_q7 (q7 column buffer, activations and weights widened in
+ * registers) against conv_HWC (q15 column buffer and q15 weight copy), per
+ * layer: 3x3 convs of the DS-CNN S and M widths on the 11x11 stand-in map,
+ * and layers with few output channels, where the per-call weight copy of
+ * conv_HWC is a larger share. The summary gives the speed and the scratch
+ * bytes of both.
+ */
+
+static void bench_layer(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t wt_size = ch_out * kernel * kernel * ch_in;
+    uint64_t macs = (uint64_t)dim * dim * ch_out * kernel * kernel * ch_in;
+    uint32_t bytes = dim * dim * (ch_in + ch_out) + wt_size + ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    uint32_t sizeA_q7 = conv_HWC_q7_get_buffer_size(dim, ch_in, kernel);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *out = nn_test_alloc(dim * dim * ch_out);
+    q7_t *wt = nn_test_alloc(wt_size);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    q7_t *bufferA_q7 = nn_test_alloc(sizeA_q7);
+    double q15, q7;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, wt_size, 20);
+    nn_test_fill(bias, ch_out);
+
+    snprintf(name, sizeof(name), "conv_HWC %ux%ux%u -> %u k%u", dim, dim, ch_in, ch_out, kernel);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+    }
+    q15 = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "conv_HWC_q7 %ux%ux%u -> %u k%u", dim, dim, ch_in, ch_out, kernel);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC_q7(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA_q7);
+    }
+    q7 = bench_stop(&b);
+
+    printf("%ux%ux%u -> %u k%u: q7 %.2fx q15, scratch %u -> %u bytes\n", dim, dim, ch_in, ch_out, kernel, q15 / q7,
+           sizeA + sizeB, sizeA_q7);
+}
+
+void bench_conv_q7(void)
+{
+    bench_section("conv_HWC q7 column buffer vs q15");
+    bench_layer(11, 64, 64, 3);
+    bench_layer(11, 172, 172, 3);
+    bench_layer(11, 64, 8, 3);
+    bench_layer(25, 8, 64, 3);
+    bench_layer(25, 16, 4, 5);
+    nn_test_free_all();
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * conv_HWC_ring and depthwise_conv_ring against conv_HWC and depthwise_conv on
+ * 3x3 layers. The ring variants widen each input column into bufferA once
+ * instead of dim_kernel times. Each pair prints the bytes copied into
+ * bufferA/bufferB per call, as make bench-profile counts them.
+ */
+
+/* Bytes conv_HWC and conv_HWC_ring copy per call, padding rows and widened weights included */
+static void conv_copy_bytes(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t k,
+                            const uint16_t pad, uint32_t *plain, uint32_t *ring)
+{
+    uint32_t fixed = (k * k * ch_in * ch_out + k * ch_in * pad * 2) * 2;
+
+    *plain = fixed + dim * dim * k * ch_in * 2;
+    *ring = fixed + (dim + k - 1) * dim * ch_in * 2;
+}
+
+/* Bytes depthwise_conv and depthwise_conv_ring copy per call */
+static void depthwise_copy_bytes(const uint16_t dim, const uint16_t ch_in, const uint16_t k, const uint16_t pad,
+                                 uint32_t *plain, uint32_t *ring)
+{
+    int32_t x;
+
+    //depthwise_conv copies the kernel columns inside the image, no padding
+    *plain = 0;
+    for (x = 0; x < dim; x++)
+    {
+        int32_t kx_start = x < pad ? pad - x : 0;
+        int32_t kx_end = x + k - pad > dim ? dim + pad - x : k;
+        *plain += (kx_end - kx_start) * dim * ch_in;
+    }
+    *ring = k * ch_in * pad * 2 + (dim + k - 1) * dim * ch_in;
+}
+
+static void bench_ring(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out)
+{
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t sizeA, sizeB, ring_sizeA, ring_sizeB;
+    uint32_t copied, ring_copied;
+    q7_t *in = nn_test_alloc(in_size);
+    q7_t *out = nn_test_alloc(dim * dim * (ch_out > ch_in ? ch_out : ch_in));
+    q7_t *wt = nn_test_alloc(9 * ch_in * ch_out);
+    q7_t *dw_wt = nn_test_alloc(9 * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q15_t *bufferA, *bufferB;
+    q7_t *dw_buffer;
+    uint64_t macs = (uint64_t)dim * dim * ch_out * 9 * ch_in;
+    uint32_t bytes = in_size + 9 * ch_in * ch_out + ch_out + dim * dim * ch_out;
+    double plain, ring;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, in_size);
+    nn_test_fill_range(wt, 9 * ch_in * ch_out, 20);
+    nn_test_fill(dw_wt, 9 * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, 3, &sizeB);
+    ring_sizeA = conv_HWC_ring_get_buffer_size(dim, ch_in, ch_out, 3, &ring_sizeB);
+    bufferA = nn_test_alloc(sizeA > ring_sizeA ? sizeA : ring_sizeA);
+    bufferB = nn_test_alloc(sizeB > ring_sizeB ? sizeB : ring_sizeB);
+
+    snprintf(name, sizeof(name), "conv_HWC %ux%ux%u -> %u k3", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC(in, dim, ch_in, wt, ch_out, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    }
+    plain = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "conv_HWC_ring %ux%ux%u -> %u k3", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC_ring(in, dim, ch_in, wt, ch_out, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    }
+    ring = bench_stop(&b);
+    conv_copy_bytes(dim, ch_in, ch_out, 3, 1, &copied, &ring_copied);
+    printf("conv ring %.2fx, copied per call %u -> %u bytes\n", plain / ring, copied, ring_copied);
+
+    macs = (uint64_t)in_size * 9;
+    bytes = 2 * in_size + 9 * ch_in;
+    dw_buffer = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch_in, 3));
+    snprintf(name, sizeof(name), "depthwise_conv %ux%ux%u k3", dim, dim, ch_in);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        depthwise_conv(in, dim, ch_in, dw_wt, 3, 1, 7, out, dw_buffer);
+    }
+    plain = bench_stop(&b);
+
+    dw_buffer = nn_test_alloc(depthwise_conv_ring_get_buffer_size(dim, ch_in, 3));
+    snprintf(name, sizeof(name), "depthwise_conv_ring %ux%ux%u k3", dim, dim, ch_in);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        depthwise_conv_ring(in, dim, ch_in, dw_wt, 3, 1, 7, out, dw_buffer);
+    }
+    ring = bench_stop(&b);
+    depthwise_copy_bytes(dim, ch_in, 3, 1, &copied, &ring_copied);
+    printf("depthwise ring %.2fx, copied per call %u -> %u bytes\n", plain / ring, copied, ring_copied);
+}
+
+void bench_conv_ring(void)
+{
+    bench_section("ring column buffer");
+    bench_ring(11, 16, 16);
+    bench_ring(11, 64, 64);
+    bench_ring(16, 32, 32);
+    nn_test_free_all();
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * conv_HWC_tiled at a range of bufferB budgets against the single-shot
+ * conv_HWC. Peak scratch is bufferA + bufferB of one call.
+ */
+
+static void bench_tiled(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out)
+{
+    static const uint32_t budgets[] = {4096, 8192, 16384, 32768};
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t sizeA, sizeB, tile_sizeA, tile_sizeB, i;
+    q7_t *in = nn_test_alloc(in_size);
+    q7_t *out = nn_test_alloc(dim * dim * ch_out);
+    q7_t *wt = nn_test_alloc(9 * ch_in * ch_out);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q15_t *bufferA, *bufferB;
+    uint64_t macs = (uint64_t)dim * dim * ch_out * 9 * ch_in;
+    uint32_t bytes = in_size + 9 * ch_in * ch_out + ch_out + dim * dim * ch_out;
+    double single, tiled;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, in_size);
+    nn_test_fill_range(wt, 9 * ch_in * ch_out, 20);
+    nn_test_fill(bias, ch_out);
+
+    sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, 3, &sizeB);
+    bufferA = nn_test_alloc(sizeA);
+    bufferB = nn_test_alloc(sizeB);
+
+    snprintf(name, sizeof(name), "conv_HWC %ux%ux%u -> %u k3", dim, dim, ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        conv_HWC(in, dim, ch_in, wt, ch_out, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    }
+    single = bench_stop(&b);
+    printf("single-shot scratch %u bytes\n", sizeA + sizeB);
+
+    for (i = 0; i < sizeof(budgets) / sizeof(budgets[0]); i++)
+    {
+        uint16_t tile = conv_HWC_get_tile_size(ch_in, ch_out, 3, budgets[i]);
+        if (tile == 0 || tile >= ch_out)
+        {
+            continue;
+        }
+        tile_sizeA = conv_HWC_tiled_get_buffer_size(dim, ch_in, tile, 3, &tile_sizeB);
+        snprintf(name, sizeof(name), "conv_HWC_tiled %ux%ux%u -> %u k3 tile %u", dim, dim, ch_in, ch_out, tile);
+        for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+        {
+            conv_HWC_tiled(in, dim, ch_in, wt, ch_out, 3, 1, bias, 2, 7, out, bufferA, bufferB, tile);
+        }
+        tiled = bench_stop(&b);
+        printf("tile %u: %.2fx single-shot speed, scratch %u bytes\n", tile, single / tiled,
+               tile_sizeA + tile_sizeB);
+    }
+}
+
+void bench_conv_tiled(void)
+{
+    bench_section("output-channel tiles");
+    bench_tiled(11, 64, 64);
+    bench_tiled(16, 32, 64);
+    nn_test_free_all();
+}
@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * Fused depthwise_pointwise_conv against depthwise_conv + pointwise_conv_fast
+ * through a full intermediate tensor, on the DS-CNN block shapes (11x11 in
+ * place of 25x5). RAM is the intermediate tensor plus scratch.
+ */
+
+static void bench_block(const char *size, const uint16_t ch)
+{
+    const uint16_t dim = 11;
+    uint32_t map = dim * dim * ch;
+    uint32_t dw_size = depthwise_conv_get_buffer_size(dim, ch, 3);
+    uint32_t pw_size = pointwise_conv_fast_get_buffer_size(ch);
+    uint32_t fused_size = depthwise_pointwise_conv_get_buffer_size(ch);
+    q7_t *in = nn_test_alloc(map);
+    q7_t *mid = nn_test_alloc(map);
+    q7_t *out = nn_test_alloc(map);
+    q7_t *dw_wt = nn_test_alloc(9 * ch);
+    q7_t *pw_wt = nn_test_alloc(ch * ch);
+    q7_t *bias = nn_test_alloc(ch);
+    q7_t *dw_buffer = nn_test_alloc(dw_size);
+    q15_t *bufferA = nn_test_alloc(pw_size > fused_size ? pw_size : fused_size);
+    uint64_t macs = (uint64_t)map * (9 + ch);
+    double separate, fused;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, map);
+    nn_test_fill(dw_wt, 9 * ch);
+    nn_test_fill(pw_wt, ch * ch);
+    nn_test_fill(bias, ch);
+
+    snprintf(name, sizeof(name), "%s depthwise_conv + pointwise_conv_fast %u ch", size, ch);
+    for (bench_start(&b, name, macs, 2 * map + 9 * ch + ch * ch + ch); bench_running(&b);)
+    {
+        depthwise_conv(in, dim, ch, dw_wt, 3, 1, 7, mid, dw_buffer);
+        pointwise_conv_fast(mid, dim, ch, pw_wt, ch, bias, 2, 7, out, bufferA);
+    }
+    separate = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s depthwise_pointwise_conv %u ch", size, ch);
+    for (bench_start(&b, name, macs, 2 * map + 9 * ch + ch * ch + ch); bench_running(&b);)
+    {
+        depthwise_pointwise_conv(in, dim, ch, dw_wt, 3, 1, 7, pw_wt, ch, bias, 2, 7, out, bufferA);
+    }
+    fused = bench_stop(&b);
+
+    printf("%s fused %.2fx, RAM %u -> %u bytes\n", size, separate / fused,
+           map + (dw_size > pw_size ? dw_size : pw_size), fused_size);
+}
+
+void bench_depthwise_pointwise(void)
+{
+    bench_section("fused depthwise + pointwise block");
+    bench_block("S", 64);
+    bench_block("M", 172);
+    bench_block("L", 276);
+    nn_test_free_all();
+}
@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * depthwise_conv, split into interior and border windows, against the padded
+ * version it replaced, on DS-CNN widths. The padded version is kept here as
+ * it was: the window is widened into bufferA with zeroed padding and every
+ * pixel runs all dim_kernel * dim_kernel taps.
+ */
+
+static void depthwise_conv_padded(const q7_t *Im_in,
+                                  const uint16_t dim_im_in,
+                                  const uint16_t ch_im_in,
+                                  const q7_t *wt,
+                                  const uint16_t dim_kernel,
+                                  const uint16_t padding,
+                                  const uint16_t out_shift,
+                                  q7_t *Im_out,
+                                  q7_t *bufferA)
+{
+    int16_t i_out_y, i_out_x;
+    q7_t *pBuffer = bufferA;
+    q7_t *pOut;
+    q7_t *data_source;
+    uint16_t rowCnt;
+    uint16_t row_shift;
+
+    uint16_t num_data_in_row = dim_kernel * ch_im_in;
+    uint16_t data_to_transfer;
+    uint32_t num_data_in_im_row = dim_im_in * ch_im_in;
+    uint16_t colCnt;
+    q7_t *pB;
+    q7_t *pA;
+    //set the top and bottom padding
+    memset((void *)pBuffer, 0, num_data_in_row * padding);
+    memset((void *)(pBuffer + num_data_in_row * (padding + dim_im_in)), 0, num_data_in_row * padding);
+
+    for (i_out_x = 0; i_out_x < dim_im_in; i_out_x++)
+    {
+        pBuffer = bufferA;
+        if (i_out_x < padding)
+        {
+            //set the left padding
+            memset((void *)(pBuffer + num_data_in_row * padding), 0, num_data_in_row * dim_im_in);
+            data_to_transfer = ch_im_in * (dim_kernel - padding + i_out_x);
+            pBuffer += num_data_in_row * padding + num_data_in_row - data_to_transfer;
+            data_source = (q7_t *)Im_in;
+            for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+            {
+                memcpy(pBuffer, data_source, data_to_transfer);
+                data_source += num_data_in_im_row;
+                pBuffer += num_data_in_row;
+            }
+        }
+        else if (i_out_x > (dim_im_in - padding - 1))
+        {
+            //set the right padding
+            memset((void *)(pBuffer + num_data_in_row * padding), 0, num_data_in_row * dim_im_in);
+            data_to_transfer = ch_im_in * (dim_kernel - (i_out_x + padding - (dim_im_in - 1)));
+            pBuffer += num_data_in_row * padding;
+            data_source = (q7_t *)Im_in + (i_out_x - padding) * ch_im_in;
+            for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+            {
+                memcpy(pBuffer, data_source, data_to_transfer);
+                data_source += num_data_in_im_row;
+                pBuffer += num_data_in_row;
+            }
+        }
+        else
+        {
+            pBuffer += num_data_in_row * padding;
+            data_source = (q7_t *)Im_in + (i_out_x - padding) * ch_im_in;
+            for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+            {
+                memcpy(pBuffer, data_source, num_data_in_row);
+                data_source += num_data_in_im_row;
+                pBuffer += num_data_in_row;
+            }
+        }
+
+        for (i_out_y = 0; i_out_y < dim_im_in; i_out_y++)
+        {
+            rowCnt = ch_im_in >> 2;
+            row_shift = 0;
+            pOut = Im_out + i_out_x * ch_im_in + i_out_y * num_data_in_im_row;
+            while (rowCnt)
+            {
+                q31_t sum = 0;
+                q31_t sum2 = 0;
+                q31_t sum3 = 0;
+                q31_t sum4 = 0;
+
+                colCnt = (dim_kernel * dim_kernel) >> 1;
+                pB = bufferA + num_data_in_row * i_out_y + row_shift;
+                pA = (q7_t *)wt + row_shift;
+
+                row_shift += 4;
+
+                while (colCnt)
+                {
+                    q31_t inA1, inA2, inB1, inB2, opA, opB;
+
+                    inB1 = *__SIMD32(pB);
+                    pB += ch_im_in;
+                    opB = *__SIMD32(pB);
+                    pB += ch_im_in;
+                    inB2 = __PKHTB(opB, inB1, 16);
+                    inB1 = __PKHBT(inB1, opB, 16);
+                    inA1 = *__SIMD32(pA);
+                    pA += ch_im_in;
+                    opB = *__SIMD32(pA);
+                    pA += ch_im_in;
+                    inA2 = __PKHTB(opB, inA1, 16);
+                    inA1 = __PKHBT(inA1, opB, 16);
+                    opA = __SXTB16(inA1);
+                    opB = __SXTB16(inB1);
+                    sum = __SMLAD(opA, opB, sum);
+                    opA = __SXTB16(__ROR(inA1, 8));
+                    opB = __SXTB16(__ROR(inB1, 8));
+                    sum2 = __SMLAD(opA, opB, sum2);
+                    opA = __SXTB16(inA2);
+                    opB = __SXTB16(inB2);
+                    sum3 = __SMLAD(opA, opB, sum3);
+                    opA = __SXTB16(__ROR(inA2, 8));
+                    opB = __SXTB16(__ROR(inB2, 8));
+                    sum4 = __SMLAD(opA, opB, sum4);
+                    colCnt--;
+                }
+
+                colCnt = (dim_kernel * dim_kernel) & 0x1;
+                while (colCnt)
+                {
+                    union arm_nnword inA, inB;
+                    inA.word = *__SIMD32(pA);
+                    pA += ch_im_in;
+                    inB.word = *__SIMD32(pB);
+                    pB += ch_im_in;
+                    sum += inA.bytes[0] * inB.bytes[0];
+                    sum2 += inA.bytes[1] * inB.bytes[1];
+                    sum3 += inA.bytes[2] * inB.bytes[2];
+                    sum4 += inA.bytes[3] * inB.bytes[3];
+                    colCnt--;
+                }
+
+                *pOut++ = (q7_t)__SSAT((sum  >> out_shift), 8);
+                *pOut++ = (q7_t)__SSAT((sum2 >> out_shift), 8);
+                *pOut++ = (q7_t)__SSAT((sum3 >> out_shift), 8);
+                *pOut++ = (q7_t)__SSAT((sum4 >> out_shift), 8);
+
+                rowCnt--;
+            }
+
+            rowCnt = ch_im_in & 0x3;
+            while (rowCnt)
+            {
+                pB = bufferA + num_data_in_row * i_out_y + row_shift;
+                pA = (q7_t *)wt + row_shift;
+                q31_t sum = 0;
+                uint16_t colCnt = (dim_kernel * dim_kernel);
+
+                row_shift += 1;
+
+                while (colCnt)
+                {
+                    q7_t A1 = *pA;
+                    q7_t B1 = *pB;
+                    pA += ch_im_in;
+                    pB += ch_im_in;
+                    sum += A1 * B1;
+
+                    colCnt--;
+                }
+                *pOut++ = (q7_t)__SSAT((sum >> out_shift), 8);
+                rowCnt--;
+            }
+        }
+    }
+}
+
+static void bench_split(const char *size, const uint16_t dim, const uint16_t ch)
+{
+    uint32_t map = dim * dim * ch;
+    q7_t *in = nn_test_alloc(map);
+    q7_t *out = nn_test_alloc(map);
+    q7_t *wt = nn_test_alloc(9 * ch);
+    q7_t *bufferA = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch, 3));
+    double padded, split;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, map);
+    nn_test_fill(wt, 9 * ch);
+
+    snprintf(name, sizeof(name), "%s padded depthwise_conv %ux%ux%u k3", size, dim, dim, ch);
+    for (bench_start(&b, name, (uint64_t)map * 9, 2 * map + 9 * ch); bench_running(&b);)
+    {
+        depthwise_conv_padded(in, dim, ch, wt, 3, 1, 7, out, bufferA);
+    }
+    padded = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s depthwise_conv %ux%ux%u k3", size, dim, dim, ch);
+    for (bench_start(&b, name, (uint64_t)map * 9, 2 * map + 9 * ch); bench_running(&b);)
+    {
+        depthwise_conv(in, dim, ch, wt, 3, 1, 7, out, bufferA);
+    }
+    split = bench_stop(&b);
+    printf("%s %ux%u split %.2fx\n", size, dim, dim, padded / split);
+}
+
+void bench_depthwise_split(void)
+{
+    static const uint16_t dims[] = {5, 7, 11};
+    uint32_t i;
+    bench_section("depthwise border/interior split");
+    for (i = 0; i < sizeof(dims) / sizeof(dims[0]); i++)
+    {
+        bench_split("S", dims[i], 64);
+        bench_split("M", dims[i], 172);
+        bench_split("L", dims[i], 276);
+    }
+    nn_test_free_all();
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * DS-CNN keyword spotting layers (49x10 MFCC input, 10x4 conv with stride 2
+ * to a 25x5 map, then 3x3 depthwise + pointwise blocks) for the S, M and L
+ * widths. The square kernels run on 11x11 (121 pixels) in place of the 25x5
+ * map (125 pixels).
+ */
+
+static void bench_width(const char *size, const uint16_t ch)
+{
+    const uint16_t dim = 11;
+    const uint16_t map_x = 5, map_y = 25;
+    uint32_t map = dim * dim * ch;
+    q7_t *in = nn_test_alloc(49 * 10);
+    q7_t *act = nn_test_alloc(map_x * map_y * ch > map ? map_x * map_y * ch : map);
+    q7_t *out = nn_test_alloc(map_x * map_y * ch > map ? map_x * map_y * ch : map);
+    q7_t *conv_wt = nn_test_alloc(ch * 10 * 4);
+    q7_t *dw_wt = nn_test_alloc(9 * ch);
+    q7_t *pw_wt = nn_test_alloc(ch * ch);
+    q7_t *bias = nn_test_alloc(ch);
+    uint32_t sizeA, sizeB;
+    q15_t *bufferA, *bufferB;
+    q7_t *dw_buffer;
+    char name[64];
+    nn_bench b;
+
+    nn_test_fill(in, 49 * 10);
+    nn_test_fill(act, map_x * map_y * ch > map ? map_x * map_y * ch : map);
+    nn_test_fill_range(conv_wt, ch * 10 * 4, 20);
+    nn_test_fill(dw_wt, 9 * ch);
+    nn_test_fill(pw_wt, ch * ch);
+    nn_test_fill(bias, ch);
+
+    sizeA = conv_HWC_nonsquare_get_buffer_size(49, 1, ch, 4, 10, 4, 5, &sizeB);
+    bufferA = nn_test_alloc(sizeA);
+    bufferB = nn_test_alloc(sizeB);
+    snprintf(name, sizeof(name), "%s conv_HWC_nonsquare 49x10x1 -> %u k10x4 s2", size, ch);
+    for (bench_start(&b, name, (uint64_t)map_x * map_y * ch * 40, 490 + ch * 40 + map_x * map_y * ch);
+         bench_running(&b);)
+    {
+        conv_HWC_nonsquare(in, 10, 49, 1, conv_wt, ch, 4, 10, 4, 5, 1, 2, 2, 2, bias, 2, 7, out, bufferA, bufferB);
+    }
+    bench_stop(&b);
+
+    dw_buffer = nn_test_alloc(depthwise_conv_nonsquare_get_buffer_size(map_y, ch, 3, 1, 1));
+    snprintf(name, sizeof(name), "%s depthwise_conv_nonsquare 25x5x%u k3", size, ch);
+    for (bench_start(&b, name, (uint64_t)map_x * map_y * ch * 9, 2 * map_x * map_y * ch + 9 * ch); bench_running(&b);)
+    {
+        depthwise_conv_nonsquare(act, map_x, map_y, ch, dw_wt, 3, 3, 1, 1, 1, 1, 1, 1, 7, out, dw_buffer);
+    }
+    bench_stop(&b);
+
+    dw_buffer = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch, 3));
+    snprintf(name, sizeof(name), "%s depthwise_conv 11x11x%u k3", size, ch);
+    for (bench_start(&b, name, (uint64_t)map * 9, 2 * map + 9 * ch); bench_running(&b);)
+    {
+        depthwise_conv(act, dim, ch, dw_wt, 3, 1, 7, out, dw_buffer);
+    }
+    bench_stop(&b);
+
+    bufferA = nn_test_alloc(pointwise_conv_fast_get_buffer_size(ch));
+    snprintf(name, sizeof(name), "%s pointwise_conv_fast 11x11x%u -> %u", size, ch, ch);
+    for (bench_start(&b, name, (uint64_t)map * ch, 2 * map + ch * ch + ch); bench_running(&b);)
+    {
+        pointwise_conv_fast(act, dim, ch, pw_wt, ch, bias, 2, 7, out, bufferA);
+    }
+    bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s pointwise_conv_basic 11x11x%u -> %u", size, ch, ch);
+    for (bench_start(&b, name, (uint64_t)map * ch, 2 * map + ch * ch + ch); bench_running(&b);)
+    {
+        pointwise_conv_basic(act, dim, ch, pw_wt, ch, bias, 2, 7, out, bufferA);
+    }
+    bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s global_avg_pool_q7_HWC 25x5x%u", size, ch);
+    for (bench_start(&b, name, (uint64_t)map_x * map_y * ch, map_x * map_y * ch + ch); bench_running(&b);)
+    {
+        global_avg_pool_q7_HWC(act, map_x, map_y, ch, out);
+    }
+    bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s avg_pool_q7_HWC_opt 10x10x%u", size, ch);
+    for (bench_start(&b, name, (uint64_t)100 * ch, 125 * ch); bench_running(&b);)
+    {
+        avg_pool_q7_HWC_opt(act, 10, ch, out);
+    }
+    bench_stop(&b);
+}
+
+void bench_dscnn(void)
+{
+    bench_section("DS-CNN layers");
+    bench_width("S", 64);
+    bench_width("M", 172);
+    bench_width("L", 276);
+    nn_test_free_all();
+}
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * The shape-specialised variants against the generic code they replace:
+ * depthwise_pixel_3x3 against depthwise_pixel on the same 3x3 window, the
+ * fixed-width pointwise mat mults against arm_nn_mat_mult_kernel_q7_q15_reordered
+ * on the same 2 columns, and conv_HWC with ch_im_in multiple of 8 (no
+ * leftover loop) against the neighbouring channel counts, per MAC, as the
+ * dispatch cannot be bypassed for the same shape. The kernels only dispatch
+ * to these variants when built with -DNN_FIXED_KERNELS (make bench
+ * DEFS=-DNN_FIXED_KERNELS); without it the pointwise and conv_HWC lines
+ * compare the generic code with itself or are skipped.
+ */
+
+static void bench_depthwise_3x3(const char *size, const uint16_t ch)
+{
+    q7_t *win = nn_test_alloc(9 * ch);
+    q7_t *wt = nn_test_alloc(9 * ch);
+    q7_t *out = nn_test_alloc(ch);
+    double generic, fixed;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(win, 9 * ch);
+    nn_test_fill(wt, 9 * ch);
+
+    snprintf(name, sizeof(name), "%s depthwise_pixel 3x3x%u", size, ch);
+    for (bench_start(&b, name, 9 * ch, 19 * ch); bench_running(&b);)
+    {
+        depthwise_pixel(win, wt, ch, 3, 3, 3 * ch, 7, NULL, out);
+    }
+    generic = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s depthwise_pixel_3x3 3x3x%u", size, ch);
+    for (bench_start(&b, name, 9 * ch, 19 * ch); bench_running(&b);)
+    {
+        depthwise_pixel_3x3(win, wt, ch, 7, NULL, out);
+    }
+    fixed = bench_stop(&b);
+    printf("%s depthwise 3x3x%u: unrolled %.2fx\n", size, ch, generic / fixed);
+}
+
+static void bench_pointwise_fixed(const uint16_t ch_in, const uint16_t ch_out)
+{
+    nn_mat_mult_fixed_fn fn = nn_mat_mult_kernel_q7_q15_reordered_fixed(ch_in);
+    q7_t *in = nn_test_alloc(2 * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(2 * ch_out);
+    q15_t *bufferA = nn_test_alloc(pointwise_conv_fast_get_buffer_size(ch_in));
+    uint64_t macs = 2 * (uint64_t)ch_in * ch_out;
+    uint32_t bytes = 2 * ch_in + ch_out * ch_in + 2 * ch_out;
+    double generic, fixed;
+    char name[80];
+    nn_bench b;
+
+    if (fn == NULL)
+    {
+        printf("pointwise %u -> %u: no fixed kernel (built without NN_FIXED_KERNELS)\n", ch_in, ch_out);
+        return;
+    }
+    nn_test_fill(in, 2 * ch_in);
+    nn_test_fill(wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+    arm_q7_to_q15_reordered_no_shift(in, bufferA, ch_in);
+    arm_q7_to_q15_reordered_no_shift(in + ch_in, bufferA + ch_in, ch_in);
+
+    snprintf(name, sizeof(name), "mat_mult reordered 2 x %u -> %u", ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        arm_nn_mat_mult_kernel_q7_q15_reordered(wt, bufferA, ch_out, ch_in, 2, 7, bias, out);
+    }
+    generic = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "mat_mult reordered fixed 2 x %u -> %u", ch_in, ch_out);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        fn(wt, bufferA, ch_out, 2, 7, bias, NULL, out);
+    }
+    fixed = bench_stop(&b);
+    printf("pointwise %u -> %u: fixed %.2fx\n", ch_in, ch_out, generic / fixed);
+}
+
+// MACs per nanosecond of conv_HWC
+static double bench_conv_rate(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t wt_size = ch_out * kernel * kernel * ch_in;
+    uint64_t macs = (uint64_t)out_size * kernel * kernel * ch_in;
+    uint32_t size_b;
+    q7_t *in = nn_test_alloc(in_size);
+    q7_t *wt = nn_test_alloc(wt_size);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &size_b));
+    q15_t *bufferB = nn_test_alloc(size_b);
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, in_size);
+    nn_test_fill_range(wt, wt_size, 32);
+    nn_test_fill(bias, ch_out);
+
+    snprintf(name, sizeof(name), "conv_HWC %ux%ux%u -> %u k%u", dim, dim, ch_in, ch_out, kernel);
+    for (bench_start(&b, name, macs, in_size + wt_size + out_size); bench_running(&b);)
+    {
+        conv_HWC(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+    }
+    return macs / bench_stop(&b);
+}
+
+static void bench_conv_mult8(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    double below = bench_conv_rate(dim, ch_in - 2, ch_out, kernel);
+    double mult8 = bench_conv_rate(dim, ch_in, ch_out, kernel);
+    double above = bench_conv_rate(dim, ch_in + 2, ch_out, kernel);
+
+    printf("conv_HWC %ux%ux%u -> %u k%u: MACs/ns %.2fx the mean of ch_im_in %u and %u\n", dim, dim, ch_in, ch_out,
+           kernel, 2 * mult8 / (below + above), ch_in - 2, ch_in + 2);
+}
+
+void bench_fixed(void)
+{
+    bench_section("specialised variants vs generic");
+    // DS-CNN S, M and L depthwise layers
+    bench_depthwise_3x3("S", 64);
+    bench_depthwise_3x3("M", 172);
+    bench_depthwise_3x3("L", 276);
+    bench_pointwise_fixed(64, 64);
+    bench_pointwise_fixed(128, 128);
+    bench_pointwise_fixed(172, 172);
+    bench_pointwise_fixed(276, 276);
+    bench_conv_mult8(10, 8, 16, 3);
+    bench_conv_mult8(10, 16, 16, 3);
+    bench_conv_mult8(8, 32, 32, 3);
+    nn_test_free_all();
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+#include "weight_packer.h"
+
+/*
+ * pointwise_conv_fast_int4 and conv_HWC_int4 against pointwise_conv_fast and
+ * conv_HWC on the expanded weights, per layer: the DS-CNN S, M and L
+ * pointwise layers on the 11x11 stand-in map and a 3x3 conv of each width.
+ * The summary gives the int4/q7 speed and the weight bytes of both.
+ */
+
+static void bench_layer(const char *size, const uint16_t dim, const uint16_t ch, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t row_len = kernel * kernel * ch;
+    uint32_t wt_bytes = row_len * ch;
+    uint32_t map = dim * dim * ch;
+    uint64_t macs = (uint64_t)map * row_len;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch, ch, kernel, &sizeB);
+    q7_t *in = nn_test_alloc(map);
+    q7_t *out = nn_test_alloc(map);
+    q7_t *wt = nn_test_alloc(wt_bytes);
+    q7_t *expanded = nn_test_alloc(wt_bytes);
+    uint8_t *packed = nn_test_alloc(wt_bytes / 2);
+    uint8_t *shift = nn_test_alloc(ch);
+    q7_t *bias = nn_test_alloc(ch);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    nn_int4_weights w;
+    double q7, int4;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, map);
+    nn_test_fill(wt, wt_bytes);
+    nn_test_fill(bias, ch);
+    if (kernel == 1)
+    {
+        pack_pointwise_int4_weights(wt, ch, ch, 1, packed, shift, expanded);
+    }
+    else
+    {
+        pack_conv_int4_weights(wt, ch, ch, kernel, 1, packed, shift, expanded);
+    }
+    w.values = (const q7_t *)packed;
+    w.shift = shift;
+    w.layer_shift = 0;
+
+    snprintf(name, sizeof(name), "%s %s %ux%ux%u -> %u", size, kernel == 1 ? "pointwise_conv_fast" : "conv_HWC 3x3",
+             dim, dim, ch, ch);
+    for (bench_start(&b, name, macs, 2 * map + wt_bytes); bench_running(&b);)
+    {
+        if (kernel == 1)
+        {
+            pointwise_conv_fast(in, dim, ch, expanded, ch, bias, 2, 7, out, bufferA);
+        }
+        else
+        {
+            conv_HWC(in, dim, ch, expanded, ch, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+        }
+    }
+    q7 = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s %s %ux%ux%u -> %u", size,
+             kernel == 1 ? "pointwise_conv_fast_int4" : "conv_HWC_int4 3x3", dim, dim, ch, ch);
+    for (bench_start(&b, name, macs, 2 * map + wt_bytes / 2); bench_running(&b);)
+    {
+        if (kernel == 1)
+        {
+            pointwise_conv_fast_int4(in, dim, ch, &w, ch, bias, 2, 7, out, bufferA);
+        }
+        else
+        {
+            conv_HWC_int4(in, dim, ch, &w, ch, kernel, padding, bias, 2, 7, out, bufferA);
+        }
+    }
+    int4 = bench_stop(&b);
+
+    printf("%s k%u %ux%ux%u: int4 %.2fx q7, weights %u -> %u bytes\n", size, kernel, dim, dim, ch, q7 / int4,
+           wt_bytes, wt_bytes / 2);
+}
+
+void bench_int4(void)
+{
+    bench_section("int4 weights vs q7, per layer");
+    bench_layer("S", 11, 64, 1);
+    bench_layer("M", 11, 172, 1);
+    bench_layer("L", 11, 276, 1);
+    bench_layer("S", 11, 64, 3);
+    bench_layer("M", 11, 172, 3);
+    bench_layer("L", 11, 276, 3);
+    nn_test_free_all();
+}
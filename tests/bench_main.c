@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <string.h>
+#include "nn_bench.h"
+
+typedef struct
+{
+    const char *name;
+    void (*run)(void);
+} nn_bench_suite;
+
+static const nn_bench_suite suites[] = {
+    {"dscnn", bench_dscnn},
+    {"depthwise_pointwise", bench_depthwise_pointwise},
+    {"conv_ring", bench_conv_ring},
+    {"conv_packed", bench_conv_packed},
+    {"conv_tiled", bench_conv_tiled},
+    {"depthwise_split", bench_depthwise_split},
+    {"conv_blocked", bench_conv_blocked},
+    {"pool", bench_pool},
+    {"parallel", bench_parallel},
+    {"batch", bench_batch},
+    {"fixed", bench_fixed},
+    {"stream", bench_stream},
+    {"pointwise_4x2", bench_pointwise_4x2},
+    {"sparse", bench_sparse},
+    {"int4", bench_int4},
+    {"mult", bench_mult},
+    {"conv_q7", bench_conv_q7},
+};
+
+// Usage: nn_bench [suite ...], all suites by default
+int main(int argc, char **argv)
+{
+    uint32_t i;
+    int j;
+    for (i = 0; i < sizeof(suites) / sizeof(suites[0]); i++)
+    {
+        int run = argc < 2;
+        for (j = 1; j < argc; j++)
+        {
+            run |= strcmp(argv[j], suites[i].name) == 0;
+        }
+        if (run)
+        {
+            suites[i].run();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * depthwise_conv_mult against the paths a model falls back to without it, on
+ * the 11x11 stand-in for the DS-CNN 25x5 map: ref_depthwise (the plain C
+ * loop of the reference kernels), and either depthwise_conv_ep on the
+ * zero-filled dilated kernel (multiplier 1) or conv_HWC on the dense
+ * block-diagonal kernel (multiplier > 1), zero-filled when dilated. MACs are
+ * those of the depthwise layer for every path.
+ */
+
+static void bench_layer(const uint16_t dim, const uint16_t ch, const uint16_t mult, const uint16_t kernel,
+                        const uint16_t dilation)
+{
+    uint16_t padding = (kernel - 1) * dilation / 2;
+    uint16_t ch_out = ch * mult;
+    uint16_t kernel_full = (kernel - 1) * dilation + 1;
+    uint32_t out_size = dim * dim * ch_out;
+    uint64_t macs = (uint64_t)out_size * kernel * kernel;
+    uint32_t bytes = dim * dim * ch + kernel * kernel * ch_out + ch_out + out_size;
+    ref_shape s = ref_square(dim, ch, ch_out, kernel, padding);
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *wt = nn_test_alloc(kernel * kernel * ch_out);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *bufferA = nn_test_alloc(depthwise_conv_mult_get_buffer_size(dim, ch, kernel));
+    nn_epilogue ep = {bias, 2, NULL, -128, 127};
+    double fast, ref, fallback;
+    char cfg[48], name[96];
+    uint16_t ky, kx, o;
+    nn_bench b;
+
+    s.dilation = dilation;
+    s.out_x = s.out_y = dim;
+    nn_test_fill(in, dim * dim * ch);
+    nn_test_fill(wt, kernel * kernel * ch_out);
+    nn_test_fill(bias, ch_out);
+    snprintf(cfg, sizeof(cfg), "%ux%ux%u x%u k%u d%u", dim, dim, ch, mult, kernel, dilation);
+
+    snprintf(name, sizeof(name), "depthwise_conv_mult %s", cfg);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        depthwise_conv_mult(in, dim, ch, wt, mult, kernel, padding, dilation, bias, 2, 7, out, bufferA);
+    }
+    fast = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "ref_depthwise %s", cfg);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        ref_depthwise(&s, in, wt, bias, 2, 7, 0, NULL, out);
+    }
+    ref = bench_stop(&b);
+
+    if (mult == 1)
+    {
+        // Dilated taps at their offsets in a kernel_full x kernel_full kernel, zeros between
+        q7_t *wt_full = nn_test_alloc(kernel_full * kernel_full * ch);
+        q7_t *buffer_full = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch, kernel_full));
+        memset(wt_full, 0, kernel_full * kernel_full * ch);
+        for (ky = 0; ky < kernel; ky++)
+        {
+            for (kx = 0; kx < kernel; kx++)
+            {
+                memcpy(wt_full + (ky * dilation * kernel_full + kx * dilation) * ch, wt + (ky * kernel + kx) * ch, ch);
+            }
+        }
+        snprintf(name, sizeof(name), "depthwise_conv_ep k%u %s", kernel_full, cfg);
+        for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+        {
+            depthwise_conv_ep(in, dim, ch, wt_full, kernel_full, padding, 7, out, buffer_full, &ep);
+        }
+        fallback = bench_stop(&b);
+    }
+    else
+    {
+        // Output channel o reads only input channel o / mult: one non-zero per tap of a dense conv row
+        uint32_t row_len = kernel_full * kernel_full * ch;
+        uint32_t sizeB;
+        uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch, ch_out, kernel_full, &sizeB);
+        q7_t *wt_full = nn_test_alloc(row_len * ch_out);
+        q15_t *conv_A = nn_test_alloc(sizeA);
+        q15_t *conv_B = nn_test_alloc(sizeB);
+        memset(wt_full, 0, row_len * ch_out);
+        for (o = 0; o < ch_out; o++)
+        {
+            for (ky = 0; ky < kernel; ky++)
+            {
+                for (kx = 0; kx < kernel; kx++)
+                {
+                    wt_full[o * row_len + (ky * dilation * kernel_full + kx * dilation) * ch + o / mult] =
+                        wt[(ky * kernel + kx) * ch_out + o];
+                }
+            }
+        }
+        snprintf(name, sizeof(name), "conv_HWC k%u %s", kernel_full, cfg);
+        for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+        {
+            conv_HWC(in, dim, ch, wt_full, ch_out, kernel_full, padding, bias, 2, 7, out, conv_A, conv_B);
+        }
+        fallback = bench_stop(&b);
+    }
+
+    printf("%s: depthwise_conv_mult %.2fx ref_depthwise, %.2fx %s\n", cfg, ref / fast, fallback / fast,
+           mult == 1 ? "depthwise_conv_ep on the zero-filled kernel" : "conv_HWC on the block-diagonal kernel");
+}
+
+void bench_mult(void)
+{
+    bench_section("depthwise with channel multiplier, bias and dilation vs fallbacks");
+    bench_layer(11, 64, 1, 3, 1);
+    bench_layer(11, 64, 1, 3, 2);
+    bench_layer(11, 64, 2, 3, 1);
+    bench_layer(11, 64, 2, 3, 2);
+    bench_layer(11, 32, 4, 3, 1);
+    bench_layer(11, 172, 2, 3, 1);
+    nn_test_free_all();
+}
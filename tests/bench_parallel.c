@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_parallel.h"
+#include "nn_test.h"
+
+/*
+ * nn_parallel_run on 1, 2, 4 and 8 threads, per graph: a DS-CNN M
+ * depthwise + pointwise block on 11x11, a conv layer and two max pools. Every
+ * round starts and joins the workers, as a real call does. The speedup is
+ * bounded by the host's core count and by the barrier after every layer.
+ */
+
+#define BENCH_MAX_THREADS 8
+
+static void bench_graph(const char *title, const nn_layer *layers, const uint16_t num_layers,
+                        const uint32_t in_size)
+{
+    uint32_t buf_size = 32 * 32 * 172, scratch_size = 4;
+    q7_t *buf0 = nn_test_alloc(buf_size);
+    q7_t *buf1 = nn_test_alloc(buf_size);
+    q7_t *scratch;
+    uint64_t macs = 0;
+    double single = 0, t;
+    char name[80];
+    nn_graph g;
+    nn_bench b;
+    uint16_t i, threads;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        uint32_t s = nn_graph_scratch_size(&layers[i]);
+        uint32_t out = (uint32_t)nn_layer_num_rows(&layers[i]) * nn_layer_num_rows(&layers[i]);
+        scratch_size = s > scratch_size ? s : scratch_size;
+        switch (layers[i].op)
+        {
+        case NN_OP_CONV:
+            macs += (uint64_t)out * layers[i].ch_im_out * layers[i].dim_kernel * layers[i].dim_kernel *
+                    layers[i].ch_im_in;
+            break;
+        case NN_OP_POINTWISE:
+            macs += (uint64_t)out * layers[i].ch_im_out * layers[i].ch_im_in;
+            break;
+        default:
+            macs += (uint64_t)out * layers[i].ch_im_in * layers[i].dim_kernel * layers[i].dim_kernel;
+            break;
+        }
+    }
+    scratch_size = (scratch_size + 3) & ~3u;
+    scratch = nn_test_alloc(scratch_size * BENCH_MAX_THREADS);
+    nn_test_fill(buf0, in_size);
+    if (nn_graph_init(&g, layers, num_layers, buf0, buf1, buf_size, scratch, scratch_size) != NN_GRAPH_OK)
+    {
+        printf("%s: nn_graph_init failed at layer %u\n", title, g.err_layer);
+        return;
+    }
+
+    for (threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2)
+    {
+        snprintf(name, sizeof(name), "%s, %u threads", title, threads);
+        for (bench_start(&b, name, macs, in_size); bench_running(&b);)
+        {
+            nn_parallel_run(&g, 0, num_layers - 1, threads, scratch + scratch_size, scratch_size);
+        }
+        t = bench_stop(&b);
+        if (threads == 1)
+        {
+            single = t;
+        }
+        else
+        {
+            printf("%s: %u threads %.2fx\n", title, threads, single / t);
+        }
+    }
+}
+
+void bench_parallel(void)
+{
+    uint16_t ch = 172;
+    q7_t *conv_wt = nn_test_alloc(9 * 32 * 32);
+    q7_t *dw_wt = nn_test_alloc(9 * ch);
+    q7_t *pw_wt = nn_test_alloc(ch * ch);
+    q7_t *bias = nn_test_alloc(ch);
+    const nn_layer dscnn[] = {
+        {NN_OP_DEPTHWISE, 11, 172, 172, 3, 1, 1, 11, dw_wt, NULL, 0, 7, NULL},
+        {NN_OP_POINTWISE, 11, 172, 172, 1, 0, 1, 11, pw_wt, bias, 2, 7, NULL},
+    };
+    const nn_layer conv[] = {
+        {NN_OP_CONV, 16, 32, 32, 3, 1, 1, 16, conv_wt, bias, 2, 7, NULL},
+    };
+    const nn_layer max_pools[] = {
+        {NN_OP_MAX_POOL, 32, 64, 64, 3, 1, 1, 32, NULL, NULL, 0, 0, NULL},
+        {NN_OP_MAX_POOL, 32, 64, 64, 2, 0, 2, 16, NULL, NULL, 0, 0, NULL},
+    };
+
+    nn_test_fill_range(conv_wt, 9 * 32 * 32, 20);
+    nn_test_fill(dw_wt, 9 * ch);
+    nn_test_fill(pw_wt, ch * ch);
+    nn_test_fill(bias, ch);
+
+    bench_section("nn_parallel_run thread scaling");
+    bench_graph("M dw+pw 11x11x172", dscnn, 2, 11 * 11 * 172);
+    bench_graph("conv 16x16x32 -> 32 k3", conv, 1, 16 * 16 * 32);
+    bench_graph("max pool x2 32x32x64", max_pools, 2, 32 * 32 * 64);
+    nn_test_free_all();
+}
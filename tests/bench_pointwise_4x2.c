@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * pointwise_conv_4x2 against pointwise_conv_fast and pointwise_conv_basic on
+ * the DS-CNN S, M and L pointwise layers: the 11x11 stand-in for the 25x5
+ * map (121 pixels, a 1-pixel tail) and a 5x5 map (25 pixels). The summary
+ * gives the weight matrix reads per layer: one per 2 pixels (plus one for an
+ * odd pixel) for the 2-column kernels, one per 4 pixels plus the tails for
+ * pointwise_conv_4x2.
+ */
+
+static void bench_layer(const char *size, const uint16_t dim, const uint16_t ch)
+{
+    uint32_t pixels = dim * dim;
+    uint32_t map = pixels * ch;
+    uint64_t macs = (uint64_t)map * ch;
+    uint32_t bytes = 2 * map + ch * ch + ch;
+    q7_t *in = nn_test_alloc(map);
+    q7_t *out = nn_test_alloc(map);
+    q7_t *wt = nn_test_alloc(ch * ch);
+    q7_t *bias = nn_test_alloc(ch);
+    q15_t *bufferA = nn_test_alloc(pointwise_conv_4x2_get_buffer_size(ch));
+    uint32_t reads_2 = (pixels + 1) / 2;
+    uint32_t reads_4 = pixels / 4 + ((pixels & 0x2) >> 1) + (pixels & 0x1);
+    double basic, fast, blocked;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, map);
+    nn_test_fill(wt, ch * ch);
+    nn_test_fill(bias, ch);
+
+    snprintf(name, sizeof(name), "%s pointwise_conv_basic %ux%ux%u -> %u", size, dim, dim, ch, ch);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        pointwise_conv_basic(in, dim, ch, wt, ch, bias, 2, 7, out, bufferA);
+    }
+    basic = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s pointwise_conv_fast %ux%ux%u -> %u", size, dim, dim, ch, ch);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        pointwise_conv_fast(in, dim, ch, wt, ch, bias, 2, 7, out, bufferA);
+    }
+    fast = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s pointwise_conv_4x2 %ux%ux%u -> %u", size, dim, dim, ch, ch);
+    for (bench_start(&b, name, macs, bytes); bench_running(&b);)
+    {
+        pointwise_conv_4x2(in, dim, ch, wt, ch, bias, 2, 7, out, bufferA);
+    }
+    blocked = bench_stop(&b);
+
+    printf("%s %ux%ux%u: 4x2 %.2fx fast, %.2fx basic; weight reads %u -> %u (%u KB -> %u KB)\n", size, dim, dim, ch,
+           fast / blocked, basic / blocked, reads_2, reads_4, reads_2 * ch * ch / 1024, reads_4 * ch * ch / 1024);
+}
+
+void bench_pointwise_4x2(void)
+{
+    bench_section("pointwise 4 pixels x 2 channels vs 2 x 2");
+    bench_layer("S", 11, 64);
+    bench_layer("S", 5, 64);
+    bench_layer("M", 11, 172);
+    bench_layer("M", 5, 172);
+    bench_layer("L", 11, 276);
+    bench_layer("L", 5, 276);
+    nn_test_free_all();
+}
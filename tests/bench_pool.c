@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+
+/*
+ * avg_pool_q7_HWC, max_pool_q7_HWC and global_avg_pool_q7_HWC against the
+ * scalar CMSIS-NN pools they replace (arm_avepool_q7_HWC and
+ * arm_maxpool_q7_HWC without ARM_MATH_DSP), kept here as they are: one
+ * channel at a time, a bounds check per tap, no buffer.
+ */
+
+static void arm_avepool_q7_HWC_scalar(const q7_t *Im_in,
+                                      const uint16_t dim_im_in,
+                                      const uint16_t ch_im_in,
+                                      const uint16_t dim_kernel,
+                                      const uint16_t padding,
+                                      const uint16_t stride,
+                                      const uint16_t dim_im_out,
+                                      q7_t *Im_out)
+{
+    int16_t i_ch_in, i_x, i_y;
+    int16_t k_x, k_y;
+
+    for (i_ch_in = 0; i_ch_in < ch_im_in; i_ch_in++)
+    {
+        for (i_y = 0; i_y < dim_im_out; i_y++)
+        {
+            for (i_x = 0; i_x < dim_im_out; i_x++)
+            {
+                int sum = 0;
+                int count = 0;
+                for (k_y = i_y * stride - padding; k_y < i_y * stride - padding + dim_kernel; k_y++)
+                {
+                    for (k_x = i_x * stride - padding; k_x < i_x * stride - padding + dim_kernel; k_x++)
+                    {
+                        if (k_y >= 0 && k_x >= 0 && k_y < dim_im_in && k_x < dim_im_in)
+                        {
+                            sum += Im_in[i_ch_in + ch_im_in * (k_x + k_y * dim_im_in)];
+                            count++;
+                        }
+                    }
+                }
+                Im_out[i_ch_in + ch_im_in * (i_x + i_y * dim_im_out)] = sum / count;
+            }
+        }
+    }
+}
+
+static void arm_maxpool_q7_HWC_scalar(const q7_t *Im_in,
+                                      const uint16_t dim_im_in,
+                                      const uint16_t ch_im_in,
+                                      const uint16_t dim_kernel,
+                                      const uint16_t padding,
+                                      const uint16_t stride,
+                                      const uint16_t dim_im_out,
+                                      q7_t *Im_out)
+{
+    int16_t i_ch_in, i_x, i_y;
+    int16_t k_x, k_y;
+
+    for (i_ch_in = 0; i_ch_in < ch_im_in; i_ch_in++)
+    {
+        for (i_y = 0; i_y < dim_im_out; i_y++)
+        {
+            for (i_x = 0; i_x < dim_im_out; i_x++)
+            {
+                int max = -129;
+                for (k_y = i_y * stride - padding; k_y < i_y * stride - padding + dim_kernel; k_y++)
+                {
+                    for (k_x = i_x * stride - padding; k_x < i_x * stride - padding + dim_kernel; k_x++)
+                    {
+                        if (k_y >= 0 && k_x >= 0 && k_y < dim_im_in && k_x < dim_im_in)
+                        {
+                            if (Im_in[i_ch_in + ch_im_in * (k_x + k_y * dim_im_in)] > max)
+                            {
+                                max = Im_in[i_ch_in + ch_im_in * (k_x + k_y * dim_im_in)];
+                            }
+                        }
+                    }
+                }
+                Im_out[i_ch_in + ch_im_in * (i_x + i_y * dim_im_out)] = max;
+            }
+        }
+    }
+}
+
+static void bench_layer(const uint16_t dim, const uint16_t ch, const uint16_t kernel, const uint16_t padding,
+                        const uint16_t stride)
+{
+    uint16_t dim_out = (dim + 2 * padding - kernel) / stride + 1;
+    uint32_t in_size = dim * dim * ch;
+    uint32_t out_size = dim_out * dim_out * ch;
+    q7_t *in = nn_test_alloc(in_size);
+    q7_t *out = nn_test_alloc(out_size);
+    uint64_t taps = (uint64_t)out_size * kernel * kernel;
+    double scalar, simd;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, in_size);
+
+    snprintf(name, sizeof(name), "arm_avepool_q7_HWC %ux%ux%u k%u s%u", dim, dim, ch, kernel, stride);
+    for (bench_start(&b, name, taps, in_size + out_size); bench_running(&b);)
+    {
+        arm_avepool_q7_HWC_scalar(in, dim, ch, kernel, padding, stride, dim_out, out);
+    }
+    scalar = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "avg_pool_q7_HWC %ux%ux%u k%u s%u", dim, dim, ch, kernel, stride);
+    for (bench_start(&b, name, taps, in_size + out_size); bench_running(&b);)
+    {
+        avg_pool_q7_HWC(in, dim, ch, kernel, padding, stride, dim_out, out);
+    }
+    simd = bench_stop(&b);
+    printf("avg %ux%ux%u k%u s%u: %.2fx scalar\n", dim, dim, ch, kernel, stride, scalar / simd);
+
+    snprintf(name, sizeof(name), "arm_maxpool_q7_HWC %ux%ux%u k%u s%u", dim, dim, ch, kernel, stride);
+    for (bench_start(&b, name, taps, in_size + out_size); bench_running(&b);)
+    {
+        arm_maxpool_q7_HWC_scalar(in, dim, ch, kernel, padding, stride, dim_out, out);
+    }
+    scalar = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "max_pool_q7_HWC %ux%ux%u k%u s%u", dim, dim, ch, kernel, stride);
+    for (bench_start(&b, name, taps, in_size + out_size); bench_running(&b);)
+    {
+        max_pool_q7_HWC(in, dim, ch, kernel, padding, stride, dim_out, out);
+    }
+    simd = bench_stop(&b);
+    printf("max %ux%ux%u k%u s%u: %.2fx scalar\n", dim, dim, ch, kernel, stride, scalar / simd);
+}
+
+// DS-CNN's last pool: the whole 25x5 map, as a 5x5 window on a square map for the scalar pool
+static void bench_global(const char *size, const uint16_t ch)
+{
+    uint32_t in_size = 25 * ch;
+    q7_t *in = nn_test_alloc(in_size);
+    q7_t *out = nn_test_alloc(ch);
+    double scalar, simd;
+    char name[80];
+    nn_bench b;
+
+    nn_test_fill(in, in_size);
+
+    snprintf(name, sizeof(name), "%s arm_avepool_q7_HWC 5x5x%u k5", size, ch);
+    for (bench_start(&b, name, in_size, in_size + ch); bench_running(&b);)
+    {
+        arm_avepool_q7_HWC_scalar(in, 5, ch, 5, 0, 1, 1, out);
+    }
+    scalar = bench_stop(&b);
+
+    snprintf(name, sizeof(name), "%s global_avg_pool_q7_HWC 5x5x%u", size, ch);
+    for (bench_start(&b, name, in_size, in_size + ch); bench_running(&b);)
+    {
+        global_avg_pool_q7_HWC(in, 5, 5, ch, out);
+    }
+    simd = bench_stop(&b);
+    printf("%s global 5x5x%u: %.2fx scalar\n", size, ch, scalar / simd);
+}
+
+void bench_pool(void)
+{
+    bench_section("pools vs scalar CMSIS-NN");
+    bench_layer(32, 32, 3, 0, 2);
+    bench_layer(16, 32, 2, 0, 2);
+    bench_layer(11, 64, 3, 1, 1);
+    bench_global("S", 64);
+    bench_global("M", 172);
+    bench_global("L", 276);
+    nn_test_free_all();
+}
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include "nn_bench.h"
+#include "nn_test.h"
+#include "weight_packer.h"
+
+/*
+ * pointwise_conv_sparse and conv_HWC_sparse against pointwise_conv_fast and
+ * conv_HWC on the same weights, with 0 to 90% of the blocks of 4 weights
+ * zero. Layers: the DS-CNN M pointwise layer on the 11x11 stand-in map, and a
+ * 3x3 conv of the same width. The summary gives the sparse/dense speed and
+ * the weight bytes (values, indices and row pointers against the dense
+ * matrix); the dense kernels do not depend on the zeros.
+ */
+
+static void sparse_weights(nn_sparse_weights *w, q7_t *wt, const uint32_t row_len, const uint16_t ch_out,
+                           const uint32_t zero_pct, uint32_t *blocks)
+{
+    uint32_t n = row_len * ch_out;
+    uint32_t *row_ptr = nn_test_alloc(4 * (ch_out + 1));
+    uint16_t *col_idx = nn_test_alloc(2 * (n / 4));
+    q7_t *values = nn_test_alloc(n);
+    uint32_t i, k;
+
+    nn_test_fill(wt, n);
+    for (i = 0; i < n; i += 4)
+    {
+        if (nn_test_rand() % 100 < zero_pct)
+        {
+            for (k = 0; k < 4; k++)
+            {
+                wt[i + k] = 0;
+            }
+        }
+    }
+    *blocks = pack_sparse_weights(wt, row_len, ch_out, row_ptr, col_idx, (int8_t *)values);
+    w->row_ptr = row_ptr;
+    w->col_idx = col_idx;
+    w->values = values;
+}
+
+static void bench_sweep(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    static const uint32_t zero_pct[] = {0, 30, 50, 70, 90};
+    uint16_t padding = kernel / 2;
+    uint32_t row_len = kernel * kernel * ch_in;
+    uint32_t dense_bytes = row_len * ch_out;
+    uint64_t macs = (uint64_t)dim * dim * ch_out * row_len;
+    uint32_t sizeB;
+    uint32_t sizeA = kernel == 1 ? pointwise_conv_sparse_get_buffer_size(ch_in)
+                                 : conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *out = nn_test_alloc(dim * dim * ch_out);
+    q7_t *wt = nn_test_alloc(dense_bytes);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = kernel == 1 ? NULL : nn_test_alloc(sizeB);
+    double dense = 0, sparse;
+    uint32_t z, blocks, sparse_bytes;
+    char name[96];
+    nn_bench b;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    for (z = 0; z < sizeof(zero_pct) / sizeof(zero_pct[0]); z++)
+    {
+        nn_sparse_weights w;
+        sparse_weights(&w, wt, row_len, ch_out, zero_pct[z], &blocks);
+        sparse_bytes = 6 * blocks + 4 * (ch_out + 1);
+
+        if (z == 0)
+        {
+            snprintf(name, sizeof(name), "%s %ux%ux%u -> %u k%u", kernel == 1 ? "pointwise_conv_fast" : "conv_HWC",
+                     dim, dim, ch_in, ch_out, kernel);
+            for (bench_start(&b, name, macs, dim * dim * (ch_in + ch_out) + dense_bytes); bench_running(&b);)
+            {
+                if (kernel == 1)
+                {
+                    pointwise_conv_fast(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA);
+                }
+                else
+                {
+                    conv_HWC(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+                }
+            }
+            dense = bench_stop(&b);
+        }
+
+        snprintf(name, sizeof(name), "%s %ux%ux%u -> %u k%u, %u%% zero",
+                 kernel == 1 ? "pointwise_conv_sparse" : "conv_HWC_sparse", dim, dim, ch_in, ch_out, kernel,
+                 zero_pct[z]);
+        for (bench_start(&b, name, macs, dim * dim * (ch_in + ch_out) + sparse_bytes); bench_running(&b);)
+        {
+            if (kernel == 1)
+            {
+                pointwise_conv_sparse(in, dim, ch_in, &w, ch_out, bias, 2, 7, out, bufferA);
+            }
+            else
+            {
+                conv_HWC_sparse(in, dim, ch_in, &w, ch_out, kernel, padding, bias, 2, 7, out, bufferA);
+            }
+        }
+        sparse = bench_stop(&b);
+
+        printf("k%u %u%% zero blocks: sparse %.2fx dense, weights %u -> %u bytes\n", kernel, zero_pct[z],
+               dense / sparse, dense_bytes, sparse_bytes);
+    }
+}
+
+void bench_sparse(void)
+{
+    bench_section("block-sparse vs dense, sparsity sweep");
+    bench_sweep(11, 172, 172, 1);
+    bench_sweep(11, 172, 172, 3);
+    nn_test_free_all();
+}
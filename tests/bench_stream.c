@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include "nn_bench.h"
+#include "nn_stream.h"
+#include "nn_test.h"
+
+/*
+ * Cost per new MFCC frame of a keyword spotting window: nn_stream_push
+ * against nn_stream_run_full, which recomputes the whole window as a
+ * non-streaming network does every frame. The window is 49 frames of 10
+ * coefficients; the chain is a 3x3 conv then DS-CNN depthwise + pointwise
+ * blocks of the S, M and L widths, all stride 1 'same' as the stream needs.
+ * Besides the time per frame the summary gives the rows and MACs per frame
+ * of both; bytes are the weights, read once per frame by both.
+ */
+
+#define STREAM_DIM_X 10
+#define STREAM_DIM_Y 49
+#define STREAM_BLOCKS 4
+#define STREAM_LAYERS (1 + 2 * STREAM_BLOCKS)
+
+static uint64_t layer_macs(const nn_stream_layer *l)
+{
+    switch (l->op)
+    {
+    case NN_STREAM_CONV:
+        return (uint64_t)STREAM_DIM_X * l->ch_im_out * l->dim_kernel * l->dim_kernel * l->ch_im_in;
+    case NN_STREAM_DEPTHWISE:
+        return (uint64_t)STREAM_DIM_X * l->ch_im_in * l->dim_kernel * l->dim_kernel;
+    default:
+        return (uint64_t)STREAM_DIM_X * l->ch_im_in * l->ch_im_out;
+    }
+}
+
+static void bench_frame(const char *size, const uint16_t ch)
+{
+    nn_stream_layer layers[STREAM_LAYERS];
+    nn_stream_tensor tensors[STREAM_LAYERS + 1];
+    q7_t *conv_wt = nn_test_alloc(9 * ch);
+    q7_t *dw_wt = nn_test_alloc(9 * ch);
+    q7_t *pw_wt = nn_test_alloc(ch * ch);
+    q7_t *bias = nn_test_alloc(ch);
+    q7_t *frame = nn_test_alloc(STREAM_DIM_X);
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+    uint32_t scratch_size = 4;
+    uint64_t macs_full = 0, macs_push = 0;
+    uint32_t wt_bytes = 18 * ch + ch * ch + ch;
+    uint32_t rows_full, rows_push;
+    double full, push;
+    char name[80];
+    nn_stream s;
+    nn_bench b;
+    uint16_t i, top = 0, bottom = 1;
+
+    nn_test_fill_range(conv_wt, 9 * ch, 32);
+    nn_test_fill(dw_wt, 9 * ch);
+    nn_test_fill(pw_wt, ch * ch);
+    nn_test_fill(bias, ch);
+    nn_test_fill(frame, STREAM_DIM_X);
+
+    layers[0] = (nn_stream_layer){NN_STREAM_CONV, 1, ch, 3, conv_wt, bias, 2, 6, &relu};
+    for (i = 0; i < STREAM_BLOCKS; i++)
+    {
+        layers[1 + 2 * i] = (nn_stream_layer){NN_STREAM_DEPTHWISE, ch, 0, 3, dw_wt, NULL, 0, 7, &relu};
+        layers[2 + 2 * i] = (nn_stream_layer){NN_STREAM_POINTWISE, ch, ch, 1, pw_wt, bias, 2, 7, &relu};
+    }
+    for (i = 0; i < STREAM_LAYERS; i++)
+    {
+        uint32_t t = nn_stream_scratch_size(&layers[i]);
+        uint16_t ch_in = i + 1 < STREAM_LAYERS ? layers[i + 1].ch_im_in : ch;
+        scratch_size = t > scratch_size ? t : scratch_size;
+        tensors[i + 1].data = nn_test_alloc(STREAM_DIM_X * STREAM_DIM_Y * ch_in);
+
+        // Rows nn_stream_push recomputes, as it counts them
+        if (layers[i].op != NN_STREAM_POINTWISE)
+        {
+            top++;
+            bottom++;
+        }
+        macs_full += STREAM_DIM_Y * layer_macs(&layers[i]);
+        macs_push += (top + bottom < STREAM_DIM_Y ? top + bottom : STREAM_DIM_Y) * layer_macs(&layers[i]);
+    }
+    tensors[0].data = nn_test_alloc(STREAM_DIM_X * STREAM_DIM_Y);
+    nn_test_fill(tensors[0].data, STREAM_DIM_X * STREAM_DIM_Y);
+    nn_stream_init(&s, layers, STREAM_LAYERS, STREAM_DIM_X, STREAM_DIM_Y, tensors, nn_test_alloc(scratch_size));
+
+    snprintf(name, sizeof(name), "%s nn_stream_run_full %ux%u ch %u", size, STREAM_DIM_X, STREAM_DIM_Y, ch);
+    for (bench_start(&b, name, macs_full, wt_bytes); bench_running(&b);)
+    {
+        nn_stream_run_full(&s);
+    }
+    full = bench_stop(&b);
+    rows_full = s.rows_computed;
+
+    snprintf(name, sizeof(name), "%s nn_stream_push %ux%u ch %u", size, STREAM_DIM_X, STREAM_DIM_Y, ch);
+    for (bench_start(&b, name, macs_push, wt_bytes); bench_running(&b);)
+    {
+        nn_stream_push(&s, frame);
+    }
+    push = bench_stop(&b);
+    rows_push = s.rows_computed;
+
+    printf("%s per frame: full %.1f us, %u rows, %.2f MMACs; streaming %.1f us, %u rows, %.2f MMACs; %.2fx\n", size,
+           full / 1e3, rows_full, macs_full / 1e6, push / 1e3, rows_push, macs_push / 1e6, full / push);
+}
+
+void bench_stream(void)
+{
+    bench_section("streaming vs full window, per frame");
+    bench_frame("S", 64);
+    bench_frame("M", 172);
+    bench_frame("L", 276);
+    nn_test_free_all();
+}
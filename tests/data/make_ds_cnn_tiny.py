@@ -0,0 +1,430 @@
+#!/usr/bin/env python3
+"""Write the ds_cnn_tiny.tflite fixture and its expected outputs.
+
+    make_ds_cnn_tiny.py [out_dir] [--interpreter]
+
+ds_cnn_tiny.tflite is a small int8 DS-CNN in the layout TFLite's converter
+produces: per-channel conv/depthwise weights, int32 biases, int8 activations
+with asymmetric zero points and fused ReLU.
+
+    input 10x6x1 -> CONV_2D 3x3 /2 SAME ReLU -> 5x3x8
+                 -> DEPTHWISE_CONV_2D 3x3 SAME ReLU -> 5x3x8
+                 -> CONV_2D 1x1 ReLU -> 5x3x8
+                 -> AVERAGE_POOL_2D 5x3 VALID -> 1x1x8
+                 -> RESHAPE -> 8 -> FULLY_CONNECTED -> 4
+
+ds_cnn_tiny.json holds int8 inputs and the int8 outputs TFLite gives for them.
+They come from an integer-exact port of the TFLite reference int8 kernels
+below (QuantizeMultiplier, MultiplyByQuantizedMultiplier, the reference
+pooling rounding), so no interpreter is needed to regenerate them. With
+--interpreter the outputs are taken from tflite_runtime or tensorflow instead
+and compared with the port.
+
+The inputs are random; only those whose top class leads the second by at least
+MARGIN output LSBs are kept, so that the power-of-two formats of tflite2c.py
+cannot flip the argmax.
+"""
+
+import json
+import math
+import os
+import random
+import struct
+import sys
+
+SEED = 7
+CASES = 16
+MARGIN = 12
+
+# ---------------------------------------------------------------------------
+# Flatbuffer writer, just enough of the TFLite schema
+#
+# Objects are written parent first; every reference (uoffset) points forward
+# to a child written after it.
+
+
+class Table:
+    def __init__(self, fields):
+        self.fields = fields    # field index -> (struct format, value) or ('off', child)
+
+
+class Vector:
+    def __init__(self, fmt, values):
+        self.fmt = fmt
+        self.values = values
+
+
+class TableVector:
+    def __init__(self, tables):
+        self.tables = tables
+
+
+class String:
+    def __init__(self, s):
+        self.data = s.encode('utf-8')
+
+
+class Writer:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def align(self, n, extra=0):
+        while (len(self.buf) + extra) % n:
+            self.buf.append(0)
+
+    def put(self, obj):
+        """Writes obj at the end of the buffer and returns its position."""
+        if isinstance(obj, Table):
+            return self.put_table(obj)
+        if isinstance(obj, TableVector):
+            self.align(4)
+            pos = len(self.buf)
+            self.buf += struct.pack('<I', len(obj.tables)) + bytes(4 * len(obj.tables))
+            for i, t in enumerate(obj.tables):
+                slot = pos + 4 + 4 * i
+                struct.pack_into('<I', self.buf, slot, self.put(t) - slot)
+            return pos
+        if isinstance(obj, String):
+            self.align(4)
+            pos = len(self.buf)
+            self.buf += struct.pack('<I', len(obj.data)) + obj.data + b'\0'
+            return pos
+        size = struct.calcsize('<' + obj.fmt)
+        self.align(max(size, 16 if obj.fmt == 'B' else 4), 4)
+        pos = len(self.buf)
+        self.buf += struct.pack('<I%d%s' % (len(obj.values), obj.fmt), len(obj.values), *obj.values)
+        return pos
+
+    def put_table(self, t):
+        # Inline layout: soffset to the vtable, then the fields, each aligned to its size
+        layout, size = {}, 4
+        for index in sorted(t.fields, key=lambda i: -self.field_size(t.fields[i])):
+            n = self.field_size(t.fields[index])
+            size = (size + n - 1) // n * n
+            layout[index] = size
+            size += n
+        nfields = max(t.fields) + 1 if t.fields else 0
+        vtable = struct.pack('<HH', 4 + 2 * nfields, size) + \
+            b''.join(struct.pack('<H', layout.get(i, 0)) for i in range(nfields))
+
+        self.align(2)
+        vt_pos = len(self.buf)
+        self.buf += vtable
+        self.align(8)
+        pos = len(self.buf)
+        self.buf += bytes(size)
+        struct.pack_into('<i', self.buf, pos, pos - vt_pos)
+        for index, (fmt, value) in t.fields.items():
+            if fmt != 'off':
+                struct.pack_into('<' + fmt, self.buf, pos + layout[index], value)
+        for index, (fmt, value) in t.fields.items():
+            if fmt == 'off':
+                slot = pos + layout[index]
+                struct.pack_into('<I', self.buf, slot, self.put(value) - slot)
+        return pos
+
+    @staticmethod
+    def field_size(field):
+        fmt, _ = field
+        return 4 if fmt == 'off' else struct.calcsize('<' + fmt)
+
+    def finish(self, root):
+        self.buf += bytes(4) + b'TFL3'
+        struct.pack_into('<I', self.buf, 0, self.put(root))
+        return bytes(self.buf)
+
+
+# schema.fbs
+TYPE_INT32 = 2
+TYPE_INT8 = 9
+
+OP_AVERAGE_POOL_2D = 1
+OP_CONV_2D = 3
+OP_DEPTHWISE_CONV_2D = 4
+OP_FULLY_CONNECTED = 9
+OP_RESHAPE = 22
+
+OPTIONS_CONV_2D = 1
+OPTIONS_DEPTHWISE_CONV_2D = 2
+OPTIONS_POOL_2D = 5
+OPTIONS_FULLY_CONNECTED = 8
+OPTIONS_RESHAPE = 17
+
+PADDING_SAME = 0
+PADDING_VALID = 1
+
+ACT_NONE = 0
+ACT_RELU = 1
+
+
+# ---------------------------------------------------------------------------
+# TFLite reference int8 arithmetic
+
+def tf_round(x):
+    return int(math.floor(abs(x) + 0.5)) * (1 if x >= 0 else -1)
+
+
+def quantize_multiplier(m):
+    if m == 0:
+        return 0, 0
+    q, shift = math.frexp(m)
+    q_fixed = tf_round(q * (1 << 31))
+    if q_fixed == 1 << 31:
+        q_fixed //= 2
+        shift += 1
+    if shift < -31:
+        return 0, 0
+    return q_fixed, shift
+
+
+def srdhm(a, b):
+    if a == b == -(1 << 31):
+        return (1 << 31) - 1
+    ab = a * b
+    nudge = (1 << 30) if ab >= 0 else 1 - (1 << 30)
+    v = ab + nudge
+    # C integer division, truncating toward zero
+    return (abs(v) >> 31) * (1 if v >= 0 else -1)
+
+
+def rounding_divide_by_pot(x, exponent):
+    mask = (1 << exponent) - 1
+    remainder = x & mask
+    threshold = (mask >> 1) + (1 if x < 0 else 0)
+    return (x >> exponent) + (1 if remainder > threshold else 0)
+
+
+def multiply_by_quantized_multiplier(x, q, shift):
+    left = shift if shift > 0 else 0
+    right = 0 if shift > 0 else -shift
+    return rounding_divide_by_pot(srdhm(x * (1 << left), q), right)
+
+
+def act_range(act, scale, zp):
+    if act == ACT_RELU:
+        return max(-128, zp + tf_round(0.0 / scale)), 127
+    return -128, 127
+
+
+def same_pad(dim_in, k, stride):
+    dim_out = (dim_in + stride - 1) // stride
+    return max((dim_out - 1) * stride + k - dim_in, 0) // 2, dim_out
+
+
+def ref_conv(x, shape, t_in, wt, bias, t_out, stride, depthwise, act):
+    """ConvPerChannel / DepthwiseConvPerChannel, SAME padding, NHWC, batch 1."""
+    h, w, c = shape
+    if depthwise:
+        _, kh, kw, co = wt['shape']
+    else:
+        co, kh, kw, _ = wt['shape']
+    pt, oh = same_pad(h, kh, stride)
+    pl, ow = same_pad(w, kw, stride)
+    lo, hi = act_range(act, t_out['scale'][0], t_out['zp'])
+    mult = [quantize_multiplier(t_in['scale'][0] * s / t_out['scale'][0]) for s in wt['scale']]
+    out = []
+    for oy in range(oh):
+        for ox in range(ow):
+            for o in range(co):
+                acc = 0
+                for ky in range(kh):
+                    for kx in range(kw):
+                        iy, ix = oy * stride - pt + ky, ox * stride - pl + kx
+                        if not (0 <= iy < h and 0 <= ix < w):
+                            continue
+                        if depthwise:
+                            acc += (x[(iy * w + ix) * c + o] - t_in['zp']) * wt['q'][(ky * kw + kx) * co + o]
+                        else:
+                            for i in range(c):
+                                acc += (x[(iy * w + ix) * c + i] - t_in['zp']) * \
+                                    wt['q'][((o * kh + ky) * kw + kx) * c + i]
+                acc += bias[o]
+                acc = multiply_by_quantized_multiplier(acc, *mult[o]) + t_out['zp']
+                out.append(max(lo, min(hi, acc)))
+    return out, (oh, ow, co)
+
+
+def ref_avg_pool(x, shape):
+    """AveragePool over the whole input, VALID."""
+    h, w, c = shape
+    out = []
+    for ch in range(c):
+        acc = sum(x[i * c + ch] for i in range(h * w))
+        n = h * w
+        acc = acc + n // 2 if acc > 0 else acc - n // 2
+        out.append(max(-128, min(127, int(acc / n))))
+    return out
+
+
+def ref_fc(x, t_in, wt, bias, t_out):
+    rows, cols = wt['shape']
+    q, shift = quantize_multiplier(t_in['scale'][0] * wt['scale'][0] / t_out['scale'][0])
+    out = []
+    for r in range(rows):
+        acc = sum((x[i] - t_in['zp']) * wt['q'][r * cols + i] for i in range(cols)) + bias[r]
+        acc = multiply_by_quantized_multiplier(acc, q, shift) + t_out['zp']
+        out.append(max(-128, min(127, acc)))
+    return out
+
+
+# ---------------------------------------------------------------------------
+# Model
+
+def weights(rng, shape, qdim, scales):
+    n = 1
+    for d in shape:
+        n *= d
+    return {'shape': shape, 'qdim': qdim, 'scale': scales, 'q': [rng.randint(-127, 127) for _ in range(n)]}
+
+
+def build(rng):
+    m = {}
+    m['in'] = {'shape': [1, 10, 6, 1], 'scale': [1.0 / 32], 'zp': 0}
+    m['a1'] = {'shape': [1, 5, 3, 8], 'scale': [0.03], 'zp': -128}
+    m['a2'] = {'shape': [1, 5, 3, 8], 'scale': [0.04], 'zp': -128}
+    m['a3'] = {'shape': [1, 5, 3, 8], 'scale': [0.05], 'zp': -128}
+    m['a4'] = dict(m['a3'], shape=[1, 1, 1, 8])
+    m['a5'] = dict(m['a3'], shape=[1, 8])
+    m['out'] = {'shape': [1, 4], 'scale': [0.08], 'zp': 3}
+
+    m['w1'] = weights(rng, [8, 3, 3, 1], 0, [rng.uniform(0.004, 0.008) for _ in range(8)])
+    m['w2'] = weights(rng, [1, 3, 3, 8], 3, [rng.uniform(0.004, 0.008) for _ in range(8)])
+    m['w3'] = weights(rng, [8, 1, 1, 8], 0, [rng.uniform(0.002, 0.004) for _ in range(8)])
+    m['w4'] = weights(rng, [4, 8], 0, [0.01])
+    for b, t_in, wt in (('b1', 'in', 'w1'), ('b2', 'a1', 'w2'), ('b3', 'a2', 'w3'), ('b4', 'a5', 'w4')):
+        n = m[wt]['shape'][m[wt]['qdim']]
+        m[b] = {'shape': [n], 'scale': [m[t_in]['scale'][0] * s for s in m[wt]['scale']],
+                'q': [rng.randint(-400, 400) for _ in range(n)]}
+    m['shape'] = {'shape': [2], 'q': [1, 8]}
+    return m
+
+
+def run(m, x):
+    y, shape = ref_conv(x, (10, 6, 1), m['in'], m['w1'], m['b1']['q'], m['a1'], 2, False, ACT_RELU)
+    y, shape = ref_conv(y, shape, m['a1'], m['w2'], m['b2']['q'], m['a2'], 1, True, ACT_RELU)
+    y, shape = ref_conv(y, shape, m['a2'], m['w3'], m['b3']['q'], m['a3'], 1, False, ACT_RELU)
+    y = ref_avg_pool(y, shape)
+    return ref_fc(y, m['a5'], m['w4'], m['b4']['q'], m['out'])
+
+
+def serialise(m):
+    order = ['in', 'w1', 'b1', 'a1', 'w2', 'b2', 'a2', 'w3', 'b3', 'a3', 'a4', 'a5', 'w4', 'b4', 'out', 'shape']
+    buffers = [Table({})]
+    tensors = []
+    for name in order:
+        t = m[name]
+        int32 = name[0] == 'b' or name == 'shape'
+        buf = 0
+        if 'q' in t:
+            fmt = 'i' if int32 else 'b'
+            buffers.append(Table({0: ('off', Vector('B', list(struct.pack('<%d%s' % (len(t['q']), fmt), *t['q']))))}))
+            buf = len(buffers) - 1
+        fields = {0: ('off', Vector('i', t['shape'])),
+                  1: ('b', TYPE_INT32 if int32 else TYPE_INT8),
+                  2: ('I', buf),
+                  3: ('off', String(name))}
+        if 'scale' in t:
+            fields[4] = ('off', Table({2: ('off', Vector('f', t['scale'])),
+                                       3: ('off', Vector('q', [t.get('zp', 0)] * len(t['scale']))),
+                                       6: ('i', t.get('qdim', 0))}))
+        tensors.append(Table(fields))
+    idx = {name: i for i, name in enumerate(order)}
+
+    opcodes = [OP_CONV_2D, OP_DEPTHWISE_CONV_2D, OP_AVERAGE_POOL_2D, OP_RESHAPE, OP_FULLY_CONNECTED]
+    conv = lambda s: Table({0: ('b', PADDING_SAME), 1: ('i', s), 2: ('i', s), 3: ('b', ACT_RELU),
+                            4: ('i', 1), 5: ('i', 1)})
+    ops = [
+        (OP_CONV_2D, ['in', 'w1', 'b1'], 'a1', OPTIONS_CONV_2D, conv(2)),
+        (OP_DEPTHWISE_CONV_2D, ['a1', 'w2', 'b2'], 'a2', OPTIONS_DEPTHWISE_CONV_2D,
+         Table({0: ('b', PADDING_SAME), 1: ('i', 1), 2: ('i', 1), 3: ('i', 1), 4: ('b', ACT_RELU),
+                5: ('i', 1), 6: ('i', 1)})),
+        (OP_CONV_2D, ['a2', 'w3', 'b3'], 'a3', OPTIONS_CONV_2D, conv(1)),
+        (OP_AVERAGE_POOL_2D, ['a3'], 'a4', OPTIONS_POOL_2D,
+         Table({0: ('b', PADDING_VALID), 1: ('i', 1), 2: ('i', 1), 3: ('i', 3), 4: ('i', 5), 5: ('b', ACT_NONE)})),
+        (OP_RESHAPE, ['a4', 'shape'], 'a5', OPTIONS_RESHAPE, Table({0: ('off', Vector('i', [1, 8]))})),
+        (OP_FULLY_CONNECTED, ['a5', 'w4', 'b4'], 'out', OPTIONS_FULLY_CONNECTED,
+         Table({0: ('b', ACT_NONE), 1: ('b', 0), 2: ('b', 0)})),
+    ]
+    operators = [Table({0: ('I', opcodes.index(code)),
+                        1: ('off', Vector('i', [idx[n] for n in ins])),
+                        2: ('off', Vector('i', [idx[out]])),
+                        3: ('B', opt_type),
+                        4: ('off', opts)})
+                 for code, ins, out, opt_type, opts in ops]
+
+    subgraph = Table({0: ('off', TableVector(tensors)),
+                      1: ('off', Vector('i', [idx['in']])),
+                      2: ('off', Vector('i', [idx['out']])),
+                      3: ('off', TableVector(operators)),
+                      4: ('off', String('main'))})
+    model = Table({0: ('I', 3),
+                   1: ('off', TableVector([Table({0: ('b', min(code, 127)), 2: ('i', 1), 3: ('i', code)})
+                                           for code in opcodes])),
+                   2: ('off', TableVector([subgraph])),
+                   3: ('off', String('ds_cnn_tiny, tests/data/make_ds_cnn_tiny.py')),
+                   4: ('off', TableVector(buffers))})
+    return Writer().finish(model)
+
+
+def interpreter_outputs(path, inputs):
+    try:
+        import numpy as np
+        try:
+            from tflite_runtime.interpreter import Interpreter
+        except ImportError:
+            from tensorflow.lite import Interpreter
+    except ImportError:
+        raise SystemExit('error: --interpreter needs numpy and tflite_runtime or tensorflow')
+    interp = Interpreter(model_path=path)
+    interp.allocate_tensors()
+    d_in, d_out = interp.get_input_details()[0], interp.get_output_details()[0]
+    outs = []
+    for x in inputs:
+        interp.set_tensor(d_in['index'], np.array(x, dtype=np.int8).reshape(d_in['shape']))
+        interp.invoke()
+        outs.append([int(v) for v in interp.get_tensor(d_out['index']).reshape(-1)])
+    return outs
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith('--')]
+    out_dir = args[0] if args else os.path.dirname(os.path.abspath(__file__))
+    rng = random.Random(SEED)
+    m = build(rng)
+    model = serialise(m)
+    path = os.path.join(out_dir, 'ds_cnn_tiny.tflite')
+    with open(path, 'wb') as f:
+        f.write(model)
+
+    cases = []
+    while len(cases) < CASES:
+        x = [rng.randint(-128, 127) for _ in range(60)]
+        y = run(m, x)
+        top = sorted(y, reverse=True)
+        if top[0] - top[1] >= MARGIN:
+            cases.append({'input': x, 'output': y})
+
+    if '--interpreter' in sys.argv:
+        outs = interpreter_outputs(path, [c['input'] for c in cases])
+        bad = sum(int(o != c['output']) for o, c in zip(outs, cases))
+        print('interpreter differs from the reference port on %d/%d inputs' % (bad, len(cases)))
+        for o, c in zip(outs, cases):
+            c['output'] = o
+
+    expected = {
+        'model': 'ds_cnn_tiny.tflite',
+        'input': {'scale': m['in']['scale'][0], 'zero_point': m['in']['zp']},
+        'output': {'scale': m['out']['scale'][0], 'zero_point': m['out']['zp']},
+        'cases': cases,
+    }
+    with open(os.path.join(out_dir, 'ds_cnn_tiny.json'), 'w') as f:
+        f.write('{\n')
+        for key in ('model', 'input', 'output'):
+            f.write('  %s: %s,\n' % (json.dumps(key), json.dumps(expected[key])))
+        f.write('  "cases": [\n%s\n  ]\n}\n' % ',\n'.join('    ' + json.dumps(c) for c in cases))
+    print('wrote %s (%d bytes) and ds_cnn_tiny.json (%d cases)' % (path, len(model), len(cases)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
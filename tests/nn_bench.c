@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "nn_bench.h"
+
+#define BENCH_ROUNDS 5
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static uint64_t bench_round_ns(void)
+{
+    const char *ms = getenv("NN_BENCH_ROUND_MS");
+    return (uint64_t)(ms ? atoi(ms) : 20) * 1000000u;
+}
+
+void bench_section(const char *title)
+{
+    printf("\n== %s\n", title);
+}
+
+void bench_start(nn_bench *b, const char *name, const uint64_t macs, const uint32_t bytes)
+{
+    b->name = name;
+    b->macs = macs;
+    b->bytes = bytes;
+    b->calls = 0;
+    b->rounds = 0;
+    b->best_ns = 1e30;
+#ifdef NN_PROFILE
+    nn_profile_reset();
+#endif
+    b->round_start = bench_now_ns();
+}
+
+int bench_running(nn_bench *b)
+{
+#ifdef NN_PROFILE
+    return b->calls++ == 0;
+#else
+    uint64_t now = bench_now_ns();
+    if (b->calls && now - b->round_start >= bench_round_ns())
+    {
+        double per_call = (double)(now - b->round_start) / b->calls;
+        if (per_call < b->best_ns)
+        {
+            b->best_ns = per_call;
+        }
+        b->rounds++;
+        b->calls = 0;
+        if (b->rounds == BENCH_ROUNDS)
+        {
+            return 0;
+        }
+        b->round_start = bench_now_ns();
+    }
+    b->calls++;
+    return 1;
+#endif
+}
+
+double bench_stop(nn_bench *b)
+{
+#ifdef NN_PROFILE
+    uint16_t num_layers, i;
+    const nn_profile_layer *t = nn_profile_table(&num_layers);
+    uint64_t macs = 0, copied = 0, written = 0, cycles = 0, copy_cycles = 0;
+    for (i = 0; i < num_layers; i++)
+    {
+        macs += t[i].macs;
+        copied += t[i].bytes_copied;
+        written += t[i].bytes_written;
+        cycles += t[i].cycles;
+        copy_cycles += t[i].copy_cycles;
+    }
+    printf("%-48s %10llu MAC %9llu B copied %8llu B out %5.1f%% copy\n", b->name, (unsigned long long)macs,
+           (unsigned long long)copied, (unsigned long long)written,
+           cycles ? 100.0 * (double)copy_cycles / (double)cycles : 0.0);
+    return (double)cycles;
+#else
+    printf("%-48s %10llu MAC %8u B %10.2f us %6.2f MAC/ns\n", b->name, (unsigned long long)b->macs, b->bytes,
+           b->best_ns / 1000.0, (double)b->macs / b->best_ns);
+    return b->best_ns;
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef NN_BENCH_H
+#define NN_BENCH_H
+
+/**
+ * @brief Host benchmark driver for the kernels
+ *
+ * @details
+ * A case times one call in a loop:
+ *
+ *   nn_bench b;
+ *   for (bench_start(&b, "pointwise_conv_fast", macs, bytes); bench_running(&b);)
+ *       pointwise_conv_fast(...);
+ *   ns = bench_stop(&b);
+ *
+ * The call is repeated in rounds of NN_BENCH_ROUND_MS milliseconds (default
+ * 20) and the fastest round gives the time per call. bench_stop prints one
+ * line: MACs, bytes moved (input + weights + output of one call, as given by
+ * the case), time per call and MACs per nanosecond.
+ *
+ * Built with -DNN_PROFILE (make bench-profile), every case runs once and the
+ * line gives the nn_profile counters instead: MACs, bytes copied into
+ * bufferA/bufferB, output bytes and the share of time spent copying.
+ *
+ * Host timings only rank variants of the same layer; cycle counts need the
+ * target.
+*/
+
+#include <stdint.h>
+#include "nn_functions.h"
+
+typedef struct
+{
+    const char *name;
+    uint64_t macs;
+    uint32_t bytes;
+    uint64_t round_start;
+    uint32_t calls;
+    uint32_t rounds;
+    double best_ns;
+} nn_bench;
+
+void bench_section(const char *title);
+
+void bench_start(nn_bench *b, const char *name, const uint64_t macs, const uint32_t bytes);
+
+int bench_running(nn_bench *b);
+
+// Prints the case and returns nanoseconds per call
+double bench_stop(nn_bench *b);
+
+/* ---- suites ---- */
+
+void bench_dscnn(void);
+void bench_depthwise_pointwise(void);
+void bench_conv_ring(void);
+void bench_conv_packed(void);
+void bench_conv_tiled(void);
+void bench_depthwise_split(void);
+void bench_conv_blocked(void);
+void bench_pool(void);
+void bench_parallel(void);
+void bench_batch(void);
+void bench_fixed(void);
+void bench_stream(void);
+void bench_pointwise_4x2(void);
+void bench_sparse(void);
+void bench_int4(void);
+void bench_mult(void);
+void bench_conv_q7(void);
+
+#endif
@@ -0,0 +1,323 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "nn_test.h"
+
+uint32_t nn_test_checks;
+uint32_t nn_test_failures;
+
+static uint32_t rand_state = 1;
+
+typedef struct nn_test_block
+{
+    struct nn_test_block *next;
+    long long data[];
+} nn_test_block;
+
+static nn_test_block *blocks;
+
+void nn_test_seed(const uint32_t seed)
+{
+    rand_state = seed ? seed : 1;
+}
+
+uint32_t nn_test_rand(void)
+{
+    // xorshift32, the same sequence on every host
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+void *nn_test_alloc(const uint32_t bytes)
+{
+    nn_test_block *b = malloc(sizeof(nn_test_block) + bytes);
+    if (b == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    b->next = blocks;
+    blocks = b;
+    return b->data;
+}
+
+void nn_test_free_all(void)
+{
+    while (blocks)
+    {
+        nn_test_block *next = blocks->next;
+        free(blocks);
+        blocks = next;
+    }
+}
+
+void nn_test_fill(q7_t *p, const uint32_t n)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+    {
+        p[i] = (q7_t)(nn_test_rand() >> 24);
+    }
+}
+
+void nn_test_fill_range(q7_t *p, const uint32_t n, const int32_t max_abs)
+{
+    uint32_t i;
+    for (i = 0; i < n; i++)
+    {
+        p[i] = (q7_t)((int32_t)(nn_test_rand() % (uint32_t)(2 * max_abs + 1)) - max_abs);
+    }
+}
+
+int nn_test_check(const q7_t *out, const q7_t *ref, const uint32_t n, const char *fmt, ...)
+{
+    uint32_t i;
+    nn_test_checks++;
+    for (i = 0; i < n; i++)
+    {
+        if (out[i] != ref[i])
+        {
+            va_list ap;
+            printf("FAIL ");
+            va_start(ap, fmt);
+            vprintf(fmt, ap);
+            va_end(ap);
+            printf(": [%u] = %d, expected %d\n", i, out[i], ref[i]);
+            nn_test_failures++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int nn_test_expect(const int cond, const char *fmt, ...)
+{
+    nn_test_checks++;
+    if (!cond)
+    {
+        va_list ap;
+        printf("FAIL ");
+        va_start(ap, fmt);
+        vprintf(fmt, ap);
+        va_end(ap);
+        printf("\n");
+        nn_test_failures++;
+        return 1;
+    }
+    return 0;
+}
+
+ref_shape ref_square(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out,
+                     const uint16_t kernel, const uint16_t padding)
+{
+    ref_shape s;
+    s.dim_x = s.dim_y = dim;
+    s.ch_in = ch_in;
+    s.ch_out = ch_out;
+    s.kernel_x = s.kernel_y = kernel;
+    s.stride_x = s.stride_y = 1;
+    s.pad_top = s.pad_left = padding;
+    s.dilation = 1;
+    s.out_x = s.out_y = dim + 2 * padding - kernel + 1;
+    return s;
+}
+
+static q7_t ref_requantize(q31_t sum, const uint16_t o, const uint16_t out_shift, const int round,
+                           const nn_epilogue *epilogue)
+{
+    uint16_t shift = (epilogue && epilogue->out_shift) ? epilogue->out_shift[o] : out_shift;
+    q31_t lo = epilogue ? epilogue->act_min : -128;
+    q31_t hi = epilogue ? epilogue->act_max : 127;
+
+    if (round)
+    {
+        sum += (q31_t)((1u << shift) >> 1);
+    }
+    sum >>= shift;
+    sum = sum > 127 ? 127 : sum < -128 ? -128 : sum;
+    sum = sum < lo ? lo : sum;
+    return (q7_t)(sum > hi ? hi : sum);
+}
+
+static q31_t ref_bias(const uint16_t o, const q7_t *bias, const uint16_t bias_shift, const nn_epilogue *epilogue)
+{
+    if (epilogue && epilogue->bias)
+    {
+        return (q31_t)epilogue->bias[o] << epilogue->bias_shift;
+    }
+    return bias ? (q31_t)bias[o] << bias_shift : 0;
+}
+
+void ref_conv(const ref_shape *s,
+              const q7_t *Im_in,
+              const q7_t *wt,
+              const q7_t *bias,
+              const uint16_t bias_shift,
+              const uint16_t out_shift,
+              const int round,
+              const nn_epilogue *epilogue,
+              q7_t *Im_out)
+{
+    int32_t oy, ox, o, ky, kx, c;
+    for (oy = 0; oy < s->out_y; oy++)
+    {
+        for (ox = 0; ox < s->out_x; ox++)
+        {
+            for (o = 0; o < s->ch_out; o++)
+            {
+                q31_t sum = ref_bias(o, bias, bias_shift, epilogue);
+                for (ky = 0; ky < s->kernel_y; ky++)
+                {
+                    for (kx = 0; kx < s->kernel_x; kx++)
+                    {
+                        int32_t iy = oy * s->stride_y - s->pad_top + ky * s->dilation;
+                        int32_t ix = ox * s->stride_x - s->pad_left + kx * s->dilation;
+                        const q7_t *pIn = Im_in + (iy * s->dim_x + ix) * s->ch_in;
+                        const q7_t *pW = wt + ((o * s->kernel_y + ky) * s->kernel_x + kx) * s->ch_in;
+                        if (iy < 0 || iy >= s->dim_y || ix < 0 || ix >= s->dim_x)
+                        {
+                            continue;
+                        }
+                        for (c = 0; c < s->ch_in; c++)
+                        {
+                            sum += pIn[c] * pW[c];
+                        }
+                    }
+                }
+                Im_out[(oy * s->out_x + ox) * s->ch_out + o] = ref_requantize(sum, o, out_shift, round, epilogue);
+            }
+        }
+    }
+}
+
+void ref_depthwise(const ref_shape *s,
+                   const q7_t *Im_in,
+                   const q7_t *wt,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   const int round,
+                   const nn_epilogue *epilogue,
+                   q7_t *Im_out)
+{
+    int32_t mult = s->ch_out / s->ch_in;
+    int32_t oy, ox, o, ky, kx;
+    for (oy = 0; oy < s->out_y; oy++)
+    {
+        for (ox = 0; ox < s->out_x; ox++)
+        {
+            for (o = 0; o < s->ch_out; o++)
+            {
+                q31_t sum = ref_bias(o, bias, bias_shift, epilogue);
+                for (ky = 0; ky < s->kernel_y; ky++)
+                {
+                    for (kx = 0; kx < s->kernel_x; kx++)
+                    {
+                        int32_t iy = oy * s->stride_y - s->pad_top + ky * s->dilation;
+                        int32_t ix = ox * s->stride_x - s->pad_left + kx * s->dilation;
+                        if (iy < 0 || iy >= s->dim_y || ix < 0 || ix >= s->dim_x)
+                        {
+                            continue;
+                        }
+                        sum += Im_in[(iy * s->dim_x + ix) * s->ch_in + o / mult] *
+                               wt[(ky * s->kernel_x + kx) * s->ch_out + o];
+                    }
+                }
+                Im_out[(oy * s->out_x + ox) * s->ch_out + o] = ref_requantize(sum, o, out_shift, round, epilogue);
+            }
+        }
+    }
+}
+
+static void ref_pool(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in,
+                     const uint16_t dim_kernel, const uint16_t padding, const uint16_t stride,
+                     const uint16_t dim_im_out, q7_t *Im_out, const int max)
+{
+    int32_t oy, ox, c, ky, kx;
+    for (oy = 0; oy < dim_im_out; oy++)
+    {
+        for (ox = 0; ox < dim_im_out; ox++)
+        {
+            for (c = 0; c < ch_im_in; c++)
+            {
+                int32_t sum = 0, count = 0, best = -128;
+                for (ky = 0; ky < dim_kernel; ky++)
+                {
+                    for (kx = 0; kx < dim_kernel; kx++)
+                    {
+                        int32_t iy = oy * stride - padding + ky;
+                        int32_t ix = ox * stride - padding + kx;
+                        int32_t v;
+                        if (iy < 0 || iy >= dim_im_in || ix < 0 || ix >= dim_im_in)
+                        {
+                            continue;
+                        }
+                        v = Im_in[(iy * dim_im_in + ix) * ch_im_in + c];
+                        sum += v;
+                        count++;
+                        best = v > best ? v : best;
+                    }
+                }
+                if (max)
+                {
+                    Im_out[(oy * dim_im_out + ox) * ch_im_in + c] = (q7_t)best;
+                }
+                else
+                {
+                    sum = sum >= 0 ? sum + count / 2 : sum - count / 2;
+                    Im_out[(oy * dim_im_out + ox) * ch_im_in + c] = (q7_t)(sum / count);
+                }
+            }
+        }
+    }
+}
+
+void ref_avg_pool(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in,
+                  const uint16_t dim_kernel, const uint16_t padding, const uint16_t stride,
+                  const uint16_t dim_im_out, q7_t *Im_out)
+{
+    ref_pool(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, stride, dim_im_out, Im_out, 0);
+}
+
+void ref_max_pool(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in,
+                  const uint16_t dim_kernel, const uint16_t padding, const uint16_t stride,
+                  const uint16_t dim_im_out, q7_t *Im_out)
+{
+    ref_pool(Im_in, dim_im_in, ch_im_in, dim_kernel, padding, stride, dim_im_out, Im_out, 1);
+}
+
+void ref_avg_pool_2x2(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in, q7_t *Im_out)
+{
+    int32_t dim_im_out = dim_im_in / 2;
+    int32_t y, x, c;
+    for (y = 0; y < dim_im_out; y++)
+    {
+        for (x = 0; x < dim_im_out; x++)
+        {
+            for (c = 0; c < ch_im_in; c++)
+            {
+                const q7_t *p = Im_in + ((2 * y) * dim_im_in + 2 * x) * ch_im_in + c;
+                int32_t top = (p[0] + p[ch_im_in]) >> 1;
+                int32_t bottom = (p[dim_im_in * ch_im_in] + p[(dim_im_in + 1) * ch_im_in]) >> 1;
+                Im_out[(y * dim_im_out + x) * ch_im_in + c] = (q7_t)((top + bottom) >> 1);
+            }
+        }
+    }
+}
+
+void ref_fully_connected(const q7_t *pV, const q7_t *pM, const uint16_t dim_vec, const uint16_t num_of_rows,
+                         const uint16_t bias_shift, const uint16_t out_shift, const q7_t *bias, q7_t *pOut)
+{
+    int32_t r, i;
+    for (r = 0; r < num_of_rows; r++)
+    {
+        q31_t sum = (q31_t)bias[r] << bias_shift;
+        for (i = 0; i < dim_vec; i++)
+        {
+            sum += pV[i] * pM[r * dim_vec + i];
+        }
+        pOut[r] = ref_requantize(sum, 0, out_shift, 1, NULL);
+    }
+}
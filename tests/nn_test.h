@@ -0,0 +1,143 @@
+#ifndef NN_TEST_H
+#define NN_TEST_H
+
+/**
+ * @brief Host unit tests for the kernels
+ *
+ * @details
+ * Every kernel is compared bit for bit against a naive reference in
+ * nn_test.c, on random tensors and weights. The references loop over every
+ * output, output channel and kernel tap, and share no code with the kernels.
+ *
+ * A suite is a void function that runs its cases with nn_test_check and
+ * nn_test_expect. test_main.c lists the suites. Buffers come from
+ * nn_test_alloc and are freed after each suite.
+*/
+
+#include <stdint.h>
+#include "nn_functions.h"
+
+/* ---- helpers ---- */
+
+extern uint32_t nn_test_checks;
+extern uint32_t nn_test_failures;
+
+void nn_test_seed(const uint32_t seed);
+
+uint32_t nn_test_rand(void);
+
+void *nn_test_alloc(const uint32_t bytes);
+
+void nn_test_free_all(void);
+
+// Uniform in [-128, 127]
+void nn_test_fill(q7_t *p, const uint32_t n);
+
+// Uniform in [-max_abs, max_abs]
+void nn_test_fill_range(q7_t *p, const uint32_t n, const int32_t max_abs);
+
+// Counts a failure and prints the first mismatch when out != ref
+int nn_test_check(const q7_t *out, const q7_t *ref, const uint32_t n, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+int nn_test_expect(const int cond, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/* ---- naive references ---- */
+
+/**
+ * Layer geometry for the references. Output pixel (ox, oy) reads input
+ * pixels (ox * stride_x - pad_left + kx * dilation, oy * stride_y - pad_top + ky * dilation);
+ * taps outside the input are zero.
+ */
+typedef struct
+{
+    uint16_t dim_x;
+    uint16_t dim_y;
+    uint16_t ch_in;
+    uint16_t ch_out;        // conv: output channels, depthwise: ch_in * multiplier
+    uint16_t kernel_x;
+    uint16_t kernel_y;
+    uint16_t stride_x;
+    uint16_t stride_y;
+    uint16_t pad_top;
+    uint16_t pad_left;
+    uint16_t dilation;
+    uint16_t out_x;
+    uint16_t out_y;
+} ref_shape;
+
+// Square input and kernel, stride 1, same padding on all sides
+ref_shape ref_square(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out,
+                     const uint16_t kernel, const uint16_t padding);
+
+/**
+ * Conv, HWC input, weights [ch_out][kernel_y][kernel_x][ch_in]. Per channel:
+ * sum = (bias << bias_shift) + taps (+ (1 << out_shift) >> 1 when round),
+ * out = clamp(ssat8(sum >> out_shift)). A non-NULL epilogue overrides bias
+ * (when its bias is set) and out_shift (when its out_shift is set), and
+ * clamps to [act_min, act_max].
+ */
+void ref_conv(const ref_shape *s,
+              const q7_t *Im_in,
+              const q7_t *wt,
+              const q7_t *bias,
+              const uint16_t bias_shift,
+              const uint16_t out_shift,
+              const int round,
+              const nn_epilogue *epilogue,
+              q7_t *Im_out);
+
+// Depthwise, weights [kernel_y][kernel_x][ch_out], output channel o reads input channel o / multiplier
+void ref_depthwise(const ref_shape *s,
+                   const q7_t *Im_in,
+                   const q7_t *wt,
+                   const q7_t *bias,
+                   const uint16_t bias_shift,
+                   const uint16_t out_shift,
+                   const int round,
+                   const nn_epilogue *epilogue,
+                   q7_t *Im_out);
+
+// Average over the taps inside the input, rounded half away from zero
+void ref_avg_pool(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in,
+                  const uint16_t dim_kernel, const uint16_t padding, const uint16_t stride,
+                  const uint16_t dim_im_out, q7_t *Im_out);
+
+void ref_max_pool(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in,
+                  const uint16_t dim_kernel, const uint16_t padding, const uint16_t stride,
+                  const uint16_t dim_im_out, q7_t *Im_out);
+
+// avg_pool_q7_HWC_opt: halving adds, (((a + b) >> 1) + ((c + d) >> 1)) >> 1
+void ref_avg_pool_2x2(const q7_t *Im_in, const uint16_t dim_im_in, const uint16_t ch_im_in, q7_t *Im_out);
+
+// arm_fully_connected_q7, weights [rows][dim_vec], rounded like the pointwise kernels
+void ref_fully_connected(const q7_t *pV, const q7_t *pM, const uint16_t dim_vec, const uint16_t num_of_rows,
+                         const uint16_t bias_shift, const uint16_t out_shift, const q7_t *bias, q7_t *pOut);
+
+/* ---- suites ---- */
+
+void test_conv(void);
+void test_depthwise(void);
+void test_pointwise(void);
+void test_pool(void);
+void test_depthwise_pointwise(void);
+void test_conv_ring(void);
+void test_conv_packed(void);
+void test_conv_tiled(void);
+void test_epilogue(void);
+void test_nonsquare(void);
+void test_fully_connected(void);
+void test_parallel(void);
+void test_planner(void);
+void test_batch(void);
+void test_stream(void);
+void test_x86(void);
+void test_sparse(void);
+void test_int4(void);
+void test_inplace(void);
+void test_mult(void);
+void test_graph(void);
+void test_conv_q7(void);
+void test_profile(void);
+
+#endif
@@ -0,0 +1,81 @@
+#include "nn_test.h"
+
+/*
+ * conv_HWC_batch and pointwise_conv_fast_batch against one reference call
+ * per input
+ */
+
+static void conv_batch_case(const uint16_t batch, const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out,
+                            const uint16_t kernel, const nn_epilogue *ep)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t size_b;
+    q7_t *in = nn_test_alloc(batch * in_size);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(batch * out_size);
+    q7_t *ref = nn_test_alloc(batch * out_size);
+    q15_t *bufferA = nn_test_alloc(conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &size_b));
+    q15_t *bufferB = nn_test_alloc(size_b);
+    uint16_t b;
+
+    nn_test_fill(in, batch * in_size);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 32);
+    nn_test_fill(bias, ch_out);
+
+    conv_HWC_batch_ep(in, batch, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, ep);
+    for (b = 0; b < batch; b++)
+    {
+        ref_conv(&s, in + b * in_size, wt, bias, 2, 7, 0, ep, ref + b * out_size);
+    }
+    nn_test_check(out, ref, batch * out_size, "conv_HWC_batch %u x %ux%ux%u -> %u k%u%s", batch, dim, dim, ch_in,
+                  ch_out, kernel, ep ? " relu" : "");
+}
+
+static void pointwise_batch_case(const uint16_t batch, const uint16_t dim, const uint16_t ch_in,
+                                 const uint16_t ch_out, const nn_epilogue *ep)
+{
+    ref_shape s = ref_square(dim, ch_in, ch_out, 1, 0);
+    uint32_t in_size = dim * dim * ch_in;
+    uint32_t out_size = dim * dim * ch_out;
+    q7_t *in = nn_test_alloc(batch * in_size);
+    q7_t *wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(batch * out_size);
+    q7_t *ref = nn_test_alloc(batch * out_size);
+    q15_t *bufferA = nn_test_alloc(pointwise_conv_4x2_get_buffer_size(ch_in));
+    uint16_t b;
+
+    nn_test_fill(in, batch * in_size);
+    nn_test_fill(wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    pointwise_conv_fast_batch_ep(in, batch, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA, ep);
+    for (b = 0; b < batch; b++)
+    {
+        ref_conv(&s, in + b * in_size, wt, bias, 2, 7, 1, ep, ref + b * out_size);
+    }
+    nn_test_check(out, ref, batch * out_size, "pointwise_conv_fast_batch %u x %ux%ux%u -> %u%s", batch, dim, dim,
+                  ch_in, ch_out, ep ? " relu" : "");
+}
+
+void test_batch(void)
+{
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+    uint16_t batch;
+
+    for (batch = 1; batch <= 5; batch++)
+    {
+        conv_batch_case(batch, 5, 4, 6, 3, NULL);
+        // Odd pixel counts, so the 4-pixel blocks straddle inputs
+        pointwise_batch_case(batch, 3, 8, 6, NULL);
+        pointwise_batch_case(batch, 5, 16, 4, NULL);
+    }
+    conv_batch_case(3, 6, 2, 8, 5, &relu);
+    pointwise_batch_case(3, 3, 64, 8, &relu);
+    pointwise_batch_case(2, 4, 172, 6, NULL);
+    pointwise_batch_case(4, 2, 128, 10, &relu);
+}
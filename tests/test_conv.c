@@ -0,0 +1,77 @@
+#include "nn_test.h"
+
+static void conv_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = s.out_x * s.out_y * ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 20);
+    nn_test_fill(bias, ch_out);
+
+    conv_HWC(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC %ux%ux%u -> %u k%u", dim, dim, ch_in, ch_out, kernel);
+}
+
+// Bias well above the taps, different in the two channels of every pair: a pair that reads its second bias
+// from the first (bias[0] + 1 in place of bias[1]) fails here
+static void conv_bias_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out)
+{
+    ref_shape s = ref_square(dim, ch_in, ch_out, 3, 1);
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, 3, &sizeB);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * 9 * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    uint16_t o;
+
+    nn_test_fill_range(in, dim * dim * ch_in, 8);
+    nn_test_fill_range(wt, ch_out * 9 * ch_in, 8);
+    for (o = 0; o < ch_out; o++)
+    {
+        bias[o] = (q7_t)((o & 1) ? -40 - 3 * o : 40 + 5 * o);
+    }
+
+    conv_HWC(in, dim, ch_in, wt, ch_out, 3, 1, bias, 7, 7, out, bufferA, bufferB);
+    ref_conv(&s, in, wt, bias, 7, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC %ux%ux%u -> %u channel pair bias", dim, dim, ch_in, ch_out);
+}
+
+void test_conv(void)
+{
+    conv_case(6, 4, 8, 3);
+    conv_case(8, 6, 4, 3);
+    conv_case(10, 2, 6, 5);
+    conv_case(4, 8, 2, 1);
+    conv_case(7, 4, 8, 3);
+    conv_case(9, 2, 6, 5);
+    conv_case(3, 4, 2, 3);
+    conv_case(1, 4, 2, 1);
+    conv_case(11, 8, 10, 3);
+    // Odd ch_im_in
+    conv_case(6, 3, 4, 3);
+    conv_case(5, 1, 2, 3);
+    conv_bias_case(6, 4, 8);
+    conv_bias_case(5, 2, 6);
+    // Windows of a multiple of 8 values take the blocks without a leftover loop, with 4-, 2- and 1-pixel blocks
+    conv_case(7, 16, 6, 3);
+    conv_case(5, 8, 4, 5);
+    conv_case(3, 24, 2, 1);
+    conv_bias_case(7, 8, 6);
+}
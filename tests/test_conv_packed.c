@@ -0,0 +1,49 @@
+#include "nn_test.h"
+#include "weight_packer.h"
+
+static void packed_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    ref_shape pw = ref_square(dim, ch_in, ch_out, 1, 0);
+    uint32_t out_size = dim * dim * ch_out;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *packed = nn_test_alloc(pack_conv_HWC_weights_size(ch_in, ch_out, kernel) * 2);
+    q15_t *bufferA = nn_test_alloc(conv_HWC_packed_get_buffer_size(dim, ch_in, kernel));
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(wt, ch_out * kernel * kernel * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    pack_conv_HWC_weights(wt, ch_in, ch_out, kernel, packed);
+    conv_HWC_packed(in, dim, ch_in, packed, ch_out, kernel, padding, bias, 2, 7, out, bufferA);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC_packed %ux%ux%u -> %u k%u", dim, dim, ch_in, ch_out, kernel);
+
+    if (ch_in % 4 == 0)
+    {
+        // The first ch_out x ch_in weights as a pointwise layer
+        packed = nn_test_alloc(pack_pointwise_fast_weights_size(ch_in, ch_out) * 2);
+        bufferA = nn_test_alloc(pointwise_conv_fast_packed_get_buffer_size(ch_in));
+        pack_pointwise_fast_weights(wt, ch_in, ch_out, packed);
+        pointwise_conv_fast_packed(in, dim, ch_in, packed, ch_out, bias, 2, 7, out, bufferA);
+        ref_conv(&pw, in, wt, bias, 2, 7, 1, NULL, ref);
+        nn_test_check(out, ref, out_size, "pointwise_conv_fast_packed %ux%ux%u -> %u", dim, dim, ch_in, ch_out);
+    }
+}
+
+void test_conv_packed(void)
+{
+    packed_case(6, 4, 8, 3);
+    packed_case(7, 6, 4, 3);
+    packed_case(9, 2, 6, 5);
+    packed_case(5, 8, 2, 1);
+    packed_case(2, 4, 2, 3);
+    packed_case(3, 12, 4, 3);
+    packed_case(11, 64, 64, 3);
+    packed_case(7, 16, 6, 3);
+}
@@ -0,0 +1,84 @@
+#include <string.h>
+#include "nn_test.h"
+
+/*
+ * conv_HWC_q7 against the reference and against conv_HWC with the same
+ * epilogue: odd and even sizes, windows that are not a multiple of 4 values,
+ * no epilogue, ReLU and a full per-channel epilogue. conv_HWC_q7_rows must
+ * give the same bytes over any split of the output rows.
+ */
+
+static void conv_q7_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *ep_bias = nn_test_alloc(ch_out);
+    uint8_t *shift = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *dense = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q7_t *bufferA_q7 = nn_test_alloc(conv_HWC_q7_get_buffer_size(dim, ch_in, kernel));
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+    nn_epilogue full = {ep_bias, 3, shift, -20, 100};
+    const nn_epilogue *eps[3] = {NULL, &relu, &full};
+    uint16_t i, split;
+    int e;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 20);
+    nn_test_fill(bias, ch_out);
+    nn_test_fill(ep_bias, ch_out);
+    for (i = 0; i < ch_out; i++)
+    {
+        shift[i] = 6 + i % 3;
+    }
+
+    for (e = 0; e < 3; e++)
+    {
+        memset(out, 0x55, out_size);
+        conv_HWC_q7_ep(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA_q7, eps[e]);
+        conv_HWC_ep(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, dense, bufferA, bufferB, eps[e]);
+        ref_conv(&s, in, wt, bias, 2, 7, 0, eps[e], ref);
+        nn_test_check(out, ref, out_size, "conv_HWC_q7 %ux%ux%u -> %u k%u, epilogue %d", dim, dim, ch_in, ch_out,
+                      kernel, e);
+        nn_test_check(out, dense, out_size, "conv_HWC_q7 %ux%ux%u -> %u k%u, epilogue %d: against conv_HWC_ep", dim,
+                      dim, ch_in, ch_out, kernel, e);
+    }
+
+    // Two slices split at every row
+    for (split = 0; split <= dim; split++)
+    {
+        memset(out, 0x55, out_size);
+        conv_HWC_q7_rows(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA_q7, &full, 0, split);
+        conv_HWC_q7_rows(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA_q7, &full, split, dim);
+        nn_test_check(out, ref, out_size, "conv_HWC_q7_rows %ux%ux%u -> %u k%u, split at row %u", dim, dim, ch_in,
+                      ch_out, kernel, split);
+    }
+}
+
+void test_conv_q7(void)
+{
+    conv_q7_case(6, 4, 8, 3);
+    conv_q7_case(7, 4, 8, 3);
+    conv_q7_case(8, 6, 4, 3);
+    conv_q7_case(9, 2, 6, 5);
+    conv_q7_case(3, 4, 2, 3);
+    conv_q7_case(1, 4, 2, 1);
+    conv_q7_case(4, 8, 2, 1);
+    conv_q7_case(6, 3, 4, 3);
+    conv_q7_case(5, 1, 6, 3);
+    conv_q7_case(11, 8, 10, 3);
+    conv_q7_case(7, 16, 6, 3);
+    conv_q7_case(5, 20, 4, 5);
+    // DS-CNN widths
+    conv_q7_case(11, 64, 64, 3);
+    conv_q7_case(5, 172, 12, 3);
+}
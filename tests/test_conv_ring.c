@@ -0,0 +1,68 @@
+#include "nn_test.h"
+
+static void ring_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    ref_shape dw = ref_square(dim, ch_in, ch_in, kernel, padding);
+    uint32_t out_size = s.out_x * s.out_y * ch_out;
+    uint32_t dw_size = dw.out_x * dw.out_y * ch_in;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_ring_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *dw_wt = nn_test_alloc(kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q7_t *dw_out = nn_test_alloc(dw_size);
+    q7_t *dw_ref = nn_test_alloc(dw_size);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    q7_t *dw_buffer = nn_test_alloc(depthwise_conv_ring_get_buffer_size(dim, ch_in, kernel));
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 20);
+    nn_test_fill(dw_wt, kernel * kernel * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    if (ch_in % 2 == 0)
+    {
+        conv_HWC_ring(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB);
+        ref_conv(&s, in, wt, bias, 2, 7, 0, NULL, ref);
+        nn_test_check(out, ref, out_size, "conv_HWC_ring %ux%ux%u -> %u k%u", dim, dim, ch_in, ch_out, kernel);
+    }
+
+    depthwise_conv_ring(in, dim, ch_in, dw_wt, kernel, padding, 7, dw_out, dw_buffer);
+    ref_depthwise(&dw, in, dw_wt, NULL, 0, 7, 0, NULL, dw_ref);
+    nn_test_check(dw_out, dw_ref, dw_size, "depthwise_conv_ring %ux%ux%u k%u", dim, dim, ch_in, kernel);
+
+    // Per-channel bias and shift, clamped
+    {
+        q7_t *dw_bias = nn_test_alloc(ch_in);
+        uint8_t *shift = nn_test_alloc(ch_in);
+        nn_epilogue ep = {dw_bias, 2, shift, -50, 90};
+        uint16_t i;
+
+        nn_test_fill(dw_bias, ch_in);
+        for (i = 0; i < ch_in; i++)
+        {
+            shift[i] = 5 + i % 4;
+        }
+        depthwise_conv_ring_ep(in, dim, ch_in, dw_wt, kernel, padding, 7, dw_out, dw_buffer, &ep);
+        ref_depthwise(&dw, in, dw_wt, NULL, 0, 7, 0, &ep, dw_ref);
+        nn_test_check(dw_out, dw_ref, dw_size, "depthwise_conv_ring_ep %ux%ux%u k%u", dim, dim, ch_in, kernel);
+    }
+}
+
+void test_conv_ring(void)
+{
+    ring_case(6, 4, 8, 3);
+    ring_case(7, 6, 4, 3);
+    ring_case(9, 2, 6, 5);
+    ring_case(5, 8, 2, 1);
+    ring_case(5, 7, 2, 3);
+    ring_case(8, 4, 2, 5);
+    ring_case(1, 4, 2, 3);
+    ring_case(11, 64, 64, 3);
+}
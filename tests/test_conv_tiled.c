@@ -0,0 +1,44 @@
+#include "nn_test.h"
+
+static void tiled_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel,
+                       const uint32_t budget)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = dim * dim * ch_out;
+    uint16_t tile = conv_HWC_get_tile_size(ch_in, ch_out, kernel, budget);
+    uint32_t sizeB;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(conv_HWC_tiled_get_buffer_size(dim, ch_in, tile, kernel, &sizeB));
+    q15_t *bufferB;
+
+    if (nn_test_expect(tile > 0 && sizeB <= budget, "conv_HWC_get_tile_size %u bytes: tile %u, bufferB %u",
+                       budget, tile, sizeB))
+    {
+        return;
+    }
+    bufferB = nn_test_alloc(sizeB);
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 20);
+    nn_test_fill(bias, ch_out);
+
+    conv_HWC_tiled(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, tile);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC_tiled %ux%ux%u -> %u k%u tile %u", dim, dim, ch_in, ch_out, kernel,
+                  tile);
+}
+
+void test_conv_tiled(void)
+{
+    tiled_case(6, 4, 8, 3, 4 * 36 * 2);
+    tiled_case(6, 4, 8, 3, 8 * 36 * 2);
+    tiled_case(7, 6, 10, 3, 6 * 54 * 2 + 50);
+    tiled_case(9, 2, 6, 5, 2 * 50 * 2);
+    tiled_case(5, 8, 12, 1, 1000);
+    tiled_case(11, 64, 64, 3, 16 * 1024);
+}
@@ -0,0 +1,36 @@
+#include "nn_test.h"
+
+static void depthwise_case(const uint16_t dim, const uint16_t ch, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch, ch, kernel, padding);
+    uint32_t out_size = s.out_x * s.out_y * ch;
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *wt = nn_test_alloc(kernel * kernel * ch);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q7_t *bufferA = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch, kernel));
+
+    nn_test_fill(in, dim * dim * ch);
+    nn_test_fill(wt, kernel * kernel * ch);
+
+    depthwise_conv(in, dim, ch, wt, kernel, padding, 7, out, bufferA);
+    ref_depthwise(&s, in, wt, NULL, 0, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "depthwise_conv %ux%ux%u k%u", dim, dim, ch, kernel);
+}
+
+void test_depthwise(void)
+{
+    depthwise_case(7, 8, 3);
+    depthwise_case(5, 5, 3);
+    depthwise_case(9, 12, 5);
+    depthwise_case(6, 3, 3);
+    depthwise_case(3, 8, 5);
+    depthwise_case(4, 4, 1);
+    depthwise_case(2, 6, 3);
+    depthwise_case(1, 7, 3);
+    // DS-CNN layer widths
+    depthwise_case(11, 64, 3);
+    depthwise_case(5, 172, 3);
+    depthwise_case(5, 276, 3);
+}
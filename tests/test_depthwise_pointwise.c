@@ -0,0 +1,68 @@
+#include "nn_test.h"
+
+static void dwpw_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel,
+                      const int with_epilogue)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape dw = ref_square(dim, ch_in, ch_in, kernel, padding);
+    ref_shape pw = ref_square(dim, ch_in, ch_out, 1, 0);
+    uint32_t out_size = dim * dim * ch_out;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *dw_wt = nn_test_alloc(kernel * kernel * ch_in);
+    q7_t *pw_wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *dw_bias = nn_test_alloc(ch_in);
+    q7_t *pw_bias = nn_test_alloc(ch_out);
+    uint8_t *dw_shift = nn_test_alloc(ch_in);
+    uint8_t *pw_shift = nn_test_alloc(ch_out);
+    q7_t *mid = nn_test_alloc(dim * dim * ch_in);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(depthwise_pointwise_conv_get_buffer_size(ch_in));
+    nn_epilogue dw_ep = {dw_bias, 3, dw_shift, 0, 100};
+    nn_epilogue pw_ep = {pw_bias, 2, pw_shift, -40, 90};
+    uint16_t i;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(dw_wt, kernel * kernel * ch_in);
+    nn_test_fill(pw_wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+    nn_test_fill(dw_bias, ch_in);
+    nn_test_fill(pw_bias, ch_out);
+    for (i = 0; i < ch_in; i++)
+    {
+        dw_shift[i] = 6 + i % 3;
+    }
+    for (i = 0; i < ch_out; i++)
+    {
+        pw_shift[i] = 6 + i % 2;
+    }
+
+    if (with_epilogue)
+    {
+        depthwise_pointwise_conv_ep(in, dim, ch_in, dw_wt, kernel, padding, 7, pw_wt, ch_out, bias, 2, 7, out,
+                                    bufferA, &dw_ep, &pw_ep);
+    }
+    else
+    {
+        depthwise_pointwise_conv(in, dim, ch_in, dw_wt, kernel, padding, 7, pw_wt, ch_out, bias, 2, 7, out, bufferA);
+    }
+    ref_depthwise(&dw, in, dw_wt, NULL, 0, 7, 0, with_epilogue ? &dw_ep : NULL, mid);
+    ref_conv(&pw, mid, pw_wt, bias, 2, 7, 1, with_epilogue ? &pw_ep : NULL, ref);
+    nn_test_check(out, ref, out_size, "depthwise_pointwise_conv%s %ux%ux%u -> %u k%u", with_epilogue ? "_ep" : "",
+                  dim, dim, ch_in, ch_out, kernel);
+}
+
+void test_depthwise_pointwise(void)
+{
+    int ep;
+    for (ep = 0; ep < 2; ep++)
+    {
+        dwpw_case(5, 8, 6, 3, ep);
+        dwpw_case(6, 12, 4, 3, ep);
+        dwpw_case(7, 4, 8, 5, ep);
+        dwpw_case(3, 8, 2, 3, ep);
+        dwpw_case(4, 4, 2, 1, ep);
+        dwpw_case(5, 64, 10, 3, ep);
+    }
+}
@@ -0,0 +1,144 @@
+#include "nn_test.h"
+#include "weight_packer.h"
+
+/*
+ * The *_ep entry points with a full epilogue (per-channel bias and shift,
+ * clamp) and with a clamp only (ReLU), against the naive references.
+ */
+
+static void epilogue_fill(nn_epilogue *ep, const int full, const uint16_t ch)
+{
+    q7_t *bias = nn_test_alloc(ch);
+    uint8_t *shift = nn_test_alloc(ch);
+    uint16_t i;
+
+    nn_test_fill(bias, ch);
+    for (i = 0; i < ch; i++)
+    {
+        shift[i] = 6 + i % 3;
+    }
+    ep->bias = full ? bias : NULL;
+    ep->bias_shift = 3;
+    ep->out_shift = full ? shift : NULL;
+    ep->act_min = full ? -50 : 0;
+    ep->act_max = full ? 90 : 127;
+}
+
+static void conv_ep_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel,
+                         const int full)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t sizeB, tile_sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    uint16_t tile = ch_out > 2 ? (ch_out / 2) & ~0x1 : 2;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *packed = nn_test_alloc(pack_conv_HWC_weights_size(ch_in, ch_out, kernel) * 2);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    nn_epilogue ep;
+
+    conv_HWC_tiled_get_buffer_size(dim, ch_in, tile, kernel, &tile_sizeB);
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 20);
+    nn_test_fill(bias, ch_out);
+    epilogue_fill(&ep, full, ch_out);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, &ep, ref);
+
+    conv_HWC_ep(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, &ep);
+    nn_test_check(out, ref, out_size, "conv_HWC_ep %ux%ux%u -> %u k%u full %d", dim, dim, ch_in, ch_out, kernel,
+                  full);
+
+    conv_HWC_ring_ep(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, &ep);
+    nn_test_check(out, ref, out_size, "conv_HWC_ring_ep %ux%ux%u -> %u k%u full %d", dim, dim, ch_in, ch_out,
+                  kernel, full);
+
+    conv_HWC_tiled_ep(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, tile, &ep);
+    nn_test_check(out, ref, out_size, "conv_HWC_tiled_ep %ux%ux%u -> %u k%u tile %u full %d", dim, dim, ch_in,
+                  ch_out, kernel, tile, full);
+
+    pack_conv_HWC_weights(wt, ch_in, ch_out, kernel, packed);
+    conv_HWC_packed_ep(in, dim, ch_in, packed, ch_out, kernel, padding, bias, 2, 7, out, bufferA, &ep);
+    nn_test_check(out, ref, out_size, "conv_HWC_packed_ep %ux%ux%u -> %u k%u full %d", dim, dim, ch_in, ch_out,
+                  kernel, full);
+}
+
+static void pointwise_ep_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const int full)
+{
+    ref_shape s = ref_square(dim, ch_in, ch_out, 1, 0);
+    uint32_t out_size = dim * dim * ch_out;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *packed = nn_test_alloc(pack_pointwise_fast_weights_size(ch_in, ch_out) * 2);
+    q15_t *bufferA = nn_test_alloc(pointwise_conv_fast_get_buffer_size(ch_in));
+    nn_epilogue ep;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+    epilogue_fill(&ep, full, ch_out);
+    ref_conv(&s, in, wt, bias, 2, 7, 1, &ep, ref);
+
+    pointwise_conv_basic_ep(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA, &ep);
+    nn_test_check(out, ref, out_size, "pointwise_conv_basic_ep %ux%ux%u -> %u full %d", dim, dim, ch_in, ch_out,
+                  full);
+    if (ch_in % 4 == 0 && ch_out % 2 == 0)
+    {
+        pointwise_conv_fast_ep(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA, &ep);
+        nn_test_check(out, ref, out_size, "pointwise_conv_fast_ep %ux%ux%u -> %u full %d", dim, dim, ch_in, ch_out,
+                      full);
+
+        pack_pointwise_fast_weights(wt, ch_in, ch_out, packed);
+        pointwise_conv_fast_packed_ep(in, dim, ch_in, packed, ch_out, bias, 2, 7, out, bufferA, &ep);
+        nn_test_check(out, ref, out_size, "pointwise_conv_fast_packed_ep %ux%ux%u -> %u full %d", dim, dim, ch_in,
+                      ch_out, full);
+    }
+}
+
+static void depthwise_ep_case(const uint16_t dim, const uint16_t ch, const uint16_t kernel, const int full)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch, ch, kernel, padding);
+    uint32_t out_size = dim * dim * ch;
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *wt = nn_test_alloc(kernel * kernel * ch);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q7_t *bufferA = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch, kernel));
+    nn_epilogue ep;
+
+    nn_test_fill(in, dim * dim * ch);
+    nn_test_fill(wt, kernel * kernel * ch);
+    epilogue_fill(&ep, full, ch);
+
+    depthwise_conv_ep(in, dim, ch, wt, kernel, padding, 7, out, bufferA, &ep);
+    ref_depthwise(&s, in, wt, NULL, 0, 7, 0, &ep, ref);
+    nn_test_check(out, ref, out_size, "depthwise_conv_ep %ux%ux%u k%u full %d", dim, dim, ch, kernel, full);
+}
+
+void test_epilogue(void)
+{
+    int full;
+    for (full = 0; full < 2; full++)
+    {
+        conv_ep_case(6, 4, 8, 3, full);
+        conv_ep_case(7, 6, 4, 3, full);
+        conv_ep_case(9, 2, 6, 5, full);
+        conv_ep_case(5, 8, 2, 1, full);
+        pointwise_ep_case(5, 8, 6, full);
+        pointwise_ep_case(4, 12, 4, full);
+        pointwise_ep_case(3, 5, 3, full);
+        depthwise_ep_case(7, 8, 3, full);
+        depthwise_ep_case(5, 5, 3, full);
+        depthwise_ep_case(9, 12, 5, full);
+        depthwise_ep_case(11, 64, 3, full);
+    }
+}
@@ -0,0 +1,63 @@
+#include "nn_test.h"
+
+// arm_fully_connected_q7 and arm_softmax_q7 come from nn_portable.c on the host, the classifier tail of
+// tools/tflite2c.py output
+
+static void fully_connected_case(const uint16_t dim_vec, const uint16_t rows)
+{
+    q7_t *in = nn_test_alloc(dim_vec);
+    q7_t *wt = nn_test_alloc(dim_vec * rows);
+    q7_t *bias = nn_test_alloc(rows);
+    q7_t *out = nn_test_alloc(rows);
+    q7_t *ref = nn_test_alloc(rows);
+    q15_t *buffer = nn_test_alloc(2 * dim_vec);
+
+    nn_test_fill(in, dim_vec);
+    nn_test_fill(wt, dim_vec * rows);
+    nn_test_fill(bias, rows);
+    arm_fully_connected_q7(in, wt, dim_vec, rows, 4, 9, bias, out, buffer);
+    ref_fully_connected(in, wt, dim_vec, rows, 4, 9, bias, ref);
+    nn_test_check(out, ref, rows, "arm_fully_connected_q7 %u -> %u", dim_vec, rows);
+}
+
+static void softmax_case(const uint16_t dim_vec)
+{
+    q7_t *in = nn_test_alloc(dim_vec);
+    q7_t *out = nn_test_alloc(dim_vec);
+    uint16_t i, top = 0;
+    int ok = 1;
+
+    nn_test_fill(in, dim_vec);
+    for (i = 1; i < dim_vec; i++)
+    {
+        top = in[i] > in[top] ? i : top;
+    }
+    arm_softmax_q7(in, dim_vec, out);
+    for (i = 0; i < dim_vec; i++)
+    {
+        // Non-negative and monotonic in the input
+        ok &= out[i] >= 0 && out[i] <= out[top] && (in[i] != in[top] || out[i] == out[top]);
+    }
+    nn_test_expect(ok, "arm_softmax_q7 %u: order of the inputs not kept", dim_vec);
+
+    // One input 8 or more above the rest takes almost all of the mass
+    for (i = 0; i < dim_vec; i++)
+    {
+        in[i] = (q7_t)(-100 + i % 5);
+    }
+    in[dim_vec / 2] = 100;
+    arm_softmax_q7(in, dim_vec, out);
+    nn_test_expect(out[dim_vec / 2] >= 120, "arm_softmax_q7 %u: dominant input gives %d", dim_vec, out[dim_vec / 2]);
+}
+
+void test_fully_connected(void)
+{
+    fully_connected_case(8, 4);
+    fully_connected_case(10, 5);
+    fully_connected_case(3, 1);
+    fully_connected_case(64, 12);
+    fully_connected_case(255, 7);
+    softmax_case(4);
+    softmax_case(12);
+    softmax_case(35);
+}
@@ -0,0 +1,152 @@
+#include <string.h>
+#include "nn_graph.h"
+#include "nn_test.h"
+
+/*
+ * nn_graph_run on a DS-CNN-style table against the references layer by
+ * layer: the whole model, every prefix and every single layer. nn_graph_init
+ * must report the first failing layer for each kind of error.
+ */
+
+#define GRAPH_LAYERS 7
+#define GRAPH_BUF (12 * 12 * 16)
+
+static uint32_t graph_scratch_size(const nn_layer *layers, const uint16_t num_layers)
+{
+    uint32_t size = 4;
+    uint16_t i;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        uint32_t s = nn_graph_scratch_size(&layers[i]);
+        size = s > size ? s : size;
+    }
+    return (size + 3) & ~3u;
+}
+
+static uint32_t graph_out_size(const nn_layer *l)
+{
+    uint16_t dim = l->op == NN_OP_AVG_POOL_2X2 ? l->dim_im_in / 2
+                 : l->op == NN_OP_GLOBAL_AVG_POOL ? 1
+                 : (l->op == NN_OP_AVG_POOL || l->op == NN_OP_MAX_POOL) ? l->dim_im_out
+                 : l->dim_im_in;
+    uint16_t ch = (l->op == NN_OP_CONV || l->op == NN_OP_POINTWISE) ? l->ch_im_out : l->ch_im_in;
+    return dim * dim * ch;
+}
+
+static void graph_expect_error(const nn_layer *layers, const uint16_t num_layers, const uint32_t buf_size,
+                               const uint32_t scratch_size, const nn_graph_status status, const uint16_t err_layer,
+                               const char *what)
+{
+    q7_t *buf0 = nn_test_alloc(GRAPH_BUF);
+    q7_t *buf1 = nn_test_alloc(GRAPH_BUF);
+    void *scratch = nn_test_alloc(scratch_size + 4);
+    nn_graph g;
+    nn_graph_status got = nn_graph_init(&g, layers, num_layers, buf0, buf1, buf_size, scratch, scratch_size);
+
+    nn_test_expect(got == status && (status == NN_GRAPH_OK || g.err_layer == err_layer),
+                   "nn_graph_init %s: status %d at layer %u, expected %d at layer %u", what, got, g.err_layer, status,
+                   err_layer);
+}
+
+void test_graph(void)
+{
+    q7_t *conv_wt = nn_test_alloc(16 * 9 * 2);
+    q7_t *dw_wt = nn_test_alloc(9 * 16);
+    q7_t *pw_wt = nn_test_alloc(16 * 10);
+    q7_t *pw2_wt = nn_test_alloc(10 * 12);
+    q7_t *bias = nn_test_alloc(16);
+    q7_t *dw_bias = nn_test_alloc(16);
+    uint8_t *shift = nn_test_alloc(16);
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+    nn_epilogue dw_ep = {dw_bias, 3, shift, -20, 100};
+    // conv, depthwise, pointwise_conv_fast, pointwise_conv_basic (10 input channels), then the pools
+    const nn_layer layers[GRAPH_LAYERS] = {
+        {NN_OP_CONV, 12, 2, 16, 3, 1, 1, 12, conv_wt, bias, 2, 7, &relu},
+        {NN_OP_DEPTHWISE, 12, 16, 16, 3, 1, 1, 12, dw_wt, NULL, 0, 7, &dw_ep},
+        {NN_OP_POINTWISE, 12, 16, 10, 1, 0, 1, 12, pw_wt, bias, 2, 7, NULL},
+        {NN_OP_POINTWISE, 12, 10, 12, 1, 0, 1, 12, pw2_wt, bias, 2, 7, &relu},
+        {NN_OP_AVG_POOL_2X2, 12, 12, 12, 2, 0, 2, 6, NULL, NULL, 0, 0, NULL},
+        {NN_OP_MAX_POOL, 6, 12, 12, 2, 0, 2, 3, NULL, NULL, 0, 0, NULL},
+        {NN_OP_GLOBAL_AVG_POOL, 3, 12, 12, 3, 0, 1, 1, NULL, NULL, 0, 0, NULL},
+    };
+    nn_layer bad[GRAPH_LAYERS];
+    uint32_t scratch_size = graph_scratch_size(layers, GRAPH_LAYERS);
+    q7_t *buf0 = nn_test_alloc(GRAPH_BUF);
+    q7_t *buf1 = nn_test_alloc(GRAPH_BUF);
+    q7_t *scratch = nn_test_alloc(scratch_size);
+    q7_t *in = nn_test_alloc(12 * 12 * 2);
+    q7_t *ref[GRAPH_LAYERS];
+    ref_shape s;
+    nn_graph g;
+    uint16_t i, last;
+
+    nn_test_fill(in, 12 * 12 * 2);
+    nn_test_fill_range(conv_wt, 16 * 9 * 2, 20);
+    nn_test_fill(dw_wt, 9 * 16);
+    nn_test_fill(pw_wt, 16 * 10);
+    nn_test_fill(pw2_wt, 10 * 12);
+    nn_test_fill(bias, 16);
+    nn_test_fill(dw_bias, 16);
+    for (i = 0; i < 16; i++)
+    {
+        shift[i] = 6 + i % 3;
+    }
+
+    for (i = 0; i < GRAPH_LAYERS; i++)
+    {
+        ref[i] = nn_test_alloc(graph_out_size(&layers[i]));
+    }
+    s = ref_square(12, 2, 16, 3, 1);
+    ref_conv(&s, in, conv_wt, bias, 2, 7, 0, &relu, ref[0]);
+    s = ref_square(12, 16, 16, 3, 1);
+    ref_depthwise(&s, ref[0], dw_wt, NULL, 0, 7, 0, &dw_ep, ref[1]);
+    s = ref_square(12, 16, 10, 1, 0);
+    ref_conv(&s, ref[1], pw_wt, bias, 2, 7, 1, NULL, ref[2]);
+    s = ref_square(12, 10, 12, 1, 0);
+    ref_conv(&s, ref[2], pw2_wt, bias, 2, 7, 1, &relu, ref[3]);
+    ref_avg_pool_2x2(ref[3], 12, 12, ref[4]);
+    ref_max_pool(ref[4], 6, 12, 2, 0, 2, 3, ref[5]);
+    ref_avg_pool(ref[5], 3, 12, 3, 0, 1, 1, ref[6]);
+
+    if (nn_test_expect(nn_graph_init(&g, layers, GRAPH_LAYERS, buf0, buf1, GRAPH_BUF, scratch, scratch_size) ==
+                           NN_GRAPH_OK, "nn_graph_init"))
+    {
+        return;
+    }
+
+    // Whole model and every prefix
+    for (last = 0; last < GRAPH_LAYERS; last++)
+    {
+        memcpy(nn_graph_input(&g, 0), in, 12 * 12 * 2);
+        nn_graph_run(&g, 0, last);
+        nn_test_check(nn_graph_output(&g, last), ref[last], graph_out_size(&layers[last]),
+                      "nn_graph_run 0..%u", last);
+    }
+
+    // Single layers, each from the reference output of the one before
+    for (i = 1; i < GRAPH_LAYERS; i++)
+    {
+        memcpy(nn_graph_input(&g, i), ref[i - 1], graph_out_size(&layers[i - 1]));
+        nn_graph_run(&g, i, i);
+        nn_test_check(nn_graph_output(&g, i), ref[i], graph_out_size(&layers[i]), "nn_graph_run %u..%u", i, i);
+    }
+
+    // A last layer past the table stops at the end
+    memcpy(nn_graph_input(&g, 0), in, 12 * 12 * 2);
+    nn_graph_run(&g, 0, GRAPH_LAYERS + 3);
+    nn_test_check(nn_graph_output(&g, GRAPH_LAYERS - 1), ref[GRAPH_LAYERS - 1], 12, "nn_graph_run past the end");
+
+    memcpy(bad, layers, sizeof(bad));
+    bad[2].ch_im_in = 12;
+    graph_expect_error(bad, GRAPH_LAYERS, GRAPH_BUF, scratch_size, NN_GRAPH_ERR_SHAPE, 2, "channel mismatch");
+    memcpy(bad, layers, sizeof(bad));
+    bad[5].dim_im_out = 4;
+    graph_expect_error(bad, GRAPH_LAYERS, GRAPH_BUF, scratch_size, NN_GRAPH_ERR_CONSTRAINT, 5, "pool output dim");
+    memcpy(bad, layers, sizeof(bad));
+    bad[1].padding = 0;
+    graph_expect_error(bad, GRAPH_LAYERS, GRAPH_BUF, scratch_size, NN_GRAPH_ERR_CONSTRAINT, 1, "valid padding");
+    graph_expect_error(layers, GRAPH_LAYERS, 12 * 12 * 12, scratch_size, NN_GRAPH_ERR_BUFFER, 0, "small buffers");
+    graph_expect_error(layers, GRAPH_LAYERS, GRAPH_BUF, scratch_size - 4, NN_GRAPH_ERR_SCRATCH, 0, "small scratch");
+    graph_expect_error(layers, 4, GRAPH_BUF, scratch_size, NN_GRAPH_OK, 0, "prefix table");
+}
@@ -0,0 +1,102 @@
+#include <string.h>
+#include "nn_test.h"
+
+/*
+ * depthwise_conv_inplace and avg_pool_q7_HWC_opt with Im_out == Im_in against
+ * the same call out of place and the references, with and without an
+ * epilogue. Out of place, depthwise_conv_inplace must also leave its input
+ * untouched.
+ */
+
+static void depthwise_inplace_case(const uint16_t dim, const uint16_t ch, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t size = dim * dim * ch;
+    ref_shape s = ref_square(dim, ch, ch, kernel, padding);
+    q7_t *in = nn_test_alloc(size);
+    q7_t *keep = nn_test_alloc(size);
+    q7_t *wt = nn_test_alloc(kernel * kernel * ch);
+    q7_t *bias = nn_test_alloc(ch);
+    uint8_t *shift = nn_test_alloc(ch);
+    q7_t *out = nn_test_alloc(size);
+    q7_t *io = nn_test_alloc(size);
+    q7_t *ref = nn_test_alloc(size);
+    q7_t *bufferA = nn_test_alloc(depthwise_conv_inplace_get_buffer_size(dim, ch, kernel, padding));
+    nn_epilogue ep = {bias, 2, shift, -20, 100};
+    uint16_t i;
+    int e;
+
+    nn_test_fill(in, size);
+    nn_test_fill(wt, kernel * kernel * ch);
+    nn_test_fill(bias, ch);
+    for (i = 0; i < ch; i++)
+    {
+        shift[i] = 5 + i % 3;
+    }
+    memcpy(keep, in, size);
+
+    for (e = 0; e < 2; e++)
+    {
+        const nn_epilogue *pe = e ? &ep : NULL;
+        ref_depthwise(&s, in, wt, NULL, 0, 7, 0, pe, ref);
+
+        memset(out, 0x55, size);
+        depthwise_conv_inplace_ep(in, dim, ch, wt, kernel, padding, 7, out, bufferA, pe);
+        nn_test_check(out, ref, size, "depthwise_conv_inplace %ux%ux%u k%u, epilogue %d, out of place", dim, dim,
+                      ch, kernel, e);
+        nn_test_check(in, keep, size, "depthwise_conv_inplace %ux%ux%u k%u, epilogue %d, input kept", dim, dim, ch,
+                      kernel, e);
+
+        memcpy(io, in, size);
+        depthwise_conv_inplace_ep(io, dim, ch, wt, kernel, padding, 7, io, bufferA, pe);
+        nn_test_check(io, out, size, "depthwise_conv_inplace %ux%ux%u k%u, epilogue %d, in place", dim, dim, ch,
+                      kernel, e);
+    }
+}
+
+static void avg_pool_inplace_case(const uint16_t dim, const uint16_t ch)
+{
+    uint32_t size = dim * dim * ch;
+    uint32_t out_size = (dim / 2) * (dim / 2) * ch;
+    q7_t *in = nn_test_alloc(size);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *io = nn_test_alloc(size);
+    q7_t *ref = nn_test_alloc(out_size);
+
+    nn_test_fill(in, size);
+    memcpy(io, in, size);
+    ref_avg_pool_2x2(in, dim, ch, ref);
+    avg_pool_q7_HWC_opt(in, dim, ch, out);
+    avg_pool_q7_HWC_opt(io, dim, ch, io);
+    nn_test_check(out, ref, out_size, "avg_pool_q7_HWC_opt %ux%ux%u, out of place", dim, dim, ch);
+    nn_test_check(io, out, out_size, "avg_pool_q7_HWC_opt %ux%ux%u, in place", dim, dim, ch);
+}
+
+void test_inplace(void)
+{
+    static const uint16_t chs[] = {1, 3, 4, 8, 12};
+    uint16_t dim, kernel, c;
+
+    for (dim = 1; dim <= 9; dim++)
+    {
+        for (kernel = 1; kernel <= 7; kernel += 2)
+        {
+            for (c = 0; c < sizeof(chs) / sizeof(chs[0]); c++)
+            {
+                depthwise_inplace_case(dim, chs[c], kernel);
+            }
+        }
+    }
+    // DS-CNN layer widths
+    depthwise_inplace_case(25, 64, 3);
+    depthwise_inplace_case(12, 172, 3);
+    depthwise_inplace_case(5, 276, 3);
+
+    for (dim = 2; dim <= 12; dim += 2)
+    {
+        avg_pool_inplace_case(dim, 4);
+        avg_pool_inplace_case(dim, 12);
+    }
+    avg_pool_inplace_case(10, 64);
+    avg_pool_inplace_case(6, 172);
+}
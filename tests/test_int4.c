@@ -0,0 +1,165 @@
+#include <string.h>
+#include "nn_test.h"
+#include "weight_packer.h"
+
+/*
+ * pointwise_conv_fast_int4 and conv_HWC_int4 against pointwise_conv_fast_ep,
+ * conv_HWC_ep and the references on the expanded q7 weights (w_int4 << shift)
+ * of the packer, with a shift per channel and per layer, no epilogue, a full
+ * one and ReLU only. The accuracy checks bound the packer's rounding error
+ * per channel and, for weights already in [-7, 7], the output against the
+ * original weights.
+ */
+
+static void int4_epilogue(nn_epilogue *ep, const uint16_t ch)
+{
+    q7_t *bias = nn_test_alloc(ch);
+    uint8_t *shift = nn_test_alloc(ch);
+    uint16_t i;
+
+    nn_test_fill(bias, ch);
+    for (i = 0; i < ch; i++)
+    {
+        shift[i] = 6 + i % 3;
+    }
+    ep->bias = bias;
+    ep->bias_shift = 3;
+    ep->out_shift = shift;
+    ep->act_min = -20;
+    ep->act_max = 100;
+}
+
+// Below shift 4 every weight fits after rounding, at shift 4 the top of [-128, 127] clamps to 7 << 4
+static void int4_check_expanded(const q7_t *wt, const q7_t *expanded, const uint8_t *shift, const uint32_t row_len,
+                                const uint16_t ch_out, const uint32_t max_err, const char *name)
+{
+    uint32_t worst = 0, bad = 0;
+    uint32_t i;
+
+    for (i = 0; i < row_len * ch_out; i++)
+    {
+        uint16_t sh = shift[i / row_len];
+        int32_t err = wt[i] - expanded[i];
+        uint32_t bound = sh < 4 ? (1u << sh) >> 1 : 15;
+        err = err < 0 ? -err : err;
+        worst = (uint32_t)err > worst ? (uint32_t)err : worst;
+        bad += sh > 4 || (uint32_t)err > bound || expanded[i] % (1 << sh) != 0;
+    }
+    nn_test_expect(bad == 0 && worst == max_err, "%s: %u weights off the int4 grid or over the rounding bound, "
+                   "largest error %u, packer reports %u", name, bad, worst, max_err);
+}
+
+static void int4_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel,
+                      const int per_channel, const int32_t max_abs)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t row_len = kernel * kernel * ch_in;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    uint32_t sizeA_int4 = kernel == 1 ? pointwise_conv_fast_int4_get_buffer_size(ch_in)
+                                      : conv_HWC_int4_get_buffer_size(dim, ch_in, kernel);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(row_len * ch_out);
+    q7_t *expanded = nn_test_alloc(row_len * ch_out);
+    uint8_t *packed = nn_test_alloc(row_len * ch_out / 2);
+    uint8_t *shift = nn_test_alloc(ch_out);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *dense = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    q15_t *bufferA_int4 = nn_test_alloc(sizeA_int4);
+    const char *name = kernel == 1 ? "pointwise_conv_fast_int4" : "conv_HWC_int4";
+    nn_int4_weights w;
+    nn_epilogue ep;
+    uint32_t max_err;
+    int mode;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, row_len * ch_out, max_abs);
+    nn_test_fill(bias, ch_out);
+    int4_epilogue(&ep, ch_out);
+
+    if (kernel == 1)
+    {
+        max_err = pack_pointwise_int4_weights(wt, ch_in, ch_out, per_channel, packed, shift, expanded);
+    }
+    else
+    {
+        max_err = pack_conv_int4_weights(wt, ch_in, ch_out, kernel, per_channel, packed, shift, expanded);
+    }
+    int4_check_expanded(wt, expanded, shift, row_len, ch_out, max_err, name);
+    w.values = (const q7_t *)packed;
+    w.shift = per_channel ? shift : NULL;
+    w.layer_shift = shift[0];
+
+    for (mode = 0; mode < 3; mode++)
+    {
+        const nn_epilogue *e = mode ? &ep : NULL;
+        if (mode == 2)
+        {
+            ep.bias = NULL;
+            ep.out_shift = NULL;
+        }
+
+        memset(out, 0x55, out_size);
+        if (kernel == 1)
+        {
+            pointwise_conv_fast_int4_ep(in, dim, ch_in, &w, ch_out, bias, 2, 7, out, bufferA_int4, e);
+            pointwise_conv_fast_ep(in, dim, ch_in, expanded, ch_out, bias, 2, 7, dense, bufferA, e);
+        }
+        else
+        {
+            conv_HWC_int4_ep(in, dim, ch_in, &w, ch_out, kernel, padding, bias, 2, 7, out, bufferA_int4, e);
+            conv_HWC_ep(in, dim, ch_in, expanded, ch_out, kernel, padding, bias, 2, 7, dense, bufferA, bufferB, e);
+        }
+        ref_conv(&s, in, expanded, bias, 2, 7, kernel == 1, e, ref);
+        nn_test_check(out, dense, out_size, "%s %ux%ux%u -> %u k%u, |w| <= %d, per channel %d, epilogue %d: "
+                      "against the dense kernel", name, dim, dim, ch_in, ch_out, kernel, max_abs, per_channel, mode);
+        nn_test_check(out, ref, out_size, "%s %ux%ux%u -> %u k%u, |w| <= %d, per channel %d, epilogue %d", name,
+                      dim, dim, ch_in, ch_out, kernel, max_abs, per_channel, mode);
+        if (max_abs <= 7)
+        {
+            // int4 weights and shift 0: no accuracy lost
+            ref_conv(&s, in, wt, bias, 2, 7, kernel == 1, e, ref);
+            nn_test_check(out, ref, out_size, "%s %ux%ux%u -> %u k%u, per channel %d, epilogue %d: against the "
+                          "q7 weights", name, dim, dim, ch_in, ch_out, kernel, per_channel, mode);
+        }
+    }
+}
+
+void test_int4(void)
+{
+    static const int32_t max_abs[] = {3, 7, 20, 64, 127};
+    uint32_t m;
+    uint16_t dim;
+    int pc;
+
+    for (m = 0; m < sizeof(max_abs) / sizeof(max_abs[0]); m++)
+    {
+        for (pc = 0; pc < 2; pc++)
+        {
+            for (dim = 1; dim <= 6; dim++)
+            {
+                int4_case(dim, 8, 6, 1, pc, max_abs[m]);
+                int4_case(dim, 16, 2, 1, pc, max_abs[m]);
+                // Rows of 4 modulo 8 weights
+                int4_case(dim, 12, 6, 1, pc, max_abs[m]);
+                if (dim >= 3)
+                {
+                    int4_case(dim, 8, 4, 3, pc, max_abs[m]);
+                    int4_case(dim, 4, 4, 3, pc, max_abs[m]);
+                    int4_case(dim, 12, 2, 3, pc, max_abs[m]);
+                }
+            }
+            int4_case(5, 64, 12, 1, pc, max_abs[m]);
+            int4_case(5, 8, 6, 5, pc, max_abs[m]);
+            int4_case(5, 172, 4, 1, pc, max_abs[m]);
+            int4_case(3, 276, 2, 1, pc, max_abs[m]);
+            int4_case(4, 20, 4, 1, pc, max_abs[m]);
+        }
+    }
+}
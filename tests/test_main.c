@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include "nn_test.h"
+
+typedef struct
+{
+    const char *name;
+    void (*run)(void);
+} nn_test_suite;
+
+static const nn_test_suite suites[] = {
+    {"conv", test_conv},
+    {"depthwise", test_depthwise},
+    {"pointwise", test_pointwise},
+    {"pool", test_pool},
+    {"depthwise_pointwise", test_depthwise_pointwise},
+    {"conv_ring", test_conv_ring},
+    {"conv_packed", test_conv_packed},
+    {"conv_tiled", test_conv_tiled},
+    {"epilogue", test_epilogue},
+    {"nonsquare", test_nonsquare},
+    {"fully_connected", test_fully_connected},
+    {"parallel", test_parallel},
+    {"planner", test_planner},
+    {"batch", test_batch},
+    {"stream", test_stream},
+    {"x86", test_x86},
+    {"sparse", test_sparse},
+    {"int4", test_int4},
+    {"inplace", test_inplace},
+    {"mult", test_mult},
+    {"graph", test_graph},
+    {"conv_q7", test_conv_q7},
+    {"profile", test_profile},
+};
+
+static int selected(const char *name, const int argc, char **argv)
+{
+    int i;
+    if (argc < 2)
+    {
+        return 1;
+    }
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Usage: nn_test [suite ...], all suites by default
+int main(int argc, char **argv)
+{
+    uint32_t i;
+    for (i = 0; i < sizeof(suites) / sizeof(suites[0]); i++)
+    {
+        uint32_t checks = nn_test_checks;
+        uint32_t failures = nn_test_failures;
+        if (!selected(suites[i].name, argc, argv))
+        {
+            continue;
+        }
+        nn_test_seed(i + 1);
+        suites[i].run();
+        nn_test_free_all();
+        printf("%-20s %5u checks %3u failures\n", suites[i].name, nn_test_checks - checks,
+               nn_test_failures - failures);
+    }
+    printf("%u checks, %u failures\n", nn_test_checks, nn_test_failures);
+    return nn_test_failures ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#include <string.h>
+#include "nn_test.h"
+
+/*
+ * depthwise_conv_mult against ref_depthwise over channel multipliers 1 to 4,
+ * dilations 1 to 3, with and without bias, with no epilogue, a clamp only and
+ * a full per-channel epilogue. Multiplier 1 with dilation 1 must also match
+ * depthwise_conv_ep with the bias in the epilogue.
+ */
+
+static void mult_case(const uint16_t dim, const uint16_t ch, const uint16_t mult, const uint16_t kernel,
+                      const uint16_t dilation, const int has_bias)
+{
+    uint16_t padding = (kernel - 1) * dilation / 2;
+    uint16_t ch_out = ch * mult;
+    uint32_t out_size = dim * dim * ch_out;
+    ref_shape s = ref_square(dim, ch, ch_out, kernel, padding);
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *wt = nn_test_alloc(kernel * kernel * ch_out);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *ep_bias = nn_test_alloc(ch_out);
+    uint8_t *shift = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q7_t *bufferA = nn_test_alloc(depthwise_conv_mult_get_buffer_size(dim, ch, kernel));
+    const q7_t *b = has_bias ? bias : NULL;
+    nn_epilogue clamp = {NULL, 0, NULL, -20, 100};
+    nn_epilogue full = {ep_bias, 1, shift, -30, 90};
+    const nn_epilogue *eps[3] = {NULL, &clamp, &full};
+    uint16_t i;
+    int e;
+
+    s.dilation = dilation;
+    s.out_x = s.out_y = dim;
+    nn_test_fill(in, dim * dim * ch);
+    nn_test_fill(wt, kernel * kernel * ch_out);
+    nn_test_fill(bias, ch_out);
+    nn_test_fill(ep_bias, ch_out);
+    for (i = 0; i < ch_out; i++)
+    {
+        shift[i] = 5 + i % 3;
+    }
+
+    for (e = 0; e < 3; e++)
+    {
+        memset(out, 0x55, out_size);
+        depthwise_conv_mult_ep(in, dim, ch, wt, mult, kernel, padding, dilation, b, 2, 7, out, bufferA, eps[e]);
+        ref_depthwise(&s, in, wt, b, 2, 7, 0, eps[e], ref);
+        nn_test_check(out, ref, out_size, "depthwise_conv_mult %ux%ux%u x%u k%u d%u, bias %d, epilogue %d", dim, dim,
+                      ch, mult, kernel, dilation, has_bias, e);
+    }
+
+    if (mult == 1 && dilation == 1)
+    {
+        q7_t *dense = nn_test_alloc(out_size);
+        q7_t *bufferB = nn_test_alloc(depthwise_conv_get_buffer_size(dim, ch, kernel));
+        depthwise_conv_ep(in, dim, ch, wt, kernel, padding, 7, dense, bufferB, &full);
+        depthwise_conv_mult_ep(in, dim, ch, wt, 1, kernel, padding, 1, NULL, 0, 7, out, bufferA, &full);
+        nn_test_check(out, dense, out_size, "depthwise_conv_mult %ux%ux%u k%u against depthwise_conv_ep", dim, dim,
+                      ch, kernel);
+    }
+}
+
+void test_mult(void)
+{
+    static const uint16_t chs[] = {1, 3, 4, 5, 8, 12};
+    uint16_t dim, c, mult, kernel, dilation;
+
+    for (dim = 1; dim <= 9; dim++)
+    {
+        for (c = 0; c < sizeof(chs) / sizeof(chs[0]); c++)
+        {
+            for (mult = 1; mult <= 4; mult++)
+            {
+                for (kernel = 1; kernel <= 5; kernel += 2)
+                {
+                    for (dilation = 1; dilation <= 3; dilation++)
+                    {
+                        mult_case(dim, chs[c], mult, kernel, dilation, (dim + mult + dilation) & 1);
+                    }
+                }
+            }
+        }
+    }
+    mult_case(2, 4, 2, 3, 1, 1);
+    mult_case(6, 8, 3, 3, 2, 0);
+    mult_case(10, 6, 5, 5, 2, 1);
+    // DS-CNN widths
+    mult_case(25, 64, 2, 3, 1, 1);
+    mult_case(13, 172, 2, 3, 2, 1);
+    mult_case(11, 64, 1, 3, 2, 0);
+}
@@ -0,0 +1,124 @@
+#include <string.h>
+#include "nn_test.h"
+
+// Bytes after every output, a strided layer must not write past its kept pixels
+#define GUARD 16
+
+static void nonsquare_case(const uint16_t dim_x, const uint16_t dim_y, const uint16_t ch_in, const uint16_t ch_out,
+                           const uint16_t kernel_x, const uint16_t kernel_y, const uint16_t pad_top,
+                           const uint16_t pad_bottom, const uint16_t pad_left, const uint16_t pad_right,
+                           const uint16_t stride_x, const uint16_t stride_y)
+{
+    ref_shape s;
+    ref_shape dw;
+    uint32_t out_size, dw_size, sizeA, sizeB;
+    q7_t *in, *wt, *dw_wt, *bias, *dw_bias, *out, *ref, *dw_out, *dw_ref, *dw_buffer, *guard;
+    q15_t *bufferA, *bufferB;
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+    nn_epilogue dw_ep;
+
+    s.dim_x = dim_x;
+    s.dim_y = dim_y;
+    s.ch_in = ch_in;
+    s.ch_out = ch_out;
+    s.kernel_x = kernel_x;
+    s.kernel_y = kernel_y;
+    s.stride_x = stride_x;
+    s.stride_y = stride_y;
+    s.pad_top = pad_top;
+    s.pad_left = pad_left;
+    s.dilation = 1;
+    s.out_x = (pad_left + dim_x + pad_right - kernel_x) / stride_x + 1;
+    s.out_y = (pad_top + dim_y + pad_bottom - kernel_y) / stride_y + 1;
+    dw = s;
+    dw.ch_out = ch_in;
+    out_size = s.out_x * s.out_y * ch_out;
+    dw_size = s.out_x * s.out_y * ch_in;
+
+    sizeA = conv_HWC_nonsquare_get_buffer_size(dim_y, ch_in, ch_out, kernel_x, kernel_y, pad_top, pad_bottom, &sizeB);
+    in = nn_test_alloc(dim_x * dim_y * ch_in);
+    wt = nn_test_alloc(ch_out * kernel_x * kernel_y * ch_in);
+    dw_wt = nn_test_alloc(kernel_x * kernel_y * ch_in);
+    bias = nn_test_alloc(ch_out);
+    dw_bias = nn_test_alloc(ch_in);
+    out = nn_test_alloc(out_size + GUARD);
+    ref = nn_test_alloc(out_size);
+    dw_out = nn_test_alloc(dw_size + GUARD);
+    dw_ref = nn_test_alloc(dw_size);
+    bufferA = nn_test_alloc(sizeA);
+    bufferB = nn_test_alloc(sizeB);
+    dw_buffer = nn_test_alloc(depthwise_conv_nonsquare_get_buffer_size(dim_y, ch_in, kernel_x, pad_top, pad_bottom));
+
+    nn_test_fill(in, dim_x * dim_y * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel_x * kernel_y * ch_in, 20);
+    nn_test_fill(dw_wt, kernel_x * kernel_y * ch_in);
+    nn_test_fill(bias, ch_out);
+    nn_test_fill(dw_bias, ch_in);
+    dw_ep = relu;
+    dw_ep.bias = dw_bias;
+    dw_ep.bias_shift = 3;
+    guard = nn_test_alloc(GUARD);
+    memset(guard, 0x5a, GUARD);
+    memset(out + out_size, 0x5a, GUARD);
+    memset(dw_out + dw_size, 0x5a, GUARD);
+
+    conv_HWC_nonsquare(in, dim_x, dim_y, ch_in, wt, ch_out, kernel_x, kernel_y, pad_top, pad_bottom, pad_left,
+                       pad_right, stride_x, stride_y, bias, 2, 7, out, bufferA, bufferB);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC_nonsquare %ux%ux%u -> %u k%ux%u s%ux%u", dim_x, dim_y, ch_in, ch_out,
+                  kernel_x, kernel_y, stride_x, stride_y);
+
+    conv_HWC_nonsquare_ep(in, dim_x, dim_y, ch_in, wt, ch_out, kernel_x, kernel_y, pad_top, pad_bottom, pad_left,
+                          pad_right, stride_x, stride_y, bias, 2, 7, out, bufferA, bufferB, &relu);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, &relu, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC_nonsquare_ep %ux%ux%u -> %u k%ux%u s%ux%u", dim_x, dim_y, ch_in,
+                  ch_out, kernel_x, kernel_y, stride_x, stride_y);
+
+    depthwise_conv_nonsquare(in, dim_x, dim_y, ch_in, dw_wt, kernel_x, kernel_y, pad_top, pad_bottom, pad_left,
+                             pad_right, stride_x, stride_y, 7, dw_out, dw_buffer);
+    ref_depthwise(&dw, in, dw_wt, NULL, 0, 7, 0, NULL, dw_ref);
+    nn_test_check(dw_out, dw_ref, dw_size, "depthwise_conv_nonsquare %ux%ux%u k%ux%u s%ux%u", dim_x, dim_y, ch_in,
+                  kernel_x, kernel_y, stride_x, stride_y);
+
+    depthwise_conv_nonsquare_ep(in, dim_x, dim_y, ch_in, dw_wt, kernel_x, kernel_y, pad_top, pad_bottom, pad_left,
+                                pad_right, stride_x, stride_y, 7, dw_out, dw_buffer, &dw_ep);
+    ref_depthwise(&dw, in, dw_wt, NULL, 0, 7, 0, &dw_ep, dw_ref);
+    nn_test_check(dw_out, dw_ref, dw_size, "depthwise_conv_nonsquare_ep %ux%ux%u k%ux%u s%ux%u", dim_x, dim_y, ch_in,
+                  kernel_x, kernel_y, stride_x, stride_y);
+
+    nn_test_check(out + out_size, guard, GUARD, "conv_HWC_nonsquare %ux%ux%u -> %u k%ux%u s%ux%u, past the output",
+                  dim_x, dim_y, ch_in, ch_out, kernel_x, kernel_y, stride_x, stride_y);
+    nn_test_check(dw_out + dw_size, guard, GUARD, "depthwise_conv_nonsquare %ux%ux%u k%ux%u s%ux%u, past the output",
+                  dim_x, dim_y, ch_in, kernel_x, kernel_y, stride_x, stride_y);
+}
+
+void test_nonsquare(void)
+{
+    uint16_t sx, sy, p;
+
+    // DS-CNN first layer, 49x10 MFCC (channel padded to 2), 10x4 kernel, stride 2
+    nonsquare_case(10, 49, 2, 8, 4, 10, 4, 5, 1, 2, 2, 2);
+    // The same without the channel padding, and an odd ch_in with an odd number of output rows
+    nonsquare_case(10, 49, 1, 8, 4, 10, 4, 5, 1, 2, 2, 2);
+    nonsquare_case(6, 13, 3, 4, 3, 3, 1, 1, 1, 1, 1, 2);
+    nonsquare_case(5, 25, 8, 6, 3, 3, 1, 1, 1, 1, 1, 1);
+    nonsquare_case(7, 9, 6, 4, 3, 3, 0, 1, 1, 0, 2, 2);
+    nonsquare_case(8, 8, 4, 2, 1, 1, 0, 0, 0, 0, 2, 2);
+    nonsquare_case(6, 5, 6, 2, 3, 3, 0, 0, 0, 0, 1, 1);
+    nonsquare_case(6, 12, 8, 4, 3, 3, 1, 1, 1, 1, 2, 2);
+    nonsquare_case(9, 7, 12, 4, 3, 3, 0, 2, 1, 1, 1, 2);
+
+    // Strides 1..3 in each direction with one-sided pads: odd output heights and widths, and strides that leave
+    // input rows or columns unread at the end
+    for (sy = 1; sy <= 3; sy++)
+    {
+        for (sx = 1; sx <= 3; sx++)
+        {
+            for (p = 0; p < 4; p++)
+            {
+                nonsquare_case(7 + p, 11 - p, 4, 6, 3, 2 + p % 2, p & 1, p >> 1, p >> 1, p & 1, sx, sy);
+            }
+            nonsquare_case(10, 49, 2, 4, 4, 10, 4, 5, 1, 2, sx, sy);
+        }
+    }
+}
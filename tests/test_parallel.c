@@ -0,0 +1,82 @@
+#include <string.h>
+#include "nn_parallel.h"
+#include "nn_test.h"
+
+// nn_parallel_run against nn_graph_run on the same table, 1..8 threads. make test-tsan runs this suite under
+// ThreadSanitizer.
+
+#define PARALLEL_MAX_THREADS 8
+
+static void parallel_case(const char *name, const nn_layer *layers, const uint16_t num_layers,
+                          const uint32_t in_size, const uint32_t out_size)
+{
+    uint32_t buf_size = 0, scratch_size = 4;
+    q7_t *buf[2], *ref, *in, *scratch;
+    nn_graph g;
+    uint16_t i, threads;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        uint32_t s = nn_graph_scratch_size(&layers[i]);
+        scratch_size = s > scratch_size ? s : scratch_size;
+    }
+    scratch_size = (scratch_size + 3) & ~3u;
+    buf_size = 32 * 32 * 64;
+    buf[0] = nn_test_alloc(buf_size);
+    buf[1] = nn_test_alloc(buf_size);
+    ref = nn_test_alloc(out_size);
+    in = nn_test_alloc(in_size);
+    scratch = nn_test_alloc(scratch_size * PARALLEL_MAX_THREADS);
+    nn_test_fill(in, in_size);
+
+    if (nn_test_expect(nn_graph_init(&g, layers, num_layers, buf[0], buf[1], buf_size, scratch, scratch_size) ==
+                           NN_GRAPH_OK, "%s: nn_graph_init", name))
+    {
+        return;
+    }
+    memcpy(nn_graph_input(&g, 0), in, in_size);
+    nn_graph_run(&g, 0, num_layers - 1);
+    memcpy(ref, nn_graph_output(&g, num_layers - 1), out_size);
+
+    for (threads = 1; threads <= PARALLEL_MAX_THREADS; threads++)
+    {
+        memcpy(nn_graph_input(&g, 0), in, in_size);
+        nn_test_expect(nn_parallel_run(&g, 0, num_layers - 1, threads, scratch + scratch_size, scratch_size) ==
+                           NN_PARALLEL_OK, "%s: nn_parallel_run %u threads", name, threads);
+        nn_test_check(nn_graph_output(&g, num_layers - 1), ref, out_size, "%s, %u threads", name, threads);
+    }
+}
+
+void test_parallel(void)
+{
+    q7_t *conv_wt = nn_test_alloc(9 * 8 * 16);
+    q7_t *dw_wt = nn_test_alloc(9 * 16);
+    q7_t *pw_wt = nn_test_alloc(16 * 32);
+    q7_t *bias = nn_test_alloc(32);
+
+    // Two max pools back to back, the graph the GE race showed up on
+    const nn_layer max_pools[] = {
+        {NN_OP_MAX_POOL, 32, 16, 16, 3, 1, 1, 32, NULL, NULL, 0, 0, NULL},
+        {NN_OP_MAX_POOL, 32, 16, 16, 2, 0, 2, 16, NULL, NULL, 0, 0, NULL},
+    };
+    const nn_layer pools[] = {
+        {NN_OP_AVG_POOL, 16, 12, 12, 3, 1, 1, 16, NULL, NULL, 0, 0, NULL},
+        {NN_OP_MAX_POOL, 16, 12, 12, 3, 0, 2, 7, NULL, NULL, 0, 0, NULL},
+        {NN_OP_GLOBAL_AVG_POOL, 7, 12, 12, 7, 0, 1, 1, NULL, NULL, 0, 0, NULL},
+    };
+    const nn_layer block[] = {
+        {NN_OP_CONV, 12, 8, 16, 3, 1, 1, 12, conv_wt, bias, 2, 7, NULL},
+        {NN_OP_DEPTHWISE, 12, 16, 16, 3, 1, 1, 12, dw_wt, NULL, 0, 7, NULL},
+        {NN_OP_POINTWISE, 12, 16, 32, 1, 0, 1, 12, pw_wt, bias, 2, 7, NULL},
+        {NN_OP_MAX_POOL, 12, 32, 32, 2, 0, 2, 6, NULL, NULL, 0, 0, NULL},
+    };
+
+    nn_test_fill_range(conv_wt, 9 * 8 * 16, 20);
+    nn_test_fill(dw_wt, 9 * 16);
+    nn_test_fill(pw_wt, 16 * 32);
+    nn_test_fill(bias, 32);
+
+    parallel_case("max pool x2", max_pools, 2, 32 * 32 * 16, 16 * 16 * 16);
+    parallel_case("avg/max/global pools", pools, 3, 16 * 16 * 12, 12);
+    parallel_case("conv/dw/pw/max pool", block, 4, 12 * 12 * 8, 6 * 6 * 32);
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include "nn_planner.h"
+#include "nn_test.h"
+
+#define PLAN_MAX_LAYERS 8
+
+typedef struct
+{
+    uint16_t num_layers;
+    uint32_t size[2 * PLAN_MAX_LAYERS + 1];     // tensors 0..num_layers, then the scratch of each layer
+    uint32_t offset[2 * PLAN_MAX_LAYERS + 1];
+} plan_chain;
+
+// Chain: layer i reads tensor i and writes tensor i + 1
+static void chain_lifetime(const plan_chain *p, const uint32_t b, int32_t *first, int32_t *last)
+{
+    if (b <= p->num_layers)
+    {
+        *first = b ? (int32_t)b - 1 : 0;
+        *last = b < p->num_layers ? (int32_t)b : p->num_layers - 1;
+    }
+    else
+    {
+        *first = *last = b - p->num_layers - 1;
+    }
+}
+
+static int chain_overlap(const plan_chain *p, const uint32_t a, const uint32_t b)
+{
+    int32_t first_a, last_a, first_b, last_b;
+    chain_lifetime(p, a, &first_a, &last_a);
+    chain_lifetime(p, b, &first_b, &last_b);
+    return p->size[a] && p->size[b] && first_a <= last_b && first_b <= last_a &&
+           p->offset[a] < p->offset[b] + p->size[b] && p->offset[b] < p->offset[a] + p->size[a];
+}
+
+// Smallest arena over every placement order, each buffer at its lowest free offset, without pruning
+static uint32_t chain_brute_force(plan_chain *p, uint32_t *placed, const uint32_t count, const uint32_t arena)
+{
+    uint32_t num_buffers = 2 * p->num_layers + 1;
+    uint32_t best = 0xFFFFFFFFu;
+    uint32_t b, b2;
+
+    if (count == num_buffers)
+    {
+        return arena;
+    }
+    for (b = 0; b < num_buffers; b++)
+    {
+        int moved = 1;
+        uint32_t result;
+        if (placed[b])
+        {
+            continue;
+        }
+        p->offset[b] = 0;
+        while (moved)
+        {
+            moved = 0;
+            for (b2 = 0; b2 < num_buffers; b2++)
+            {
+                if (placed[b2] && chain_overlap(p, b, b2))
+                {
+                    p->offset[b] = (p->offset[b2] + p->size[b2] + 3) & ~3u;
+                    moved = 1;
+                }
+            }
+        }
+        placed[b] = 1;
+        result = chain_brute_force(p, placed, count + 1,
+                                   p->offset[b] + p->size[b] > arena ? p->offset[b] + p->size[b] : arena);
+        placed[b] = 0;
+        best = result < best ? result : best;
+    }
+    return best;
+}
+
+// Plans the chain with nn_plan and checks it; returns the arena
+static uint32_t plan_case(plan_chain *p, const char *name)
+{
+    nn_plan_tensor tensors[PLAN_MAX_LAYERS + 1];
+    nn_plan_layer layers[PLAN_MAX_LAYERS];
+    uint32_t num_buffers = 2 * p->num_layers + 1;
+    uint32_t arena, a, b;
+    int ok = 1;
+
+    for (b = 0; b <= p->num_layers; b++)
+    {
+        tensors[b].size = p->size[b];
+    }
+    for (b = 0; b < p->num_layers; b++)
+    {
+        layers[b].input = (int16_t)b;
+        layers[b].input2 = NN_PLAN_NONE;
+        layers[b].output = (int16_t)(b + 1);
+        layers[b].scratch = p->size[p->num_layers + 1 + b];
+    }
+    arena = nn_plan(tensors, p->num_layers + 1, layers, p->num_layers, 4);
+    for (b = 0; b <= p->num_layers; b++)
+    {
+        p->offset[b] = tensors[b].offset;
+    }
+    for (b = 0; b < p->num_layers; b++)
+    {
+        p->offset[p->num_layers + 1 + b] = layers[b].scratch_offset;
+    }
+
+    for (a = 0; a < num_buffers; a++)
+    {
+        ok &= (p->offset[a] & 3) == 0 && p->offset[a] + p->size[a] <= arena;
+        for (b = a + 1; b < num_buffers; b++)
+        {
+            ok &= !chain_overlap(p, a, b);
+        }
+    }
+    nn_test_expect(ok, "nn_plan %s: overlapping, misaligned or outside the arena", name);
+    nn_test_expect(arena >= nn_plan_lower_bound(layers, p->num_layers), "nn_plan %s: arena %u below the peak",
+                   name, arena);
+    return arena;
+}
+
+void test_planner(void)
+{
+    // T0 28, T1 16, T2 16, scratch 4 and 20: greedy by size gives 60, the peak live bytes are 52
+    plan_chain p = {2, {28, 16, 16, 4, 20}, {0}};
+    uint32_t placed[2 * PLAN_MAX_LAYERS + 1];
+    uint32_t i, b, arena;
+
+    arena = plan_case(&p, "28/16/16 + 4/20");
+    nn_test_expect(arena == 52, "nn_plan 28/16/16 + 4/20: arena %u, expected 52", arena);
+
+    // Random chains against the brute force, small enough for the exact search
+    for (i = 0; i < 40; i++)
+    {
+        char name[32];
+        memset(&p, 0, sizeof(p));
+        p.num_layers = 2 + nn_test_rand() % 2;
+        for (b = 0; b < 2 * p.num_layers + 1; b++)
+        {
+            // A third of the scratch areas empty
+            p.size[b] = (b > p.num_layers && nn_test_rand() % 3 == 0) ? 0 : 4 + nn_test_rand() % 60;
+        }
+        snprintf(name, sizeof(name), "random chain %u", i);
+        arena = plan_case(&p, name);
+        memset(placed, 0, sizeof(placed));
+        b = chain_brute_force(&p, placed, 0, 0);
+        nn_test_expect(arena == b, "nn_plan %s: arena %u, smallest %u", name, arena, b);
+    }
+
+    // Longer chains, heuristics only: valid plans within the lower bound
+    for (i = 0; i < 20; i++)
+    {
+        char name[32];
+        memset(&p, 0, sizeof(p));
+        p.num_layers = PLAN_MAX_LAYERS;
+        for (b = 0; b < 2 * p.num_layers + 1; b++)
+        {
+            p.size[b] = (b > p.num_layers && nn_test_rand() % 2) ? 0 : 1 + nn_test_rand() % 4000;
+        }
+        snprintf(name, sizeof(name), "long chain %u", i);
+        plan_case(&p, name);
+    }
+}
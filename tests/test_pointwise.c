@@ -0,0 +1,95 @@
+#include <string.h>
+#include "nn_test.h"
+
+static void pointwise_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const int fast)
+{
+    ref_shape s = ref_square(dim, ch_in, ch_out, 1, 0);
+    uint32_t out_size = dim * dim * ch_out;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(fast ? pointwise_conv_fast_get_buffer_size(ch_in)
+                                        : pointwise_conv_basic_get_buffer_size(ch_in));
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+
+    if (fast)
+    {
+        pointwise_conv_fast(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA);
+    }
+    else
+    {
+        pointwise_conv_basic(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA);
+    }
+    ref_conv(&s, in, wt, bias, 2, 7, 1, NULL, ref);
+    nn_test_check(out, ref, out_size, "pointwise_conv_%s %ux%ux%u -> %u", fast ? "fast" : "basic",
+                  dim, dim, ch_in, ch_out);
+}
+
+// pointwise_conv_4x2 with no epilogue (mode 0), a full one (1) and ReLU only (2). The output is prefilled so a
+// pixel the tails miss shows up.
+static void pointwise_4x2_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const int mode)
+{
+    ref_shape s = ref_square(dim, ch_in, ch_out, 1, 0);
+    uint32_t out_size = dim * dim * ch_out;
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *ep_bias = nn_test_alloc(ch_out);
+    uint8_t *shift = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(pointwise_conv_4x2_get_buffer_size(ch_in));
+    nn_epilogue full = {ep_bias, 3, shift, -20, 100};
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+    const nn_epilogue *ep = mode == 1 ? &full : mode == 2 ? &relu : NULL;
+    uint16_t i;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+    nn_test_fill(ep_bias, ch_out);
+    for (i = 0; i < ch_out; i++)
+    {
+        shift[i] = 6 + i % 3;
+    }
+    memset(out, 0x55, out_size);
+
+    pointwise_conv_4x2_ep(in, dim, ch_in, wt, ch_out, bias, 2, 7, out, bufferA, ep);
+    ref_conv(&s, in, wt, bias, 2, 7, 1, ep, ref);
+    nn_test_check(out, ref, out_size, "pointwise_conv_4x2 %ux%ux%u -> %u epilogue %d", dim, dim, ch_in, ch_out,
+                  mode);
+}
+
+void test_pointwise(void)
+{
+    uint16_t i;
+
+    pointwise_case(5, 8, 6, 1);
+    pointwise_case(6, 4, 8, 1);
+    pointwise_case(6, 16, 4, 1);
+    pointwise_case(5, 7, 6, 0);
+    pointwise_case(4, 8, 5, 0);
+    pointwise_case(3, 3, 2, 0);
+    // DS-CNN layer widths
+    pointwise_case(3, 64, 8, 1);
+    pointwise_case(3, 128, 10, 1);
+    pointwise_case(3, 172, 6, 1);
+    pointwise_case(2, 276, 4, 1);
+    // 1 to 36 pixels: every 4-pixel block count with each of the 0 to 3 pixel tails
+    for (i = 1; i <= 6; i++)
+    {
+        pointwise_4x2_case(i, 8, 6, i % 3);
+        pointwise_4x2_case(i, 4, 2, 0);
+    }
+    // The 2-pixel tail on the unrolled kernels
+    pointwise_4x2_case(5, 64, 12, 1);
+    pointwise_4x2_case(7, 128, 8, 2);
+    pointwise_4x2_case(5, 172, 10, 0);
+    pointwise_4x2_case(3, 276, 4, 1);
+    pointwise_4x2_case(5, 12, 64, 2);
+}
@@ -0,0 +1,60 @@
+#include "nn_test.h"
+
+static void avg_pool_2x2_case(const uint16_t dim, const uint16_t ch)
+{
+    uint32_t out_size = (dim / 2) * (dim / 2) * ch;
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+
+    nn_test_fill(in, dim * dim * ch);
+    ref_avg_pool_2x2(in, dim, ch, ref);
+    avg_pool_q7_HWC_opt(in, dim, ch, out);
+    nn_test_check(out, ref, out_size, "avg_pool_q7_HWC_opt %ux%ux%u", dim, dim, ch);
+}
+
+static void pool_case(const uint16_t dim, const uint16_t ch, const uint16_t kernel, const uint16_t padding,
+                      const uint16_t stride)
+{
+    uint16_t dim_out = (dim + 2 * padding - kernel) / stride + 1;
+    uint32_t out_size = dim_out * dim_out * ch;
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+
+    nn_test_fill(in, dim * dim * ch);
+    avg_pool_q7_HWC(in, dim, ch, kernel, padding, stride, dim_out, out);
+    ref_avg_pool(in, dim, ch, kernel, padding, stride, dim_out, ref);
+    nn_test_check(out, ref, out_size, "avg_pool_q7_HWC %ux%ux%u k%u p%u s%u", dim, dim, ch, kernel, padding, stride);
+
+    max_pool_q7_HWC(in, dim, ch, kernel, padding, stride, dim_out, out);
+    ref_max_pool(in, dim, ch, kernel, padding, stride, dim_out, ref);
+    nn_test_check(out, ref, out_size, "max_pool_q7_HWC %ux%ux%u k%u p%u s%u", dim, dim, ch, kernel, padding, stride);
+}
+
+static void global_pool_case(const uint16_t dim, const uint16_t ch)
+{
+    q7_t *in = nn_test_alloc(dim * dim * ch);
+    q7_t *out = nn_test_alloc(ch);
+    q7_t *ref = nn_test_alloc(ch);
+
+    nn_test_fill(in, dim * dim * ch);
+    global_avg_pool_q7_HWC(in, dim, dim, ch, out);
+    ref_avg_pool(in, dim, ch, dim, 0, 1, 1, ref);
+    nn_test_check(out, ref, ch, "global_avg_pool_q7_HWC %ux%ux%u", dim, dim, ch);
+}
+
+void test_pool(void)
+{
+    avg_pool_2x2_case(8, 8);
+    avg_pool_2x2_case(6, 12);
+    avg_pool_2x2_case(10, 64);
+    avg_pool_2x2_case(2, 4);
+    pool_case(8, 8, 2, 0, 2);
+    pool_case(11, 12, 3, 1, 1);
+    pool_case(15, 7, 3, 0, 2);
+    pool_case(9, 5, 5, 2, 2);
+    pool_case(6, 64, 3, 1, 2);
+    global_pool_case(5, 64);
+    global_pool_case(17, 6);
+}
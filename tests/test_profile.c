@@ -0,0 +1,112 @@
+#include <string.h>
+#include "nn_graph.h"
+#include "nn_test.h"
+
+/*
+ * The nn_profile table, in the build with -DNN_PROFILE (make test-profile):
+ * one row per outermost kernel call with its MACs and output bytes, rows
+ * reused after nn_profile_rewind, one row per layer under nn_graph_run, and a
+ * full table that drops rows instead of writing past its end. Profiling must
+ * not change any output. Without NN_PROFILE the suite is empty.
+ */
+
+#ifdef NN_PROFILE
+
+static int profile_row_is(const nn_profile_layer *r, const char *name, const uint32_t calls, const uint64_t macs,
+                          const uint64_t bytes_written)
+{
+    return strcmp(r->name, name) == 0 && r->calls == calls && r->macs == macs && r->bytes_written == bytes_written;
+}
+
+void test_profile(void)
+{
+    q7_t *in = nn_test_alloc(6 * 6 * 4);
+    q7_t *conv_wt = nn_test_alloc(8 * 9 * 4);
+    q7_t *dw_wt = nn_test_alloc(9 * 8);
+    q7_t *pw_wt = nn_test_alloc(8 * 4);
+    q7_t *bias = nn_test_alloc(8);
+    q7_t *out = nn_test_alloc(6 * 6 * 8);
+    q7_t *ref = nn_test_alloc(6 * 6 * 8);
+    const nn_layer layers[] = {
+        {NN_OP_CONV, 6, 4, 8, 3, 1, 1, 6, conv_wt, bias, 2, 7, NULL},
+        {NN_OP_DEPTHWISE, 6, 8, 8, 3, 1, 1, 6, dw_wt, NULL, 0, 7, NULL},
+        {NN_OP_POINTWISE, 6, 8, 4, 1, 0, 1, 6, pw_wt, bias, 2, 7, NULL},
+    };
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(6, 4, 8, 3, &sizeB);
+    uint32_t scratch_size = nn_graph_scratch_size(&layers[0]);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    q7_t *buf0 = nn_test_alloc(6 * 6 * 8);
+    q7_t *buf1 = nn_test_alloc(6 * 6 * 8);
+    void *scratch = nn_test_alloc(scratch_size);
+    const nn_profile_layer *t;
+    ref_shape s = ref_square(6, 4, 8, 3, 1);
+    uint64_t conv_macs = 6 * 6 * 8 * 9 * 4;
+    uint16_t n, i;
+    nn_graph g;
+
+    nn_test_fill(in, 6 * 6 * 4);
+    nn_test_fill_range(conv_wt, 8 * 9 * 4, 20);
+    nn_test_fill(dw_wt, 9 * 8);
+    nn_test_fill(pw_wt, 8 * 4);
+    nn_test_fill(bias, 8);
+
+    // conv_HWC runs conv_HWC_ep inside: one row, counted once
+    nn_profile_reset();
+    conv_HWC(in, 6, 4, conv_wt, 8, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    ref_conv(&s, in, conv_wt, bias, 2, 7, 0, NULL, ref);
+    nn_test_check(out, ref, 6 * 6 * 8, "conv_HWC profiled");
+    t = nn_profile_table(&n);
+    nn_test_expect(n == 1 && profile_row_is(&t[0], "conv_HWC", 1, conv_macs, 6 * 6 * 8) && t[0].bytes_copied > 0,
+                   "profile: one conv_HWC row, %u rows, %s %u calls %lu MACs %lu written", n, t[0].name, t[0].calls,
+                   (unsigned long)t[0].macs, (unsigned long)t[0].bytes_written);
+
+    // A second call opens the next row, after a rewind it adds to the first
+    conv_HWC(in, 6, 4, conv_wt, 8, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    t = nn_profile_table(&n);
+    nn_test_expect(n == 2 && profile_row_is(&t[1], "conv_HWC", 1, conv_macs, 6 * 6 * 8),
+                   "profile: second call in row 1, %u rows", n);
+    nn_profile_rewind();
+    conv_HWC(in, 6, 4, conv_wt, 8, 3, 1, bias, 2, 7, out, bufferA, bufferB);
+    t = nn_profile_table(&n);
+    nn_test_expect(n == 2 && profile_row_is(&t[0], "conv_HWC", 2, 2 * conv_macs, 2 * 6 * 6 * 8),
+                   "profile: rewind adds to row 0, %u calls %lu MACs", t[0].calls, (unsigned long)t[0].macs);
+
+    // nn_graph_run: one row per layer named after its op, over two inferences
+    if (nn_test_expect(nn_graph_init(&g, layers, 3, buf0, buf1, 6 * 6 * 8, scratch, scratch_size) == NN_GRAPH_OK,
+                       "profile: nn_graph_init"))
+    {
+        return;
+    }
+    nn_profile_reset();
+    for (i = 0; i < 2; i++)
+    {
+        nn_profile_rewind();
+        memcpy(nn_graph_input(&g, 0), in, 6 * 6 * 4);
+        nn_graph_run(&g, 0, 2);
+    }
+    t = nn_profile_table(&n);
+    nn_test_expect(n == 3 && profile_row_is(&t[0], "conv", 2, 2 * conv_macs, 2 * 6 * 6 * 8) &&
+                       profile_row_is(&t[1], "depthwise", 2, 2 * 6 * 6 * 8 * 9, 2 * 6 * 6 * 8) &&
+                       profile_row_is(&t[2], "pointwise", 2, 2 * 6 * 6 * 8 * 4, 2 * 6 * 6 * 4),
+                   "profile: graph rows, %u rows, %s %s %s", n, t[0].name, n > 1 ? t[1].name : "",
+                   n > 2 ? t[2].name : "");
+
+    // Past NN_PROFILE_MAX_LAYERS calls the table stays full
+    nn_profile_reset();
+    for (i = 0; i < NN_PROFILE_MAX_LAYERS + 4; i++)
+    {
+        depthwise_conv(in, 6, 4, dw_wt, 3, 1, 7, out, (q7_t *)bufferA);
+    }
+    t = nn_profile_table(&n);
+    nn_test_expect(n == NN_PROFILE_MAX_LAYERS && t[n - 1].calls == 1, "profile: full table, %u rows", n);
+}
+
+#else
+
+void test_profile(void)
+{
+}
+
+#endif
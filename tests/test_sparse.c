@@ -0,0 +1,140 @@
+#include <string.h>
+#include "nn_test.h"
+#include "weight_packer.h"
+
+/*
+ * pointwise_conv_sparse and conv_HWC_sparse against the references on the
+ * dense weights, at 0 to 100% zero blocks, with no epilogue, a full one and
+ * ReLU only, and the block count of the packer.
+ */
+
+typedef struct
+{
+    nn_sparse_weights w;
+    uint32_t blocks;
+} sparse_pack;
+
+// Block-pruned weights: each block of 4 is zero with probability zero_pct %, the others keep scattered zeros
+static void sparse_fill(q7_t *wt, const uint32_t n, const uint32_t zero_pct)
+{
+    uint32_t i, k;
+    for (i = 0; i < n; i += 4)
+    {
+        int zero = nn_test_rand() % 100 < zero_pct;
+        for (k = 0; k < 4; k++)
+        {
+            wt[i + k] = zero || nn_test_rand() % 5 == 0 ? 0 : (q7_t)(nn_test_rand() % 64) - 32;
+        }
+    }
+}
+
+static void sparse_pack_weights(sparse_pack *p, const q7_t *wt, const uint32_t row_len, const uint16_t ch_out)
+{
+    uint32_t *row_ptr = nn_test_alloc(4 * (ch_out + 1));
+    uint16_t *col_idx;
+    q7_t *values;
+    uint32_t stored, i, nonzero = 0;
+
+    p->blocks = pack_sparse_weights_blocks(wt, row_len, ch_out);
+    col_idx = nn_test_alloc(2 * p->blocks + 2);
+    values = nn_test_alloc(4 * p->blocks + 4);
+    stored = pack_sparse_weights(wt, row_len, ch_out, row_ptr, col_idx, (int8_t *)values);
+    for (i = 0; i < row_len * ch_out; i += 4)
+    {
+        nonzero += wt[i] || wt[i + 1] || wt[i + 2] || wt[i + 3];
+    }
+    nn_test_expect(stored == p->blocks && stored == nonzero, "pack_sparse_weights: %u blocks stored, %u counted, "
+                   "%u non-zero", stored, p->blocks, nonzero);
+    p->w.row_ptr = row_ptr;
+    p->w.col_idx = col_idx;
+    p->w.values = values;
+}
+
+static const nn_epilogue *sparse_epilogue(nn_epilogue *ep, const int mode, const uint16_t ch)
+{
+    q7_t *bias = nn_test_alloc(ch);
+    uint8_t *shift = nn_test_alloc(ch);
+    uint16_t i;
+
+    nn_test_fill(bias, ch);
+    for (i = 0; i < ch; i++)
+    {
+        shift[i] = 6 + i % 3;
+    }
+    ep->bias = mode == 1 ? bias : NULL;
+    ep->bias_shift = 3;
+    ep->out_shift = mode == 1 ? shift : NULL;
+    ep->act_min = mode == 1 ? -20 : 0;
+    ep->act_max = mode == 1 ? 100 : 127;
+    return mode ? ep : NULL;
+}
+
+static void sparse_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel,
+                        const uint32_t zero_pct)
+{
+    uint16_t padding = kernel / 2;
+    uint32_t row_len = kernel * kernel * ch_in;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t sizeA = kernel == 1 ? pointwise_conv_sparse_get_buffer_size(ch_in)
+                                 : conv_HWC_sparse_get_buffer_size(dim, ch_in, kernel);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(row_len * ch_out);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(sizeA);
+    sparse_pack p;
+    int mode;
+
+    nn_test_fill(in, dim * dim * ch_in);
+    sparse_fill(wt, row_len * ch_out, zero_pct);
+    nn_test_fill(bias, ch_out);
+    sparse_pack_weights(&p, wt, row_len, ch_out);
+
+    for (mode = 0; mode < 3; mode++)
+    {
+        nn_epilogue ep;
+        const nn_epilogue *e = sparse_epilogue(&ep, mode, ch_out);
+
+        memset(out, 0x55, out_size);
+        if (kernel == 1)
+        {
+            pointwise_conv_sparse_ep(in, dim, ch_in, &p.w, ch_out, bias, 2, 7, out, bufferA, e);
+        }
+        else
+        {
+            conv_HWC_sparse_ep(in, dim, ch_in, &p.w, ch_out, kernel, padding, bias, 2, 7, out, bufferA, e);
+        }
+        ref_conv(&s, in, wt, bias, 2, 7, kernel == 1, e, ref);
+        nn_test_check(out, ref, out_size, "%s %ux%ux%u -> %u k%u, %u%% zero blocks, epilogue %d",
+                      kernel == 1 ? "pointwise_conv_sparse" : "conv_HWC_sparse", dim, dim, ch_in, ch_out, kernel,
+                      zero_pct, mode);
+    }
+}
+
+void test_sparse(void)
+{
+    static const uint32_t zero_pct[] = {0, 30, 60, 90, 100};
+    uint32_t z;
+    uint16_t dim;
+
+    for (z = 0; z < sizeof(zero_pct) / sizeof(zero_pct[0]); z++)
+    {
+        for (dim = 1; dim <= 6; dim++)
+        {
+            sparse_case(dim, 8, 6, 1, zero_pct[z]);
+            sparse_case(dim, 4, 3, 1, zero_pct[z]);
+            // The column copy of conv_HWC reads whole kernel windows of the input row, so dim >= kernel
+            if (dim >= 3)
+            {
+                sparse_case(dim, 4, 6, 3, zero_pct[z]);
+                sparse_case(dim, 8, 2, 3, zero_pct[z]);
+            }
+        }
+        sparse_case(5, 64, 12, 1, zero_pct[z]);
+        sparse_case(7, 12, 8, 5, zero_pct[z]);
+        sparse_case(6, 4, 5, 3, zero_pct[z]);
+        sparse_case(5, 20, 6, 3, zero_pct[z]);
+    }
+}
@@ -0,0 +1,176 @@
+#include <string.h>
+#include "nn_stream.h"
+#include "nn_test.h"
+
+/*
+ * nn_stream_run_full and nn_stream_push against the references recomputed on
+ * the whole window: every tensor of the chain after the first window and
+ * after each pushed frame, plus the row count of the push.
+ */
+
+#define STREAM_MAX_LAYERS 6
+#define STREAM_PUSHES 20
+
+// Reference of layer l on a dim_y x dim_x window, plain HWC
+static void ref_layer(const nn_stream_layer *l, const uint16_t dim_x, const uint16_t dim_y, const q7_t *in,
+                      q7_t *out)
+{
+    ref_shape s;
+    uint16_t padding = l->op == NN_STREAM_POINTWISE ? 0 : (l->dim_kernel - 1) / 2;
+
+    s.dim_x = s.out_x = dim_x;
+    s.dim_y = s.out_y = dim_y;
+    s.ch_in = l->ch_im_in;
+    s.ch_out = l->op == NN_STREAM_DEPTHWISE ? l->ch_im_in : l->ch_im_out;
+    s.kernel_x = s.kernel_y = l->op == NN_STREAM_POINTWISE ? 1 : l->dim_kernel;
+    s.stride_x = s.stride_y = 1;
+    s.pad_top = s.pad_left = padding;
+    s.dilation = 1;
+    if (l->op == NN_STREAM_DEPTHWISE)
+    {
+        ref_depthwise(&s, in, l->wt, NULL, 0, l->out_shift, 0, l->epilogue, out);
+    }
+    else
+    {
+        ref_conv(&s, in, l->wt, l->bias, l->bias_shift, l->out_shift, l->op == NN_STREAM_POINTWISE, l->epilogue,
+                 out);
+    }
+}
+
+static uint16_t out_ch(const nn_stream_layer *l)
+{
+    return l->op == NN_STREAM_DEPTHWISE ? l->ch_im_in : l->ch_im_out;
+}
+
+// Every row of every tensor of the stream against the reference chain on window
+static int stream_check(const nn_stream *s, const q7_t *window, const char *name, const uint32_t frame)
+{
+    q7_t *ref[2], *got;
+    const q7_t *in = window;
+    uint32_t size = 0;
+    uint16_t i, r;
+
+    for (i = 0; i < s->num_layers; i++)
+    {
+        uint32_t t = s->dim_x * s->dim_y * out_ch(&s->layers[i]);
+        size = t > size ? t : size;
+    }
+    ref[0] = nn_test_alloc(size);
+    ref[1] = nn_test_alloc(size);
+    got = nn_test_alloc(size);
+
+    for (i = 0; i < s->num_layers; i++)
+    {
+        uint32_t row = s->dim_x * out_ch(&s->layers[i]);
+        q7_t *out = ref[i & 1];
+
+        ref_layer(&s->layers[i], s->dim_x, s->dim_y, in, out);
+        //The ring in window order
+        for (r = 0; r < s->dim_y; r++)
+        {
+            memcpy(got + r * row, nn_stream_row(s, i + 1, r), row);
+        }
+        if (nn_test_check(got, out, s->dim_y * row, "%s frame %u, layer %u", name, frame, i))
+        {
+            return 1;
+        }
+        in = out;
+    }
+    return 0;
+}
+
+static void stream_case(const char *name, const nn_stream_layer *layers, const uint16_t num_layers,
+                        const uint16_t dim_x, const uint16_t dim_y)
+{
+    nn_stream_tensor tensors[STREAM_MAX_LAYERS + 1];
+    uint32_t in_row = dim_x * layers[0].ch_im_in;
+    uint32_t scratch_size = 4;
+    q7_t *window = nn_test_alloc((dim_y + STREAM_PUSHES) * in_row);
+    q7_t *scratch;
+    uint32_t rows_full;
+    nn_stream s;
+    uint16_t i, f;
+
+    for (i = 0; i < num_layers; i++)
+    {
+        uint32_t t = nn_stream_scratch_size(&layers[i]);
+        scratch_size = t > scratch_size ? t : scratch_size;
+        tensors[i + 1].data = nn_test_alloc(dim_x * dim_y * out_ch(&layers[i]));
+    }
+    tensors[0].data = nn_test_alloc(dim_y * in_row);
+    scratch = nn_test_alloc(scratch_size);
+    // The frames of the whole run, window f is rows f .. f + dim_y - 1
+    nn_test_fill(window, (dim_y + STREAM_PUSHES) * in_row);
+
+    nn_stream_init(&s, layers, num_layers, dim_x, dim_y, tensors, scratch);
+    memcpy(tensors[0].data, window, dim_y * in_row);
+    nn_stream_run_full(&s);
+    rows_full = s.rows_computed;
+    if (stream_check(&s, window, name, 0))
+    {
+        return;
+    }
+
+    for (f = 1; f <= STREAM_PUSHES; f++)
+    {
+        nn_stream_push(&s, window + (dim_y - 1 + f) * in_row);
+        if (stream_check(&s, window + f * in_row, name, f))
+        {
+            return;
+        }
+    }
+    nn_test_expect(s.rows_computed < rows_full, "%s: push computed %u rows, full %u", name, s.rows_computed,
+                   rows_full);
+}
+
+void test_stream(void)
+{
+    q7_t *conv_wt = nn_test_alloc(9 * 2 * 8);
+    q7_t *conv5_wt = nn_test_alloc(25 * 8 * 6);
+    q7_t *dw_wt = nn_test_alloc(9 * 8);
+    q7_t *dw5_wt = nn_test_alloc(25 * 6);
+    q7_t *pw_wt = nn_test_alloc(8 * 8);
+    q7_t *pw2_wt = nn_test_alloc(6 * 4);
+    q7_t *bias = nn_test_alloc(8);
+    nn_epilogue relu = {NULL, 0, NULL, 0, 127};
+
+    nn_test_fill_range(conv_wt, 9 * 2 * 8, 32);
+    nn_test_fill_range(conv5_wt, 25 * 8 * 6, 16);
+    nn_test_fill(dw_wt, 9 * 8);
+    nn_test_fill(dw5_wt, 25 * 6);
+    nn_test_fill(pw_wt, 8 * 8);
+    nn_test_fill(pw2_wt, 6 * 4);
+    nn_test_fill(bias, 8);
+
+    {
+        // DS-CNN shaped: conv, then depthwise + pointwise blocks
+        const nn_stream_layer dscnn[] = {
+            {NN_STREAM_CONV, 2, 8, 3, conv_wt, bias, 2, 7, &relu},
+            {NN_STREAM_DEPTHWISE, 8, 0, 3, dw_wt, NULL, 0, 7, NULL},
+            {NN_STREAM_POINTWISE, 8, 8, 1, pw_wt, bias, 2, 7, &relu},
+            {NN_STREAM_DEPTHWISE, 8, 0, 3, dw_wt, NULL, 0, 7, &relu},
+            {NN_STREAM_POINTWISE, 8, 8, 1, pw_wt, bias, 1, 7, NULL},
+        };
+        stream_case("dscnn 5x12", dscnn, 5, 5, 12);
+        stream_case("dscnn 4x9", dscnn, 5, 4, 9);
+    }
+    {
+        // 5x5 kernels reach 2 rows each way, the window fills up and push recomputes everything from layer 2 on
+        const nn_stream_layer wide[] = {
+            {NN_STREAM_CONV, 2, 8, 3, conv_wt, bias, 2, 7, NULL},
+            {NN_STREAM_CONV, 8, 6, 5, conv5_wt, bias, 2, 8, NULL},
+            {NN_STREAM_DEPTHWISE, 6, 0, 5, dw5_wt, NULL, 0, 7, NULL},
+            {NN_STREAM_POINTWISE, 6, 4, 1, pw2_wt, bias, 2, 7, NULL},
+        };
+        stream_case("wide 3x10", wide, 4, 3, 10);
+    }
+    {
+        // One MFCC channel in, as bench_stream
+        const nn_stream_layer mfcc[] = {
+            {NN_STREAM_CONV, 1, 8, 3, conv_wt, bias, 2, 6, &relu},
+            {NN_STREAM_DEPTHWISE, 8, 0, 3, dw_wt, NULL, 0, 7, NULL},
+            {NN_STREAM_POINTWISE, 8, 8, 1, pw_wt, bias, 2, 7, &relu},
+        };
+        stream_case("mfcc 10x12", mfcc, 3, 10, 12);
+    }
+}
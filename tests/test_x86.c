@@ -0,0 +1,157 @@
+#include <string.h>
+#include "nn_test.h"
+
+/*
+ * The x86 kernels of nn_x86.c against the portable kernels they reproduce,
+ * byte for byte, with no epilogue and with a full one (per-channel bias and
+ * shift, clamp). conv_HWC_x86 is also checked against the reference on
+ * shapes the portable conv_HWC does not take (odd channels, kernel larger
+ * than the image). Only built with -msse4.1 or -mavx2 (make test-sse,
+ * make test-avx2); otherwise the suite has no checks.
+ */
+
+#if defined(__SSE4_1__)
+
+static void x86_epilogue(nn_epilogue *ep, const uint16_t ch)
+{
+    q7_t *bias = nn_test_alloc(ch);
+    uint8_t *shift = nn_test_alloc(ch);
+    uint16_t i;
+
+    nn_test_fill(bias, ch);
+    for (i = 0; i < ch; i++)
+    {
+        shift[i] = 5 + i % 4;
+    }
+    ep->bias = bias;
+    ep->bias_shift = 3;
+    ep->out_shift = shift;
+    ep->act_min = -40;
+    ep->act_max = 100;
+}
+
+static void x86_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel,
+                     const int full)
+{
+    uint16_t padding = kernel / 2;
+    uint16_t ch_max = ch_in > ch_out ? ch_in : ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    uint32_t dw_size = depthwise_conv_get_buffer_size(dim, ch_in, kernel);
+    uint32_t pw_size = pointwise_conv_fast_get_buffer_size(ch_in);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *dw_wt = nn_test_alloc(kernel * kernel * ch_in);
+    q7_t *pw_wt = nn_test_alloc(ch_out * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(dim * dim * ch_max);
+    q7_t *ref = nn_test_alloc(dim * dim * ch_max);
+    q15_t *bufferA = nn_test_alloc(sizeA > dw_size ? (sizeA > pw_size ? sizeA : pw_size) : dw_size);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+    nn_epilogue ep;
+    const nn_epilogue *e = full ? &ep : NULL;
+    const char *tag = full ? " full epilogue" : "";
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill(wt, ch_out * kernel * kernel * ch_in);
+    nn_test_fill(dw_wt, kernel * kernel * ch_in);
+    nn_test_fill(pw_wt, ch_out * ch_in);
+    nn_test_fill(bias, ch_out);
+    x86_epilogue(&ep, ch_max);
+
+    conv_HWC_ep(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, ref, bufferA, bufferB, e);
+    conv_HWC_x86(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, e);
+    nn_test_check(out, ref, dim * dim * ch_out, "conv_HWC_x86 %ux%ux%u -> %u k%u%s", dim, dim, ch_in, ch_out,
+                  kernel, tag);
+
+    depthwise_conv_ep(in, dim, ch_in, dw_wt, kernel, padding, 7, ref, (q7_t *)bufferA, e);
+    depthwise_conv_x86(in, dim, ch_in, dw_wt, kernel, padding, 7, out, (q7_t *)bufferA, e);
+    nn_test_check(out, ref, dim * dim * ch_in, "depthwise_conv_x86 %ux%ux%u k%u%s", dim, dim, ch_in, kernel, tag);
+
+    if ((ch_in & 0x3) == 0)
+    {
+        pointwise_conv_fast_ep(in, dim, ch_in, pw_wt, ch_out, bias, 2, 7, ref, bufferA, e);
+        pointwise_conv_fast_x86(in, dim, ch_in, pw_wt, ch_out, bias, 2, 7, out, bufferA, e);
+        nn_test_check(out, ref, dim * dim * ch_out, "pointwise_conv_fast_x86 %ux%ux%u -> %u%s", dim, dim, ch_in,
+                      ch_out, tag);
+    }
+
+    if ((dim & 0x1) == 0 && !full)
+    {
+        uint32_t pool_out = (dim / 2) * (dim / 2) * ch_in;
+        q7_t *in2 = nn_test_alloc(dim * dim * ch_in);
+
+        avg_pool_q7_HWC_opt(in, dim, ch_in, ref);
+        avg_pool_q7_HWC_opt_x86(in, dim, ch_in, out);
+        nn_test_check(out, ref, pool_out, "avg_pool_q7_HWC_opt_x86 %ux%ux%u", dim, dim, ch_in);
+
+        // In place, as the device kernel allows
+        memcpy(in2, in, dim * dim * ch_in);
+        avg_pool_q7_HWC_opt_x86(in2, dim, ch_in, in2);
+        nn_test_check(in2, ref, pool_out, "avg_pool_q7_HWC_opt_x86 %ux%ux%u in place", dim, dim, ch_in);
+    }
+}
+
+// conv_HWC_x86 on shapes outside the conv_HWC constraints, against the reference
+static void x86_ref_case(const uint16_t dim, const uint16_t ch_in, const uint16_t ch_out, const uint16_t kernel)
+{
+    uint16_t padding = kernel / 2;
+    ref_shape s = ref_square(dim, ch_in, ch_out, kernel, padding);
+    uint32_t out_size = dim * dim * ch_out;
+    uint32_t sizeB;
+    uint32_t sizeA = conv_HWC_get_buffer_size(dim, ch_in, ch_out, kernel, &sizeB);
+    q7_t *in = nn_test_alloc(dim * dim * ch_in);
+    q7_t *wt = nn_test_alloc(ch_out * kernel * kernel * ch_in);
+    q7_t *bias = nn_test_alloc(ch_out);
+    q7_t *out = nn_test_alloc(out_size);
+    q7_t *ref = nn_test_alloc(out_size);
+    q15_t *bufferA = nn_test_alloc(sizeA > kernel * kernel * ch_in * 2 ? sizeA : kernel * kernel * ch_in * 2);
+    q15_t *bufferB = nn_test_alloc(sizeB);
+
+    nn_test_fill(in, dim * dim * ch_in);
+    nn_test_fill_range(wt, ch_out * kernel * kernel * ch_in, 20);
+    nn_test_fill(bias, ch_out);
+
+    conv_HWC_x86(in, dim, ch_in, wt, ch_out, kernel, padding, bias, 2, 7, out, bufferA, bufferB, NULL);
+    ref_conv(&s, in, wt, bias, 2, 7, 0, NULL, ref);
+    nn_test_check(out, ref, out_size, "conv_HWC_x86 %ux%ux%u -> %u k%u vs reference", dim, dim, ch_in, ch_out,
+                  kernel);
+}
+
+void test_x86(void)
+{
+    int full;
+
+    x86_ref_case(3, 20, 4, 5);
+    x86_ref_case(1, 4, 2, 3);
+    x86_ref_case(2, 4, 2, 5);
+    x86_ref_case(6, 4, 8, 3);
+    x86_ref_case(5, 3, 5, 3);
+    for (full = 0; full < 2; full++)
+    {
+        x86_case(6, 4, 8, 3, full);
+        x86_case(7, 6, 4, 3, full);
+        x86_case(9, 2, 6, 5, full);
+        x86_case(5, 8, 2, 1, full);
+        x86_case(8, 16, 10, 3, full);
+        x86_case(4, 32, 6, 3, full);
+        x86_case(6, 24, 16, 3, full);
+        x86_case(4, 64, 18, 1, full);
+        x86_case(8, 12, 8, 3, full);
+        x86_case(10, 8, 12, 3, full);
+        x86_case(3, 4, 2, 3, full);
+        x86_case(6, 36, 6, 3, full);
+        // DS-CNN widths
+        x86_case(5, 64, 64, 3, full);
+        x86_case(4, 172, 172, 3, full);
+        x86_case(3, 276, 276, 3, full);
+    }
+}
+
+#else
+
+void test_x86(void)
+{
+}
+
+#endif
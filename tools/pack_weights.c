@@ -0,0 +1,333 @@
+/*
+ * Command line front end of weight_packer.
+ *
+ * Reads raw q7 weights (OHWI) and writes them in the layout of the *_packed
+ * kernels, either as raw little endian q15 (.bin) or as a C array, or in the
+ * block-sparse layout of the *_sparse kernels as an nn_sparse_weights in C,
+ * or quantised to int4 with a shift per output channel for the *_int4 kernels
+ * as an nn_int4_weights in C.
+ *
+ * Usage:
+ *   pack_weights conv <ch_im_in> <ch_im_out> <dim_kernel> <in.bin> <out.c|out.bin> [name]
+ *   pack_weights pointwise <ch_im_in> <ch_im_out> <in.bin> <out.c|out.bin> [name]
+ *   pack_weights sparse <ch_im_in> <ch_im_out> <dim_kernel> <in.bin> <out.c> [name]
+ *   pack_weights conv_int4 <ch_im_in> <ch_im_out> <dim_kernel> <in.bin> <out.c> [name]
+ *   pack_weights pointwise_int4 <ch_im_in> <ch_im_out> <in.bin> <out.c> [name]
+ *
+ * sparse takes dim_kernel 1 for pointwise_conv_sparse.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "weight_packer.h"
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: pack_weights conv <ch_im_in> <ch_im_out> <dim_kernel> <in.bin> <out.c|out.bin> [name]\n"
+            "       pack_weights pointwise <ch_im_in> <ch_im_out> <in.bin> <out.c|out.bin> [name]\n"
+            "       pack_weights sparse <ch_im_in> <ch_im_out> <dim_kernel> <in.bin> <out.c> [name]\n"
+            "       pack_weights conv_int4 <ch_im_in> <ch_im_out> <dim_kernel> <in.bin> <out.c> [name]\n"
+            "       pack_weights pointwise_int4 <ch_im_in> <ch_im_out> <in.bin> <out.c> [name]\n");
+}
+
+static int8_t *read_weights(const char *path, uint32_t size)
+{
+    FILE *f = fopen(path, "rb");
+    int8_t *wt;
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return NULL;
+    }
+    wt = (int8_t *)malloc(size);
+    if (wt != NULL && fread(wt, 1, size, f) != size)
+    {
+        fprintf(stderr, "%s: expected %u bytes of weights\n", path, (unsigned)size);
+        free(wt);
+        wt = NULL;
+    }
+    fclose(f);
+    return wt;
+}
+
+static int write_packed(const char *path, const char *name, const int16_t *packed, uint32_t size)
+{
+    size_t len = strlen(path);
+    FILE *f = fopen(path, "wb");
+    uint32_t i;
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    if (len > 4 && strcmp(path + len - 4, ".bin") == 0)
+    {
+        for (i = 0; i < size; i++)
+        {
+            fputc(packed[i] & 0xFF, f);
+            fputc((packed[i] >> 8) & 0xFF, f);
+        }
+    }
+    else
+    {
+        fprintf(f, "#include \"nn_functions.h\"\n\n");
+        fprintf(f, "const q15_t %s[%u] = {", name, (unsigned)size);
+        for (i = 0; i < size; i++)
+        {
+            fprintf(f, "%s%d,", (i % 16) ? " " : "\n    ", packed[i]);
+        }
+        fprintf(f, "\n};\n");
+    }
+    fclose(f);
+    return 0;
+}
+
+static int write_sparse(const char *path,
+                        const char *name,
+                        const uint32_t *row_ptr,
+                        const uint16_t *col_idx,
+                        const int8_t *values,
+                        uint16_t ch_im_out,
+                        uint32_t num_blocks)
+{
+    FILE *f = fopen(path, "w");
+    uint32_t i;
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    fprintf(f, "#include \"nn_functions.h\"\n\n");
+    fprintf(f, "static const uint32_t %s_row_ptr[%u] = {", name, (unsigned)ch_im_out + 1);
+    for (i = 0; i <= ch_im_out; i++)
+    {
+        fprintf(f, "%s%u,", (i % 16) ? " " : "\n    ", (unsigned)row_ptr[i]);
+    }
+    //An all-zero layer still gets one (unused) block, C has no empty arrays
+    fprintf(f, "\n};\n\nstatic const uint16_t %s_col_idx[%u] = {", name, (unsigned)(num_blocks ? num_blocks : 1));
+    for (i = 0; i < (num_blocks ? num_blocks : 1); i++)
+    {
+        fprintf(f, "%s%u,", (i % 16) ? " " : "\n    ", num_blocks ? (unsigned)col_idx[i] : 0u);
+    }
+    fprintf(f, "\n};\n\nstatic const q7_t %s_values[%u] __attribute__((aligned(4))) = {", name,
+            (unsigned)(num_blocks ? 4 * num_blocks : 4));
+    for (i = 0; i < (num_blocks ? 4 * num_blocks : 4); i++)
+    {
+        fprintf(f, "%s%d,", (i % 16) ? " " : "\n    ", num_blocks ? values[i] : 0);
+    }
+    fprintf(f, "\n};\n\nconst nn_sparse_weights %s = {%s_row_ptr, %s_col_idx, %s_values};\n", name, name, name,
+            name);
+    fclose(f);
+    return 0;
+}
+
+static int pack_sparse_main(int argc, char **argv)
+{
+    uint16_t ch_im_in, ch_im_out, dim_kernel;
+    uint32_t row_len, num_blocks;
+    const char *name;
+    int8_t *wt, *values;
+    uint32_t *row_ptr;
+    uint16_t *col_idx;
+    int ret = 1;
+
+    if (argc < 7)
+    {
+        usage();
+        return 1;
+    }
+    ch_im_in = (uint16_t)atoi(argv[2]);
+    ch_im_out = (uint16_t)atoi(argv[3]);
+    dim_kernel = (uint16_t)atoi(argv[4]);
+    name = argc > 7 ? argv[7] : "wt_sparse";
+    row_len = (uint32_t)dim_kernel * dim_kernel * ch_im_in;
+    if (row_len == 0 || ch_im_out == 0 || (row_len & 0x3) || (dim_kernel == 1 && (ch_im_in & 0x3)))
+    {
+        fprintf(stderr, "unsupported channel count, see weight_packer.h\n");
+        return 1;
+    }
+
+    wt = read_weights(argv[5], row_len * ch_im_out);
+    if (wt == NULL)
+    {
+        return 1;
+    }
+    num_blocks = pack_sparse_weights_blocks(wt, row_len, ch_im_out);
+    row_ptr = (uint32_t *)malloc((ch_im_out + 1) * sizeof(uint32_t));
+    col_idx = (uint16_t *)malloc((num_blocks + 1) * sizeof(uint16_t));
+    values = (int8_t *)malloc(4 * num_blocks + 4);
+    if (row_ptr != NULL && col_idx != NULL && values != NULL)
+    {
+        pack_sparse_weights(wt, row_len, ch_im_out, row_ptr, col_idx, values);
+        ret = write_sparse(argv[6], name, row_ptr, col_idx, values, ch_im_out, num_blocks) ? 1 : 0;
+        fprintf(stderr, "%u of %u blocks stored (%u%% zero blocks)\n", (unsigned)num_blocks,
+                (unsigned)(row_len / 4 * ch_im_out), (unsigned)(100 - num_blocks * 400 / (row_len * ch_im_out)));
+    }
+
+    free(values);
+    free(col_idx);
+    free(row_ptr);
+    free(wt);
+    return ret;
+}
+
+static int write_int4(const char *path, const char *name, const uint8_t *packed, const uint8_t *shift,
+                      uint16_t ch_im_out, uint32_t size)
+{
+    FILE *f = fopen(path, "w");
+    uint32_t i;
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    fprintf(f, "#include \"nn_functions.h\"\n\n");
+    fprintf(f, "static const q7_t %s_values[%u] __attribute__((aligned(4))) = {", name, (unsigned)size);
+    for (i = 0; i < size; i++)
+    {
+        fprintf(f, "%s%d,", (i % 16) ? " " : "\n    ", (int8_t)packed[i]);
+    }
+    fprintf(f, "\n};\n\nstatic const uint8_t %s_shift[%u] = {", name, (unsigned)ch_im_out);
+    for (i = 0; i < ch_im_out; i++)
+    {
+        fprintf(f, "%s%u,", (i % 16) ? " " : "\n    ", (unsigned)shift[i]);
+    }
+    fprintf(f, "\n};\n\nconst nn_int4_weights %s = {%s_values, %s_shift, 0};\n", name, name, name);
+    fclose(f);
+    return 0;
+}
+
+static int pack_int4_main(int argc, char **argv)
+{
+    uint16_t ch_im_in, ch_im_out, dim_kernel = 1;
+    uint32_t in_size;
+    const char *in_path, *out_path, *name;
+    int is_conv = strcmp(argv[1], "conv_int4") == 0;
+    int8_t *wt;
+    uint8_t *packed, *shift;
+    uint32_t max_err;
+    int ret = 1;
+
+    if (argc < (is_conv ? 7 : 6))
+    {
+        usage();
+        return 1;
+    }
+    ch_im_in = (uint16_t)atoi(argv[2]);
+    ch_im_out = (uint16_t)atoi(argv[3]);
+    if (is_conv)
+    {
+        dim_kernel = (uint16_t)atoi(argv[4]);
+    }
+    in_path = argv[is_conv ? 5 : 4];
+    out_path = argv[is_conv ? 6 : 5];
+    name = argc > (is_conv ? 7 : 6) ? argv[is_conv ? 7 : 6] : "wt_int4";
+
+    in_size = (uint32_t)dim_kernel * dim_kernel * ch_im_in * ch_im_out;
+    if (ch_im_out == 0 || (ch_im_out & 0x1) || ((uint32_t)dim_kernel * dim_kernel * ch_im_in) % 4)
+    {
+        fprintf(stderr, "unsupported channel count, see weight_packer.h\n");
+        return 1;
+    }
+
+    wt = read_weights(in_path, in_size);
+    if (wt == NULL)
+    {
+        return 1;
+    }
+    packed = (uint8_t *)malloc(in_size / 2);
+    shift = (uint8_t *)malloc(ch_im_out);
+    if (packed != NULL && shift != NULL)
+    {
+        max_err = is_conv ? pack_conv_int4_weights(wt, ch_im_in, ch_im_out, dim_kernel, 1, packed, shift, NULL)
+                          : pack_pointwise_int4_weights(wt, ch_im_in, ch_im_out, 1, packed, shift, NULL);
+        ret = write_int4(out_path, name, packed, shift, ch_im_out, in_size / 2) ? 1 : 0;
+        fprintf(stderr, "%u -> %u bytes, largest weight error %u\n", (unsigned)in_size, (unsigned)(in_size / 2),
+                (unsigned)max_err);
+    }
+
+    free(shift);
+    free(packed);
+    free(wt);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    uint16_t ch_im_in, ch_im_out, dim_kernel = 1;
+    uint32_t in_size, out_size;
+    const char *in_path, *out_path, *name;
+    int8_t *wt;
+    int16_t *packed;
+    int is_conv;
+    int ret;
+
+    if (argc < 2)
+    {
+        usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "sparse") == 0)
+    {
+        return pack_sparse_main(argc, argv);
+    }
+    if (strcmp(argv[1], "conv_int4") == 0 || strcmp(argv[1], "pointwise_int4") == 0)
+    {
+        return pack_int4_main(argc, argv);
+    }
+    is_conv = strcmp(argv[1], "conv") == 0;
+    if ((is_conv && argc < 7) || (!is_conv && (strcmp(argv[1], "pointwise") != 0 || argc < 6)))
+    {
+        usage();
+        return 1;
+    }
+
+    ch_im_in = (uint16_t)atoi(argv[2]);
+    ch_im_out = (uint16_t)atoi(argv[3]);
+    if (is_conv)
+    {
+        dim_kernel = (uint16_t)atoi(argv[4]);
+    }
+    in_path = argv[is_conv ? 5 : 4];
+    out_path = argv[is_conv ? 6 : 5];
+    name = argc > (is_conv ? 7 : 6) ? argv[is_conv ? 7 : 6] : "wt_packed";
+
+    if ((ch_im_out & 0x1) || (ch_im_in & (is_conv ? 0x1 : 0x3)))
+    {
+        fprintf(stderr, "unsupported channel count, see weight_packer.h\n");
+        return 1;
+    }
+
+    in_size = (uint32_t)dim_kernel * dim_kernel * ch_im_in * ch_im_out;
+    out_size = is_conv ? pack_conv_HWC_weights_size(ch_im_in, ch_im_out, dim_kernel)
+                       : pack_pointwise_fast_weights_size(ch_im_in, ch_im_out);
+
+    wt = read_weights(in_path, in_size);
+    if (wt == NULL)
+    {
+        return 1;
+    }
+    packed = (int16_t *)malloc(out_size * sizeof(int16_t));
+    if (packed == NULL)
+    {
+        free(wt);
+        return 1;
+    }
+
+    if (is_conv)
+    {
+        pack_conv_HWC_weights(wt, ch_im_in, ch_im_out, dim_kernel, packed);
+    }
+    else
+    {
+        pack_pointwise_fast_weights(wt, ch_im_in, ch_im_out, packed);
+    }
+    ret = write_packed(out_path, name, packed, out_size);
+
+    free(packed);
+    free(wt);
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,696 @@
+#!/usr/bin/env python3
+"""Generate C sources for a quantised .tflite DS-CNN model.
+
+    tflite2c.py model.tflite out_dir [--name model]
+    tflite2c.py check model.tflite out_dir [--name model] [--runs 20] [--cc gcc]
+                      [--expected cases.json]
+
+The first form writes out_dir/<name>.c and out_dir/<name>.h:
+  - const weight/bias arrays, already in the layout of each kernel,
+  - one statically sized arena (two ping-pong activation buffers + scratch),
+  - run_inference(input, output), a straight-line sequence of kernel calls
+    with literal shapes and shifts.
+
+The kernels use power-of-two (Qm.n) formats. Every activation tensor gets the
+largest fractional bit count that holds the range given by its TFLite scale and
+zero point, and weights/biases are re-quantised from their real values to the
+largest fractional bit count that holds them. bias_shift and out_shift follow:
+    bias_shift = frac_in + frac_wt - frac_bias
+    out_shift  = frac_in + frac_wt - frac_out
+<NAME>_INPUT_FRAC / <NAME>_OUTPUT_FRAC in the header give the formats of the
+run_inference input and output.
+
+The second form also builds the generated code for the host (-DNN_PORTABLE)
+with a small driver, runs it on random inputs and compares the dequantised
+outputs with the TFLite interpreter (tflite_runtime or tensorflow, with numpy).
+With --expected the inputs and reference outputs are int8 cases recorded in a
+JSON file instead (tests/data/ds_cnn_tiny.json), and no interpreter or numpy is
+needed. The check passes when the argmax agrees on every input.
+
+Only the standard library is needed for generation: the .tflite flatbuffer is
+read directly.
+"""
+
+import argparse
+import json
+import math
+import os
+import random
+import struct
+import subprocess
+import sys
+
+# ---------------------------------------------------------------------------
+# Flatbuffer reader, just enough of the TFLite schema
+
+class Table:
+    def __init__(self, buf, pos):
+        self.buf = buf
+        self.pos = pos
+        self.vtable = pos - struct.unpack_from('<i', buf, pos)[0]
+        self.vtsize = struct.unpack_from('<H', buf, self.vtable)[0]
+
+    def _field(self, index):
+        off = 4 + 2 * index
+        if off >= self.vtsize:
+            return 0
+        return struct.unpack_from('<H', self.buf, self.vtable + off)[0]
+
+    def scalar(self, index, fmt, default=0):
+        off = self._field(index)
+        if not off:
+            return default
+        return struct.unpack_from('<' + fmt, self.buf, self.pos + off)[0]
+
+    def _indirect(self, index):
+        off = self._field(index)
+        if not off:
+            return None
+        p = self.pos + off
+        return p + struct.unpack_from('<I', self.buf, p)[0]
+
+    def table(self, index):
+        p = self._indirect(index)
+        return None if p is None else Table(self.buf, p)
+
+    def vector(self, index, fmt):
+        p = self._indirect(index)
+        if p is None:
+            return []
+        n = struct.unpack_from('<I', self.buf, p)[0]
+        return list(struct.unpack_from('<%d%s' % (n, fmt), self.buf, p + 4))
+
+    def bytes(self, index):
+        p = self._indirect(index)
+        if p is None:
+            return b''
+        n = struct.unpack_from('<I', self.buf, p)[0]
+        return self.buf[p + 4:p + 4 + n]
+
+    def string(self, index):
+        return self.bytes(index).decode('utf-8', 'replace')
+
+    def tables(self, index):
+        p = self._indirect(index)
+        if p is None:
+            return []
+        n = struct.unpack_from('<I', self.buf, p)[0]
+        out = []
+        for i in range(n):
+            q = p + 4 + 4 * i
+            out.append(Table(self.buf, q + struct.unpack_from('<I', self.buf, q)[0]))
+        return out
+
+
+# schema.fbs enums
+OP_AVERAGE_POOL_2D = 1
+OP_CONV_2D = 3
+OP_DEPTHWISE_CONV_2D = 4
+OP_DEQUANTIZE = 6
+OP_FULLY_CONNECTED = 9
+OP_MAX_POOL_2D = 17
+OP_RESHAPE = 22
+OP_SOFTMAX = 25
+OP_SQUEEZE = 43
+OP_QUANTIZE = 114
+
+OP_NAMES = {
+    OP_AVERAGE_POOL_2D: 'AVERAGE_POOL_2D', OP_CONV_2D: 'CONV_2D',
+    OP_DEPTHWISE_CONV_2D: 'DEPTHWISE_CONV_2D', OP_DEQUANTIZE: 'DEQUANTIZE',
+    OP_FULLY_CONNECTED: 'FULLY_CONNECTED', OP_MAX_POOL_2D: 'MAX_POOL_2D',
+    OP_RESHAPE: 'RESHAPE', OP_SOFTMAX: 'SOFTMAX', OP_SQUEEZE: 'SQUEEZE',
+    OP_QUANTIZE: 'QUANTIZE',
+}
+
+TYPE_FLOAT32 = 0
+TYPE_INT32 = 2
+TYPE_INT8 = 9
+
+PADDING_SAME = 0
+
+ACT_NONE = 0
+ACT_RELU = 1
+ACT_RELU_N1_TO_1 = 2
+ACT_RELU6 = 3
+
+
+class Tensor:
+    pass
+
+
+class Operator:
+    pass
+
+
+def read_model(path):
+    with open(path, 'rb') as f:
+        buf = f.read()
+    model = Table(buf, struct.unpack_from('<I', buf, 0)[0])
+
+    opcodes = []
+    for oc in model.tables(1):
+        code = oc.scalar(0, 'b')
+        code = max(code, oc.scalar(3, 'i'))
+        opcodes.append(code)
+
+    buffers = [b.bytes(0) for b in model.tables(4)]
+
+    subgraphs = model.tables(2)
+    if len(subgraphs) != 1:
+        raise SystemExit('error: only single-subgraph models are supported')
+    sg = subgraphs[0]
+
+    tensors = []
+    for t in sg.tables(0):
+        ten = Tensor()
+        ten.shape = t.vector(0, 'i')
+        ten.type = t.scalar(1, 'b')
+        ten.data = buffers[t.scalar(2, 'I')] if t.scalar(2, 'I') < len(buffers) else b''
+        ten.name = t.string(3)
+        q = t.table(4)
+        ten.scale = q.vector(2, 'f') if q else []
+        ten.zero_point = q.vector(3, 'q') if q else []
+        ten.qdim = q.scalar(6, 'i') if q else 0
+        tensors.append(ten)
+
+    operators = []
+    for o in sg.tables(3):
+        op = Operator()
+        op.code = opcodes[o.scalar(0, 'I')]
+        op.inputs = o.vector(1, 'i')
+        op.outputs = o.vector(2, 'i')
+        op.options = o.table(4)
+        operators.append(op)
+
+    return tensors, operators, sg.vector(1, 'i'), sg.vector(2, 'i')
+
+
+# ---------------------------------------------------------------------------
+# Power-of-two formats
+
+def frac_for(max_abs):
+    """Largest fractional bit count with max_abs inside the q7 range."""
+    if max_abs <= 0:
+        return 7
+    return int(math.floor(math.log2(127.0 / max_abs)))
+
+
+def act_frac(t):
+    if t.type != TYPE_INT8 or not t.scale:
+        raise SystemExit('error: tensor %s is not int8 quantised' % t.name)
+    s, zp = t.scale[0], t.zero_point[0] if t.zero_point else 0
+    return frac_for(max(abs(s * (-128 - zp)), abs(s * (127 - zp))))
+
+
+def q7(values, frac):
+    return [max(-128, min(127, int(round(v * 2.0 ** frac)))) for v in values]
+
+
+def int8_data(t):
+    return list(struct.unpack('<%db' % len(t.data), t.data))
+
+
+def int32_data(t):
+    return list(struct.unpack('<%di' % (len(t.data) // 4), t.data))
+
+
+def real_weights(t):
+    """Dequantised weights, per-channel scales along qdim."""
+    q = int8_data(t)
+    scale, zp = t.scale, t.zero_point or [0]
+    if len(scale) == 1:
+        return [scale[0] * (v - zp[0]) for v in q]
+    inner = 1
+    for d in t.shape[t.qdim + 1:]:
+        inner *= d
+    nch = t.shape[t.qdim]
+    return [scale[(i // inner) % nch] * (v - zp[(i // inner) % nch if len(zp) > 1 else 0])
+            for i, v in enumerate(q)]
+
+
+def real_bias(t, in_scale, wt):
+    b = int32_data(t)
+    return [v * in_scale * wt.scale[i if len(wt.scale) > 1 else 0] for i, v in enumerate(b)]
+
+
+def same_pads(dim_in, k, stride):
+    dim_out = (dim_in + stride - 1) // stride
+    total = max((dim_out - 1) * stride + k - dim_in, 0)
+    return total // 2, total - total // 2, dim_out
+
+
+def pads(opts, padding_field, h, w, kh, kw, sh, sw):
+    if opts.scalar(padding_field, 'b') == PADDING_SAME:
+        pt, pb, oh = same_pads(h, kh, sh)
+        pl, pr, ow = same_pads(w, kw, sw)
+    else:
+        pt = pb = pl = pr = 0
+        oh = (h - kh) // sh + 1
+        ow = (w - kw) // sw + 1
+    return pt, pb, pl, pr, oh, ow
+
+
+def clamp_range(act, frac):
+    if act == ACT_NONE:
+        return None
+    if act == ACT_RELU:
+        return 0, 127
+    if act == ACT_RELU6:
+        return 0, min(127, int(round(6 * 2.0 ** frac)))
+    if act == ACT_RELU_N1_TO_1:
+        one = int(round(2.0 ** frac))
+        return -min(128, one), min(127, one)
+    raise SystemExit('error: unsupported fused activation %d' % act)
+
+
+# ---------------------------------------------------------------------------
+# Conversion to kernel calls
+
+class Gen:
+    def __init__(self, name):
+        self.name = name
+        self.arrays = []    # C definitions
+        self.calls = []     # C statements of run_inference
+        self.max_act = 0
+        self.max_scratch = 0
+
+    def array(self, ctype, cname, values):
+        lines = []
+        for i in range(0, len(values), 16):
+            lines.append('    ' + ', '.join(str(v) for v in values[i:i + 16]) + ',')
+        self.arrays.append('static const %s %s[%d] = {\n%s\n};\n' %
+                           (ctype, cname, len(values), '\n'.join(lines)))
+
+    def epilogue(self, cname, bias, bias_shift, act):
+        lo, hi = act if act else (-128, 127)
+        self.arrays.append('static const nn_epilogue %s = {%s, %d, NULL, %d, %d};\n' %
+                           (cname, bias or 'NULL', bias_shift, lo, hi))
+        return '&' + cname
+
+    def scratch(self, size):
+        self.max_scratch = max(self.max_scratch, (size + 3) & ~3)
+
+
+def weight_shifts(in_frac, wt_real, bias_real, out_frac):
+    """Formats of one layer, out_frac may be lowered to keep out_shift >= 0."""
+    w_frac = frac_for(max(abs(v) for v in wt_real))
+    acc_frac = in_frac + w_frac
+    b_frac = min(frac_for(max(abs(v) for v in bias_real)) if bias_real else acc_frac, acc_frac)
+    out_frac = min(out_frac, acc_frac)
+    return w_frac, b_frac, acc_frac - b_frac, acc_frac - out_frac, out_frac
+
+
+def convert(tensors, operators, graph_in, graph_out, name):
+    g = Gen(name)
+    ops = list(operators)
+
+    # Float edges: QUANTIZE at the input, DEQUANTIZE at the output
+    cur = graph_in[0]
+    if ops and ops[0].code == OP_QUANTIZE and ops[0].inputs[0] == cur:
+        cur = ops[0].outputs[0]
+        ops = ops[1:]
+    out_tensor = graph_out[0]
+    if ops and ops[-1].code == OP_DEQUANTIZE and ops[-1].outputs[0] == out_tensor:
+        out_tensor = ops[-1].inputs[0]
+        ops = ops[:-1]
+
+    t_in = tensors[cur]
+    _, h, w, c = t_in.shape
+    frac = act_frac(t_in)
+    ch_pad = c + (c & 1)
+    if ch_pad != c and (not ops or ops[0].code != OP_CONV_2D):
+        raise SystemExit('error: an odd input channel count is only supported before CONV_2D')
+    g.input = (h, w, c, ch_pad, frac)
+    g.max_act = h * w * ch_pad
+    buf = 0     # run_inference input is in buf0
+
+    for i, op in enumerate(ops):
+        if op.inputs[0] != cur:
+            raise SystemExit('error: operator %d does not read the previous output, '
+                             'only chains are supported' % i)
+        opt = op.options
+        t_out = tensors[op.outputs[0]]
+        src, dst = 'buf%d' % buf, 'buf%d' % (buf ^ 1)
+        name_i = '%s_%d' % (OP_NAMES.get(op.code, 'op').lower(), i)
+        comment = '    // %d: %s %dx%dx%d' % (i, OP_NAMES.get(op.code, str(op.code)), h, w, c)
+
+        if op.code in (OP_CONV_2D, OP_DEPTHWISE_CONV_2D):
+            wt = tensors[op.inputs[1]]
+            bias = tensors[op.inputs[2]] if len(op.inputs) > 2 and op.inputs[2] >= 0 else None
+            depthwise = op.code == OP_DEPTHWISE_CONV_2D
+            if depthwise:
+                _, kh, kw, ch_out = wt.shape
+                sw, sh = opt.scalar(1, 'i'), opt.scalar(2, 'i')
+                act = opt.scalar(4, 'b')
+                if opt.scalar(3, 'i', 1) != 1 or ch_out != c:
+                    raise SystemExit('error: %s: depth_multiplier must be 1' % name_i)
+                dil = (opt.scalar(5, 'i', 1), opt.scalar(6, 'i', 1))
+            else:
+                ch_out, kh, kw, _ = wt.shape
+                sw, sh = opt.scalar(1, 'i'), opt.scalar(2, 'i')
+                act = opt.scalar(3, 'b')
+                dil = (opt.scalar(4, 'i', 1), opt.scalar(5, 'i', 1))
+            if dil != (1, 1):
+                raise SystemExit('error: %s: dilation is not supported' % name_i)
+            pt, pb, pl, pr, oh, ow = pads(opt, 0, h, w, kh, kw, sh, sw)
+
+            wt_real = real_weights(wt)
+            bias_real = real_bias(bias, t_in.scale[0], wt) if bias else [0.0] * ch_out
+            w_frac, b_frac, bias_shift, out_shift, out_frac = \
+                weight_shifts(frac, wt_real, bias_real, act_frac(t_out))
+            wt_q = q7(wt_real, w_frac)
+            bias_q = q7(bias_real, b_frac)
+
+            if not depthwise and ch_pad != c:
+                # Zero weights for the padded input channel
+                wt_q = [v for o in range(ch_out * kh * kw) for v in wt_q[o * c:(o + 1) * c] + [0]]
+            cin = ch_pad if not depthwise else c
+            g.array('q7_t', name_i + '_wt', wt_q)
+            g.array('q7_t', name_i + '_bias', bias_q)
+            ep = g.epilogue(name_i + '_ep', name_i + '_bias' if depthwise else None,
+                            bias_shift if depthwise else 0, clamp_range(act, out_frac))
+            comment += ' -> %dx%dx%d, Q%d.%d -> Q%d.%d' % (oh, ow, ch_out, 7 - frac, frac,
+                                                          7 - out_frac, out_frac)
+            g.calls.append(comment)
+
+            if depthwise:
+                if h == w and kh == kw and kh & 1 and sh == sw == 1 and pt == pb == pl == pr == kh // 2:
+                    size = kh * (kh - 1 + h) * c
+                    g.calls.append('    depthwise_conv_ep(%s, %d, %d, %s_wt, %d, %d, %d, %s, (q7_t *)scratch, %s);'
+                                   % (src, h, c, name_i, kh, pt, out_shift, dst, ep))
+                else:
+                    size = kw * (pt + h + pb) * c
+                    g.calls.append('    depthwise_conv_nonsquare_ep(%s, %d, %d, %d, %s_wt, %d, %d, %d, %d, %d, %d, %d, '
+                                   '%d, %d, %s, (q7_t *)scratch, %s);'
+                                   % (src, w, h, c, name_i, kw, kh, pt, pb, pl, pr, sw, sh, out_shift, dst, ep))
+                g.scratch(size)
+            else:
+                if ch_out & 1 or cin & 1:
+                    raise SystemExit('error: %s: channel counts must be even' % name_i)
+                pointwise = kh == kw == 1 and sh == sw == 1
+                if pointwise and h == w:
+                    fast = cin % 4 == 0
+                    g.scratch(2 * cin * 2)
+                    g.calls.append('    pointwise_conv_%s_ep(%s, %d, %d, %s_wt, %d, %s_bias, %d, %d, %s, '
+                                   '(q15_t *)scratch, %s);'
+                                   % ('fast' if fast else 'basic', src, h, cin, name_i, ch_out, name_i,
+                                      bias_shift, out_shift, dst, ep))
+                elif h == w and kh == kw and kh & 1 and sh == sw == 1 and pt == pb == pl == pr == kh // 2:
+                    size_a = (kh * (kh - 1 + h) * cin * 2 + 3) & ~3
+                    g.scratch(size_a + kh * kh * cin * ch_out * 2)
+                    g.calls.append('    conv_HWC_ep(%s, %d, %d, %s_wt, %d, %d, %d, %s_bias, %d, %d, %s, '
+                                   '(q15_t *)scratch, (q15_t *)(scratch + %d), %s);'
+                                   % (src, h, cin, name_i, ch_out, kh, pt, name_i, bias_shift, out_shift,
+                                      dst, size_a, ep))
+                else:
+                    size_a = (kw * (pt + h + pb) * cin * 2 + 3) & ~3
+                    g.scratch(size_a + kh * kw * cin * ch_out * 2)
+                    g.calls.append('    conv_HWC_nonsquare_ep(%s, %d, %d, %d, %s_wt, %d, %d, %d, %d, %d, %d, %d, %d, '
+                                   '%d, %s_bias, %d, %d, %s, (q15_t *)scratch, (q15_t *)(scratch + %d), %s);'
+                                   % (src, w, h, cin, name_i, ch_out, kw, kh, pt, pb, pl, pr, sw, sh,
+                                      name_i, bias_shift, out_shift, dst, size_a, ep))
+            h, w, c, frac = oh, ow, ch_out, out_frac
+            ch_pad = c
+
+        elif op.code in (OP_AVERAGE_POOL_2D, OP_MAX_POOL_2D):
+            sw, sh = opt.scalar(1, 'i'), opt.scalar(2, 'i')
+            kw, kh = opt.scalar(3, 'i'), opt.scalar(4, 'i')
+            if opt.scalar(5, 'b') != ACT_NONE:
+                raise SystemExit('error: %s: fused activation on pooling is not supported' % name_i)
+            pt, pb, pl, pr, oh, ow = pads(opt, 0, h, w, kh, kw, sh, sw)
+            g.calls.append(comment + ' -> %dx%dx%d' % (oh, ow, c))
+            avg = op.code == OP_AVERAGE_POOL_2D
+            if avg and oh == ow == 1 and kh >= h and kw >= w:
+                g.calls.append('    global_avg_pool_q7_HWC(%s, %d, %d, %d, %s);' % (src, w, h, c, dst))
+            elif avg and h == w and kh == kw == 2 and sh == sw == 2 and h % 2 == 0 and c % 4 == 0 and pt == pl == 0:
+                g.calls.append('    avg_pool_q7_HWC_opt(%s, %d, %d, %s);' % (src, h, c, dst))
+            elif h == w and kh == kw and sh == sw and pt == pl:
+                g.calls.append('    %s_pool_q7_HWC(%s, %d, %d, %d, %d, %d, %d, %s);'
+                               % ('avg' if avg else 'max', src, h, c, kh, pt, sh, oh, dst))
+            else:
+                raise SystemExit('error: %s: only square pooling is supported' % name_i)
+            h, w = oh, ow
+
+        elif op.code == OP_FULLY_CONNECTED:
+            wt = tensors[op.inputs[1]]
+            bias = tensors[op.inputs[2]] if len(op.inputs) > 2 and op.inputs[2] >= 0 else None
+            rows, dim_vec = wt.shape
+            if dim_vec != h * w * c:
+                raise SystemExit('error: %s: input size mismatch' % name_i)
+            act = opt.scalar(0, 'b') if opt else ACT_NONE
+            wt_real = real_weights(wt)
+            bias_real = real_bias(bias, t_in.scale[0], wt) if bias else [0.0] * rows
+            w_frac, b_frac, bias_shift, out_shift, out_frac = \
+                weight_shifts(frac, wt_real, bias_real, act_frac(t_out))
+            g.array('q7_t', name_i + '_wt', q7(wt_real, w_frac))
+            g.array('q7_t', name_i + '_bias', q7(bias_real, b_frac))
+            g.calls.append(comment + ' -> %d, Q%d.%d -> Q%d.%d' % (rows, 7 - frac, frac, 7 - out_frac, out_frac))
+            g.calls.append('    arm_fully_connected_q7(%s, %s_wt, %d, %d, %d, %d, %s_bias, %s, (q15_t *)scratch);'
+                           % (src, name_i, dim_vec, rows, bias_shift, out_shift, name_i, dst))
+            g.scratch(dim_vec * 2)
+            clamp = clamp_range(act, out_frac)
+            if clamp:
+                g.calls.append('    clamp_q7(%s, %d, %d, %d);' % (dst, rows, clamp[0], clamp[1]))
+            h, w, c, frac = 1, 1, rows, out_frac
+
+        elif op.code in (OP_RESHAPE, OP_SQUEEZE):
+            g.calls.append(comment + ' (no-op)')
+            cur = op.outputs[0]
+            t_in = tensors[cur]
+            continue
+
+        elif op.code == OP_SOFTMAX:
+            # arm_softmax_q7 is base 2 on the raw q7 input: the ranking is
+            # kept, the probabilities are sharper than TFLite's
+            g.calls.append(comment + ' -> Q0.7')
+            g.calls.append('    arm_softmax_q7(%s, %d, %s);' % (src, h * w * c, dst))
+            frac = 7
+
+        else:
+            raise SystemExit('error: operator %d: %s is not supported'
+                             % (i, OP_NAMES.get(op.code, 'builtin %d' % op.code)))
+
+        g.max_act = max(g.max_act, h * w * c)
+        buf ^= 1
+        cur = op.outputs[0]
+        t_in = tensors[cur]
+
+    if cur != out_tensor:
+        raise SystemExit('error: the last operator does not produce the model output')
+    g.output = (h * w * c, frac, buf)
+    return g
+
+
+# ---------------------------------------------------------------------------
+# C emission
+
+def emit(g, out_dir):
+    name = g.name
+    NAME = name.upper()
+    h, w, c, ch_pad, in_frac = g.input
+    out_size, out_frac, out_buf = g.output
+    buf_size = (g.max_act + 3) & ~3
+    arena = 2 * buf_size + g.max_scratch
+
+    hdr = '''#ifndef {NAME}_H
+#define {NAME}_H
+
+#include "nn_functions.h"
+
+// Generated by tools/tflite2c.py
+
+#define {NAME}_INPUT_SIZE   {in_size}   // {h}x{w}x{c} HWC
+#define {NAME}_INPUT_FRAC   {in_frac}
+#define {NAME}_OUTPUT_SIZE  {out_size}
+#define {NAME}_OUTPUT_FRAC  {out_frac}
+#define {NAME}_ARENA_SIZE   {arena}
+
+void run_inference(const q7_t *input, q7_t *output);
+
+#endif
+'''.format(NAME=NAME, in_size=h * w * c, h=h, w=w, c=c, in_frac=in_frac,
+           out_size=out_size, out_frac=out_frac, arena=arena)
+
+    if ch_pad != c:
+        load = '''    // Pad the input to an even channel count
+    for (i = 0; i < {pixels}; i++)
+    {{
+        for (ch = 0; ch < {c}; ch++)
+        {{
+            buf0[i * {ch_pad} + ch] = input[i * {c} + ch];
+        }}
+        buf0[i * {ch_pad} + {c}] = 0;
+    }}
+'''.format(pixels=h * w, c=c, ch_pad=ch_pad)
+        decl = '    uint32_t i, ch;\n'
+    else:
+        load = '    memcpy(buf0, input, %s_INPUT_SIZE);\n' % NAME
+        decl = ''
+
+    clamp = ''
+    if any('clamp_q7(' in s for s in g.calls):
+        clamp = '''static void clamp_q7(q7_t *p, uint32_t n, q7_t lo, q7_t hi)
+{
+    while (n--)
+    {
+        *p = *p < lo ? lo : (*p > hi ? hi : *p);
+        p++;
+    }
+}
+
+'''
+
+    src = '''#include "{name}.h"
+
+// Generated by tools/tflite2c.py
+
+{arrays}
+// buf0 | buf1 | scratch
+static q31_t arena[({NAME}_ARENA_SIZE + 3) / 4];
+
+{clamp}void run_inference(const q7_t *input, q7_t *output)
+{{
+    q7_t *buf0 = (q7_t *)arena;
+    q7_t *buf1 = buf0 + {buf_size};
+    q7_t *scratch = buf1 + {buf_size};
+{decl}
+{load}
+{calls}
+
+    memcpy(output, buf{out_buf}, {NAME}_OUTPUT_SIZE);
+}}
+'''.format(name=name, NAME=NAME, arrays='\n'.join(g.arrays), clamp=clamp, buf_size=buf_size,
+           decl=decl, load=load, calls='\n'.join(g.calls), out_buf=out_buf)
+
+    os.makedirs(out_dir, exist_ok=True)
+    with open(os.path.join(out_dir, name + '.h'), 'w') as f:
+        f.write(hdr)
+    with open(os.path.join(out_dir, name + '.c'), 'w') as f:
+        f.write(src)
+
+
+# ---------------------------------------------------------------------------
+# Host check against the TFLite interpreter or recorded outputs
+
+DRIVER = '''#include <stdio.h>
+#include "{name}.h"
+
+int main(void)
+{{
+    static q7_t in[{NAME}_INPUT_SIZE], out[{NAME}_OUTPUT_SIZE];
+    while (fread(in, 1, sizeof(in), stdin) == sizeof(in))
+    {{
+        run_inference(in, out);
+        fwrite(out, 1, sizeof(out), stdout);
+    }}
+    return 0;
+}}
+'''
+
+
+def build_host(args, g):
+    repo = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    name, NAME = g.name, g.name.upper()
+    with open(os.path.join(args.out_dir, name + '_main.c'), 'w') as f:
+        f.write(DRIVER.format(name=name, NAME=NAME))
+    exe = os.path.join(args.out_dir, name + '_host')
+    sources = [os.path.join(repo, s) for s in sorted(os.listdir(repo)) if s.endswith('.c')]
+    subprocess.check_call([args.cc, '-O2', '-DNN_PORTABLE', '-fno-strict-aliasing', '-I', repo,
+                           '-I', args.out_dir, os.path.join(args.out_dir, name + '.c'),
+                           os.path.join(args.out_dir, name + '_main.c')] + sources + ['-o', exe])
+    return exe
+
+
+def interpreter_cases(args, g):
+    """Random inputs, dequantised outputs of the TFLite interpreter."""
+    try:
+        import numpy as np
+        try:
+            from tflite_runtime.interpreter import Interpreter
+        except ImportError:
+            from tensorflow.lite import Interpreter
+    except ImportError:
+        raise SystemExit('error: check needs numpy and tflite_runtime or tensorflow, or --expected')
+
+    interp = Interpreter(model_path=args.model)
+    interp.allocate_tensors()
+    d_in, d_out = interp.get_input_details()[0], interp.get_output_details()[0]
+    h, w, c, _, in_frac = g.input
+
+    rng = random.Random(0)
+    inputs, ref_out = [], []
+    for _ in range(args.runs):
+        x = q7([rng.uniform(-1.0, 1.0) * (127.0 / 2 ** in_frac) for _ in range(h * w * c)], in_frac)
+        inputs.append(x)
+        xr = np.array([v / 2.0 ** in_frac for v in x], dtype=np.float32)
+        if d_in['dtype'] == np.int8:
+            s, zp = d_in['quantization']
+            xr = np.clip(np.round(xr / s) + zp, -128, 127).astype(np.int8)
+        interp.set_tensor(d_in['index'], xr.reshape(d_in['shape']))
+        interp.invoke()
+        y = interp.get_tensor(d_out['index']).astype(np.float32).reshape(-1)
+        if d_out['dtype'] == np.int8:
+            s, zp = d_out['quantization']
+            y = (y - zp) * s
+        ref_out.append([float(v) for v in y])
+    return inputs, ref_out
+
+
+def expected_cases(path, g):
+    """int8 inputs and outputs recorded from TFLite, see tests/data/make_ds_cnn_tiny.py."""
+    with open(path) as f:
+        exp = json.load(f)
+    in_frac = g.input[4]
+    s_in, zp_in = exp['input']['scale'], exp['input']['zero_point']
+    s_out, zp_out = exp['output']['scale'], exp['output']['zero_point']
+    inputs = [q7([s_in * (v - zp_in) for v in case['input']], in_frac) for case in exp['cases']]
+    ref_out = [[s_out * (v - zp_out) for v in case['output']] for case in exp['cases']]
+    return inputs, ref_out
+
+
+def check(args, g):
+    exe = build_host(args, g)
+    if args.expected:
+        inputs, ref_out = expected_cases(args.expected, g)
+    else:
+        inputs, ref_out = interpreter_cases(args, g)
+    out_size, out_frac, _ = g.output
+
+    ours_in = b''.join(struct.pack('<%db' % len(x), *x) for x in inputs)
+    res = subprocess.run([exe], input=ours_in, stdout=subprocess.PIPE, check=True).stdout
+    ours = [[v / 2.0 ** out_frac for v in struct.unpack_from('<%db' % out_size, res, i * out_size)]
+            for i in range(len(inputs))]
+    argmax = lambda v: max(range(len(v)), key=v.__getitem__)
+    err = max(abs(a - b) for o, r in zip(ours, ref_out) for a, b in zip(o, r))
+    agree = sum(int(argmax(o) == argmax(r)) for o, r in zip(ours, ref_out))
+    print('max abs error %.4f (output LSB %.4f), argmax agrees %d/%d'
+          % (err, 2.0 ** -out_frac, agree, len(inputs)))
+    return 0 if agree == len(inputs) else 1
+
+
+def main():
+    argv = sys.argv[1:]
+    checking = bool(argv) and argv[0] == 'check'
+    if checking:
+        argv = argv[1:]
+    ap = argparse.ArgumentParser(description='Generate C sources for a quantised .tflite model.')
+    ap.add_argument('model')
+    ap.add_argument('out_dir')
+    ap.add_argument('--name', default='model')
+    ap.add_argument('--runs', type=int, default=20)
+    ap.add_argument('--cc', default='gcc')
+    ap.add_argument('--expected', help='check: JSON of int8 inputs/outputs instead of the interpreter')
+    args = ap.parse_args(argv)
+
+    tensors, operators, graph_in, graph_out = read_model(args.model)
+    g = convert(tensors, operators, graph_in, graph_out, args.name)
+    emit(g, args.out_dir)
+    print('wrote %s/%s.c, %s.h, arena %d bytes'
+          % (args.out_dir, args.name, args.name, 2 * ((g.max_act + 3) & ~3) + g.max_scratch))
+    if checking:
+        return check(args, g)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
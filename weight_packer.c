@@ -0,0 +1,248 @@
+#include "weight_packer.h"
+
+uint32_t pack_conv_HWC_weights_size(const uint16_t ch_im_in,
+                                    const uint16_t ch_im_out,
+                                    const uint16_t dim_kernel)
+{
+    return (uint32_t)dim_kernel * dim_kernel * ch_im_in * ch_im_out;
+}
+
+void pack_conv_HWC_weights(const int8_t *wt,
+                           const uint16_t ch_im_in,
+                           const uint16_t ch_im_out,
+                           const uint16_t dim_kernel,
+                           int16_t *packed)
+{
+    uint32_t para_per_ch_out = (uint32_t)dim_kernel * dim_kernel * ch_im_in;
+    uint16_t ch;
+    uint32_t i;
+
+    for (ch = 0; ch + 1 < ch_im_out; ch += 2)
+    {
+        const int8_t *pA = wt + ch * para_per_ch_out;
+        const int8_t *pA2 = pA + para_per_ch_out;
+        for (i = 0; i < para_per_ch_out; i += 2)
+        {
+            *packed++ = pA[i];
+            *packed++ = pA[i + 1];
+            *packed++ = pA2[i];
+            *packed++ = pA2[i + 1];
+        }
+    }
+}
+
+uint32_t pack_pointwise_fast_weights_size(const uint16_t ch_im_in,
+                                          const uint16_t ch_im_out)
+{
+    return (uint32_t)ch_im_in * ch_im_out;
+}
+
+void pack_pointwise_fast_weights(const int8_t *wt,
+                                 const uint16_t ch_im_in,
+                                 const uint16_t ch_im_out,
+                                 int16_t *packed)
+{
+    uint16_t ch;
+    uint32_t i;
+
+    for (ch = 0; ch + 1 < ch_im_out; ch += 2)
+    {
+        const int8_t *pA = wt + ch * ch_im_in;
+        const int8_t *pA2 = pA + ch_im_in;
+        for (i = 0; i < ch_im_in; i += 4)
+        {
+            *packed++ = pA[i];
+            *packed++ = pA[i + 2];
+            *packed++ = pA[i + 1];
+            *packed++ = pA[i + 3];
+            *packed++ = pA2[i];
+            *packed++ = pA2[i + 2];
+            *packed++ = pA2[i + 1];
+            *packed++ = pA2[i + 3];
+        }
+    }
+}
+
+static int sparse_block_is_zero(const int8_t *block)
+{
+    return block[0] == 0 && block[1] == 0 && block[2] == 0 && block[3] == 0;
+}
+
+uint32_t pack_sparse_weights_blocks(const int8_t *wt,
+                                    const uint32_t row_len,
+                                    const uint16_t ch_im_out)
+{
+    uint32_t total = (uint32_t)ch_im_out * row_len;
+    uint32_t num_blocks = 0;
+    uint32_t i;
+
+    for (i = 0; i < total; i += 4)
+    {
+        num_blocks += !sparse_block_is_zero(wt + i);
+    }
+    return num_blocks;
+}
+
+uint32_t pack_sparse_weights(const int8_t *wt,
+                             const uint32_t row_len,
+                             const uint16_t ch_im_out,
+                             uint32_t *row_ptr,
+                             uint16_t *col_idx,
+                             int8_t *values)
+{
+    uint32_t num_blocks = 0;
+    uint16_t ch;
+    uint32_t i;
+
+    for (ch = 0; ch < ch_im_out; ch++)
+    {
+        const int8_t *pA = wt + ch * row_len;
+
+        row_ptr[ch] = num_blocks;
+        for (i = 0; i < row_len; i += 4)
+        {
+            if (!sparse_block_is_zero(pA + i))
+            {
+                col_idx[num_blocks] = (uint16_t)(i / 4);
+                values[4 * num_blocks] = pA[i];
+                values[4 * num_blocks + 1] = pA[i + 1];
+                values[4 * num_blocks + 2] = pA[i + 2];
+                values[4 * num_blocks + 3] = pA[i + 3];
+                num_blocks++;
+            }
+        }
+    }
+    row_ptr[ch_im_out] = num_blocks;
+    return num_blocks;
+}
+
+static int int4_round(const int8_t w, const uint8_t shift)
+{
+    return shift ? (w + (1 << (shift - 1))) >> shift : w;
+}
+
+static int int4_quantise(const int8_t w, const uint8_t shift)
+{
+    int q = int4_round(w, shift);
+    return q < -8 ? -8 : (q > 7 ? 7 : q);
+}
+
+//Smallest shift of 0..4 that fits the weights in [-8, 7] after rounding
+static uint8_t int4_shift(const int8_t *wt, const uint32_t len)
+{
+    uint8_t shift;
+    uint32_t i;
+
+    for (shift = 0; shift < 4; shift++)
+    {
+        for (i = 0; i < len; i++)
+        {
+            int q = int4_round(wt[i], shift);
+            if (q < -8 || q > 7)
+            {
+                break;
+            }
+        }
+        if (i == len)
+        {
+            break;
+        }
+    }
+    return shift;
+}
+
+/*
+ * Quantise ch_im_out rows of row_len weights. Output channels 2j and 2j + 1
+ * share every word: byte k of 4 weights gets weight idx[k] of channel 2j in
+ * the low nibble and of channel 2j + 1 in the high nibble.
+ */
+static uint32_t pack_int4_weights(const int8_t *wt,
+                                  const uint32_t row_len,
+                                  const uint16_t ch_im_out,
+                                  const int per_channel,
+                                  const uint8_t *idx,
+                                  uint8_t *packed,
+                                  uint8_t *shift,
+                                  int8_t *expanded)
+{
+    uint8_t layer_shift = 0;
+    uint32_t max_err = 0;
+    uint16_t ch;
+    uint32_t i;
+    int k;
+
+    for (ch = 0; ch < ch_im_out; ch++)
+    {
+        shift[ch] = int4_shift(wt + ch * row_len, row_len);
+        layer_shift = shift[ch] > layer_shift ? shift[ch] : layer_shift;
+    }
+    if (!per_channel)
+    {
+        for (ch = 0; ch < ch_im_out; ch++)
+        {
+            shift[ch] = layer_shift;
+        }
+    }
+
+    for (ch = 0; ch < ch_im_out; ch += 2)
+    {
+        const int8_t *pA = wt + ch * row_len;
+        const int8_t *pA2 = pA + row_len;
+
+        for (i = 0; i < row_len; i += 4)
+        {
+            for (k = 0; k < 4; k++)
+            {
+                int lo = int4_quantise(pA[i + idx[k]], shift[ch]);
+                int hi = int4_quantise(pA2[i + idx[k]], shift[ch + 1]);
+                *packed++ = (uint8_t)((lo & 0xF) | ((hi & 0xF) << 4));
+            }
+        }
+    }
+
+    for (ch = 0; ch < ch_im_out; ch++)
+    {
+        const int8_t *pA = wt + ch * row_len;
+
+        for (i = 0; i < row_len; i++)
+        {
+            int8_t w = (int8_t)(int4_quantise(pA[i], shift[ch]) * (1 << shift[ch]));
+            uint32_t err = (uint32_t)(w > pA[i] ? w - pA[i] : pA[i] - w);
+
+            max_err = err > max_err ? err : max_err;
+            if (expanded)
+            {
+                expanded[ch * row_len + i] = w;
+            }
+        }
+    }
+    return max_err;
+}
+
+uint32_t pack_pointwise_int4_weights(const int8_t *wt,
+                                     const uint16_t ch_im_in,
+                                     const uint16_t ch_im_out,
+                                     const int per_channel,
+                                     uint8_t *packed,
+                                     uint8_t *shift,
+                                     int8_t *expanded)
+{
+    static const uint8_t idx[4] = {0, 1, 2, 3};
+
+    return pack_int4_weights(wt, ch_im_in, ch_im_out, per_channel, idx, packed, shift, expanded);
+}
+
+uint32_t pack_conv_int4_weights(const int8_t *wt,
+                                const uint16_t ch_im_in,
+                                const uint16_t ch_im_out,
+                                const uint16_t dim_kernel,
+                                const int per_channel,
+                                uint8_t *packed,
+                                uint8_t *shift,
+                                int8_t *expanded)
+{
+    static const uint8_t idx[4] = {0, 2, 1, 3};
+
+    return pack_int4_weights(wt, (uint32_t)dim_kernel * dim_kernel * ch_im_in, ch_im_out, per_channel, idx, packed,
+                             shift, expanded);
+}
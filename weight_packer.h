@@ -0,0 +1,151 @@
+#ifndef WEIGHT_PACKER_H
+#define WEIGHT_PACKER_H
+
+/**
+ * @brief Host-side weight packer
+ *
+ * @details
+ * Converts plain q7 weights (OHWI, as used by conv_HWC and pointwise_conv_*)
+ * into the layouts read by the *_packed kernels, so nothing is widened or
+ * reordered at runtime, into the block-sparse layout of the *_sparse
+ * kernels and into the int4 layout of the *_int4 kernels. Only depends on the
+ * C standard library.
+*/
+
+#include <stdint.h>
+
+/**
+ * @brief Size of the conv_HWC_packed weights (in q15)
+ */
+uint32_t pack_conv_HWC_weights_size(const uint16_t ch_im_in,
+                                    const uint16_t ch_im_out,
+                                    const uint16_t dim_kernel);
+
+/**
+ * @brief Pack conv_HWC weights for conv_HWC_packed
+ * @param[in]       wt          q7 weights, ch_im_out x dim_kernel x dim_kernel x ch_im_in
+ * @param[in]       ch_im_in    Input tensor channel, even
+ * @param[in]       ch_im_out   Output tensor channel, even
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[out]      packed      q15 weights, pack_conv_HWC_weights_size() elements
+ *
+ * @details
+ * Weights are widened to q15 and interleaved by output channel pair, two
+ * weights of channel 2n followed by the same two weights of channel 2n+1.
+ */
+void pack_conv_HWC_weights(const int8_t *wt,
+                           const uint16_t ch_im_in,
+                           const uint16_t ch_im_out,
+                           const uint16_t dim_kernel,
+                           int16_t *packed);
+
+/**
+ * @brief Size of the pointwise_conv_fast_packed weights (in q15)
+ */
+uint32_t pack_pointwise_fast_weights_size(const uint16_t ch_im_in,
+                                          const uint16_t ch_im_out);
+
+/**
+ * @brief Pack pointwise weights for pointwise_conv_fast_packed
+ * @param[in]       wt          q7 weights, ch_im_out x ch_im_in
+ * @param[in]       ch_im_in    Input tensor channel, multiple of 4
+ * @param[in]       ch_im_out   Output tensor channel, even
+ * @param[out]      packed      q15 weights, pack_pointwise_fast_weights_size() elements
+ *
+ * @details
+ * Weights are widened to q15 in the reordered layout of
+ * arm_q7_to_q15_reordered_no_shift (w0 w2 w1 w3) and interleaved by output
+ * channel pair, four weights of channel 2n followed by the same four weights
+ * of channel 2n+1.
+ */
+void pack_pointwise_fast_weights(const int8_t *wt,
+                                 const uint16_t ch_im_in,
+                                 const uint16_t ch_im_out,
+                                 int16_t *packed);
+
+/**
+ * @brief Number of 4-weight blocks with a non-zero weight
+ * @param[in]       wt          q7 weights, ch_im_out x row_len
+ * @param[in]       row_len     Weights per output channel, multiple of 4
+ * @param[in]       ch_im_out   Output tensor channel
+ * @return          Entries of col_idx for pack_sparse_weights, values has 4 times more
+ */
+uint32_t pack_sparse_weights_blocks(const int8_t *wt,
+                                    const uint32_t row_len,
+                                    const uint16_t ch_im_out);
+
+/**
+ * @brief Pack weights for pointwise_conv_sparse and conv_HWC_sparse
+ * @param[in]       wt          q7 weights, ch_im_out x row_len
+ * @param[in]       row_len     Weights per output channel: ch_im_in for pointwise,
+ *                              dim_kernel * dim_kernel * ch_im_in for conv, multiple of 4
+ * @param[in]       ch_im_out   Output tensor channel
+ * @param[out]      row_ptr     ch_im_out + 1 block offsets
+ * @param[out]      col_idx     Block index in the row of each stored block
+ * @param[out]      values      4 weights per stored block
+ * @return          Number of stored blocks
+ *
+ * @details
+ * CSR by output channel over blocks of 4 consecutive weights, see
+ * nn_sparse_weights. Blocks of 4 zero weights are dropped, the others keep
+ * their zeros. values must be placed word aligned.
+ */
+uint32_t pack_sparse_weights(const int8_t *wt,
+                             const uint32_t row_len,
+                             const uint16_t ch_im_out,
+                             uint32_t *row_ptr,
+                             uint16_t *col_idx,
+                             int8_t *values);
+
+/**
+ * @brief Quantise pointwise weights to int4 for pointwise_conv_fast_int4
+ * @param[in]       wt          q7 weights, ch_im_out x ch_im_in
+ * @param[in]       ch_im_in    Input tensor channel, multiple of 4
+ * @param[in]       ch_im_out   Output tensor channel, even
+ * @param[in]       per_channel 1 for a shift per output channel, 0 for one shift for the layer
+ * @param[out]      packed      ch_im_in * ch_im_out / 2 bytes
+ * @param[out]      shift       ch_im_out shifts, all equal when per_channel is 0
+ * @param[out]      expanded    q7 weights the kernel computes with (w_int4 << shift), NULL if not needed
+ * @return          Largest absolute difference between wt and expanded
+ *
+ * @details
+ * The shift of a channel (or of the layer) is the smallest of 0..4 that fits
+ * its weights in [-8, 7] after rounding, clamping at 4. Output channels are
+ * packed in pairs, 4 input channels per word: byte k holds weight k of
+ * channel 2j in the low nibble and weight k of channel 2j + 1 in the high
+ * nibble, the order of the reordered q15 columns of pointwise_conv_fast.
+ */
+uint32_t pack_pointwise_int4_weights(const int8_t *wt,
+                                     const uint16_t ch_im_in,
+                                     const uint16_t ch_im_out,
+                                     const int per_channel,
+                                     uint8_t *packed,
+                                     uint8_t *shift,
+                                     int8_t *expanded);
+
+/**
+ * @brief Quantise conv_HWC weights to int4 for conv_HWC_int4
+ * @param[in]       wt          q7 weights, ch_im_out x dim_kernel x dim_kernel x ch_im_in
+ * @param[in]       ch_im_in    Input tensor channel, dim_kernel * dim_kernel * ch_im_in multiple of 4
+ * @param[in]       ch_im_out   Output tensor channel, even
+ * @param[in]       dim_kernel  Kernel dimention
+ * @param[in]       per_channel 1 for a shift per output channel, 0 for one shift for the layer
+ * @param[out]      packed      dim_kernel * dim_kernel * ch_im_in * ch_im_out / 2 bytes
+ * @param[out]      shift       ch_im_out shifts, all equal when per_channel is 0
+ * @param[out]      expanded    q7 weights the kernel computes with (w_int4 << shift), NULL if not needed
+ * @return          Largest absolute difference between wt and expanded
+ *
+ * @details
+ * As pack_pointwise_int4_weights, with bytes 0..3 of every word holding
+ * weights 0, 2, 1, 3, the order of the plain q15 columns of conv_HWC.
+ */
+uint32_t pack_conv_int4_weights(const int8_t *wt,
+                                const uint16_t ch_im_in,
+                                const uint16_t ch_im_out,
+                                const uint16_t dim_kernel,
+                                const int per_channel,
+                                uint8_t *packed,
+                                uint8_t *shift,
+                                int8_t *expanded);
+
+#endif